@@ -0,0 +1,113 @@
+// internal/vision/flow_control.go
+package vision
+
+import "sync"
+
+// FrameCredits tracks, per camera, how many frames may be sent to the vision
+// service on a ProcessFrames stream without being shed.
+//
+// The service advertises a credit window per camera in every
+// FrameResponse.flow_control. A frame is in flight from the moment it is sent
+// until its response arrives or the service reports it as shed, so the
+// client-side view is: available = window - (sent - answered - shed).
+//
+// A ProcessFrames sender owns one tracker per stream: it calls TryAcquire
+// before each frame and Update with every FrameResponse.flow_control.
+type FrameCredits struct {
+	mutex         sync.Mutex
+	cameras       map[string]*cameraCredits
+	defaultWindow int32
+}
+
+type cameraCredits struct {
+	window   int32
+	sent     int64
+	answered int64
+	shed     int64
+}
+
+// NewFrameCredits creates a tracker; defaultWindow applies to cameras the
+// service has not answered for yet.
+func NewFrameCredits(defaultWindow int32) *FrameCredits {
+	if defaultWindow < 1 {
+		defaultWindow = 1
+	}
+	return &FrameCredits{
+		cameras:       make(map[string]*cameraCredits),
+		defaultWindow: defaultWindow,
+	}
+}
+
+func (fc *FrameCredits) camera(cameraID string) *cameraCredits {
+	cc, exists := fc.cameras[cameraID]
+	if !exists {
+		cc = &cameraCredits{window: fc.defaultWindow}
+		fc.cameras[cameraID] = cc
+	}
+	return cc
+}
+
+func (cc *cameraCredits) available() int32 {
+	inFlight := cc.sent - cc.answered - cc.shed
+	if inFlight < 0 {
+		inFlight = 0
+	}
+	available := int64(cc.window) - inFlight
+	if available < 0 {
+		return 0
+	}
+	return int32(available)
+}
+
+// TryAcquire consumes one credit for cameraID. It returns false when the
+// frame should be dropped (or delayed) on the client side instead of sent.
+func (fc *FrameCredits) TryAcquire(cameraID string) bool {
+	fc.mutex.Lock()
+	defer fc.mutex.Unlock()
+
+	cc := fc.camera(cameraID)
+	if cc.available() == 0 {
+		return false
+	}
+	cc.sent++
+	return true
+}
+
+// Update applies the flow control block received with a frame response.
+func (fc *FrameCredits) Update(cameraID string, window int32, framesShed int64) {
+	fc.mutex.Lock()
+	defer fc.mutex.Unlock()
+
+	cc := fc.camera(cameraID)
+	cc.answered++
+	if window > 0 {
+		cc.window = window
+	}
+	if framesShed > cc.shed {
+		cc.shed = framesShed
+	}
+}
+
+// Available returns the number of frames that can currently be sent.
+func (fc *FrameCredits) Available(cameraID string) int32 {
+	fc.mutex.Lock()
+	defer fc.mutex.Unlock()
+
+	return fc.camera(cameraID).available()
+}
+
+// FramesShed returns how many frames the service reported as shed.
+func (fc *FrameCredits) FramesShed(cameraID string) int64 {
+	fc.mutex.Lock()
+	defer fc.mutex.Unlock()
+
+	return fc.camera(cameraID).shed
+}
+
+// Reset forgets a camera, e.g. when its stream is stopped.
+func (fc *FrameCredits) Reset(cameraID string) {
+	fc.mutex.Lock()
+	defer fc.mutex.Unlock()
+
+	delete(fc.cameras, cameraID)
+}
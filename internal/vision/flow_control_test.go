@@ -0,0 +1,53 @@
+// internal/vision/flow_control_test.go
+package vision
+
+import "testing"
+
+func TestFrameCredits_AcquireWithinWindow(t *testing.T) {
+	credits := NewFrameCredits(2)
+
+	if !credits.TryAcquire("cam") || !credits.TryAcquire("cam") {
+		t.Fatalf("Expected the first two frames to be accepted")
+	}
+	if credits.TryAcquire("cam") {
+		t.Errorf("Expected third frame to be refused without credits")
+	}
+
+	// Une réponse rend un crédit
+	credits.Update("cam", 2, 0)
+	if got := credits.Available("cam"); got != 1 {
+		t.Errorf("Expected 1 credit after a response, got %d", got)
+	}
+
+	// Les autres caméras ont leur propre budget
+	if got := credits.Available("other_cam"); got != 2 {
+		t.Errorf("Expected full window for another camera, got %d", got)
+	}
+}
+
+func TestFrameCredits_ShedFramesReturnCredits(t *testing.T) {
+	credits := NewFrameCredits(4)
+	for i := 0; i < 4; i++ {
+		credits.TryAcquire("cam")
+	}
+
+	// Le serveur a répondu à une frame et en a abandonné deux
+	credits.Update("cam", 4, 2)
+	if got := credits.Available("cam"); got != 3 {
+		t.Errorf("Expected 3 credits, got %d", got)
+	}
+	if got := credits.FramesShed("cam"); got != 2 {
+		t.Errorf("Expected 2 shed frames, got %d", got)
+	}
+
+	// Le serveur peut réduire la fenêtre
+	credits.Update("cam", 1, 2)
+	if got := credits.Available("cam"); got != 1 {
+		t.Errorf("Expected window shrink to 1 credit, got %d", got)
+	}
+
+	credits.Reset("cam")
+	if got := credits.Available("cam"); got != 4 {
+		t.Errorf("Expected default window after reset, got %d", got)
+	}
+}
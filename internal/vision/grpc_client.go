@@ -254,6 +254,7 @@ func (gc *grpcClient) stopStreamInternal(cameraID string) error {
 	stream.cancel()
 	close(stream.stopChan)
 	delete(gc.streams, cameraID)
+	gc.credits.Reset(cameraID)
 
 	log.Printf("✅ Stream stopped for camera: %s", cameraID)
 
@@ -0,0 +1,95 @@
+// benchmarks/bench_quantized_cnn.cpp
+// Débit du moteur int8 sur des imagettes 64 × 64 × 3, par jeu de noyaux,
+// sur un seul cœur. Réseau de type MobileNet aux poids aléatoires : le
+// coût ne dépend pas des valeurs.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "quantized_cnn.h"
+
+namespace {
+
+QuantizedLayer MakeLayer(QuantizedLayer::Type type, int kernel, int stride, int in, int out,
+                         size_t weights, std::mt19937* rng) {
+    std::uniform_int_distribution<int> weight(-64, 64);
+    QuantizedLayer layer;
+    layer.type = type;
+    layer.kernel = kernel;
+    layer.stride = stride;
+    layer.in_channels = in;
+    layer.out_channels = out;
+    layer.weights.resize(weights);
+    for (auto& w : layer.weights) {
+        w = static_cast<int8_t>(weight(*rng));
+    }
+    if (type != QuantizedLayer::Type::GLOBAL_POOL) {
+        layer.bias.assign(out, 512);
+        layer.multipliers.assign(out, 1 << 30);
+        layer.shifts.assign(out, -6);
+    }
+    return layer;
+}
+
+QuantizedNetwork BuildNetwork() {
+    using Type = QuantizedLayer::Type;
+    std::mt19937 rng(7);
+    QuantizedNetwork network;
+    network.SetInput(64, 64, 3);
+    network.AddLayer(MakeLayer(Type::CONV, 3, 2, 3, 16, 16 * 9 * 3, &rng));       // 32 × 32
+    network.AddLayer(MakeLayer(Type::DEPTHWISE, 3, 2, 16, 16, 9 * 16, &rng));     // 16 × 16
+    network.AddLayer(MakeLayer(Type::POINTWISE, 1, 1, 16, 32, 32 * 16, &rng));
+    network.AddLayer(MakeLayer(Type::DEPTHWISE, 3, 2, 32, 32, 9 * 32, &rng));     // 8 × 8
+    network.AddLayer(MakeLayer(Type::POINTWISE, 1, 1, 32, 64, 64 * 32, &rng));
+    network.AddLayer(MakeLayer(Type::DEPTHWISE, 3, 2, 64, 64, 9 * 64, &rng));     // 4 × 4
+    network.AddLayer(MakeLayer(Type::POINTWISE, 1, 1, 64, 64, 64 * 64, &rng));
+    network.AddLayer(MakeLayer(Type::GLOBAL_POOL, 1, 1, 64, 64, 0, &rng));
+    network.AddLayer(MakeLayer(Type::FULLY_CONNECTED, 1, 1, 64, 4, 4 * 64, &rng));
+    network.SetClasses({"person", "vehicle", "animal", "other"}, 1.0f / 256.0f);
+    return network;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int crops = argc > 1 ? std::atoi(argv[1]) : 5000;
+    QuantizedNetwork network = BuildNetwork();
+    std::string error;
+    if (crops <= 0 || !network.Finalize(&error)) {
+        std::fprintf(stderr, "Invalid benchmark setup: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::mt19937 rng(11);
+    std::vector<uint8_t> input(64 * 64 * 3);
+    for (auto& value : input) {
+        value = static_cast<uint8_t>(rng());
+    }
+
+    std::printf("Network: 64x64x3, %lld MAC per crop, best kernels: %s\n",
+                static_cast<long long>(network.GetMacsPerInference()),
+                QuantizedNetwork::KernelsToString(QuantizedNetwork::DetectKernels()));
+    for (QuantizedKernels kernels : {QuantizedKernels::SCALAR, QuantizedKernels::AVX2, QuantizedKernels::AVX512_VNNI}) {
+        network.SetKernels(kernels);
+        if (network.GetKernels() != kernels) {
+            std::printf("%-12s unsupported on this CPU\n", QuantizedNetwork::KernelsToString(kernels));
+            continue;
+        }
+        int64_t checksum = 0;
+        for (int i = 0; i < 100; ++i) {
+            checksum += network.Run(input.data())[0];  // préchauffage
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < crops; ++i) {
+            checksum += network.Run(input.data())[0];
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12s %9.0f crops/s  %6.2f GMAC/s  (checksum %lld)\n",
+                    QuantizedNetwork::KernelsToString(kernels), crops / seconds,
+                    crops * static_cast<double>(network.GetMacsPerInference()) / seconds / 1e9,
+                    static_cast<long long>(checksum));
+    }
+    return 0;
+}
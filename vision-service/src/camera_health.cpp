@@ -0,0 +1,207 @@
+// src/camera_health.cpp
+#include "camera_health.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace CameraHealthConstants;
+
+namespace {
+
+constexpr int EDGE_CELLS = FrameQualityStats::EDGE_CELLS;
+
+int64_t WallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+}  // namespace
+
+// =============================================================================
+// FrameQualityAccumulator
+// =============================================================================
+
+void FrameQualityAccumulator::Begin(int width, int height) {
+    width_ = width;
+    height_ = height;
+    laplacian_sum_ = 0.0;
+    laplacian_squares_ = 0.0;
+    edges_.fill(0.0);
+    samples_ = 0;
+}
+
+void FrameQualityAccumulator::AddRow(const uint8_t* above, const uint8_t* row, const uint8_t* below, int y) {
+    if (y % QUALITY_SAMPLE_STEP != 0 || y < 1 || y >= height_ - 1) {
+        return;
+    }
+
+    int cell_y = y * EDGE_CELLS / height_;
+    for (int x = 1; x < width_ - 1; x += QUALITY_SAMPLE_STEP) {
+        int center = row[x];
+        int left = row[x - 1];
+        int right = row[x + 1];
+        int up = above[x];
+        int down = below[x];
+
+        int laplacian = 4 * center - left - right - up - down;
+        laplacian_sum_ += laplacian;
+        laplacian_squares_ += static_cast<double>(laplacian) * laplacian;
+        edges_[cell_y * EDGE_CELLS + x * EDGE_CELLS / width_] += std::abs(right - left) + std::abs(down - up);
+        samples_++;
+    }
+}
+
+FrameQualityStats FrameQualityAccumulator::Finish() {
+    FrameQualityStats stats;
+    stats.samples = samples_;
+    if (samples_ == 0) {
+        return stats;
+    }
+    double laplacian_mean = laplacian_sum_ / samples_;
+    stats.sharpness = static_cast<float>(std::max(0.0, laplacian_squares_ / samples_ - laplacian_mean * laplacian_mean));
+
+    double total = 0.0;
+    for (double energy : edges_) {
+        total += energy;
+    }
+    if (total > 0.0) {
+        for (size_t i = 0; i < edges_.size(); ++i) {
+            stats.edges[i] = static_cast<float>(edges_[i] / total);
+        }
+    }
+    return stats;
+}
+
+// =============================================================================
+// CameraHealthMonitor
+// =============================================================================
+
+void CameraHealthMonitor::SetTransitionCallback(TransitionCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_transition_ = std::move(callback);
+}
+
+void CameraHealthMonitor::Update(const FrameQualityStats& stats, std::chrono::steady_clock::time_point now) {
+    if (stats.samples == 0) {
+        return;
+    }
+
+    CameraHealthStatus transition;
+    TransitionCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CameraHealthState previous = status_.state;
+        status_.current = stats;
+
+        if (status_.state == CameraHealthState::LEARNING) {
+            // Moyenne des premières frames
+            Learn(stats, 1.0f / static_cast<float>(reference_frames_ + 1));
+            if (++reference_frames_ >= REFERENCE_FRAMES) {
+                EnterState(CameraHealthState::OK);
+            }
+        } else {
+            status_.edge_change = EdgeDistance(stats, status_.reference);
+            CameraHealthState observed = Classify(stats, status_.edge_change);
+            if (observed == status_.state) {
+                candidate_frames_ = 0;
+                if (observed == CameraHealthState::OK) {
+                    Learn(stats, REFERENCE_TRACKING_RATE);
+                } else if (now - degraded_since_ >= std::chrono::milliseconds(RELEARN_MS)) {
+                    // Dégradé depuis trop longtemps : la nouvelle scène devient la référence
+                    reference_frames_ = 0;
+                    EnterState(CameraHealthState::LEARNING);
+                }
+            } else {
+                candidate_frames_ = observed == candidate_ ? candidate_frames_ + 1 : 1;
+                candidate_ = observed;
+                if (candidate_frames_ >= CONFIRM_FRAMES) {
+                    EnterState(observed);
+                    degraded_since_ = now;
+                }
+            }
+        }
+
+        if (status_.state != previous && on_transition_) {
+            transition = status_;
+            callback = on_transition_;
+        }
+    }
+    // Hors verrou : le callback peut relire l'état
+    if (callback) {
+        callback(transition);
+    }
+}
+
+CameraHealthStatus CameraHealthMonitor::GetStatus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+bool CameraHealthMonitor::IsThrottled() const {
+    return throttled_.load(std::memory_order_relaxed);
+}
+
+const char* CameraHealthMonitor::StateToString(CameraHealthState state) {
+    switch (state) {
+        case CameraHealthState::LEARNING: return "learning";
+        case CameraHealthState::OK: return "ok";
+        case CameraHealthState::BLACKOUT: return "blackout";
+        case CameraHealthState::GLARE: return "glare";
+        case CameraHealthState::TAMPER: return "tamper";
+        case CameraHealthState::BLUR: return "blur";
+    }
+    return "unknown";
+}
+
+float CameraHealthMonitor::EdgeDistance(const FrameQualityStats& a, const FrameQualityStats& b) {
+    // Demi-distance L1 entre deux répartitions : 0 identiques, 1 disjointes
+    float distance = 0.0f;
+    for (size_t i = 0; i < a.edges.size(); ++i) {
+        distance += std::fabs(a.edges[i] - b.edges[i]);
+    }
+    return std::min(1.0f, distance / 2.0f);
+}
+
+CameraHealthState CameraHealthMonitor::Classify(const FrameQualityStats& stats, float edge_change) const {
+    const FrameQualityStats& reference = status_.reference;
+    if (stats.brightness < BLACKOUT_BRIGHTNESS && stats.contrast < BLACKOUT_CONTRAST) {
+        return CameraHealthState::BLACKOUT;
+    }
+    // Avant la comparaison des contours, que l'éblouissement efface aussi
+    if (stats.saturated > GLARE_SATURATED_FRACTION && reference.saturated <= GLARE_SATURATED_FRACTION) {
+        return CameraHealthState::GLARE;
+    }
+    if (edge_change > TAMPER_EDGE_CHANGE || stats.contrast < OCCLUSION_CONTRAST_RATIO * reference.contrast) {
+        return CameraHealthState::TAMPER;
+    }
+    if (reference.sharpness >= MIN_REFERENCE_SHARPNESS &&
+        stats.sharpness < BLUR_SHARPNESS_RATIO * reference.sharpness) {
+        return CameraHealthState::BLUR;
+    }
+    return CameraHealthState::OK;
+}
+
+void CameraHealthMonitor::Learn(const FrameQualityStats& stats, float rate) {
+    FrameQualityStats& reference = status_.reference;
+    reference.brightness += rate * (stats.brightness - reference.brightness);
+    reference.contrast += rate * (stats.contrast - reference.contrast);
+    reference.saturated += rate * (stats.saturated - reference.saturated);
+    reference.sharpness += rate * (stats.sharpness - reference.sharpness);
+    // Combinaison convexe : la répartition reste normalisée
+    for (size_t i = 0; i < reference.edges.size(); ++i) {
+        reference.edges[i] += rate * (stats.edges[i] - reference.edges[i]);
+    }
+    reference.samples = stats.samples;
+}
+
+void CameraHealthMonitor::EnterState(CameraHealthState state) {
+    status_.state = state;
+    status_.transitions++;
+    status_.since_ms = WallClockMs();
+    status_.throttled = state != CameraHealthState::OK && state != CameraHealthState::LEARNING;
+    throttled_.store(status_.throttled, std::memory_order_relaxed);
+    candidate_ = state;
+    candidate_frames_ = 0;
+}
@@ -0,0 +1,137 @@
+// src/camera_health.h
+#ifndef CAMERA_HEALTH_H
+#define CAMERA_HEALTH_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+// Statistiques d'image d'une frame. Netteté et contours sont calculés sur
+// une ligne sur QUALITY_SAMPLE_STEP et un pixel sur QUALITY_SAMPLE_STEP ;
+// luminance, contraste et saturation viennent des caractéristiques de la
+// frame (FrameFeatures), déjà calculées pour le détecteur.
+struct FrameQualityStats {
+    static constexpr int EDGE_CELLS = 4;  // histogramme spatial EDGE_CELLS × EDGE_CELLS
+
+    float brightness = 0.0f;  // luminance moyenne (0-255)
+    float contrast = 0.0f;    // écart type de la luminance
+    float saturated = 0.0f;   // part des pixels au-delà de SATURATION_LEVEL
+    float sharpness = 0.0f;   // variance du laplacien
+    std::array<float, EDGE_CELLS * EDGE_CELLS> edges{};  // répartition de l'énergie des contours (somme 1)
+    uint32_t samples = 0;
+};
+
+// Netteté et contours, alimentés ligne par ligne pendant l'extraction des
+// caractéristiques de la frame (voir QualityStage) : les lignes
+// échantillonnées sont lues pendant qu'elles sont en cache, sans second
+// parcours de la frame. Finish() laisse luminance, contraste et saturation
+// à l'extracteur.
+class FrameQualityAccumulator {
+public:
+    void Begin(int width, int height);
+
+    // Luminance de la ligne y et de ses voisines (width octets chacune). Ne
+    // fait rien pour les lignes non échantillonnées : l'appelant peut la
+    // proposer à chaque ligne.
+    void AddRow(const uint8_t* above, const uint8_t* row, const uint8_t* below, int y);
+
+    FrameQualityStats Finish();
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    double laplacian_sum_ = 0.0;
+    double laplacian_squares_ = 0.0;
+    std::array<double, FrameQualityStats::EDGE_CELLS * FrameQualityStats::EDGE_CELLS> edges_{};
+    uint32_t samples_ = 0;
+};
+
+enum class CameraHealthState {
+    LEARNING,   // référence en cours d'apprentissage
+    OK,
+    BLACKOUT,   // image noire et uniforme : signal perdu, objectif couvert
+    GLARE,      // image en grande partie saturée : soleil ou projecteur dans l'objectif
+    TAMPER,     // scène différente de la référence : caméra déplacée ou masquée
+    BLUR        // netteté effondrée : mise au point, buée, objectif sali
+};
+
+struct CameraHealthStatus {
+    CameraHealthState state = CameraHealthState::LEARNING;
+    FrameQualityStats current;
+    FrameQualityStats reference;
+    float edge_change = 0.0f;       // distance à la référence (0-1)
+    int64_t transitions = 0;        // changements d'état depuis le démarrage
+    int64_t since_ms = 0;           // entrée dans l'état, ms depuis epoch
+    bool throttled = false;
+};
+
+// Surveillance de l'image d'une caméra : compare les statistiques de chaque
+// frame à une référence apprise au démarrage puis suivie lentement (jour,
+// nuit) tant que l'image est saine. Un état dégradé n'est retenu qu'après
+// CONFIRM_FRAMES frames consécutives, et la caméra repart à l'apprentissage
+// si elle reste dégradée RELEARN_MS (caméra volontairement réorientée).
+//
+// Tant qu'un état est dégradé, le traitement est ralenti (IsThrottled) :
+// seule une frame sur THROTTLE_INTERVAL est analysée, assez pour voir le
+// retour à la normale.
+//
+// Update() est appelé par le thread de traitement, GetStatus() depuis
+// n'importe quel thread.
+class CameraHealthMonitor {
+public:
+    using TransitionCallback = std::function<void(const CameraHealthStatus&)>;
+
+    CameraHealthMonitor() = default;
+
+    CameraHealthMonitor(const CameraHealthMonitor&) = delete;
+    CameraHealthMonitor& operator=(const CameraHealthMonitor&) = delete;
+
+    // Appelé (thread de traitement) à chaque changement d'état
+    void SetTransitionCallback(TransitionCallback callback);
+
+    void Update(const FrameQualityStats& stats, std::chrono::steady_clock::time_point now);
+    CameraHealthStatus GetStatus() const;
+    bool IsThrottled() const;
+
+    static const char* StateToString(CameraHealthState state);
+    static float EdgeDistance(const FrameQualityStats& a, const FrameQualityStats& b);
+
+private:
+    mutable std::mutex mutex_;
+    CameraHealthStatus status_;
+    std::atomic<bool> throttled_{false};
+    TransitionCallback on_transition_;
+
+    uint32_t reference_frames_ = 0;
+    CameraHealthState candidate_ = CameraHealthState::OK;
+    int candidate_frames_ = 0;
+    std::chrono::steady_clock::time_point degraded_since_;
+
+    CameraHealthState Classify(const FrameQualityStats& stats, float edge_change) const;
+    void Learn(const FrameQualityStats& stats, float rate);
+    void EnterState(CameraHealthState state);
+};
+
+namespace CameraHealthConstants {
+    constexpr int QUALITY_SAMPLE_STEP = 4;
+    constexpr uint32_t REFERENCE_FRAMES = 30;
+    constexpr float REFERENCE_TRACKING_RATE = 0.002f;  // suivi lent hors dégradation
+
+    constexpr float BLACKOUT_BRIGHTNESS = 20.0f;
+    constexpr float BLACKOUT_CONTRAST = 8.0f;
+    constexpr int SATURATION_LEVEL = 250;
+    constexpr float GLARE_SATURATED_FRACTION = 0.3f;   // scène de référence en deçà
+    constexpr float TAMPER_EDGE_CHANGE = 0.5f;
+    constexpr float OCCLUSION_CONTRAST_RATIO = 0.25f;   // du contraste de référence
+    constexpr float BLUR_SHARPNESS_RATIO = 0.3f;        // de la netteté de référence
+    constexpr float MIN_REFERENCE_SHARPNESS = 20.0f;    // scène trop lisse pour juger du flou
+
+    constexpr int CONFIRM_FRAMES = 10;
+    constexpr int THROTTLE_INTERVAL = 5;
+    constexpr int64_t RELEARN_MS = 10 * 60 * 1000;
+}
+
+#endif // CAMERA_HEALTH_H
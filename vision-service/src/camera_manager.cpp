@@ -6,8 +6,27 @@
 #include <random>
 #include <limits>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using namespace CameraManagerConstants;
 
+namespace {
+
+// Camera whose capture step runs on this thread; a pooled capture has no
+// thread id of its own to compare against
+thread_local const CameraManager* current_capture = nullptr;
+
+struct CaptureScope {
+    explicit CaptureScope(const CameraManager* camera) : previous(current_capture) { current_capture = camera; }
+    ~CaptureScope() { current_capture = previous; }
+    const CameraManager* previous;
+};
+
+}  // namespace
+
 // =============================================================================
 // CameraManager Implementation
 // =============================================================================
@@ -59,6 +78,29 @@ bool CameraManager::Initialize(const CameraConfig& config) {
         config_ = config;
     }
 
+    CircuitBreakerConfig breaker_config;
+    breaker_config.failure_threshold = config.max_reconnect_attempts;
+    breaker_config.open_ms = config.circuit_open_ms;
+    breaker_config.max_open_ms = config.circuit_open_max_ms;
+    breaker_.SetConfig(breaker_config);
+    breaker_.Reset();
+
+    bool success = InitializeCapture();
+
+    if (success) {
+        SetState(CameraState::READY);
+        stats_.Reset();
+        std::cerr << "[CameraManager] Initialization successful." << std::endl;
+    } else {
+        SetState(CameraState::ERROR);
+        std::cerr << "[CameraManager] Initialization failed." << std::endl;
+    }
+
+    return success;
+}
+
+bool CameraManager::InitializeCapture() {
+    std::cerr << "[CameraManager] InitializeCapture() called." << std::endl;
     bool success = false;
     try {
         switch (camera_type_) {
@@ -89,16 +131,6 @@ bool CameraManager::Initialize(const CameraConfig& config) {
         SetError("Unknown exception during initialization");
         success = false;
     }
-
-    if (success) {
-        SetState(CameraState::READY);
-        stats_.start_time = std::chrono::steady_clock::now();
-        std::cerr << "[CameraManager] Initialization successful." << std::endl;
-    } else {
-        SetState(CameraState::ERROR);
-        std::cerr << "[CameraManager] Initialization failed." << std::endl;
-    }
-
     return success;
 }
 
@@ -141,17 +173,28 @@ bool CameraManager::StartCapture() {
     }
 
     try {
-        // Start capture thread
-        capture_thread_ = std::make_unique<std::thread>(&CameraManager::CaptureLoop, this);
+        loop_exited_ = false;
         is_capturing_ = true;
+        if (IsCooperative()) {
+            // A previous stop left the sleeper woken
+            sleeper_.Bind(frame_clock_, executor_);
+            sleeper_.Reset();
+            if (!SpawnCaptureTask()) {
+                throw std::runtime_error("executor stopped");
+            }
+            std::cerr << "[CameraManager] Capture task started on the shared executor." << std::endl;
+        } else {
+            capture_thread_ = std::make_unique<std::thread>(&CameraManager::CaptureLoop, this);
+            std::cerr << "[CameraManager] Capture thread started successfully." << std::endl;
+        }
         SetState(CameraState::CAPTURING);
-        std::cerr << "[CameraManager] Capture thread started successfully." << std::endl;
         return true;
     } catch (const std::exception& e) {
         {
             std::lock_guard<std::mutex> lock(config_mutex_);
             should_stop_ = true;
             is_capturing_ = false;
+            loop_exited_ = true;
             SetState(CameraState::READY);
         }
         SetError("Failed to start capture thread: " + std::string(e.what()));
@@ -165,18 +208,48 @@ bool CameraManager::StartCapture() {
 
 bool CameraManager::StopCapture() {
     std::cerr << "[CameraManager] StopCapture() called." << std::endl;
-    if (!is_capturing_.load()) {
-        std::cerr << "[CameraManager] Not capturing, nothing to stop." << std::endl;
-        return true;  // Already stopped
+    TimerWheel::TimerId circuit_timer = 0;
+    {
+        // A half-open trial swaps capture_thread_ under this lock
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        if ((capture_thread_ && std::this_thread::get_id() == capture_thread_->get_id()) ||
+            current_capture == this) {
+            std::cerr << "[CameraManager] StopCapture called from capture thread itself. Operation aborted." << std::endl;
+            return false;
+        }
+        should_stop_ = true;
+        std::swap(circuit_timer, circuit_timer_);
     }
+    stop_condition_.notify_all();
+    sleeper_.Wake();
 
-    // Check if called from the capture thread itself
-    if (capture_thread_ && std::this_thread::get_id() == capture_thread_->get_id()) {
-        std::cerr << "[CameraManager] StopCapture called from capture thread itself. Operation aborted." << std::endl;
-        return false;
+    // An open circuit has no thread, only its wheel entry. Cancel() waits
+    // for a trial already running, so no new thread can appear after this.
+    if (circuit_timer != 0 && timer_wheel_) {
+        timer_wheel_->Cancel(circuit_timer);
+    }
+
+    // A pooled capture is only referenced by its own frame: wait until it
+    // has left this object for good
+    {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        WaitForCaptureTaskExit(lock);
+    }
+
+    // The loop clears is_capturing_ when it exits on its own (stop request,
+    // fatal error, open circuit): its thread must still be joined
+    bool has_thread = capture_thread_ && capture_thread_->joinable();
+    if (!is_capturing_.load() && !has_thread) {
+        // A pooled capture stopped by this call exits still CAPTURING
+        CameraState state = state_.load();
+        if (state == CameraState::CIRCUIT_OPEN ||
+            (IsCooperative() && (state == CameraState::CAPTURING || state == CameraState::RECONNECTING))) {
+            SetState(CameraState::READY);
+        }
+        std::cerr << "[CameraManager] Not capturing, nothing to stop." << std::endl;
+        return true;  // Already stopped
     }
 
-    should_stop_ = true;
     std::cerr << "[CameraManager] Stopping capture..." << std::endl;
 
     // Wait for thread to finish
@@ -193,7 +266,9 @@ bool CameraManager::StopCapture() {
     capture_thread_.reset();
     is_capturing_ = false;
 
-    if (state_ == CameraState::CAPTURING) {
+    CameraState state = state_.load();
+    if (state == CameraState::CAPTURING || state == CameraState::RECONNECTING ||
+        state == CameraState::CIRCUIT_OPEN) {
         SetState(CameraState::READY);
     }
 
@@ -201,6 +276,84 @@ bool CameraManager::StopCapture() {
     return true;
 }
 
+void CameraManager::RequestStop() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        should_stop_ = true;
+    }
+    stop_condition_.notify_all();
+    sleeper_.Wake();
+}
+
+bool CameraManager::Abandon() {
+    RequestStop();
+
+    // A thread hung inside the callback still uses it: retry later
+    std::unique_lock<std::mutex> lock(callback_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        std::cerr << "[CameraManager] Abandon() deferred: capture thread busy in callback." << std::endl;
+        return false;
+    }
+    frame_callback_ = nullptr;
+    std::cerr << "[CameraManager] Capture abandoned for: " << camera_url_ << std::endl;
+    return true;
+}
+
+bool CameraManager::HasCaptureLoopExited() const {
+    return loop_exited_.load();
+}
+
+void CameraManager::DetachCaptureThread() {
+    if (capture_thread_ && capture_thread_->joinable()) {
+        std::cerr << "[CameraManager] Detaching hung capture thread for: " << camera_url_ << std::endl;
+        capture_thread_->detach();
+    }
+    capture_thread_.reset();
+}
+
+void CameraManager::SetTimerWheel(TimerWheel* timer_wheel) {
+    timer_wheel_ = timer_wheel;
+}
+
+void CameraManager::SetExecutor(WorkerPool* executor, TimerWheel* frame_clock) {
+    executor_ = executor;
+    frame_clock_ = frame_clock;
+}
+
+bool CameraManager::IsCooperative() const {
+#ifdef HAVE_OPENCV
+    // OpenCV reads can block indefinitely: they keep a thread the watchdog
+    // is able to abandon
+    if (camera_type_ != CameraType::TEST_PATTERN) {
+        return false;
+    }
+#endif
+    return executor_ != nullptr && frame_clock_ != nullptr && timer_wheel_ != nullptr;
+}
+
+CircuitBreakerStatus CameraManager::GetCircuitBreakerStatus() const {
+    return breaker_.GetStatus();
+}
+
+bool CameraManager::SetCpuAffinity(const std::vector<int>& cpus) {
+    if (!cpus.empty() && IsCooperative()) {
+        std::cerr << "[CameraManager] CPU affinity ignored for " << camera_url_
+                  << ": cooperative capture runs on the shared executor." << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        cpu_affinity_ = cpus;
+    }
+    affinity_pending_ = true;
+    return true;
+}
+
+std::vector<int> CameraManager::GetCpuAffinity() const {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    return cpu_affinity_;
+}
+
 void CameraManager::SetConfig(const CameraConfig& config) {
     std::lock_guard<std::mutex> lock(config_mutex_);
     std::cerr << "[CameraManager] SetConfig() called. Width: " << config.width
@@ -330,39 +483,200 @@ std::vector<std::string> CameraManager::GetAvailableWebcams() {
 
 void CameraManager::CaptureLoop() {
     std::cerr << "[CameraManager] CaptureLoop() started." << std::endl;
+    // A half-open trial reopens the source here, never on the wheel thread
+    bool reopen_source = breaker_.GetState() == CircuitState::HALF_OPEN;
+
+    // A new thread inherits its creator's affinity, not the camera's
+    affinity_pending_ = true;
+
     while (!should_stop_.load()) {
-        try {
-            if (!CaptureFrame()) {
-                std::cerr << "[CameraManager] CaptureFrame() failed." << std::endl;
-                if (config_.auto_reconnect && ShouldAttemptReconnect()) {
-                    std::cerr << "[CameraManager] Attempting reconnect..." << std::endl;
-                    AttemptReconnect();
-                } else {
-                    SetError("Capture failed and reconnect disabled");
-                    SetState(CameraState::ERROR);
-                    break;
-                }
+        if (affinity_pending_.exchange(false)) {
+            ApplyCpuAffinity();
+        }
+
+        CaptureStep step = RunCaptureStep(&reopen_source);
+        if (step == CaptureStep::STOP) {
+            break;
+        }
+        if (step == CaptureStep::CIRCUIT_OPEN) {
+            // Persistently dead source: give the thread back for the open period
+            if (OpenCircuit()) {
+                break;
             }
+            reopen_source = true;
+            continue;
+        }
+        if (step == CaptureStep::RECONNECT) {
+            std::cerr << "[CameraManager] Attempting reconnect..." << std::endl;
+            AttemptReconnect();
+        }
 
-            // Framerate control
-            std::this_thread::sleep_for(
-                std::chrono::milliseconds(1000 / std::max(1, config_.fps))
-            );
+        // Framerate control, interrupted as soon as a stop is requested
+        WaitForStop(std::chrono::milliseconds(1000 / std::max(1, config_.fps)));
+    }
 
-        } catch (const std::exception& e) {
-            HandleCaptureError("Capture exception: " + std::string(e.what()));
+    is_capturing_ = false;
+    std::cerr << "[CameraManager] CaptureLoop() exited." << std::endl;
+
+    // Last access to this object from the capture thread
+    loop_exited_ = true;
+}
+
+CameraManager::CaptureStep CameraManager::RunCaptureStep(bool* reopen_source) {
+    CaptureScope scope(this);
+    bool captured = false;
+    try {
+        captured = *reopen_source ? InitializeCapture() && CaptureFrame() : CaptureFrame();
+    } catch (const std::exception& e) {
+        HandleCaptureError("Capture exception: " + std::string(e.what()));
+    }
+    *reopen_source = false;
+
+    if (captured) {
+        breaker_.RecordSuccess(std::chrono::steady_clock::now());
+        if (state_ != CameraState::CAPTURING) {
+            reconnect_attempts_ = 0;
+            SetState(CameraState::CAPTURING);
+        }
+        return CaptureStep::NEXT_FRAME;
+    }
+    if (!config_.auto_reconnect) {
+        SetError("Capture failed and reconnect disabled");
+        SetState(CameraState::ERROR);
+        return CaptureStep::STOP;
+    }
+    if (breaker_.RecordFailure(std::chrono::steady_clock::now())) {
+        return CaptureStep::CIRCUIT_OPEN;
+    }
+    return CaptureStep::RECONNECT;
+}
+
+DetachedTask CameraManager::CaptureTask() {
+    // Runs on every exit path, exceptions included: the frame is freed
+    // right after, without touching this object again. Closing the channel
+    // lets the delivery task drain it and exit.
+    struct ExitGuard {
+        CameraManager* camera;
+        ~ExitGuard() {
+            camera->frames_.Close();
+            camera->ExitCaptureTask();
+        }
+    } exit_guard{this};
+
+    std::cerr << "[CameraManager] CaptureTask() started." << std::endl;
+    // Runs here up to its first co_await, then on the pool for each frame
+    DeliverTask();
+    bool reopen_source = breaker_.GetState() == CircuitState::HALF_OPEN;
+    auto interval = std::chrono::milliseconds(1000 / std::max(1, config_.fps));
+    auto next_frame = std::chrono::steady_clock::now();
+
+    while (!should_stop_.load()) {
+        CaptureStep step = RunCaptureStep(&reopen_source);
+        if (step == CaptureStep::STOP) {
+            break;
+        }
+        if (step == CaptureStep::CIRCUIT_OPEN) {
+            // With a wheel the half-open trial spawns a new task
+            OpenCircuit();
+            break;
+        }
+        if (step == CaptureStep::RECONNECT) {
+            BeginReconnect();
+            auto retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.reconnect_delay_ms);
+            if (co_await sleeper_.SleepUntil(retry_at)) {
+                std::cerr << "[CameraManager] Reconnect aborted: stop requested." << std::endl;
+                break;
+            }
+            FinishReconnect();
+            next_frame = std::chrono::steady_clock::now();
+        }
+
+        // Absolute deadlines keep the framerate; a late frame does not
+        // trigger a burst, it only yields the worker to the other streams
+        next_frame += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (next_frame <= now) {
+            next_frame = now;
+            co_await ScheduleOn(*executor_);
+        } else {
+            co_await sleeper_.SleepUntil(next_frame);
+        }
+    }
+}
+
+DetachedTask CameraManager::DeliverTask() {
+    struct ExitGuard {
+        CameraManager* camera;
+        ~ExitGuard() { camera->ExitCaptureTask(); }
+    } exit_guard{this};
+
+    while (true) {
+        std::optional<Frame> frame = co_await frames_.Next();
+        if (!frame) {
+            break;
         }
+        // The callback may not stop its own capture
+        CaptureScope scope(this);
+        NotifyFrameAvailable(*frame);
+    }
+}
+
+bool CameraManager::SpawnCaptureTask() {
+    frames_.Bind(executor_);
+    frames_.Reset();
+    live_tasks_ = 2;
+    return executor_->Post([this]() { CaptureTask(); });
+}
+
+void CameraManager::ExitCaptureTask() {
+    if (live_tasks_.fetch_sub(1) == 1) {
+        MarkCaptureTaskExited();
     }
+}
 
+void CameraManager::MarkCaptureTaskExited() {
     is_capturing_ = false;
-    std::cerr << "[CameraManager] CaptureLoop() exited." << std::endl;
+    std::cerr << "[CameraManager] CaptureTask() exited." << std::endl;
+    {
+        // Notified under the lock: the waiter may destroy this object as
+        // soon as it sees loop_exited_
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        loop_exited_ = true;
+        exit_condition_.notify_all();
+    }
 }
 
-bool CameraManager::InitializeCapture() {
-    std::cerr << "[CameraManager] InitializeCapture() called." << std::endl;
-    // Common initialization
-    reconnect_attempts_ = 0;
-    return true;
+void CameraManager::WaitForCaptureTaskExit(std::unique_lock<std::mutex>& stop_lock) {
+    // A capture thread signals nothing here: it is joined instead
+    if (IsCooperative()) {
+        exit_condition_.wait(stop_lock, [this]() { return loop_exited_.load(); });
+    }
+}
+
+void CameraManager::ApplyCpuAffinity() {
+    std::vector<int> cpus = GetCpuAffinity();
+    if (cpus.empty()) {
+        return;
+    }
+#ifdef __linux__
+    // Frame buffers are then allocated and first touched on this node
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        std::cerr << "[CameraManager] Failed to pin capture thread: error " << result << std::endl;
+    }
+#endif
+}
+
+bool CameraManager::WaitForStop(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    return stop_condition_.wait_for(lock, timeout, [this]() { return should_stop_.load(); });
 }
 
 bool CameraManager::CaptureFrame() {
@@ -384,7 +698,7 @@ bool CameraManager::CaptureFrame() {
             break;
         case CameraType::TEST_PATTERN:
             frame = CaptureTestFrame();
-            success = true;  // Test frames are always valid
+            success = !frame.data.empty();  // Empty for test://offline
             break;
         default:
             success = false;
@@ -392,8 +706,13 @@ bool CameraManager::CaptureFrame() {
 
     if (success && ValidateFrame(frame)) {
         UpdateStats(frame);
-        NotifyFrameAvailable(frame);
         std::cerr << "[CameraManager] Frame captured and validated. Size: " << frame.data.size() << std::endl;
+        if (!IsCooperative()) {
+            NotifyFrameAvailable(frame);
+        } else if (frames_.Push(std::move(frame))) {
+            // Overtaken before the delivery task took it
+            stats_.RecordDrop();
+        }
     } else if (!success) {
         std::cerr << "[CameraManager] Frame capture failed." << std::endl;
     } else {
@@ -415,42 +734,96 @@ void CameraManager::HandleCaptureError(const std::string& error) {
 }
 
 void CameraManager::AttemptReconnect() {
-    std::cerr << "[CameraManager] AttemptReconnect() called. Attempt: " << reconnect_attempts_.load() << std::endl;
-    if (reconnect_attempts_.load() >= config_.max_reconnect_attempts) {
-        SetError("Maximum reconnect attempts exceeded");
-        SetState(CameraState::ERROR);
+    BeginReconnect();
+    if (WaitForStop(std::chrono::milliseconds(config_.reconnect_delay_ms))) {
+        std::cerr << "[CameraManager] Reconnect aborted: stop requested." << std::endl;
         return;
     }
+    FinishReconnect();
+}
 
+void CameraManager::BeginReconnect() {
+    std::cerr << "[CameraManager] AttemptReconnect() called. Attempt: " << reconnect_attempts_.load() << std::endl;
     SetState(CameraState::RECONNECTING);
     reconnect_attempts_++;
-    stats_.reconnect_count++;
-
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(config_.reconnect_delay_ms)
-    );
+    stats_.RecordReconnect();
+}
 
-    // Reinitialize capture
+void CameraManager::FinishReconnect() {
+    // Reopen the source; the next capture decides, and repeated failures
+    // open the circuit instead of retrying forever
     if (InitializeCapture()) {
-        SetState(CameraState::CAPTURING);
-        reconnect_attempts_ = 0;
-        std::cerr << "[CameraManager] Reconnect successful." << std::endl;
+        std::cerr << "[CameraManager] Source reopened." << std::endl;
     } else {
-        // Failure, try again if possible
         std::cerr << "[CameraManager] Reconnect failed." << std::endl;
-        if (ShouldAttemptReconnect()) {
-            AttemptReconnect();
-        } else {
-            SetState(CameraState::ERROR);
+    }
+}
+
+bool CameraManager::OpenCircuit() {
+    std::chrono::milliseconds open_period = breaker_.GetOpenPeriod();
+    SetState(CameraState::CIRCUIT_OPEN);
+    std::cerr << "[CameraManager] Circuit opened for " << camera_url_ << ", retry in "
+              << open_period.count() << " ms." << std::endl;
+
+#ifdef HAVE_OPENCV
+    opencv_capture_.reset();
+#endif
+
+    if (timer_wheel_) {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        if (!should_stop_.load()) {
+            circuit_timer_ = timer_wheel_->Schedule(open_period, [this]() { RunHalfOpenTrial(); });
         }
+        return true;
+    }
+
+    // Without a wheel this thread sleeps through the open period itself
+    if (WaitForStop(open_period)) {
+        return true;
     }
+    breaker_.BeginTrial(std::chrono::steady_clock::now());
+    SetState(CameraState::RECONNECTING);
+    return false;
 }
 
-bool CameraManager::ShouldAttemptReconnect() const {
-    bool should = config_.auto_reconnect &&
-           reconnect_attempts_.load() < config_.max_reconnect_attempts;
-    std::cerr << "[CameraManager] ShouldAttemptReconnect() = " << should << std::endl;
-    return should;
+void CameraManager::RunHalfOpenTrial() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    circuit_timer_ = 0;
+    if (should_stop_.load()) {
+        return;
+    }
+
+    // The previous capture thread or task exited when the circuit opened
+    if (capture_thread_ && capture_thread_->joinable()) {
+        capture_thread_->join();
+    }
+    WaitForCaptureTaskExit(lock);
+
+    auto now = std::chrono::steady_clock::now();
+    breaker_.BeginTrial(now);
+    SetState(CameraState::RECONNECTING);
+    std::cerr << "[CameraManager] Half-open trial for: " << camera_url_ << std::endl;
+
+    try {
+        loop_exited_ = false;
+        is_capturing_ = true;
+        if (IsCooperative()) {
+            if (!SpawnCaptureTask()) {
+                throw std::runtime_error("executor stopped");
+            }
+        } else {
+            capture_thread_ = std::make_unique<std::thread>(&CameraManager::CaptureLoop, this);
+        }
+    } catch (const std::exception& e) {
+        is_capturing_ = false;
+        loop_exited_ = true;
+        capture_thread_.reset();
+        SetError("Failed to start trial capture thread: " + std::string(e.what()));
+        breaker_.RecordFailure(now);
+        SetState(CameraState::CIRCUIT_OPEN);
+        circuit_timer_ = timer_wheel_->Schedule(breaker_.GetOpenPeriod(),
+                                                [this]() { RunHalfOpenTrial(); });
+    }
 }
 
 void CameraManager::SetState(CameraState new_state) {
@@ -553,6 +926,10 @@ bool CameraManager::InitializeRtspCapture() {
 
 bool CameraManager::InitializeTestPattern() {
     std::cerr << "[CameraManager] InitializeTestPattern() called." << std::endl;
+    // Source that blocks while opening, like an unresponsive RTSP server
+    if (camera_url_ == "test://slow-open") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLOW_OPEN_MS));
+    }
     // No OpenCV needed for test patterns
     return true;
 }
@@ -570,10 +947,25 @@ Frame CameraManager::CaptureFileFrame() {
         return CreateEmptyFrame();
     }
 
-    return ConvertFromMat(mat);
+    // Crop through a Mat view so conversion only touches the region
+    FrameRegion region = GetCaptureRegion(mat.cols, mat.rows);
+    if (!region.IsEmpty()) {
+        mat = mat(cv::Rect(region.x, region.y, region.width, region.height));
+    }
+    Frame frame = ConvertFromMat(mat);
+    frame.offset_x = region.x;
+    frame.offset_y = region.y;
+    return frame;
 #else
-    // Simulate without OpenCV
-    return FrameUtils::CreateTestFrame(config_.width, config_.height, config_.format);
+    // Simulate without OpenCV, directly at the region size
+    FrameRegion region = GetCaptureRegion(config_.width, config_.height);
+    if (region.IsEmpty()) {
+        return FrameUtils::CreateTestFrame(config_.width, config_.height, config_.format);
+    }
+    Frame frame = FrameUtils::CreateTestFrame(region.width, region.height, config_.format);
+    frame.offset_x = region.x;
+    frame.offset_y = region.y;
+    return frame;
 #endif
 }
 
@@ -590,10 +982,25 @@ Frame CameraManager::CaptureWebcamFrame() {
         return CreateEmptyFrame();
     }
 
-    return ConvertFromMat(mat);
+    // Crop through a Mat view so conversion only touches the region
+    FrameRegion region = GetCaptureRegion(mat.cols, mat.rows);
+    if (!region.IsEmpty()) {
+        mat = mat(cv::Rect(region.x, region.y, region.width, region.height));
+    }
+    Frame frame = ConvertFromMat(mat);
+    frame.offset_x = region.x;
+    frame.offset_y = region.y;
+    return frame;
 #else
-    // Simulate without OpenCV
-    return FrameUtils::CreateTestFrame(config_.width, config_.height, config_.format);
+    // Simulate without OpenCV, directly at the region size
+    FrameRegion region = GetCaptureRegion(config_.width, config_.height);
+    if (region.IsEmpty()) {
+        return FrameUtils::CreateTestFrame(config_.width, config_.height, config_.format);
+    }
+    Frame frame = FrameUtils::CreateTestFrame(region.width, region.height, config_.format);
+    frame.offset_x = region.x;
+    frame.offset_y = region.y;
+    return frame;
 #endif
 }
 
@@ -603,6 +1010,11 @@ Frame CameraManager::CaptureRtspFrame() {
 }
 
 Frame CameraManager::CaptureTestFrame() {
+    // Reachable source that never delivers a frame
+    if (camera_url_ == "test://offline") {
+        return CreateEmptyFrame();
+    }
+
     static TestPatternGenerator generator(config_.width, config_.height);
     static int pattern_type = 0;
 
@@ -616,12 +1028,43 @@ Frame CameraManager::CaptureTestFrame() {
     }
 
     // Change pattern every 5 seconds (approx)
-    if (stats_.frames_captured.load() % (std::max(1, config_.fps) * 5) == 0) {
+    if (stats_.Local().frames_captured % (std::max(1, config_.fps) * 5) == 0) {
         pattern_type++;
         std::cerr << "[CameraManager] TestPatternGenerator: pattern_type changed to " << pattern_type << std::endl;
     }
 
-    return frame;
+    return CropToCaptureRegion(std::move(frame));
+}
+
+FrameRegion CameraManager::GetCaptureRegion(int source_width, int source_height) const {
+    FrameRegion region;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        region = config_.region_of_interest;
+    }
+    if (region.IsEmpty()) {
+        return FrameRegion();
+    }
+
+    // The source may not deliver the configured resolution
+    int x0 = std::clamp(region.x, 0, source_width);
+    int y0 = std::clamp(region.y, 0, source_height);
+    int x1 = std::clamp(region.x + region.width, x0, source_width);
+    int y1 = std::clamp(region.y + region.height, y0, source_height);
+    if (x1 - x0 < FrameProcessorConstants::MIN_FRAME_WIDTH ||
+        y1 - y0 < FrameProcessorConstants::MIN_FRAME_HEIGHT ||
+        (x1 - x0 == source_width && y1 - y0 == source_height)) {
+        return FrameRegion();
+    }
+    return FrameRegion(x0, y0, x1 - x0, y1 - y0);
+}
+
+Frame CameraManager::CropToCaptureRegion(Frame frame) const {
+    FrameRegion region = GetCaptureRegion(frame.width, frame.height);
+    if (region.IsEmpty()) {
+        return frame;
+    }
+    return FrameUtils::CropFrame(frame, region);
 }
 
 Frame CameraManager::CreateEmptyFrame() const {
@@ -651,11 +1094,9 @@ bool CameraManager::ValidateFrame(const Frame& frame) const {
 }
 
 void CameraManager::UpdateStats(const Frame& frame) {
-    stats_.frames_captured++;
-    stats_.bytes_received += frame.data.size();
-    stats_.last_frame_time = std::chrono::steady_clock::now();
-    std::cerr << "[CameraManager] UpdateStats(): frames_captured=" << stats_.frames_captured
-              << ", bytes_received=" << stats_.bytes_received << std::endl;
+    stats_.RecordFrame(frame.data.size());
+    std::cerr << "[CameraManager] UpdateStats(): frames_captured=" << stats_.Local().frames_captured
+              << ", bytes_received=" << stats_.Local().bytes_received << std::endl;
 }
 
 // =============================================================================
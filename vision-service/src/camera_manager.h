@@ -18,6 +18,11 @@
 #endif
 
 #include "frame_processor.h"
+#include "stats_block.h"
+#include "circuit_breaker.h"
+#include "timer_wheel.h"
+#include "worker_pool.h"
+#include "coroutine.h"
 
 // Énumération des types de caméras supportés
 enum class CameraType {
@@ -37,8 +42,11 @@ struct CameraConfig {
     std::string format = "bgr";
     bool auto_reconnect = true;
     int reconnect_delay_ms = 5000;
-    int max_reconnect_attempts = 3;
+    int max_reconnect_attempts = 3;  // échecs consécutifs avant ouverture du disjoncteur
+    int circuit_open_ms = 5000;      // première période d'ouverture, doublée à chaque récidive
+    int circuit_open_max_ms = 300000;
     int frame_buffer_size = 30;
+    FrameRegion region_of_interest;  // recadrage à la capture (vide = frame entière)
     
     CameraConfig() = default;
     CameraConfig(int w, int h, int f) : width(w), height(h), fps(f) {}
@@ -52,24 +60,23 @@ enum class CameraState {
     CAPTURING,
     ERROR,
     DISCONNECTED,
-    RECONNECTING
+    RECONNECTING,
+    CIRCUIT_OPEN    // disjoncteur ouvert : aucun thread, une entrée de roue
 };
 
-// Statistiques d'une caméra
-struct CameraStats {
-    std::atomic<int64_t> frames_captured{0};
-    std::atomic<int64_t> frames_dropped{0};
-    std::atomic<int64_t> bytes_received{0};
-    std::atomic<int64_t> reconnect_count{0};
+// Instantané des statistiques d'une caméra
+struct CameraStatsSnapshot {
+    int64_t frames_captured = 0;
+    int64_t frames_dropped = 0;
+    int64_t bytes_received = 0;
+    int64_t reconnect_count = 0;
     std::chrono::steady_clock::time_point start_time;
     std::chrono::steady_clock::time_point last_frame_time;
     
-    CameraStats() : start_time(std::chrono::steady_clock::now()) {}
-    
     double GetFpsActual() const {
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
-        return elapsed.count() > 0 ? static_cast<double>(frames_captured.load()) / elapsed.count() : 0.0;
+        return elapsed.count() > 0 ? static_cast<double>(frames_captured) / elapsed.count() : 0.0;
     }
     
     double GetUptimeSeconds() const {
@@ -78,6 +85,48 @@ struct CameraStats {
     }
 };
 
+// Statistiques d'une caméra : écrites par le thread de capture (ou par
+// Initialize() avant son démarrage), lues par instantanés cohérents
+class CameraStats {
+public:
+    CameraStats() { Reset(); }
+    
+    // Écrivain uniquement
+    void Reset() {
+        block_.Update([](CameraStatsSnapshot& stats) {
+            stats = CameraStatsSnapshot();
+            stats.start_time = std::chrono::steady_clock::now();
+        });
+    }
+    
+    void RecordFrame(size_t bytes) {
+        block_.Update([bytes](CameraStatsSnapshot& stats) {
+            stats.frames_captured++;
+            stats.bytes_received += static_cast<int64_t>(bytes);
+            stats.last_frame_time = std::chrono::steady_clock::now();
+        });
+    }
+    
+    void RecordDrop() {
+        block_.Update([](CameraStatsSnapshot& stats) { stats.frames_dropped++; });
+    }
+    
+    void RecordReconnect() {
+        block_.Update([](CameraStatsSnapshot& stats) { stats.reconnect_count++; });
+    }
+    
+    // Écrivain uniquement : sans passer par le seqlock
+    const CameraStatsSnapshot& Local() const { return block_.Local(); }
+    
+    // N'importe quel thread
+    CameraStatsSnapshot Snapshot() const { return block_.Snapshot(); }
+    double GetFpsActual() const { return Snapshot().GetFpsActual(); }
+    double GetUptimeSeconds() const { return Snapshot().GetUptimeSeconds(); }
+    
+private:
+    StatsBlock<CameraStatsSnapshot> block_;
+};
+
 // Callback pour les frames capturées
 using FrameCallback = std::function<void(const Frame& frame)>;
 
@@ -95,6 +144,46 @@ public:
     bool StartCapture();
     bool StopCapture();
     
+    // Demande l'arrêt sans attendre le thread de capture (réveille ses
+    // attentes) ; StopCapture() joint ensuite. Permet d'arrêter plusieurs
+    // caméras en parallèle.
+    void RequestStop();
+    
+    // Abandon d'une capture bloquée (lecture qui ne rend jamais la main) :
+    // demande l'arrêt et coupe le callback sans joindre le thread. Échoue si
+    // le thread est dans le callback. L'objet doit rester en vie tant que
+    // HasCaptureLoopExited() est faux.
+    bool Abandon();
+    bool HasCaptureLoopExited() const;
+    
+    // Fin du processus uniquement : détache un thread toujours bloqué ;
+    // l'objet ne doit alors plus jamais être détruit
+    void DetachCaptureThread();
+    
+    // Roue partagée pour les périodes d'ouverture du disjoncteur ; doit
+    // survivre à la caméra. Sans roue, le thread de capture attend lui-même.
+    void SetTimerWheel(TimerWheel* timer_wheel);
+    CircuitBreakerStatus GetCircuitBreakerStatus() const;
+    
+    // Capture coopérative : avec un pool et une horloge de frames (roue à
+    // tick court, en plus de celle du disjoncteur), le stream devient un
+    // pipeline de deux coroutines reprises sur le pool, sans thread dédié :
+    // la capture pousse chaque frame dans un canal, la livraison l'y attend
+    // (co_await) et appelle le callback. Une capture n'attend jamais le
+    // callback : une frame pas encore livrée est remplacée par la suivante
+    // et comptée perdue. À fixer avant StartCapture ; tous deux doivent
+    // survivre à la caméra. Les sources dont la lecture peut bloquer
+    // (OpenCV) gardent leur thread et un callback synchrone.
+    void SetExecutor(WorkerPool* executor, TimerWheel* frame_clock);
+    bool IsCooperative() const;
+    
+    // CPU du thread de capture (vide = non épinglé). Appliqué par le thread
+    // lui-même à son démarrage et à la frame suivante s'il tourne déjà.
+    // Refusé (false) en capture coopérative : les threads du pool sont
+    // partagés par tous les streams.
+    bool SetCpuAffinity(const std::vector<int>& cpus);
+    std::vector<int> GetCpuAffinity() const;
+    
     // Configuration
     void SetConfig(const CameraConfig& config);
     CameraConfig GetConfig() const;
@@ -132,6 +221,18 @@ private:
     std::unique_ptr<std::thread> capture_thread_;
     std::atomic<bool> should_stop_;
     std::atomic<bool> is_capturing_;
+    std::atomic<bool> loop_exited_{true};
+    std::mutex stop_mutex_;
+    std::condition_variable stop_condition_;
+    
+    // Capture coopérative ; exit_condition_ signale loop_exited_ sous
+    // stop_mutex_, une fois sorties les deux coroutines du stream
+    WorkerPool* executor_ = nullptr;
+    TimerWheel* frame_clock_ = nullptr;
+    CoSleeper sleeper_;
+    CoChannel<Frame> frames_;  // capture → livraison
+    std::atomic<int> live_tasks_{0};
+    std::condition_variable exit_condition_;
     
     // Frame handling
     FrameCallback frame_callback_;
@@ -146,17 +247,46 @@ private:
     std::atomic<int> reconnect_attempts_;
     std::chrono::steady_clock::time_point last_reconnect_time_;
     
+    // Disjoncteur ; circuit_timer_ protégé par stop_mutex_
+    CircuitBreaker breaker_;
+    TimerWheel* timer_wheel_ = nullptr;
+    TimerWheel::TimerId circuit_timer_ = 0;
+    
+    // Placement ; cpu_affinity_ protégé par config_mutex_
+    std::vector<int> cpu_affinity_;
+    std::atomic<bool> affinity_pending_{false};
+    
 #ifdef HAVE_OPENCV
     std::unique_ptr<cv::VideoCapture> opencv_capture_;
 #endif
     
+    // Issue d'une itération de capture, commune au thread et à la coroutine
+    enum class CaptureStep {
+        NEXT_FRAME,
+        RECONNECT,
+        CIRCUIT_OPEN,
+        STOP
+    };
+    
     // Méthodes privées
     void CaptureLoop();
+    CaptureStep RunCaptureStep(bool* reopen_source);
+    DetachedTask CaptureTask();
+    DetachedTask DeliverTask();
+    bool SpawnCaptureTask();
+    void ExitCaptureTask();  // la dernière des deux coroutines signale la sortie
+    void MarkCaptureTaskExited();
+    void WaitForCaptureTaskExit(std::unique_lock<std::mutex>& stop_lock);
+    bool WaitForStop(std::chrono::milliseconds timeout);  // true si arrêt demandé
     bool InitializeCapture();
     bool CaptureFrame();
     void HandleCaptureError(const std::string& error);
     void AttemptReconnect();
-    bool ShouldAttemptReconnect() const;
+    void BeginReconnect();
+    void FinishReconnect();
+    bool OpenCircuit();        // true si le thread de capture doit sortir
+    void RunHalfOpenTrial();   // thread de la roue
+    void ApplyCpuAffinity();   // thread de capture
     
     void SetState(CameraState new_state);
     void SetError(const std::string& error);
@@ -173,6 +303,10 @@ private:
     Frame CaptureRtspFrame();
     Frame CaptureTestFrame();
     
+    // Région d'intérêt bornée aux dimensions réelles de la source
+    FrameRegion GetCaptureRegion(int source_width, int source_height) const;
+    Frame CropToCaptureRegion(Frame frame) const;
+    
     // Utilitaires
     Frame CreateEmptyFrame() const;
     bool ValidateFrame(const Frame& frame) const;
@@ -227,6 +361,7 @@ namespace CameraManagerConstants {
     constexpr int DEFAULT_RECONNECT_DELAY_MS = 5000;
     constexpr int MAX_FRAME_BUFFER_SIZE = 60;  // 4 secondes à 15fps
     constexpr int CAPTURE_TIMEOUT_MS = 10000;  // 10 secondes
+    constexpr int SLOW_OPEN_MS = 3000;  // ouverture de test://slow-open
     
     // Types MIME supportés
     const std::vector<std::string> SUPPORTED_VIDEO_FORMATS = {
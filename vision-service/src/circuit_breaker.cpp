@@ -0,0 +1,112 @@
+// src/circuit_breaker.cpp
+#include "circuit_breaker.h"
+#include <algorithm>
+
+CircuitBreaker::CircuitBreaker(const CircuitBreakerConfig& config) {
+    SetConfig(config);
+    Reset();
+}
+
+void CircuitBreaker::SetConfig(const CircuitBreakerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.failure_threshold = std::max(1, config_.failure_threshold);
+    config_.open_ms = std::max(1, config_.open_ms);
+    config_.max_open_ms = std::max(config_.open_ms, config_.max_open_ms);
+}
+
+void CircuitBreaker::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_ = CircuitBreakerStatus();
+    status_.last_transition = std::chrono::steady_clock::now();
+    consecutive_trips_ = 0;
+    healthy_ = true;
+}
+
+bool CircuitBreaker::RecordFailure(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    healthy_ = false;
+
+    switch (status_.state) {
+        case CircuitState::OPEN:
+            return false;
+        case CircuitState::HALF_OPEN:
+            // L'essai a échoué : réouverture immédiate
+            break;
+        case CircuitState::CLOSED:
+            status_.consecutive_failures++;
+            if (status_.consecutive_failures < config_.failure_threshold) {
+                return false;
+            }
+            break;
+    }
+
+    consecutive_trips_++;
+    status_.trips++;
+    status_.open_period = ComputeOpenPeriod();
+    status_.retry_at = now + status_.open_period;
+    Transition(CircuitState::OPEN, now);
+    return true;
+}
+
+void CircuitBreaker::RecordSuccess(std::chrono::steady_clock::time_point now) {
+    if (healthy_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.consecutive_failures = 0;
+    if (status_.state != CircuitState::CLOSED) {
+        consecutive_trips_ = 0;
+        status_.open_period = std::chrono::milliseconds(0);
+        Transition(CircuitState::CLOSED, now);
+    }
+    healthy_ = true;
+}
+
+bool CircuitBreaker::BeginTrial(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (status_.state != CircuitState::OPEN) {
+        return false;
+    }
+    Transition(CircuitState::HALF_OPEN, now);
+    return true;
+}
+
+CircuitState CircuitBreaker::GetState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_.state;
+}
+
+std::chrono::milliseconds CircuitBreaker::GetOpenPeriod() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_.open_period;
+}
+
+CircuitBreakerStatus CircuitBreaker::GetStatus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+std::string CircuitBreaker::StateToString(CircuitState state) {
+    switch (state) {
+        case CircuitState::CLOSED: return "closed";
+        case CircuitState::OPEN: return "open";
+        case CircuitState::HALF_OPEN: return "half_open";
+    }
+    return "unknown";
+}
+
+std::chrono::milliseconds CircuitBreaker::ComputeOpenPeriod() const {
+    // open_ms * 2^(trips-1), sans débordement
+    int64_t period = config_.open_ms;
+    for (int i = 1; i < consecutive_trips_ && period < config_.max_open_ms; ++i) {
+        period *= 2;
+    }
+    return std::chrono::milliseconds(std::min<int64_t>(period, config_.max_open_ms));
+}
+
+void CircuitBreaker::Transition(CircuitState state, std::chrono::steady_clock::time_point now) {
+    status_.state = state;
+    status_.last_transition = now;
+}
@@ -0,0 +1,70 @@
+// src/circuit_breaker.h
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// État du disjoncteur d'une source
+enum class CircuitState {
+    CLOSED,      // fonctionnement normal
+    OPEN,        // source considérée morte : aucune tentative jusqu'à l'échéance
+    HALF_OPEN    // une seule tentative d'essai en cours
+};
+
+struct CircuitBreakerConfig {
+    int failure_threshold = 3;     // échecs consécutifs avant ouverture
+    int open_ms = 5000;            // première période d'ouverture
+    int max_open_ms = 300000;      // plafond de la croissance exponentielle
+};
+
+struct CircuitBreakerStatus {
+    CircuitState state = CircuitState::CLOSED;
+    int consecutive_failures = 0;
+    int64_t trips = 0;                         // ouvertures depuis le démarrage
+    std::chrono::milliseconds open_period{0};  // période de l'ouverture courante
+    std::chrono::steady_clock::time_point last_transition;
+    std::chrono::steady_clock::time_point retry_at;  // valide si OPEN
+};
+
+// Disjoncteur fermé/ouvert/semi-ouvert. Chaque réouverture sans succès
+// intermédiaire double la période d'ouverture, jusqu'au plafond ; un succès
+// referme le circuit et remet la période à sa valeur initiale.
+class CircuitBreaker {
+public:
+    explicit CircuitBreaker(const CircuitBreakerConfig& config = CircuitBreakerConfig());
+
+    void SetConfig(const CircuitBreakerConfig& config);
+    void Reset();
+
+    // true si cet échec ouvre le circuit (seuil atteint, ou échec de l'essai)
+    bool RecordFailure(std::chrono::steady_clock::time_point now);
+    void RecordSuccess(std::chrono::steady_clock::time_point now);
+
+    // OPEN -> HALF_OPEN ; false si le circuit n'est pas ouvert
+    bool BeginTrial(std::chrono::steady_clock::time_point now);
+
+    CircuitState GetState() const;
+    std::chrono::milliseconds GetOpenPeriod() const;
+    CircuitBreakerStatus GetStatus() const;
+
+    static std::string StateToString(CircuitState state);
+
+private:
+    CircuitBreakerConfig config_;
+    CircuitBreakerStatus status_;
+    int consecutive_trips_ = 0;
+    mutable std::mutex mutex_;
+
+    // Chemin rapide de RecordSuccess (appelé à chaque frame) : circuit
+    // fermé sans échec en cours
+    std::atomic<bool> healthy_{true};
+
+    std::chrono::milliseconds ComputeOpenPeriod() const;
+    void Transition(CircuitState state, std::chrono::steady_clock::time_point now);
+};
+
+#endif // CIRCUIT_BREAKER_H
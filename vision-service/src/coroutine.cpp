@@ -0,0 +1,125 @@
+// src/coroutine.cpp
+#include "coroutine.h"
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <new>
+
+namespace {
+
+std::atomic<int64_t> live_frames{0};
+std::atomic<int64_t> live_bytes{0};
+std::atomic<int64_t> largest_frame_bytes{0};
+
+}  // namespace
+
+CoroutineStats GetCoroutineStats() {
+    CoroutineStats stats;
+    stats.live_frames = live_frames.load(std::memory_order_relaxed);
+    stats.live_bytes = live_bytes.load(std::memory_order_relaxed);
+    stats.largest_frame_bytes = largest_frame_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DetachedTask::promise_type::unhandled_exception() noexcept {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "[Coroutine] Unhandled exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[Coroutine] Unknown unhandled exception." << std::endl;
+    }
+}
+
+void* DetachedTask::promise_type::operator new(size_t size) {
+    void* frame = ::operator new(size);
+    live_frames.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    int64_t largest = largest_frame_bytes.load(std::memory_order_relaxed);
+    while (static_cast<int64_t>(size) > largest &&
+           !largest_frame_bytes.compare_exchange_weak(largest, static_cast<int64_t>(size),
+                                                      std::memory_order_relaxed)) {
+    }
+    return frame;
+}
+
+void DetachedTask::promise_type::operator delete(void* frame, size_t size) noexcept {
+    live_frames.fetch_sub(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    ::operator delete(frame);
+}
+
+void CoSleeper::Bind(TimerWheel* timer_wheel, WorkerPool* pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timer_wheel_ = timer_wheel;
+    pool_ = pool;
+}
+
+void CoSleeper::Wake() {
+    std::coroutine_handle<> handle;
+    TimerWheel::TimerId timer = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        woken_ = true;
+        std::swap(handle, waiting_);
+        std::swap(timer, timer_);
+    }
+    // Un callback échu mais pas lancé est retiré ; un callback déjà lancé
+    // trouve waiting_ vide et ne reprend rien, Cancel attend sa fin
+    if (timer != 0) {
+        timer_wheel_->Cancel(timer);
+    }
+    if (handle) {
+        Resume(handle);
+    }
+}
+
+void CoSleeper::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    woken_ = false;
+}
+
+bool CoSleeper::IsWoken() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return woken_;
+}
+
+bool CoSleeper::Suspend(std::coroutine_handle<> handle, std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (woken_ || !timer_wheel_ || delay.count() <= 0) {
+        return false;
+    }
+
+    // Le callback prend mutex_ : il ne peut reprendre la coroutine qu'une
+    // fois celle-ci entièrement suspendue
+    waiting_ = handle;
+    timer_ = timer_wheel_->Schedule(delay, [this]() { OnTimer(); });
+    if (timer_ == 0) {
+        // Roue arrêtée : on ne suspend pas
+        waiting_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void CoSleeper::OnTimer() {
+    std::coroutine_handle<> handle;
+    {
+        // timer_ reste en place : un Wake() concurrent annule ce timer et
+        // attend la fin de ce callback avant que le dormeur puisse être libéré
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(handle, waiting_);
+    }
+    if (handle) {
+        Resume(handle);
+    }
+}
+
+void CoSleeper::Resume(std::coroutine_handle<> handle) {
+    // Jamais de traitement sur le thread de la roue, sauf pool arrêté
+    if (!pool_ || !pool_->Post([handle]() { handle.resume(); })) {
+        handle.resume();
+    }
+}
@@ -0,0 +1,203 @@
+// src/coroutine.h
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <coroutine>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "worker_pool.h"
+#include "timer_wheel.h"
+
+// Briques C++20 pour les pipelines de streams : une coroutine suspendue ne
+// coûte que sa frame (quelques centaines d'octets), pas un thread. Elle
+// reprend sur le pool partagé, réveillée par la roue de temporisation.
+
+// Frames de coroutine allouées (toutes coroutines de ce fichier confondues)
+struct CoroutineStats {
+    int64_t live_frames = 0;
+    int64_t live_bytes = 0;
+    int64_t largest_frame_bytes = 0;
+};
+
+CoroutineStats GetCoroutineStats();
+
+// Coroutine détachée : démarre à l'appel et libère sa frame à la fin. Son
+// propriétaire apprend la fin par ses propres moyens (drapeau, condition).
+// Une exception non rattrapée termine la coroutine après journalisation.
+class DetachedTask {
+public:
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size) noexcept;
+    };
+};
+
+// co_await ScheduleOn(pool) : la suite s'exécute sur un thread du pool,
+// ou sur place si le pool est arrêté
+class ScheduleOn {
+public:
+    explicit ScheduleOn(WorkerPool& pool) : pool_(pool) {}
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        return pool_.Post([handle]() { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    WorkerPool& pool_;
+};
+
+// Attente annulable d'une seule coroutine à la fois, reprise sur le pool à
+// l'échéance (précision d'un tick de roue) ou dès Wake(). Wake() est
+// persistant : les attentes suivantes rendent la main aussitôt jusqu'à
+// Reset(). co_await SleepUntil(...) vaut true si l'attente a été écourtée.
+// Au retour de Wake(), plus aucun callback de la roue ne touche le
+// dormeur : il peut être détruit dès que sa coroutine est sortie.
+class CoSleeper {
+public:
+    class Awaiter {
+    public:
+        Awaiter(CoSleeper& sleeper, std::chrono::steady_clock::time_point deadline)
+            : sleeper_(sleeper), deadline_(deadline) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) { return sleeper_.Suspend(handle, deadline_); }
+        bool await_resume() const { return sleeper_.IsWoken(); }
+
+    private:
+        CoSleeper& sleeper_;
+        std::chrono::steady_clock::time_point deadline_;
+    };
+
+    CoSleeper() = default;
+    CoSleeper(const CoSleeper&) = delete;
+    CoSleeper& operator=(const CoSleeper&) = delete;
+
+    // Roue et pool doivent survivre aux attentes
+    void Bind(TimerWheel* timer_wheel, WorkerPool* pool);
+
+    Awaiter SleepUntil(std::chrono::steady_clock::time_point deadline) { return Awaiter(*this, deadline); }
+    void Wake();
+    void Reset();
+    bool IsWoken() const;
+
+private:
+    TimerWheel* timer_wheel_ = nullptr;
+    WorkerPool* pool_ = nullptr;
+    mutable std::mutex mutex_;
+    std::coroutine_handle<> waiting_;
+    TimerWheel::TimerId timer_ = 0;
+    bool woken_ = false;
+
+    bool Suspend(std::coroutine_handle<> handle, std::chrono::steady_clock::time_point deadline);
+    void OnTimer();
+    void Resume(std::coroutine_handle<> handle);
+};
+
+// Canal entre deux étages d'un pipeline de stream : l'étage aval attend
+// par co_await Next() et reprend sur le pool à chaque valeur, sans thread.
+// Une seule valeur en attente : le producteur n'attend jamais l'aval, une
+// valeur pas encore prise est remplacée par la suivante. Next() rend
+// std::nullopt une fois le canal fermé et vidé. Un consommateur à la fois.
+template <typename T>
+class CoChannel {
+public:
+    class Awaiter {
+    public:
+        explicit Awaiter(CoChannel& channel) : channel_(channel) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) { return channel_.Suspend(handle); }
+        std::optional<T> await_resume() { return channel_.Take(); }
+
+    private:
+        CoChannel& channel_;
+    };
+
+    CoChannel() = default;
+    CoChannel(const CoChannel&) = delete;
+    CoChannel& operator=(const CoChannel&) = delete;
+
+    // Le pool doit survivre aux attentes ; sans pool (ou pool arrêté), le
+    // consommateur reprend sur le thread du producteur
+    void Bind(WorkerPool* pool) { pool_ = pool; }
+
+    Awaiter Next() { return Awaiter(*this); }
+
+    // true si une valeur est perdue : remplacée avant d'être prise, ou
+    // poussée dans un canal fermé
+    bool Push(T value) {
+        std::coroutine_handle<> waiting;
+        bool lost = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return true;
+            }
+            lost = value_.has_value();
+            value_ = std::move(value);
+            waiting = std::exchange(waiting_, {});
+        }
+        Resume(waiting);
+        return lost;
+    }
+
+    // La valeur en attente reste à prendre
+    void Close() {
+        std::coroutine_handle<> waiting;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            waiting = std::exchange(waiting_, {});
+        }
+        Resume(waiting);
+    }
+
+    // Rouvre un canal vide pour un nouveau consommateur
+    void Reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+        value_.reset();
+    }
+
+private:
+    WorkerPool* pool_ = nullptr;
+    std::mutex mutex_;
+    std::optional<T> value_;
+    std::coroutine_handle<> waiting_;
+    bool closed_ = false;
+
+    bool Suspend(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (value_ || closed_) {
+            return false;
+        }
+        waiting_ = handle;
+        return true;
+    }
+
+    std::optional<T> Take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::exchange(value_, std::nullopt);
+    }
+
+    void Resume(std::coroutine_handle<> handle) {
+        if (handle && (!pool_ || !pool_->Post([handle]() { handle.resume(); }))) {
+            handle.resume();
+        }
+    }
+};
+
+#endif // COROUTINE_H
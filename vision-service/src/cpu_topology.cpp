@@ -0,0 +1,264 @@
+// src/cpu_topology.cpp
+#include "cpu_topology.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace CpuTopologyConstants;
+
+namespace {
+
+bool ReadFirstLine(const std::filesystem::path& path, std::string* line) {
+    std::ifstream file(path);
+    if (!file || !std::getline(file, *line)) {
+        return false;
+    }
+    line->erase(std::remove_if(line->begin(), line->end(),
+                               [](char c) { return c == '\n' || c == '\r' || c == ' '; }),
+                line->end());
+    return true;
+}
+
+bool ReadInt(const std::filesystem::path& path, int* value) {
+    std::string line;
+    if (!ReadFirstLine(path, &line)) {
+        return false;
+    }
+    try {
+        *value = std::stoi(line);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Plus petit CPU de la liste, -1 si vide ou illisible
+int ReadDomainId(const std::filesystem::path& path) {
+    std::string line;
+    if (!ReadFirstLine(path, &line)) {
+        return -1;
+    }
+    std::vector<int> cpus = CpuTopology::ParseCpuList(line);
+    return cpus.empty() ? -1 : cpus.front();
+}
+
+}  // namespace
+
+CpuTopology::CpuTopology(std::vector<CpuInfo> cpus) : cpus_(std::move(cpus)) {
+    std::sort(cpus_.begin(), cpus_.end(),
+              [](const CpuInfo& a, const CpuInfo& b) { return a.cpu < b.cpu; });
+}
+
+CpuTopology CpuTopology::Load() {
+    return Load(DEFAULT_SYSFS_ROOT);
+}
+
+CpuTopology CpuTopology::Load(const std::string& sysfs_root) {
+    namespace fs = std::filesystem;
+    fs::path root(sysfs_root);
+
+    std::string online;
+    if (!ReadFirstLine(root / "cpu" / "online", &online)) {
+        return Fallback();
+    }
+
+    // Nœud NUMA de chaque CPU ; absent sur les machines non NUMA
+    std::unordered_map<int, int> node_of_cpu;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(root / "node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+            continue;
+        }
+        std::string cpulist;
+        if (ReadFirstLine(entry.path() / "cpulist", &cpulist)) {
+            int node = std::stoi(name.substr(4));
+            for (int cpu : ParseCpuList(cpulist)) {
+                node_of_cpu[cpu] = node;
+            }
+        }
+    }
+
+    std::vector<CpuInfo> cpus;
+    for (int cpu : ParseCpuList(online)) {
+        fs::path cpu_dir = root / "cpu" / ("cpu" + std::to_string(cpu));
+        CpuInfo info;
+        info.cpu = cpu;
+        ReadInt(cpu_dir / "topology" / "physical_package_id", &info.package_id);
+        ReadInt(cpu_dir / "topology" / "core_id", &info.core_id);
+        auto node = node_of_cpu.find(cpu);
+        info.numa_node = node != node_of_cpu.end() ? node->second : 0;
+
+        // Domaines de cache : index dont le niveau vaut 2, puis le plus haut niveau
+        int l2_domain = -1;
+        int llc_domain = -1;
+        int llc_level = 0;
+        for (int index = 0; index < MAX_CACHE_INDEX; ++index) {
+            fs::path cache_dir = cpu_dir / "cache" / ("index" + std::to_string(index));
+            int level = 0;
+            if (!ReadInt(cache_dir / "level", &level)) {
+                continue;
+            }
+            int domain = ReadDomainId(cache_dir / "shared_cpu_list");
+            if (domain < 0) {
+                continue;
+            }
+            if (level == 2) {
+                l2_domain = domain;
+            }
+            if (level >= llc_level) {
+                llc_level = level;
+                llc_domain = domain;
+            }
+        }
+
+        // Sans information de cache : cœur physique, puis socket
+        if (l2_domain < 0) {
+            l2_domain = ReadDomainId(cpu_dir / "topology" / "thread_siblings_list");
+        }
+        info.l2_domain = l2_domain >= 0 ? l2_domain : cpu;
+        info.l3_domain = llc_level >= 3 ? llc_domain : -1;
+        cpus.push_back(info);
+    }
+
+    if (cpus.empty()) {
+        return Fallback();
+    }
+
+    // L3 inconnu : un domaine par socket, identifié par son premier CPU
+    std::unordered_map<int, int> first_cpu_of_package;
+    for (const auto& info : cpus) {
+        auto it = first_cpu_of_package.find(info.package_id);
+        if (it == first_cpu_of_package.end() || info.cpu < it->second) {
+            first_cpu_of_package[info.package_id] = info.cpu;
+        }
+    }
+    for (auto& info : cpus) {
+        if (info.l3_domain < 0) {
+            info.l3_domain = first_cpu_of_package[info.package_id];
+        }
+    }
+
+    return CpuTopology(std::move(cpus));
+}
+
+CpuTopology CpuTopology::Fallback() {
+    int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<CpuInfo> cpus(count);
+    for (int cpu = 0; cpu < count; ++cpu) {
+        cpus[cpu].cpu = cpu;
+        cpus[cpu].core_id = cpu;
+        cpus[cpu].l2_domain = cpu;
+    }
+    return CpuTopology(std::move(cpus));
+}
+
+CpuTopology CpuTopology::Restrict(const std::vector<int>& allowed_cpus) const {
+    if (allowed_cpus.empty()) {
+        return *this;
+    }
+    std::set<int> allowed(allowed_cpus.begin(), allowed_cpus.end());
+    std::vector<CpuInfo> cpus;
+    for (const auto& info : cpus_) {
+        if (allowed.count(info.cpu)) {
+            cpus.push_back(info);
+        }
+    }
+    // Masque sans rapport avec la topologie : on la garde telle quelle
+    return cpus.empty() ? *this : CpuTopology(std::move(cpus));
+}
+
+std::vector<int> CpuTopology::GetProcessAllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+const std::vector<CpuInfo>& CpuTopology::GetCpus() const {
+    return cpus_;
+}
+
+bool CpuTopology::IsEmpty() const {
+    return cpus_.empty();
+}
+
+int CpuTopology::GetNumaNodeCount() const {
+    std::set<int> nodes;
+    for (const auto& info : cpus_) {
+        nodes.insert(info.numa_node);
+    }
+    return static_cast<int>(nodes.size());
+}
+
+int CpuTopology::GetL3DomainCount() const {
+    std::set<int> domains;
+    for (const auto& info : cpus_) {
+        domains.insert(info.l3_domain);
+    }
+    return static_cast<int>(domains.size());
+}
+
+std::vector<int> CpuTopology::ParseCpuList(const std::string& list) {
+    std::set<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = std::max(first, 0); cpu <= std::min(last, MAX_CPUS - 1); ++cpu) {
+                cpus.insert(cpu);
+            }
+        } catch (...) {
+            // Entrée illisible ignorée
+        }
+    }
+    return std::vector<int>(cpus.begin(), cpus.end());
+}
+
+std::string CpuTopology::FormatCpuList(const std::vector<int>& cpus) {
+    std::vector<int> sorted(cpus);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    std::ostringstream out;
+    for (size_t i = 0; i < sorted.size(); ) {
+        size_t j = i;
+        while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) {
+            ++j;
+        }
+        if (i > 0) {
+            out << ',';
+        }
+        out << sorted[i];
+        if (j > i) {
+            out << '-' << sorted[j];
+        }
+        i = j + 1;
+    }
+    return out.str();
+}
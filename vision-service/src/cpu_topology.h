@@ -0,0 +1,57 @@
+// src/cpu_topology.h
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+// Position d'un CPU logique dans la hiérarchie de la machine. Les domaines
+// de cache sont identifiés par le plus petit CPU qui les partage.
+struct CpuInfo {
+    int cpu = 0;
+    int package_id = 0;
+    int core_id = 0;
+    int numa_node = 0;
+    int l2_domain = 0;   // CPU partageant le L2 (hyperthreads d'un cœur)
+    int l3_domain = 0;   // CPU partageant le dernier niveau de cache
+};
+
+// Topologie lue dans sysfs. La racine est paramétrable pour que les tests
+// puissent décrire une machine fictive (bi-socket, NUMA...) dans un
+// répertoire temporaire.
+class CpuTopology {
+public:
+    CpuTopology() = default;
+    explicit CpuTopology(std::vector<CpuInfo> cpus);
+
+    // Racine type "/sys/devices/system" (contient cpu/ et node/). Sans
+    // sysfs lisible : un seul nœud, un seul L3, un L2 par CPU.
+    static CpuTopology Load(const std::string& sysfs_root);
+    static CpuTopology Load();
+
+    // Ne garde que les CPU autorisés (cgroup, taskset)
+    CpuTopology Restrict(const std::vector<int>& allowed_cpus) const;
+    static std::vector<int> GetProcessAllowedCpus();
+
+    const std::vector<CpuInfo>& GetCpus() const;
+    bool IsEmpty() const;
+    int GetNumaNodeCount() const;
+    int GetL3DomainCount() const;
+
+    // Format des listes sysfs : "0-3,8,10-11"
+    static std::vector<int> ParseCpuList(const std::string& list);
+    static std::string FormatCpuList(const std::vector<int>& cpus);
+
+private:
+    std::vector<CpuInfo> cpus_;
+
+    static CpuTopology Fallback();
+};
+
+namespace CpuTopologyConstants {
+    const std::string DEFAULT_SYSFS_ROOT = "/sys/devices/system";
+    constexpr int MAX_CACHE_INDEX = 8;
+    constexpr int MAX_CPUS = 4096;
+}
+
+#endif // CPU_TOPOLOGY_H
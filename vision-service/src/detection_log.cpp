@@ -0,0 +1,592 @@
+// src/detection_log.cpp
+#include "detection_log.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace DetectionLogConstants;
+
+namespace {
+
+constexpr size_t SEGMENT_HEADER_SIZE = 64;
+constexpr size_t INDEX_HEADER_SIZE = 64;
+constexpr uint64_t INDEX_CAPACITY = (SEGMENT_MAX_RECORDS + INDEX_STRIDE - 1) / INDEX_STRIDE;
+constexpr size_t INDEX_FILE_SIZE = INDEX_HEADER_SIZE + INDEX_CAPACITY * 16;
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t reserved;
+    int64_t first_timestamp;
+};
+
+// entry_count est publié après l'entrée qu'il couvre
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t stride;
+    uint64_t capacity;
+    uint64_t entry_count;
+};
+
+// Premier enregistrement de chaque bloc de INDEX_STRIDE
+struct IndexEntry {
+    int64_t timestamp_ms;
+    uint64_t record_index;
+};
+
+static_assert(sizeof(SegmentHeader) <= SEGMENT_HEADER_SIZE, "en-tête de segment trop grand");
+static_assert(sizeof(IndexHeader) <= INDEX_HEADER_SIZE, "en-tête d'index trop grand");
+static_assert(sizeof(IndexEntry) == 16, "entrée d'index figée");
+
+// Types connus ; l'identifiant est la position, ne jamais réordonner
+const std::array<const char*, 6> TYPE_NAMES = {"unknown", "motion", "person", "vehicle", "face", "object"};
+
+struct SegmentFile {
+    int64_t first_timestamp;
+    std::string path;
+};
+
+// Segments du répertoire, par premier horodatage croissant
+std::vector<SegmentFile> ListSegments(const std::string& directory) {
+    std::vector<SegmentFile> segments;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const auto& path = entry.path();
+        if (path.extension() != SEGMENT_EXTENSION) {
+            continue;
+        }
+        std::string stem = path.stem().string();
+        char* end = nullptr;
+        long long first = std::strtoll(stem.c_str(), &end, 10);
+        if (stem.empty() || *end != '\0') {
+            continue;
+        }
+        segments.push_back(SegmentFile{first, path.string()});
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const SegmentFile& a, const SegmentFile& b) { return a.first_timestamp < b.first_timestamp; });
+    return segments;
+}
+
+std::string SegmentName(int64_t first_timestamp) {
+    // Largeur fixe : l'ordre des noms est celui des horodatages
+    std::string digits = std::to_string(first_timestamp);
+    return std::string(digits.size() < 16 ? 16 - digits.size() : 0, '0') + digits;
+}
+
+std::string IndexPathFor(const std::string& segment_path) {
+    return std::filesystem::path(segment_path).replace_extension(INDEX_EXTENSION).string();
+}
+
+bool ReadFull(int fd, void* buffer, size_t size, off_t offset) {
+    auto* out = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        ssize_t count = ::pread(fd, out, size, offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        out += count;
+        size -= static_cast<size_t>(count);
+        offset += count;
+    }
+    return true;
+}
+
+bool WriteFull(int fd, const void* buffer, size_t size, off_t offset) {
+    const auto* in = static_cast<const uint8_t*>(buffer);
+    while (size > 0) {
+        ssize_t count = ::pwrite(fd, in, size, offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        in += count;
+        size -= static_cast<size_t>(count);
+        offset += count;
+    }
+    return true;
+}
+
+off_t RecordOffset(uint64_t record_index) {
+    return static_cast<off_t>(SEGMENT_HEADER_SIZE + record_index * sizeof(DetectionRecord));
+}
+
+bool HasValidSegmentHeader(int fd) {
+    SegmentHeader header;
+    return ReadFull(fd, &header, sizeof(header), 0) &&
+           std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) == 0 &&
+           header.version == FORMAT_VERSION && header.header_size == SEGMENT_HEADER_SIZE &&
+           header.record_size == sizeof(DetectionRecord);
+}
+
+// Enregistrements complets du segment (un lot interrompu laisse une fin partielle)
+uint64_t CountRecords(int fd) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < SEGMENT_HEADER_SIZE) {
+        return 0;
+    }
+    return (static_cast<uint64_t>(info.st_size) - SEGMENT_HEADER_SIZE) / sizeof(DetectionRecord);
+}
+
+bool HasValidIndexHeader(const uint8_t* mapping, size_t size) {
+    if (!mapping || size < INDEX_HEADER_SIZE) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const IndexHeader*>(mapping);
+    return std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+           header->version == FORMAT_VERSION && header->header_size == INDEX_HEADER_SIZE &&
+           header->stride == INDEX_STRIDE && header->capacity == INDEX_CAPACITY &&
+           INDEX_HEADER_SIZE + header->capacity * sizeof(IndexEntry) <= size;
+}
+
+// Premier enregistrement à lire pour atteindre from_ms ; 0 sans index utilisable
+uint64_t FindStartRecord(const std::string& segment_path, uint64_t records, int64_t from_ms) {
+    int fd = ::open(IndexPathFor(segment_path).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat info;
+    void* address = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        address = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return 0;
+    }
+
+    uint64_t start = 0;
+    const auto* mapping = static_cast<const uint8_t*>(address);
+    size_t size = static_cast<size_t>(info.st_size);
+    if (HasValidIndexHeader(mapping, size)) {
+        const auto* header = reinterpret_cast<const IndexHeader*>(mapping);
+        uint64_t count = __atomic_load_n(&header->entry_count, __ATOMIC_ACQUIRE);
+        count = std::min({count, header->capacity, (records + INDEX_STRIDE - 1) / INDEX_STRIDE});
+        const auto* entries = reinterpret_cast<const IndexEntry*>(mapping + INDEX_HEADER_SIZE);
+
+        // Premier bloc qui commence à from_ms ou après : le précédent peut
+        // encore contenir des enregistrements de l'intervalle
+        const IndexEntry* first = std::lower_bound(
+            entries, entries + count, from_ms,
+            [](const IndexEntry& entry, int64_t timestamp) { return entry.timestamp_ms < timestamp; });
+        if (first != entries) {
+            start = std::min((first - 1)->record_index, records);
+        }
+    }
+    ::munmap(address, size);
+    return start;
+}
+
+}  // namespace
+
+DetectionLog::~DetectionLog() {
+    Close();
+}
+
+bool DetectionLog::Open(const std::string& directory) {
+    Close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        return false;
+    }
+    directory_ = directory;
+    record_count_ = 0;
+    last_timestamp_ = 0;
+    segment_first_timestamp_ = 0;
+    return ResumeLastSegment();
+}
+
+void DetectionLog::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!directory_.empty()) {
+        FlushLocked();
+    }
+    CloseSegment();
+    pending_.clear();
+    directory_.clear();
+}
+
+bool DetectionLog::IsOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !directory_.empty();
+}
+
+const std::string& DetectionLog::GetDirectory() const {
+    return directory_;
+}
+
+bool DetectionLog::Append(const std::vector<Detection>& detections) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+        return false;
+    }
+    for (const auto& detection : detections) {
+        AppendLocked(ToRecord(detection));
+    }
+    if (pending_.size() >= BATCH_RECORDS ||
+        (!pending_.empty() && std::chrono::steady_clock::now() - oldest_pending_ >=
+                                  std::chrono::milliseconds(FLUSH_INTERVAL_MS))) {
+        return FlushLocked();
+    }
+    return true;
+}
+
+bool DetectionLog::Append(const DetectionRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+        return false;
+    }
+    AppendLocked(record);
+    if (pending_.size() >= BATCH_RECORDS) {
+        return FlushLocked();
+    }
+    return true;
+}
+
+bool DetectionLog::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FlushLocked();
+}
+
+int64_t DetectionLog::GetRecordCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return record_count_;
+}
+
+bool DetectionLog::Query(const std::string& directory, int64_t from_ms, int64_t to_ms, size_t limit,
+                         DetectionQueryResult* result) {
+    *result = DetectionQueryResult();
+    if (from_ms > to_ms || limit == 0) {
+        return true;
+    }
+
+    std::vector<SegmentFile> segments = ListSegments(directory);
+    std::vector<DetectionRecord> buffer(QUERY_READ_RECORDS);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        // Un segment ne contient rien d'antérieur à son nom ni de
+        // postérieur au nom du suivant
+        if (segments[i].first_timestamp > to_ms) {
+            break;
+        }
+        if (i + 1 < segments.size() && segments[i + 1].first_timestamp < from_ms) {
+            continue;
+        }
+
+        int fd = ::open(segments[i].path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        if (!HasValidSegmentHeader(fd)) {
+            ::close(fd);
+            continue;
+        }
+        result->segments_scanned++;
+
+        uint64_t records = CountRecords(fd);
+        uint64_t next = FindStartRecord(segments[i].path, records, from_ms);
+        bool done = false;
+        while (next < records && !done) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(QUERY_READ_RECORDS, records - next));
+            if (!ReadFull(fd, buffer.data(), count * sizeof(DetectionRecord), RecordOffset(next))) {
+                break;
+            }
+            next += count;
+            for (size_t j = 0; j < count; ++j) {
+                const DetectionRecord& record = buffer[j];
+                result->records_scanned++;
+                if (record.timestamp_ms < from_ms) {
+                    continue;
+                }
+                if (record.timestamp_ms > to_ms) {
+                    done = true;
+                    break;
+                }
+                if (result->records.size() >= limit) {
+                    result->truncated = true;
+                    done = true;
+                    break;
+                }
+                result->records.push_back(record);
+            }
+        }
+        ::close(fd);
+
+        // Horodatages croissants d'un segment à l'autre
+        if (done) {
+            break;
+        }
+    }
+    return true;
+}
+
+DetectionRecord DetectionLog::ToRecord(const Detection& detection) {
+    DetectionRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timestamp_ms = detection.timestamp();
+    if (record.timestamp_ms <= 0) {
+        record.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    record.x = detection.bbox().x();
+    record.y = detection.bbox().y();
+    record.width = detection.bbox().width();
+    record.height = detection.bbox().height();
+    record.confidence = detection.confidence();
+    record.type_id = GetTypeId(detection.type());
+
+    auto track = detection.metadata().find("track_id");
+    if (track != detection.metadata().end()) {
+        record.track_id = static_cast<uint32_t>(std::strtoul(track->second.c_str(), nullptr, 10));
+    }
+    return record;
+}
+
+uint16_t DetectionLog::GetTypeId(const std::string& type) {
+    for (size_t id = 0; id < TYPE_NAMES.size(); ++id) {
+        if (type == TYPE_NAMES[id]) {
+            return static_cast<uint16_t>(id);
+        }
+    }
+    return 0;
+}
+
+std::string DetectionLog::GetTypeName(uint16_t type_id) {
+    return type_id < TYPE_NAMES.size() ? TYPE_NAMES[type_id] : TYPE_NAMES[0];
+}
+
+bool DetectionLog::AppendLocked(DetectionRecord record) {
+    // Horloge murale qui recule : l'ordre du journal prime, l'index en dépend
+    record.timestamp_ms = std::max(record.timestamp_ms, last_timestamp_);
+    last_timestamp_ = record.timestamp_ms;
+    if (pending_.empty()) {
+        oldest_pending_ = std::chrono::steady_clock::now();
+    }
+    pending_.push_back(record);
+    record_count_++;
+    return true;
+}
+
+bool DetectionLog::FlushLocked() {
+    if (pending_.empty()) {
+        return true;
+    }
+    if (directory_.empty()) {
+        pending_.clear();
+        return false;
+    }
+
+    // Un write() par segment touché ; un lot en échec est abandonné plutôt
+    // que de grossir sans fin
+    bool written = true;
+    size_t position = 0;
+    while (position < pending_.size()) {
+        if (NeedsNewSegment(pending_[position].timestamp_ms) &&
+            !StartSegment(pending_[position].timestamp_ms)) {
+            written = false;
+            break;
+        }
+        size_t count = 1;
+        uint64_t room = SEGMENT_MAX_RECORDS - segment_records_;
+        while (position + count < pending_.size() && count < room &&
+               pending_[position + count].timestamp_ms - segment_first_timestamp_ < SEGMENT_MAX_SPAN_MS) {
+            ++count;
+        }
+        if (!WriteFull(segment_fd_, &pending_[position], count * sizeof(DetectionRecord),
+                       RecordOffset(segment_records_))) {
+            written = false;
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t record_index = segment_records_ + i;
+            if (record_index % INDEX_STRIDE == 0) {
+                AddIndexEntry(record_index, pending_[position + i].timestamp_ms);
+            }
+        }
+        segment_records_ += count;
+        position += count;
+    }
+    pending_.clear();
+
+    // Écriture différée par le noyau : le thread de capture n'attend pas le disque
+    if (index_mapping_) {
+        ::msync(index_mapping_, index_mapping_size_, MS_ASYNC);
+    }
+    return written;
+}
+
+bool DetectionLog::ResumeLastSegment() {
+    std::vector<SegmentFile> segments = ListSegments(directory_);
+    if (segments.empty()) {
+        return true;  // premier segment créé au premier lot
+    }
+
+    // Le dernier nom fixe le plancher des horodatages, même si le segment
+    // est inutilisable : un nouveau segment ne peut pas le précéder
+    const SegmentFile& last = segments.back();
+    last_timestamp_ = std::max<int64_t>(0, last.first_timestamp);
+    segment_first_timestamp_ = last.first_timestamp;
+    if (!OpenSegment(last.path, false)) {
+        return true;
+    }
+
+    if (segment_records_ > 0) {
+        DetectionRecord record;
+        if (ReadFull(segment_fd_, &record, sizeof(record), RecordOffset(segment_records_ - 1))) {
+            last_timestamp_ = std::max(last_timestamp_, record.timestamp_ms);
+        }
+    }
+    return true;
+}
+
+bool DetectionLog::StartSegment(int64_t first_timestamp) {
+    // Un nom par segment, toujours après celui du segment précédent
+    int64_t name = std::max(first_timestamp, segment_first_timestamp_ + 1);
+    CloseSegment();
+    segment_first_timestamp_ = name;
+    last_timestamp_ = std::max(last_timestamp_, name);
+
+    std::string path = (std::filesystem::path(directory_) / (SegmentName(name) + SEGMENT_EXTENSION)).string();
+    return OpenSegment(path, true);
+}
+
+bool DetectionLog::OpenSegment(const std::string& segment_path, bool create) {
+    // Un segment à moitié ouvert ne doit pas recevoir d'écriture
+    auto fail = [this]() {
+        CloseSegment();
+        return false;
+    };
+    int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    segment_fd_ = ::open(segment_path.c_str(), flags, 0644);
+    if (segment_fd_ < 0) {
+        return fail();
+    }
+
+    if (create) {
+        SegmentHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+        header.version = FORMAT_VERSION;
+        header.header_size = SEGMENT_HEADER_SIZE;
+        header.record_size = sizeof(DetectionRecord);
+        header.first_timestamp = segment_first_timestamp_;
+        std::array<uint8_t, SEGMENT_HEADER_SIZE> block{};
+        std::memcpy(block.data(), &header, sizeof(header));
+        if (!WriteFull(segment_fd_, block.data(), block.size(), 0)) {
+            return fail();
+        }
+        segment_records_ = 0;
+    } else {
+        if (!HasValidSegmentHeader(segment_fd_)) {
+            return fail();
+        }
+        // Fin de lot interrompu : les octets partiels seront écrasés
+        segment_records_ = std::min(CountRecords(segment_fd_), SEGMENT_MAX_RECORDS);
+        if (::ftruncate(segment_fd_, RecordOffset(segment_records_)) != 0) {
+            return fail();
+        }
+    }
+
+    int index_flags = O_RDWR | O_CREAT | O_CLOEXEC | (create ? O_TRUNC : 0);
+    index_fd_ = ::open(IndexPathFor(segment_path).c_str(), index_flags, 0644);
+    if (index_fd_ < 0) {
+        return fail();
+    }
+    // Taille fixe, creuse sur disque : l'index n'est jamais reprojeté
+    struct stat info;
+    if (::fstat(index_fd_, &info) != 0 ||
+        (static_cast<size_t>(info.st_size) != INDEX_FILE_SIZE &&
+         ::ftruncate(index_fd_, static_cast<off_t>(INDEX_FILE_SIZE)) != 0)) {
+        return fail();
+    }
+    void* address = ::mmap(nullptr, INDEX_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+    if (address == MAP_FAILED) {
+        return fail();
+    }
+    index_mapping_ = static_cast<uint8_t*>(address);
+    index_mapping_size_ = INDEX_FILE_SIZE;
+
+    uint64_t expected = (segment_records_ + INDEX_STRIDE - 1) / INDEX_STRIDE;
+    const auto* header = reinterpret_cast<const IndexHeader*>(index_mapping_);
+    if ((!HasValidIndexHeader(index_mapping_, index_mapping_size_) || header->entry_count != expected) &&
+        !RebuildIndex()) {
+        return fail();
+    }
+    return true;
+}
+
+void DetectionLog::CloseSegment() {
+    if (index_mapping_) {
+        ::munmap(index_mapping_, index_mapping_size_);
+        index_mapping_ = nullptr;
+        index_mapping_size_ = 0;
+    }
+    if (index_fd_ >= 0) {
+        ::close(index_fd_);
+        index_fd_ = -1;
+    }
+    if (segment_fd_ >= 0) {
+        ::close(segment_fd_);
+        segment_fd_ = -1;
+    }
+    segment_records_ = 0;
+}
+
+bool DetectionLog::NeedsNewSegment(int64_t timestamp) const {
+    return segment_fd_ < 0 || segment_records_ >= SEGMENT_MAX_RECORDS ||
+           timestamp - segment_first_timestamp_ >= SEGMENT_MAX_SPAN_MS;
+}
+
+bool DetectionLog::RebuildIndex() {
+    // Index absent, d'une autre version ou en retard sur le segment (arrêt
+    // entre l'écriture d'un lot et celle de ses entrées)
+    std::memset(index_mapping_, 0, index_mapping_size_);
+    auto* header = reinterpret_cast<IndexHeader*>(index_mapping_);
+    std::memcpy(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header->version = FORMAT_VERSION;
+    header->header_size = INDEX_HEADER_SIZE;
+    header->stride = INDEX_STRIDE;
+    header->capacity = INDEX_CAPACITY;
+
+    for (uint64_t record_index = 0; record_index < segment_records_; record_index += INDEX_STRIDE) {
+        DetectionRecord record;
+        if (!ReadFull(segment_fd_, &record, sizeof(record), RecordOffset(record_index))) {
+            return false;
+        }
+        AddIndexEntry(record_index, record.timestamp_ms);
+    }
+    return true;
+}
+
+void DetectionLog::AddIndexEntry(uint64_t record_index, int64_t timestamp_ms) {
+    auto* header = reinterpret_cast<IndexHeader*>(index_mapping_);
+    uint64_t count = header->entry_count;
+    if (count >= header->capacity) {
+        return;
+    }
+    auto* entries = reinterpret_cast<IndexEntry*>(index_mapping_ + INDEX_HEADER_SIZE);
+    entries[count] = IndexEntry{timestamp_ms, record_index};
+    // Les lecteurs projettent le même fichier : l'entrée avant le compteur
+    __atomic_store_n(&header->entry_count, count + 1, __ATOMIC_RELEASE);
+}
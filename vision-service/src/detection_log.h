@@ -0,0 +1,129 @@
+// src/detection_log.h
+#ifndef DETECTION_LOG_H
+#define DETECTION_LOG_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "vision.pb.h"
+
+using surveillance::vision::Detection;
+
+// Détection persistée : enregistrement de taille fixe, sans pointeur ni
+// chaîne, lisible colonne par colonne sur des mois de données
+struct DetectionRecord {
+    int64_t timestamp_ms;   // ms depuis epoch, croissant dans un journal
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    float confidence;
+    uint16_t type_id;       // voir DetectionLog::GetTypeId
+    uint16_t flags;         // réservé (0)
+    uint32_t track_id;      // 0 = pas de piste
+    uint32_t reserved;
+};
+
+static_assert(sizeof(DetectionRecord) == 40, "format d'enregistrement figé");
+
+// Résultat d'une requête par intervalle de temps
+struct DetectionQueryResult {
+    std::vector<DetectionRecord> records;  // ordre chronologique
+    bool truncated = false;                // limite atteinte avant la fin de l'intervalle
+    int64_t records_scanned = 0;
+    int segments_scanned = 0;
+};
+
+// Journal des détections d'une caméra, en ajout seul : un répertoire de
+// segments "<premier horodatage>.dlog" (en-tête puis enregistrements) et,
+// pour chacun, un index clairsemé ".didx" projeté en mémoire qui donne
+// l'horodatage d'un enregistrement sur INDEX_STRIDE. Une requête choisit
+// les segments d'après leur nom, cherche dans l'index par dichotomie et ne
+// lit que les blocs de l'intervalle.
+//
+// Les détections sont accumulées puis écrites par lots (un write() par lot
+// et par segment). Un arrêt brutal perd au plus le lot en cours ; un
+// enregistrement partiel en fin de segment est ignoré puis écrasé.
+//
+// Un seul écrivain par répertoire ; les lecteurs (Query) n'ont pas besoin
+// de l'écrivain et ne voient que les lots déjà écrits.
+class DetectionLog {
+public:
+    DetectionLog() = default;
+    ~DetectionLog();
+
+    DetectionLog(const DetectionLog&) = delete;
+    DetectionLog& operator=(const DetectionLog&) = delete;
+
+    // Ouvre (ou crée) le répertoire et reprend l'écriture du dernier segment
+    bool Open(const std::string& directory);
+    void Close();  // écrit le lot en attente
+    bool IsOpen() const;
+    const std::string& GetDirectory() const;
+
+    // Ajoute au lot, écrit quand il est plein ou plus vieux que
+    // FLUSH_INTERVAL_MS. Appelé à chaque frame, même sans détection, pour
+    // que le délai soit tenu.
+    bool Append(const std::vector<Detection>& detections);
+    bool Append(const DetectionRecord& record);
+    bool Flush();
+
+    int64_t GetRecordCount() const;  // écrits et en attente, depuis l'ouverture
+
+    // Enregistrements de [from_ms, to_ms], au plus limit
+    static bool Query(const std::string& directory, int64_t from_ms, int64_t to_ms, size_t limit,
+                      DetectionQueryResult* result);
+
+    static DetectionRecord ToRecord(const Detection& detection);
+    static uint16_t GetTypeId(const std::string& type);  // 0 si inconnu
+    static std::string GetTypeName(uint16_t type_id);
+
+private:
+    mutable std::mutex mutex_;
+    std::string directory_;
+    std::vector<DetectionRecord> pending_;
+    std::chrono::steady_clock::time_point oldest_pending_;
+    int64_t last_timestamp_ = 0;
+    int64_t record_count_ = 0;
+
+    // Segment en cours d'écriture
+    int segment_fd_ = -1;
+    int64_t segment_first_timestamp_ = 0;
+    uint64_t segment_records_ = 0;
+    int index_fd_ = -1;
+    uint8_t* index_mapping_ = nullptr;
+    size_t index_mapping_size_ = 0;
+
+    bool AppendLocked(DetectionRecord record);
+    bool FlushLocked();
+    bool ResumeLastSegment();
+    bool StartSegment(int64_t first_timestamp);
+    bool OpenSegment(const std::string& segment_path, bool create);
+    void CloseSegment();
+    bool NeedsNewSegment(int64_t timestamp) const;
+    bool RebuildIndex();
+    void AddIndexEntry(uint64_t record_index, int64_t timestamp_ms);
+};
+
+namespace DetectionLogConstants {
+    constexpr char SEGMENT_MAGIC[8] = {'V', 'S', 'D', 'E', 'T', 'L', 'O', 'G'};
+    constexpr char INDEX_MAGIC[8] = {'V', 'S', 'D', 'E', 'T', 'I', 'D', 'X'};
+    constexpr uint32_t FORMAT_VERSION = 1;
+    const std::string SEGMENT_EXTENSION = ".dlog";
+    const std::string INDEX_EXTENSION = ".didx";
+
+    // 1 Mi enregistrements (40 Mio) ou une journée par segment
+    constexpr uint64_t SEGMENT_MAX_RECORDS = 1 << 20;
+    constexpr int64_t SEGMENT_MAX_SPAN_MS = 24LL * 3600 * 1000;
+    constexpr uint64_t INDEX_STRIDE = 64;
+
+    constexpr size_t BATCH_RECORDS = 256;
+    constexpr int FLUSH_INTERVAL_MS = 1000;
+    constexpr size_t QUERY_READ_RECORDS = 4096;  // taille des lectures d'une requête
+}
+
+#endif // DETECTION_LOG_H
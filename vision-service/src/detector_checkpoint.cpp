@@ -0,0 +1,242 @@
+// src/detector_checkpoint.cpp
+#include "detector_checkpoint.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace DetectorCheckpointConstants;
+
+namespace {
+
+// Tailles multiples de 64 : slots alignés sur les lignes de cache
+constexpr size_t FILE_HEADER_SIZE = 64;
+constexpr size_t SLOT_HEADER_SIZE = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t slot_capacity;
+};
+
+// sequence == 0 : slot vide ou en cours d'écriture
+struct SlotHeader {
+    uint64_t sequence;
+    uint64_t config_hash;
+    uint64_t payload_size;
+    uint32_t checksum;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) <= FILE_HEADER_SIZE, "en-tête de fichier trop grand");
+static_assert(sizeof(SlotHeader) <= SLOT_HEADER_SIZE, "en-tête de slot trop grand");
+
+std::array<uint32_t, 256> MakeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+size_t RoundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+DetectorCheckpoint::~DetectorCheckpoint() {
+    Close();
+}
+
+bool DetectorCheckpoint::Open(const std::string& path) {
+    Close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    path_ = path;
+
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        Close();
+        return false;
+    }
+    // Fichier vide : projeté à la première écriture
+    if (info.st_size > 0 && !Map(static_cast<size_t>(info.st_size))) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void DetectorCheckpoint::Close() {
+    Unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    path_.clear();
+}
+
+bool DetectorCheckpoint::IsOpen() const {
+    return fd_ >= 0;
+}
+
+const std::string& DetectorCheckpoint::GetPath() const {
+    return path_;
+}
+
+bool DetectorCheckpoint::Write(uint64_t config_hash, const std::vector<uint8_t>& payload) {
+    if (fd_ < 0) {
+        return false;
+    }
+    if (!HasValidHeader() || payload.size() > GetSlotCapacity()) {
+        // Marge de 50 % : l'état grandit peu d'une écriture à l'autre
+        if (!Format(std::max(MIN_SLOT_CAPACITY, payload.size() + payload.size() / 2))) {
+            return false;
+        }
+    }
+
+    // Slot le plus ancien ; l'autre reste le checkpoint valide pendant l'écriture
+    auto* first = reinterpret_cast<SlotHeader*>(GetSlot(0));
+    auto* second = reinterpret_cast<SlotHeader*>(GetSlot(1));
+    SlotHeader* target = first->sequence <= second->sequence ? first : second;
+    uint64_t sequence = std::max(first->sequence, second->sequence) + 1;
+
+    target->sequence = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    uint8_t* data = reinterpret_cast<uint8_t*>(target) + SLOT_HEADER_SIZE;
+    if (!payload.empty()) {
+        std::memcpy(data, payload.data(), payload.size());
+    }
+    target->config_hash = config_hash;
+    target->payload_size = payload.size();
+    target->checksum = Checksum(payload.data(), payload.size());
+    std::atomic_thread_fence(std::memory_order_release);
+    target->sequence = sequence;
+
+    // Écriture différée par le noyau : le thread de capture n'attend pas le disque
+    ::msync(mapping_, mapping_size_, MS_ASYNC);
+    return true;
+}
+
+bool DetectorCheckpoint::Read(uint64_t config_hash, std::vector<uint8_t>* payload) const {
+    if (!HasValidHeader()) {
+        return false;
+    }
+
+    const SlotHeader* best = nullptr;
+    for (int index = 0; index < SLOT_COUNT; ++index) {
+        const auto* slot = reinterpret_cast<const SlotHeader*>(GetSlot(index));
+        if (slot->sequence == 0 || slot->config_hash != config_hash ||
+            slot->payload_size > GetSlotCapacity()) {
+            continue;
+        }
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(slot) + SLOT_HEADER_SIZE;
+        if (Checksum(data, slot->payload_size) != slot->checksum) {
+            continue;
+        }
+        if (!best || slot->sequence > best->sequence) {
+            best = slot;
+        }
+    }
+    if (!best) {
+        return false;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(best) + SLOT_HEADER_SIZE;
+    payload->assign(data, data + best->payload_size);
+    return true;
+}
+
+uint32_t DetectorCheckpoint::Checksum(const uint8_t* data, size_t size) {
+    static const std::array<uint32_t, 256> table = MakeCrcTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+uint64_t DetectorCheckpoint::Hash(const std::string& bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool DetectorCheckpoint::HasValidHeader() const {
+    if (!mapping_ || mapping_size_ < FILE_HEADER_SIZE) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const FileHeader*>(mapping_);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != FORMAT_VERSION || header->header_size != FILE_HEADER_SIZE ||
+        header->slot_capacity % SLOT_HEADER_SIZE != 0) {
+        return false;
+    }
+    // Fichier tronqué : les slots ne tiennent pas dans la projection
+    return FILE_HEADER_SIZE + SLOT_COUNT * (SLOT_HEADER_SIZE + header->slot_capacity) <=
+           mapping_size_;
+}
+
+size_t DetectorCheckpoint::GetSlotCapacity() const {
+    return static_cast<size_t>(reinterpret_cast<const FileHeader*>(mapping_)->slot_capacity);
+}
+
+uint8_t* DetectorCheckpoint::GetSlot(int index) const {
+    return mapping_ + FILE_HEADER_SIZE + index * (SLOT_HEADER_SIZE + GetSlotCapacity());
+}
+
+bool DetectorCheckpoint::Map(size_t size) {
+    Unmap();
+    void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    mapping_ = static_cast<uint8_t*>(address);
+    mapping_size_ = size;
+    return true;
+}
+
+void DetectorCheckpoint::Unmap() {
+    if (mapping_) {
+        ::munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
+}
+
+bool DetectorCheckpoint::Format(size_t slot_capacity) {
+    slot_capacity = RoundUp(slot_capacity, SLOT_HEADER_SIZE);
+    size_t size = FILE_HEADER_SIZE + SLOT_COUNT * (SLOT_HEADER_SIZE + slot_capacity);
+
+    Unmap();
+    // Agrandir ou réduire puis remettre à zéro : les slots redeviennent vides
+    if (::ftruncate(fd_, 0) != 0 || ::ftruncate(fd_, static_cast<off_t>(size)) != 0 ||
+        !Map(size)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.header_size = FILE_HEADER_SIZE;
+    header.slot_capacity = slot_capacity;
+    std::memcpy(mapping_, &header, sizeof(header));
+    return true;
+}
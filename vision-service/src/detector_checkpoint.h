@@ -0,0 +1,64 @@
+// src/detector_checkpoint.h
+#ifndef DETECTOR_CHECKPOINT_H
+#define DETECTOR_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Fichier d'état des détecteurs d'une caméra, projeté en mémoire. Il
+// contient un en-tête versionné et deux slots écrits en alternance : le
+// slot le plus ancien est réécrit puis publié par son numéro de séquence,
+// si bien qu'un arrêt brutal pendant l'écriture laisse le checkpoint
+// précédent intact. Chaque slot porte l'empreinte de la configuration qui
+// l'a produit et un CRC32 de son contenu.
+//
+// Un seul écrivain par fichier (le thread de capture du stream).
+class DetectorCheckpoint {
+public:
+    DetectorCheckpoint() = default;
+    ~DetectorCheckpoint();
+
+    DetectorCheckpoint(const DetectorCheckpoint&) = delete;
+    DetectorCheckpoint& operator=(const DetectorCheckpoint&) = delete;
+
+    // Ouvre (ou crée) le fichier ; le contenu existant n'est validé qu'à la lecture
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const;
+    const std::string& GetPath() const;
+
+    // Publie payload dans le slot le plus ancien. Le fichier est agrandi
+    // (et ses slots effacés) si payload dépasse leur capacité.
+    bool Write(uint64_t config_hash, const std::vector<uint8_t>& payload);
+
+    // Slot valide le plus récent écrit avec config_hash ; false si le
+    // fichier est vide, d'une autre version, corrompu ou d'une autre configuration
+    bool Read(uint64_t config_hash, std::vector<uint8_t>* payload) const;
+
+    static uint32_t Checksum(const uint8_t* data, size_t size);  // CRC32
+    static uint64_t Hash(const std::string& bytes);              // FNV-1a 64 bits, stable
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    uint8_t* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    bool HasValidHeader() const;
+    size_t GetSlotCapacity() const;
+    uint8_t* GetSlot(int index) const;
+    bool Map(size_t size);
+    void Unmap();
+    bool Format(size_t slot_capacity);  // nouvel en-tête, slots vides
+};
+
+namespace DetectorCheckpointConstants {
+    constexpr char MAGIC[8] = {'V', 'S', 'D', 'S', 'T', 'A', 'T', 'E'};
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr int SLOT_COUNT = 2;
+    constexpr size_t MIN_SLOT_CAPACITY = 4096;
+}
+
+#endif // DETECTOR_CHECKPOINT_H
@@ -0,0 +1,54 @@
+// src/frame_features.cpp
+#include "frame_features.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace FrameFeatureConstants;
+
+FrameFeatureExtractor::FrameFeatureExtractor() {
+    SetBlockSize(DEFAULT_BLOCK_SIZE);
+}
+
+void FrameFeatureExtractor::SetBlockSize(int block_size) {
+    pipeline_.Get<BlockLumaStage>().SetBlockSize(block_size);
+}
+
+void FrameFeatureExtractor::SetQualityEnabled(bool enabled) {
+    pipeline_.Get<QualityStage>().SetEnabled(enabled);
+}
+
+void FrameFeatureExtractor::Finish(int width, int height) {
+    const BlockLumaStage& blocks = pipeline_.Get<BlockLumaStage>();
+    // features_ décrit encore la frame précédente
+    bool same_grid = features_.width == width && features_.height == height &&
+                     features_.grid_width == blocks.GetGridWidth() &&
+                     features_.grid_height == blocks.GetGridHeight();
+    uint64_t hash = pipeline_.Get<ContentHashStage>().GetHash();
+    features_.repeated = same_grid && features_.content_hash == hash;
+    features_.content_hash = hash;
+
+    features_.width = width;
+    features_.height = height;
+    features_.grid_width = blocks.GetGridWidth();
+    features_.grid_height = blocks.GetGridHeight();
+    features_.block_luma.assign(blocks.GetMeans().begin(), blocks.GetMeans().end());
+
+    const LumaStatisticsStage& statistics = pipeline_.Get<LumaStatisticsStage>();
+    features_.brightness = statistics.GetMean();
+    features_.variance = statistics.GetVariance();
+    features_.quality = pipeline_.Get<QualityStage>().Finish();
+    pipeline_.Get<HistogramStage>().Collect(&features_.histogram);
+
+    // Exposition pour le moniteur de santé, sans autre lecture des pixels
+    if (features_.quality.samples > 0) {
+        uint64_t pixels = 0;
+        uint64_t saturated = 0;
+        for (int level = 0; level < HISTOGRAM_BINS; ++level) {
+            pixels += features_.histogram[level];
+            saturated += level >= CameraHealthConstants::SATURATION_LEVEL ? features_.histogram[level] : 0;
+        }
+        features_.quality.brightness = features_.brightness;
+        features_.quality.contrast = std::sqrt(features_.variance);
+        features_.quality.saturated = pixels > 0 ? static_cast<float>(saturated) / static_cast<float>(pixels) : 0.0f;
+    }
+}
@@ -0,0 +1,203 @@
+// src/frame_features.h
+#ifndef FRAME_FEATURES_H
+#define FRAME_FEATURES_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "camera_health.h"
+#include "pixel_pipeline.h"
+
+namespace FrameFeatureConstants {
+    constexpr int HISTOGRAM_BINS = 256;
+    constexpr int HASH_LANES = 8;                     // mots de 32 bits hachés en parallèle
+    constexpr uint32_t HASH_LANE_PRIME = 0x9E3779B1u;
+    constexpr uint64_t HASH_OFFSET = 0xcbf29ce484222325ULL;  // FNV-1a 64 bits
+    constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+    constexpr int DEFAULT_BLOCK_SIZE = 16;
+}
+
+// Caractéristiques d'une frame, calculées en un seul parcours et lues par
+// les étages suivants (modèle de fond, santé de la caméra, flot optique)
+struct FrameFeatures {
+    int width = 0;
+    int height = 0;
+
+    // Luminance moyenne par bloc (blocs tronqués aux bords), ligne par ligne
+    int grid_width = 0;
+    int grid_height = 0;
+    std::vector<float> block_luma;
+
+    // Sur tous les pixels
+    float brightness = 0.0f;
+    float variance = 0.0f;
+
+    // Statistiques du moniteur de santé : netteté et contours
+    // échantillonnés, luminance et contraste ci-dessus, saturation de
+    // l'histogramme ; vide (samples = 0) si elles n'ont pas été demandées
+    FrameQualityStats quality;
+
+    // Luminance, une ligne sur QUALITY_SAMPLE_STEP
+    std::array<uint32_t, FrameFeatureConstants::HISTOGRAM_BINS> histogram{};
+
+    // Empreinte de la luminance (non cryptographique) : frames répétées par
+    // la source (flux figé, doublons), comptées à part par le détecteur
+    uint64_t content_hash = 0;
+    bool repeated = false;  // même empreinte et mêmes dimensions que la précédente
+};
+
+// Netteté et contours de FrameQualityAccumulator, lus dans les lignes de
+// luminance du pipeline : une ligne échantillonnée est comptée à l'arrivée
+// de la ligne du dessous, rien n'est relu dans la frame.
+class QualityStage : public PixelStage {
+public:
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+
+    void Begin(const PipelineFrame& frame) {
+        active_ = enabled_;
+        if (active_) {
+            accumulator_.Begin(frame.width, frame.height);
+        }
+    }
+
+    template <typename Format>
+    void Row(const PipelineRow& row) {
+        if (active_ && row.y % CameraHealthConstants::QUALITY_SAMPLE_STEP == 1) {
+            accumulator_.AddRow(row.above[1], row.above[0], row.luma, row.y - 1);
+        }
+    }
+
+    FrameQualityStats Finish() { return active_ ? accumulator_.Finish() : FrameQualityStats{}; }
+
+private:
+    bool enabled_ = false;
+    bool active_ = false;
+    FrameQualityAccumulator accumulator_;
+};
+
+// Histogramme de la luminance, une ligne sur QUALITY_SAMPLE_STEP ; quatre
+// sous-histogrammes pour que deux pixels voisins égaux n'attendent pas
+// l'un sur l'autre
+class HistogramStage : public PixelStage {
+public:
+    void Begin(const PipelineFrame& /*frame*/) {
+        for (auto& bins : bins_) {
+            bins.fill(0);
+        }
+    }
+
+    template <typename Format>
+    void Row(const PipelineRow& row) {
+        if (row.y % CameraHealthConstants::QUALITY_SAMPLE_STEP != 0) {
+            return;
+        }
+        int x = 0;
+        for (; x + 4 <= row.width; x += 4) {
+            bins_[0][row.luma[x]]++;
+            bins_[1][row.luma[x + 1]]++;
+            bins_[2][row.luma[x + 2]]++;
+            bins_[3][row.luma[x + 3]]++;
+        }
+        for (; x < row.width; ++x) {
+            bins_[0][row.luma[x]]++;
+        }
+    }
+
+    void Collect(std::array<uint32_t, FrameFeatureConstants::HISTOGRAM_BINS>* histogram) const {
+        for (int i = 0; i < FrameFeatureConstants::HISTOGRAM_BINS; ++i) {
+            (*histogram)[i] = bins_[0][i] + bins_[1][i] + bins_[2][i] + bins_[3][i];
+        }
+    }
+
+private:
+    std::array<std::array<uint32_t, FrameFeatureConstants::HISTOGRAM_BINS>, 4> bins_{};
+};
+
+// Empreinte de la luminance : HASH_LANES mots de 32 bits hachés côte à côte
+// (xor puis multiplication, vectorisé), les voies repliées en FNV-1a
+// 64 bits à la fin de chaque ligne. Un seul mot modifié change toujours sa
+// voie.
+class ContentHashStage : public PixelStage {
+public:
+    void Begin(const PipelineFrame& frame) {
+        using namespace FrameFeatureConstants;
+        hash_ = (HASH_OFFSET ^ static_cast<uint64_t>(frame.width)) * HASH_PRIME;
+        hash_ = (hash_ ^ static_cast<uint64_t>(frame.height)) * HASH_PRIME;
+    }
+
+    template <typename Format>
+    void Row(const PipelineRow& row) {
+        using namespace FrameFeatureConstants;
+        constexpr int CHUNK = HASH_LANES * 4;
+        uint32_t lanes[HASH_LANES];
+        for (int i = 0; i < HASH_LANES; ++i) {
+            lanes[i] = static_cast<uint32_t>(i + 1);
+        }
+        int x = 0;
+        for (; x + CHUNK <= row.width; x += CHUNK) {
+            uint32_t words[HASH_LANES];
+            std::memcpy(words, row.luma + x, CHUNK);
+            for (int i = 0; i < HASH_LANES; ++i) {
+                lanes[i] = (lanes[i] ^ words[i]) * HASH_LANE_PRIME;
+            }
+        }
+        for (int i = 0; i < HASH_LANES; ++i) {
+            hash_ = (hash_ ^ lanes[i]) * HASH_PRIME;
+        }
+        for (; x < row.width; ++x) {
+            hash_ = (hash_ ^ row.luma[x]) * HASH_PRIME;
+        }
+    }
+
+    uint64_t GetHash() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0;
+};
+
+// Extraction fusionnée des caractéristiques d'une frame : chaque pixel est
+// lu une fois, converti en luminance dans un tampon de lignes qui reste en
+// cache L1, et cette ligne alimente tous les étages (blocs, moyenne et
+// variance, netteté, histogramme, empreinte) puis le crochet de ligne de
+// l'appelant. Les étages sont composés à la compilation (PixelPipeline) et
+// leurs boucles vectorisées par le compilateur ; le seul trafic mémoire est
+// la lecture de la frame, plus ce que le crochet écrit.
+//
+// Utilisé par le seul thread de traitement.
+class FrameFeatureExtractor {
+public:
+    FrameFeatureExtractor();
+
+    void SetBlockSize(int block_size);
+    // Netteté et contours (FrameFeatures::quality), pour le moniteur de santé
+    void SetQualityEnabled(bool enabled);
+
+    // pixels : width × height pixels de bytes_per_pixel octets (1 ou 3),
+    // lignes contiguës. nullptr pour un autre format.
+    const FrameFeatures* Extract(const uint8_t* pixels, int width, int height, int bytes_per_pixel) {
+        return Extract(pixels, width, height, bytes_per_pixel, [](const PipelineRow&) {});
+    }
+
+    template <typename RowHook>
+    const FrameFeatures* Extract(const uint8_t* pixels, int width, int height, int bytes_per_pixel,
+                                 RowHook&& hook) {
+        if (!pipeline_.Run(pixels, width, height, bytes_per_pixel, hook)) {
+            return nullptr;
+        }
+        Finish(width, height);
+        return &features_;
+    }
+
+    // Dernière frame extraite
+    const FrameFeatures& GetFeatures() const { return features_; }
+
+private:
+    PixelPipeline<BlockLumaStage, LumaStatisticsStage, QualityStage, HistogramStage, ContentHashStage> pipeline_;
+    FrameFeatures features_;
+
+    void Finish(int width, int height);
+};
+
+#endif // FRAME_FEATURES_H
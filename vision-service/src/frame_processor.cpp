@@ -1,19 +1,38 @@
 // src/frame_processor.cpp
 #include "frame_processor.h"
 #include <algorithm>
-#include <random>
+#include <cmath>
 #include <sstream>
 #include <cstring>
+#include <filesystem>
+#include <limits>
 
 using namespace FrameProcessorConstants;
 
+// =============================================================================
+// Detector
+// =============================================================================
+
+std::vector<std::vector<Detection>> Detector::DetectBatch(const std::vector<Frame>& crops) {
+    std::vector<std::vector<Detection>> results;
+    results.reserve(crops.size());
+    for (const auto& crop : crops) {
+        results.push_back(Detect(crop));
+    }
+    return results;
+}
+
 // =============================================================================
 // BasicMotionDetector Implementation
 // =============================================================================
 
 BasicMotionDetector::BasicMotionDetector() 
-    : initialized_(false), detection_counter_(0), 
-      motion_threshold_(DEFAULT_MOTION_THRESHOLD), min_area_(DEFAULT_MIN_AREA) {
+    : initialized_(false), detection_counter_(0), heatmap_(nullptr), health_monitor_(nullptr),
+      motion_threshold_(DEFAULT_MOTION_THRESHOLD), min_area_(DEFAULT_MIN_AREA),
+      grid_width_(0), grid_height_(0), frames_seen_(0), repeated_frames_(0),
+      illumination_gain_(1.0f), illumination_offset_(0.0f), illumination_events_(0),
+      illumination_change_(false) {
+    features_.SetBlockSize(MOTION_BLOCK_SIZE);
 }
 
 BasicMotionDetector::~BasicMotionDetector() {
@@ -28,56 +47,310 @@ bool BasicMotionDetector::Initialize() {
 
 void BasicMotionDetector::Cleanup() {
     initialized_ = false;
-    previous_frame_ = Frame();
+    ResetModel(0, 0);
 }
 
 std::vector<Detection> BasicMotionDetector::Detect(const Frame& frame) {
-    std::vector<Detection> detections;
+    if (!initialized_ || !ExtractFeatures(frame)) {
+        return {};
+    }
+    if (health_monitor_) {
+        health_monitor_->Update(features_.GetFeatures().quality, frame.timestamp);
+    }
     
-    if (!initialized_) {
-        return detections;
+    // Première frame ou changement de résolution : nouveau modèle
+    int grid_width = (frame.width + MOTION_BLOCK_SIZE - 1) / MOTION_BLOCK_SIZE;
+    int grid_height = (frame.height + MOTION_BLOCK_SIZE - 1) / MOTION_BLOCK_SIZE;
+    if (frames_seen_ == 0 || grid_width != grid_width_ || grid_height != grid_height_) {
+        ResetModel(grid_width, grid_height);
+        background_ = luma_;
+    }
+    
+    bool learning = IsLearning();
+    UpdateModel(learning);
+    frames_seen_++;
+    if (learning) {
+        return {};
+    }
+    bool repeated = features_.GetFeatures().repeated;
+    repeated_frames_ += repeated;
+    // Avant ExtractDetections, qui consomme le masque
+    if (heatmap_ && !repeated) {
+        heatmap_->Accumulate(mask_.data(), grid_width_, grid_height_, frame.offset_x, frame.offset_y,
+                             frame.timestamp);
+    }
+    std::vector<Detection> detections = ExtractDetections(frame);
+    optical_flow_.Annotate(&detections);
+    return detections;
+}
+
+bool BasicMotionDetector::IsLearning() const {
+    return frames_seen_ < LEARNING_FRAMES;
+}
+
+void BasicMotionDetector::SetMotionThreshold(double threshold) {
+    motion_threshold_ = std::clamp(threshold, 0.0, 1.0);
+}
+
+void BasicMotionDetector::SetMinArea(int area) {
+    min_area_ = std::max(1, area);
+}
+
+void BasicMotionDetector::SetHeatmap(MotionHeatmap* heatmap) {
+    heatmap_ = heatmap;
+}
+
+void BasicMotionDetector::SetHealthMonitor(CameraHealthMonitor* monitor) {
+    health_monitor_ = monitor;
+}
+
+bool BasicMotionDetector::ExtractFeatures(const Frame& frame) {
+    // Formats compressés : pas de décodage ici
+    int bytes_per_pixel = FrameUtils::BytesPerPixel(frame.format);
+    size_t expected_size = static_cast<size_t>(frame.width) * frame.height * bytes_per_pixel;
+    if (bytes_per_pixel == 0 || frame.width <= 0 || frame.height <= 0 ||
+        frame.PixelBytes() < expected_size) {
+        return false;
     }
     
-    // Pour Phase 2.1, simulation simple de détection de mouvement
-    if (previous_frame_.data.empty()) {
-        // Première frame, juste la stocker
-        previous_frame_ = frame;
-        return detections;
+    // Luminance de chaque ligne conservée pour le flot optique pendant
+    // qu'elle est en cache
+    features_.SetQualityEnabled(health_monitor_ != nullptr);
+    optical_flow_.BeginFrame(frame.width, frame.height, frame.offset_x, frame.offset_y, frame.timestamp);
+    const FrameFeatures* features = features_.Extract(frame.Pixels(), frame.width, frame.height, bytes_per_pixel,
+                                                      [this](const PipelineRow& row) {
+        optical_flow_.StoreLumaRow(row.luma, row.y);
+    });
+    if (!features) {
+        return false;
     }
     
-    // Vérifier s'il y a un changement significatif
-    if (HasSignificantChange(frame, previous_frame_)) {
-        // Créer une détection simulée
-        int x = 100 + (detection_counter_ % 400);  // Position variable
-        int y = 100 + ((detection_counter_ / 10) % 200);
-        int width = 80 + (detection_counter_ % 40);
-        int height = 60 + (detection_counter_ % 30);
-        float confidence = 0.7f + static_cast<float>(rand()) / RAND_MAX * 0.3f;  // 0.7-1.0
+    luma_.assign(features->block_luma.begin(), features->block_luma.end());
+    return true;
+}
+
+void BasicMotionDetector::ResetModel(int grid_width, int grid_height) {
+    size_t blocks = static_cast<size_t>(grid_width) * grid_height;
+    grid_width_ = grid_width;
+    grid_height_ = grid_height;
+    frames_seen_ = 0;
+    background_.assign(blocks, 0.0f);
+    noise_.assign(blocks, INITIAL_NOISE);
+    foreground_age_.assign(blocks, 0);
+    mask_.assign(blocks, 0);
+    illumination_gain_ = 1.0f;
+    illumination_offset_ = 0.0f;
+    illumination_change_ = false;
+}
+
+void BasicMotionDetector::EstimateIllumination() {
+    illumination_gain_ = 1.0f;
+    illumination_offset_ = 0.0f;
+    if (luma_.size() < MIN_ILLUMINATION_BLOCKS) {
+        return;
+    }
+    
+    // Premier passage sur tous les blocs, puis seulement sur ceux que le
+    // modèle précédent explique : les objets en mouvement ne tirent pas la droite
+    float limit = std::numeric_limits<float>::infinity();
+    for (int pass = 0; pass < ILLUMINATION_FIT_PASSES; ++pass) {
+        double n = 0.0, sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+        for (size_t i = 0; i < luma_.size(); ++i) {
+            float predicted = illumination_gain_ * background_[i] + illumination_offset_;
+            if (std::fabs(luma_[i] - predicted) > limit) {
+                continue;
+            }
+            n += 1.0;
+            sum_x += background_[i];
+            sum_y += luma_[i];
+            sum_xx += static_cast<double>(background_[i]) * background_[i];
+            sum_xy += static_cast<double>(background_[i]) * luma_[i];
+        }
+        if (n < MIN_ILLUMINATION_BLOCKS) {
+            break;
+        }
         
-        Detection detection = CreateMotionDetection(x, y, width, height, confidence);
-        detections.push_back(detection);
+        double variance = sum_xx - sum_x * sum_x / n;
+        double gain = 1.0;
+        if (variance > MIN_ILLUMINATION_VARIANCE * n) {
+            gain = std::clamp((sum_xy - sum_x * sum_y / n) / variance,
+                              static_cast<double>(MIN_ILLUMINATION_GAIN),
+                              static_cast<double>(MAX_ILLUMINATION_GAIN));
+        }
+        illumination_gain_ = static_cast<float>(gain);
+        illumination_offset_ = static_cast<float>((sum_y - gain * sum_x) / n);
         
-        detection_counter_++;
+        difference_.resize(luma_.size());
+        for (size_t i = 0; i < luma_.size(); ++i) {
+            difference_[i] = std::fabs(luma_[i] - (illumination_gain_ * background_[i] + illumination_offset_));
+        }
+        auto median = difference_.begin() + difference_.size() / 2;
+        std::nth_element(difference_.begin(), median, difference_.end());
+        limit = std::max(ILLUMINATION_MIN_RESIDUAL, ILLUMINATION_RESIDUAL_FACTOR * *median);
+    }
+}
+
+void BasicMotionDetector::UpdateModel(bool learning) {
+    float min_difference = static_cast<float>(motion_threshold_ * 255.0);
+    if (!learning) {
+        EstimateIllumination();
     }
     
-    // Mettre à jour la frame précédente
-    previous_frame_ = frame;
+    // Écarts ramenés à l'éclairage du fond
+    size_t raw_foreground = 0;
+    size_t foreground_blocks = 0;
+    difference_.resize(luma_.size());
+    for (size_t i = 0; i < luma_.size(); ++i) {
+        float threshold = std::max(NOISE_FACTOR * noise_[i], min_difference);
+        float compensated = (luma_[i] - illumination_offset_) / illumination_gain_;
+        difference_[i] = std::fabs(compensated - background_[i]);
+        raw_foreground += std::fabs(luma_[i] - background_[i]) > threshold;
+        foreground_blocks += difference_[i] > threshold;
+    }
+    
+    float blocks = static_cast<float>(luma_.size());
+    bool global_change = !learning && foreground_blocks > GLOBAL_CHANGE_FRACTION * blocks;
+    bool illumination_change = global_change ||
+        (raw_foreground > foreground_blocks &&
+         static_cast<float>(raw_foreground - foreground_blocks) >= ILLUMINATION_EVENT_FRACTION * blocks);
+    if (illumination_change && !illumination_change_) {
+        illumination_events_++;
+    }
+    illumination_change_ = illumination_change;
+    
+    if (global_change) {
+        // Changement que le gain n'explique pas (ombres, exposition) : nouveau fond
+        background_ = luma_;
+        std::fill(foreground_age_.begin(), foreground_age_.end(), 0);
+        std::fill(mask_.begin(), mask_.end(), 0);
+        return;
+    }
+    
+    for (size_t i = 0; i < luma_.size(); ++i) {
+        float difference = difference_[i];
+        bool foreground = !learning &&
+                          difference > std::max(NOISE_FACTOR * noise_[i], min_difference);
+        
+        if (!foreground) {
+            background_[i] += BACKGROUND_LEARNING_RATE * (luma_[i] - background_[i]);
+            noise_[i] += BACKGROUND_LEARNING_RATE * (difference - noise_[i]);
+            foreground_age_[i] = 0;
+            mask_[i] = 0;
+        } else if (++foreground_age_[i] >= ABSORB_FRAMES) {
+            // Immobile depuis trop longtemps : fait désormais partie du fond
+            background_[i] = luma_[i];
+            foreground_age_[i] = 0;
+            mask_[i] = 0;
+        } else {
+            mask_[i] = 1;
+        }
+    }
+}
+
+std::vector<Detection> BasicMotionDetector::ExtractDetections(const Frame& frame) {
+    std::vector<Detection> detections;
+    
+    // Composantes 4-connexes des blocs au premier plan (le masque est consommé)
+    for (int start = 0; start < grid_width_ * grid_height_; ++start) {
+        if (!mask_[start]) {
+            continue;
+        }
+        int min_x = grid_width_, min_y = grid_height_, max_x = -1, max_y = -1;
+        int blocks = 0;
+        mask_[start] = 0;
+        component_stack_.assign(1, start);
+        while (!component_stack_.empty()) {
+            int index = component_stack_.back();
+            component_stack_.pop_back();
+            int bx = index % grid_width_;
+            int by = index / grid_width_;
+            min_x = std::min(min_x, bx);
+            max_x = std::max(max_x, bx);
+            min_y = std::min(min_y, by);
+            max_y = std::max(max_y, by);
+            blocks++;
+            
+            const int neighbours[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (const auto& offset : neighbours) {
+                int nx = bx + offset[0];
+                int ny = by + offset[1];
+                if (nx < 0 || ny < 0 || nx >= grid_width_ || ny >= grid_height_) {
+                    continue;
+                }
+                int neighbour = ny * grid_width_ + nx;
+                if (mask_[neighbour]) {
+                    mask_[neighbour] = 0;
+                    component_stack_.push_back(neighbour);
+                }
+            }
+        }
+        
+        int x = min_x * MOTION_BLOCK_SIZE;
+        int y = min_y * MOTION_BLOCK_SIZE;
+        int width = std::min((max_x + 1) * MOTION_BLOCK_SIZE, frame.width) - x;
+        int height = std::min((max_y + 1) * MOTION_BLOCK_SIZE, frame.height) - y;
+        if (width * height < min_area_) {
+            continue;
+        }
+        
+        // Confiance : part des blocs du rectangle réellement en mouvement
+        int box_blocks = (max_x - min_x + 1) * (max_y - min_y + 1);
+        float confidence = 0.5f + 0.5f * static_cast<float>(blocks) / box_blocks;
+        detections.push_back(CreateMotionDetection(x, y, width, height, confidence));
+        detection_counter_++;
+    }
     
     return detections;
 }
 
-bool BasicMotionDetector::HasSignificantChange(const Frame& current, const Frame& previous) const {
-    // Simulation simple basée sur la taille des données et un peu d'aléatoire
-    if (current.data.size() != previous.data.size()) {
-        return true;
+std::vector<uint8_t> BasicMotionDetector::SaveState() const {
+    if (frames_seen_ == 0) {
+        return {};
     }
     
-    // Simulation : mouvement détecté environ 30% du temps
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
+    // [largeur, hauteur (u32)] [frames vues (u64)] [fond] [bruit] [âges]
+    size_t blocks = background_.size();
+    std::vector<uint8_t> state(16 + blocks * (2 * sizeof(float) + sizeof(uint16_t)));
+    uint8_t* out = state.data();
+    uint32_t dims[2] = {static_cast<uint32_t>(grid_width_), static_cast<uint32_t>(grid_height_)};
+    std::memcpy(out, dims, sizeof(dims));
+    std::memcpy(out + 8, &frames_seen_, sizeof(frames_seen_));
+    out += 16;
+    std::memcpy(out, background_.data(), blocks * sizeof(float));
+    out += blocks * sizeof(float);
+    std::memcpy(out, noise_.data(), blocks * sizeof(float));
+    out += blocks * sizeof(float);
+    std::memcpy(out, foreground_age_.data(), blocks * sizeof(uint16_t));
+    return state;
+}
+
+bool BasicMotionDetector::RestoreState(const std::vector<uint8_t>& state) {
+    if (state.size() < 16) {
+        return false;
+    }
+    uint32_t dims[2];
+    uint64_t frames_seen;
+    std::memcpy(dims, state.data(), sizeof(dims));
+    std::memcpy(&frames_seen, state.data() + 8, sizeof(frames_seen));
     
-    return dis(gen) < 0.3;  // 30% de chance de détection
+    const uint32_t max_grid = MAX_FRAME_WIDTH / MOTION_BLOCK_SIZE + 1;
+    if (dims[0] == 0 || dims[1] == 0 || dims[0] > max_grid || dims[1] > max_grid) {
+        return false;
+    }
+    size_t blocks = static_cast<size_t>(dims[0]) * dims[1];
+    if (state.size() != 16 + blocks * (2 * sizeof(float) + sizeof(uint16_t))) {
+        return false;
+    }
+    
+    ResetModel(static_cast<int>(dims[0]), static_cast<int>(dims[1]));
+    const uint8_t* in = state.data() + 16;
+    std::memcpy(background_.data(), in, blocks * sizeof(float));
+    in += blocks * sizeof(float);
+    std::memcpy(noise_.data(), in, blocks * sizeof(float));
+    in += blocks * sizeof(float);
+    std::memcpy(foreground_age_.data(), in, blocks * sizeof(uint16_t));
+    frames_seen_ = frames_seen;
+    return true;
 }
 
 Detection BasicMotionDetector::CreateMotionDetection(int x, int y, int width, int height, float confidence) const {
@@ -101,7 +374,7 @@ Detection BasicMotionDetector::CreateMotionDetection(int x, int y, int width, in
     // Métadonnées
     auto& metadata = *detection.mutable_metadata();
     metadata["detector"] = "BasicMotionDetector";
-    metadata["algorithm"] = "simulated";
+    metadata["algorithm"] = "background_subtraction";
     metadata["confidence_str"] = std::to_string(confidence);
     
     return detection;
@@ -121,8 +394,12 @@ std::string BasicMotionDetector::GenerateDetectionId() const {
 // =============================================================================
 
 FrameProcessor::FrameProcessor() 
-    : initialized_(false), motion_threshold_(DEFAULT_MOTION_THRESHOLD),
-      min_detection_area_(DEFAULT_MIN_AREA), max_detections_per_frame_(DEFAULT_MAX_DETECTIONS) {
+    : heatmap_(std::make_unique<MotionHeatmap>()), health_monitor_(std::make_unique<CameraHealthMonitor>()),
+      motion_detector_(nullptr), illumination_events_(0), repeated_frames_(0),
+      initialized_(false), motion_threshold_(DEFAULT_MOTION_THRESHOLD),
+      min_detection_area_(DEFAULT_MIN_AREA), max_detections_per_frame_(DEFAULT_MAX_DETECTIONS),
+      throttled_frames_(0), classification_budget_(DEFAULT_CLASSIFICATION_BUDGET),
+      checkpoint_config_hash_(0), checkpoint_interval_(0), heatmap_interval_(0) {
 }
 
 FrameProcessor::~FrameProcessor() {
@@ -139,6 +416,13 @@ bool FrameProcessor::Initialize() {
     if (!motion_detector->Initialize()) {
         return false;
     }
+    motion_detector->SetHeatmap(heatmap_.get());
+    motion_detector->SetHealthMonitor(health_monitor_.get());
+    motion_detector->SetMotionThreshold(motion_threshold_);
+    motion_detector->SetMinArea(min_detection_area_);
+    motion_detector_ = motion_detector.get();
+    illumination_events_ = 0;
+    repeated_frames_ = 0;
     
     detectors_.push_back(std::move(motion_detector));
     
@@ -147,12 +431,27 @@ bool FrameProcessor::Initialize() {
 }
 
 void FrameProcessor::Cleanup() {
+    // Dernier état appris, repris au prochain démarrage du stream
+    if (checkpoint_) {
+        SaveCheckpoint();
+        checkpoint_.reset();
+    }
+    if (heatmap_checkpoint_) {
+        SaveHeatmapCheckpoint();
+        heatmap_checkpoint_.reset();
+    }
+    
     for (auto& detector : detectors_) {
         if (detector) {
             detector->Cleanup();
         }
     }
     detectors_.clear();
+    motion_detector_ = nullptr;
+    if (classifier_) {
+        classifier_->Cleanup();
+        classifier_.reset();
+    }
     initialized_ = false;
 }
 
@@ -168,6 +467,14 @@ ProcessingResult FrameProcessor::ProcessFrame(const Frame& frame) {
     }
     
     ProcessingResult result;
+    int classifications = 0;
+    int classifications_skipped = 0;
+    
+    // Image dégradée : analyser assez de frames pour voir le retour à la normale
+    if (health_monitor_->IsThrottled() && ++throttled_frames_ % CameraHealthConstants::THROTTLE_INTERVAL != 0) {
+        result.skipped = true;
+        return result;
+    }
     
     try {
         // Appliquer tous les détecteurs
@@ -175,6 +482,15 @@ ProcessingResult FrameProcessor::ProcessFrame(const Frame& frame) {
             if (detector) {
                 std::vector<Detection> detections = detector->Detect(frame);
                 
+                // Frame recadrée : coordonnées ramenées dans la frame source
+                if (frame.offset_x != 0 || frame.offset_y != 0) {
+                    for (auto& detection : detections) {
+                        auto* bbox = detection.mutable_bbox();
+                        bbox->set_x(bbox->x() + frame.offset_x);
+                        bbox->set_y(bbox->y() + frame.offset_y);
+                    }
+                }
+                
                 // Ajouter les détections au résultat
                 for (const auto& detection : detections) {
                     if (result.detections.size() < static_cast<size_t>(max_detections_per_frame_)) {
@@ -186,8 +502,29 @@ ProcessingResult FrameProcessor::ProcessFrame(const Frame& frame) {
             }
         }
         
+        // Nouveau changement d'éclairage ou frame répétée, vus par le détecteur de mouvement
+        if (motion_detector_) {
+            result.illumination_change = motion_detector_->GetIlluminationEvents() != illumination_events_;
+            result.repeated = motion_detector_->GetRepeatedFrames() != repeated_frames_;
+            illumination_events_ = motion_detector_->GetIlluminationEvents();
+            repeated_frames_ = motion_detector_->GetRepeatedFrames();
+        }
+        
+        // Second étage sur les régions du premier, dans la limite du budget
+        if (classifier_ && !result.detections.empty()) {
+            classifications = ClassifyRegions(frame, &result.detections);
+            classifications_skipped = static_cast<int>(result.detections.size()) - classifications;
+        }
+        
         result.success = true;
         
+        if (checkpoint_ && start_time - last_checkpoint_ >= checkpoint_interval_) {
+            SaveCheckpoint();
+        }
+        if (heatmap_checkpoint_ && start_time - last_heatmap_checkpoint_ >= heatmap_interval_) {
+            SaveHeatmapCheckpoint();
+        }
+        
     } catch (const std::exception& e) {
         result = CreateErrorResult("Processing error: " + std::string(e.what()));
     }
@@ -199,7 +536,7 @@ ProcessingResult FrameProcessor::ProcessFrame(const Frame& frame) {
     ).count();
     
     // Mettre à jour les statistiques
-    UpdateStatistics(result.processing_time_ms, static_cast<int>(result.detections.size()));
+    UpdateStatistics(result, classifications, classifications_skipped);
     
     return result;
 }
@@ -221,6 +558,9 @@ void FrameProcessor::AddDetector(std::unique_ptr<Detector> detector) {
 }
 
 void FrameProcessor::RemoveDetector(const std::string& detector_name) {
+    if (motion_detector_ && motion_detector_->GetName() == detector_name) {
+        motion_detector_ = nullptr;
+    }
     detectors_.erase(
         std::remove_if(detectors_.begin(), detectors_.end(),
                       [&detector_name](const std::unique_ptr<Detector>& detector) {
@@ -242,33 +582,273 @@ std::vector<std::string> FrameProcessor::GetDetectorNames() const {
 
 void FrameProcessor::SetMotionThreshold(double threshold) {
     motion_threshold_ = std::clamp(threshold, 0.0, 1.0);
+    if (motion_detector_) {
+        motion_detector_->SetMotionThreshold(motion_threshold_);
+    }
 }
 
 void FrameProcessor::SetMinDetectionArea(int area) {
     min_detection_area_ = std::max(1, area);
+    if (motion_detector_) {
+        motion_detector_->SetMinArea(min_detection_area_);
+    }
 }
 
 void FrameProcessor::SetMaxDetectionsPerFrame(int max_detections) {
     max_detections_per_frame_ = std::max(1, max_detections);
 }
 
+void FrameProcessor::SetClassifier(std::unique_ptr<Detector> classifier) {
+    if (classifier_) {
+        classifier_->Cleanup();
+    }
+    classifier_.reset();
+    if (classifier && classifier->Initialize()) {
+        classifier_ = std::move(classifier);
+    }
+}
+
+void FrameProcessor::SetClassificationBudget(int max_per_frame) {
+    classification_budget_ = std::max(0, max_per_frame);
+}
+
+int FrameProcessor::ClassifyRegions(const Frame& frame, std::vector<Detection>* detections) {
+    // Les plus grandes régions d'abord
+    classification_order_.resize(detections->size());
+    for (size_t i = 0; i < detections->size(); ++i) {
+        classification_order_[i] = i;
+    }
+    auto area = [detections](size_t index) {
+        const auto& bbox = (*detections)[index].bbox();
+        return static_cast<int64_t>(bbox.width()) * bbox.height();
+    };
+    std::stable_sort(classification_order_.begin(), classification_order_.end(),
+                     [&area](size_t a, size_t b) { return area(a) > area(b); });
+    classification_order_.resize(std::min(classification_order_.size(),
+                                          static_cast<size_t>(classification_budget_)));
+    
+    int input_width = classifier_->GetInputWidth();
+    int input_height = classifier_->GetInputHeight();
+    classification_regions_.clear();
+    classification_crops_.clear();
+    for (size_t index : classification_order_) {
+        // Boîte dans la frame analysée, élargie puis mise au format d'entrée
+        const auto& bbox = (*detections)[index].bbox();
+        float width = bbox.width() * (1.0f + 2.0f * CLASSIFICATION_MARGIN);
+        float height = bbox.height() * (1.0f + 2.0f * CLASSIFICATION_MARGIN);
+        if (input_width > 0 && input_height > 0) {
+            float aspect = static_cast<float>(input_width) / input_height;
+            if (width / height < aspect) {
+                width = height * aspect;
+            } else {
+                height = width / aspect;
+            }
+        }
+        float center_x = bbox.x() - frame.offset_x + bbox.width() / 2.0f;
+        float center_y = bbox.y() - frame.offset_y + bbox.height() / 2.0f;
+        int x0 = std::clamp(static_cast<int>(std::lround(center_x - width / 2)), 0, frame.width);
+        int y0 = std::clamp(static_cast<int>(std::lround(center_y - height / 2)), 0, frame.height);
+        int x1 = std::clamp(static_cast<int>(std::lround(center_x + width / 2)), x0, frame.width);
+        int y1 = std::clamp(static_cast<int>(std::lround(center_y + height / 2)), y0, frame.height);
+        FrameRegion region(x0, y0, x1 - x0, y1 - y0);
+        
+        classification_regions_.push_back(region);
+        classification_crops_.push_back(input_width > 0 && input_height > 0
+            ? FrameUtils::ResizeRegion(frame, region, input_width, input_height)
+            : FrameUtils::CropFrame(frame, region));
+    }
+    if (classification_crops_.empty()) {
+        return 0;
+    }
+    
+    std::vector<std::vector<Detection>> results = classifier_->DetectBatch(classification_crops_);
+    for (size_t i = 0; i < classification_order_.size() && i < results.size(); ++i) {
+        auto best = std::max_element(results[i].begin(), results[i].end(),
+                                     [](const Detection& a, const Detection& b) {
+                                         return a.confidence() < b.confidence();
+                                     });
+        if (best == results[i].end()) {
+            continue;
+        }
+        
+        // Boîte du classifieur ramenée de l'imagette à la frame source
+        const FrameRegion& region = classification_regions_[i];
+        const Frame& crop = classification_crops_[i];
+        double scale_x = static_cast<double>(region.width) / std::max(1, crop.width);
+        double scale_y = static_cast<double>(region.height) / std::max(1, crop.height);
+        Detection& detection = (*detections)[classification_order_[i]];
+        auto& metadata = *detection.mutable_metadata();
+        metadata["motion_confidence"] = std::to_string(detection.confidence());
+        metadata["classifier"] = classifier_->GetName();
+        for (const auto& [key, value] : best->metadata()) {
+            metadata.insert({key, value});
+        }
+        detection.set_type(best->type());
+        detection.set_confidence(best->confidence());
+        auto* bbox = detection.mutable_bbox();
+        bbox->set_x(frame.offset_x + region.x + static_cast<int>(std::lround(best->bbox().x() * scale_x)));
+        bbox->set_y(frame.offset_y + region.y + static_cast<int>(std::lround(best->bbox().y() * scale_y)));
+        bbox->set_width(static_cast<int>(std::lround(best->bbox().width() * scale_x)));
+        bbox->set_height(static_cast<int>(std::lround(best->bbox().height() * scale_y)));
+    }
+    return static_cast<int>(classification_crops_.size());
+}
+
+bool FrameProcessor::EnableCheckpoint(const std::string& path, uint64_t config_hash,
+                                      std::chrono::milliseconds interval) {
+    auto checkpoint = std::make_unique<DetectorCheckpoint>();
+    if (!checkpoint->Open(path)) {
+        return false;
+    }
+    checkpoint_ = std::move(checkpoint);
+    checkpoint_config_hash_ = config_hash;
+    checkpoint_interval_ = interval;
+    last_checkpoint_ = std::chrono::steady_clock::now();
+    
+    std::vector<uint8_t> payload;
+    if (!checkpoint_->Read(config_hash, &payload)) {
+        return false;
+    }
+    
+    // Entrées [taille du nom (u32)] [nom] [taille de l'état (u64)] [état]
+    bool restored = false;
+    size_t offset = 0;
+    while (offset + sizeof(uint32_t) <= payload.size()) {
+        uint32_t name_size;
+        std::memcpy(&name_size, payload.data() + offset, sizeof(name_size));
+        offset += sizeof(name_size);
+        if (name_size > payload.size() - offset ||
+            payload.size() - offset - name_size < sizeof(uint64_t)) {
+            break;
+        }
+        std::string name(reinterpret_cast<const char*>(payload.data() + offset), name_size);
+        offset += name_size;
+        uint64_t state_size;
+        std::memcpy(&state_size, payload.data() + offset, sizeof(state_size));
+        offset += sizeof(state_size);
+        if (state_size > payload.size() - offset) {
+            break;
+        }
+        std::vector<uint8_t> state(payload.begin() + offset, payload.begin() + offset + state_size);
+        offset += state_size;
+        
+        for (auto& detector : detectors_) {
+            if (detector && detector->GetName() == name && detector->RestoreState(state)) {
+                restored = true;
+            }
+        }
+    }
+    return restored;
+}
+
+bool FrameProcessor::SaveCheckpoint() {
+    if (!checkpoint_) {
+        return false;
+    }
+    last_checkpoint_ = std::chrono::steady_clock::now();
+    
+    std::vector<uint8_t> payload;
+    for (const auto& detector : detectors_) {
+        if (!detector) {
+            continue;
+        }
+        std::vector<uint8_t> state = detector->SaveState();
+        if (state.empty()) {
+            continue;
+        }
+        std::string name = detector->GetName();
+        uint32_t name_size = static_cast<uint32_t>(name.size());
+        uint64_t state_size = state.size();
+        size_t offset = payload.size();
+        payload.resize(offset + sizeof(name_size) + name.size() + sizeof(state_size) + state.size());
+        uint8_t* out = payload.data() + offset;
+        std::memcpy(out, &name_size, sizeof(name_size));
+        out += sizeof(name_size);
+        std::memcpy(out, name.data(), name.size());
+        out += name.size();
+        std::memcpy(out, &state_size, sizeof(state_size));
+        out += sizeof(state_size);
+        std::memcpy(out, state.data(), state.size());
+    }
+    // Rien d'appris (pas encore de frame) : on garde le checkpoint précédent
+    if (payload.empty()) {
+        return false;
+    }
+    return checkpoint_->Write(checkpoint_config_hash_, payload);
+}
+
+bool FrameProcessor::IsCheckpointEnabled() const {
+    return checkpoint_ != nullptr;
+}
+
+MotionHeatmap* FrameProcessor::GetHeatmap() const {
+    return heatmap_.get();
+}
+
+CameraHealthMonitor* FrameProcessor::GetHealthMonitor() const {
+    return health_monitor_.get();
+}
+
+bool FrameProcessor::EnableHeatmapCheckpoint(const std::string& path, std::chrono::milliseconds interval) {
+    auto checkpoint = std::make_unique<DetectorCheckpoint>();
+    if (!checkpoint->Open(path)) {
+        return false;
+    }
+    heatmap_checkpoint_ = std::move(checkpoint);
+    heatmap_interval_ = interval;
+    last_heatmap_checkpoint_ = std::chrono::steady_clock::now();
+    
+    std::vector<uint8_t> state;
+    return heatmap_checkpoint_->Read(MotionHeatmapConstants::STATE_VERSION, &state) &&
+           heatmap_->RestoreState(state);
+}
+
+bool FrameProcessor::SaveHeatmapCheckpoint() {
+    if (!heatmap_checkpoint_) {
+        return false;
+    }
+    last_heatmap_checkpoint_ = std::chrono::steady_clock::now();
+    std::vector<uint8_t> state = heatmap_->SaveState();
+    if (state.empty()) {
+        return false;
+    }
+    return heatmap_checkpoint_->Write(MotionHeatmapConstants::STATE_VERSION, state);
+}
+
+bool FrameProcessor::LoadHeatmapCheckpoint(const std::string& path, MotionHeatmap* heatmap) {
+    // Lecture seule : pas de fichier créé pour une caméra inconnue
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    DetectorCheckpoint checkpoint;
+    std::vector<uint8_t> state;
+    return checkpoint.Open(path) &&
+           checkpoint.Read(MotionHeatmapConstants::STATE_VERSION, &state) &&
+           heatmap->RestoreState(state);
+}
+
+FrameProcessorStats FrameProcessor::GetStats() const {
+    return stats_.Snapshot();
+}
+
 int64_t FrameProcessor::GetTotalFramesProcessed() const {
-    return total_frames_processed_.load();
+    return stats_.Snapshot().frames_processed;
 }
 
 int64_t FrameProcessor::GetTotalDetections() const {
-    return total_detections_.load();
+    return stats_.Snapshot().detections;
 }
 
 double FrameProcessor::GetAverageProcessingTime() const {
-    int64_t frames = total_frames_processed_.load();
-    if (frames == 0) return 0.0;
+    // Un seul instantané : numérateur et dénominateur cohérents
+    FrameProcessorStats stats = stats_.Snapshot();
+    if (stats.frames_processed == 0) return 0.0;
     
-    return static_cast<double>(total_processing_time_.load()) / frames;
+    return static_cast<double>(stats.processing_time_ms) / stats.frames_processed;
 }
 
 bool FrameProcessor::ValidateFrame(const Frame& frame) const {
-    if (frame.data.empty()) {
+    if (frame.PixelBytes() == 0) {
         return false;
     }
     
@@ -283,7 +863,7 @@ bool FrameProcessor::ValidateFrame(const Frame& frame) const {
     
     // Vérifier que la taille des données correspond aux dimensions
     size_t expected_size = FrameUtils::CalculateFrameSize(frame.width, frame.height, frame.format);
-    if (expected_size > 0 && frame.data.size() < expected_size * 0.8) {  // Tolérance de 20%
+    if (expected_size > 0 && frame.PixelBytes() < expected_size * 0.8) {  // Tolérance de 20%
         return false;
     }
     
@@ -298,10 +878,18 @@ ProcessingResult FrameProcessor::CreateErrorResult(const std::string& error) con
     return result;
 }
 
-void FrameProcessor::UpdateStatistics(int64_t processing_time, int detections_count) {
-    total_frames_processed_++;
-    total_detections_ += detections_count;
-    total_processing_time_ += processing_time;
+void FrameProcessor::UpdateStatistics(const ProcessingResult& result, int classifications,
+                                      int classifications_skipped) {
+    int64_t detections = static_cast<int64_t>(result.detections.size());
+    stats_.Update([&](FrameProcessorStats& stats) {
+        stats.frames_processed++;
+        stats.detections += detections;
+        stats.processing_time_ms += result.processing_time_ms;
+        stats.classifications += classifications;
+        stats.classifications_skipped += classifications_skipped;
+        stats.illumination_events += result.illumination_change;
+        stats.repeated_frames += result.repeated;
+    });
 }
 
 // =============================================================================
@@ -356,6 +944,147 @@ size_t CalculateFrameSize(int width, int height, const std::string& format) {
     return 0;  // Format inconnu
 }
 
+int BytesPerPixel(const std::string& format) {
+    if (format == "bgr" || format == "rgb") {
+        return 3;
+    } else if (format == "gray") {
+        return 1;
+    }
+    return 0;
+}
+
+Frame CropFrame(const Frame& frame, const FrameRegion& region) {
+    int bytes_per_pixel = BytesPerPixel(frame.format);
+    size_t expected_size = static_cast<size_t>(frame.width) * frame.height * bytes_per_pixel;
+    
+    // Formats compressés ou données incomplètes : pas de recadrage possible
+    if (region.IsEmpty() || bytes_per_pixel == 0 || frame.PixelBytes() < expected_size) {
+        return frame;
+    }
+    
+    int x0 = std::clamp(region.x, 0, frame.width);
+    int y0 = std::clamp(region.y, 0, frame.height);
+    int x1 = std::clamp(region.x + region.width, x0, frame.width);
+    int y1 = std::clamp(region.y + region.height, y0, frame.height);
+    if (x0 == 0 && y0 == 0 && x1 == frame.width && y1 == frame.height) {
+        return frame;
+    }
+    
+    Frame cropped(x1 - x0, y1 - y0, frame.format);
+    cropped.timestamp = frame.timestamp;
+    cropped.offset_x = frame.offset_x + x0;
+    cropped.offset_y = frame.offset_y + y0;
+    
+    size_t src_stride = static_cast<size_t>(frame.width) * bytes_per_pixel;
+    size_t row_bytes = static_cast<size_t>(cropped.width) * bytes_per_pixel;
+    cropped.data.resize(row_bytes * cropped.height);
+    
+    const uint8_t* src = frame.Pixels() + y0 * src_stride + static_cast<size_t>(x0) * bytes_per_pixel;
+    uint8_t* dst = cropped.data.data();
+    for (int y = 0; y < cropped.height; ++y) {
+        std::copy(src, src + row_bytes, dst);
+        src += src_stride;
+        dst += row_bytes;
+    }
+    
+    return cropped;
+}
+
+Frame ResizeRegion(const Frame& frame, const FrameRegion& region, int width, int height) {
+    int bytes_per_pixel = BytesPerPixel(frame.format);
+    size_t expected_size = static_cast<size_t>(frame.width) * frame.height * bytes_per_pixel;
+    if (region.IsEmpty() || width <= 0 || height <= 0 || bytes_per_pixel == 0 ||
+        frame.PixelBytes() < expected_size) {
+        return Frame();
+    }
+    
+    int x0 = std::clamp(region.x, 0, frame.width - 1);
+    int y0 = std::clamp(region.y, 0, frame.height - 1);
+    int x1 = std::clamp(region.x + region.width, x0 + 1, frame.width);
+    int y1 = std::clamp(region.y + region.height, y0 + 1, frame.height);
+    
+    Frame resized(width, height, frame.format);
+    resized.timestamp = frame.timestamp;
+    resized.offset_x = frame.offset_x + x0;
+    resized.offset_y = frame.offset_y + y0;
+    resized.data.resize(static_cast<size_t>(width) * height * bytes_per_pixel);
+    
+    // Centres des pixels alignés ; coordonnées source bornées à la région
+    const uint8_t* src = frame.Pixels();
+    size_t stride = static_cast<size_t>(frame.width) * bytes_per_pixel;
+    float scale_x = static_cast<float>(x1 - x0) / width;
+    float scale_y = static_cast<float>(y1 - y0) / height;
+    uint8_t* dst = resized.data.data();
+    for (int y = 0; y < height; ++y) {
+        float sy = std::clamp(y0 + (y + 0.5f) * scale_y - 0.5f, static_cast<float>(y0), static_cast<float>(y1 - 1));
+        int top = static_cast<int>(sy);
+        int bottom = std::min(top + 1, y1 - 1);
+        float fy = sy - top;
+        const uint8_t* top_row = src + top * stride;
+        const uint8_t* bottom_row = src + bottom * stride;
+        for (int x = 0; x < width; ++x) {
+            float sx = std::clamp(x0 + (x + 0.5f) * scale_x - 0.5f, static_cast<float>(x0), static_cast<float>(x1 - 1));
+            int left = static_cast<int>(sx);
+            int right = std::min(left + 1, x1 - 1);
+            float fx = sx - left;
+            for (int c = 0; c < bytes_per_pixel; ++c) {
+                float a = top_row[left * bytes_per_pixel + c];
+                float b = top_row[right * bytes_per_pixel + c];
+                float d = bottom_row[left * bytes_per_pixel + c];
+                float e = bottom_row[right * bytes_per_pixel + c];
+                float value = (a + (b - a) * fx) * (1.0f - fy) + (d + (e - d) * fx) * fy;
+                *dst++ = static_cast<uint8_t>(value + 0.5f);
+            }
+        }
+    }
+    return resized;
+}
+
+FrameRegion ComputeActiveZonesRegion(
+    const google::protobuf::RepeatedPtrField<DetectionZone>& zones,
+    int frame_width, int frame_height, int margin) {
+    int min_x = frame_width, min_y = frame_height;
+    int max_x = 0, max_y = 0;
+    bool has_points = false;
+    
+    for (const auto& zone : zones) {
+        if (!zone.active()) {
+            continue;
+        }
+        for (const auto& point : zone.points()) {
+            min_x = std::min(min_x, point.x());
+            min_y = std::min(min_y, point.y());
+            max_x = std::max(max_x, point.x());
+            max_y = std::max(max_y, point.y());
+            has_points = true;
+        }
+    }
+    
+    if (!has_points) {
+        return FrameRegion();
+    }
+    
+    int x0 = std::clamp(min_x - margin, 0, frame_width);
+    int y0 = std::clamp(min_y - margin, 0, frame_height);
+    int x1 = std::clamp(max_x + margin + 1, x0, frame_width);
+    int y1 = std::clamp(max_y + margin + 1, y0, frame_height);
+    
+    // Garder une région analysable par les détecteurs
+    if (x1 - x0 < MIN_FRAME_WIDTH) {
+        x0 = std::max(0, std::min(x0, frame_width - MIN_FRAME_WIDTH));
+        x1 = std::min(frame_width, x0 + MIN_FRAME_WIDTH);
+    }
+    if (y1 - y0 < MIN_FRAME_HEIGHT) {
+        y0 = std::max(0, std::min(y0, frame_height - MIN_FRAME_HEIGHT));
+        y1 = std::min(frame_height, y0 + MIN_FRAME_HEIGHT);
+    }
+    
+    if (x0 == 0 && y0 == 0 && x1 == frame_width && y1 == frame_height) {
+        return FrameRegion();
+    }
+    return FrameRegion(x0, y0, x1 - x0, y1 - y0);
+}
+
 Frame CreateTestFrame(int width, int height, const std::string& format) {
     Frame frame(width, height, format);
     
@@ -13,9 +13,29 @@
 #endif
 
 #include "vision.pb.h"
+#include "stats_block.h"
+#include "detector_checkpoint.h"
+#include "motion_heatmap.h"
+#include "camera_health.h"
+#include "optical_flow.h"
+#include "frame_features.h"
 
 using surveillance::vision::Detection;
 using surveillance::vision::BoundingBox;
+using surveillance::vision::DetectionZone;
+
+// Région rectangulaire d'une frame (vide = frame entière)
+struct FrameRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    
+    FrameRegion() = default;
+    FrameRegion(int x_, int y_, int w, int h) : x(x_), y(y_), width(w), height(h) {}
+    
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+};
 
 // Structure pour une frame interne
 struct Frame {
@@ -25,9 +45,24 @@ struct Frame {
     std::string format;
     std::chrono::steady_clock::time_point timestamp;
     
-    Frame() : width(0), height(0), format("unknown") {}
+    // Position dans la frame source quand la frame est un recadrage (ROI)
+    int offset_x;
+    int offset_y;
+    
+    // Pixels empruntés à l'appelant (API C), prioritaires sur data : ni
+    // copiés ni possédés, la frame ne doit pas survivre à leur tampon
+    const uint8_t* external_data;
+    size_t external_size;
+    
+    Frame() : width(0), height(0), format("unknown"), offset_x(0), offset_y(0),
+              external_data(nullptr), external_size(0) {}
     Frame(int w, int h, const std::string& fmt) 
-        : width(w), height(h), format(fmt), timestamp(std::chrono::steady_clock::now()) {}
+        : width(w), height(h), format(fmt), timestamp(std::chrono::steady_clock::now()),
+          offset_x(0), offset_y(0), external_data(nullptr), external_size(0) {}
+    
+    // Lecture des pixels, qu'ils soient possédés ou empruntés
+    const uint8_t* Pixels() const { return external_data ? external_data : data.data(); }
+    size_t PixelBytes() const { return external_data ? external_size : data.size(); }
 };
 
 // Résultat du traitement d'une frame
@@ -35,9 +70,24 @@ struct ProcessingResult {
     std::vector<Detection> detections;
     int64_t processing_time_ms;
     bool success;
+    bool skipped;  // frame non analysée (caméra dégradée) : detections n'en dit rien
+    bool illumination_change;  // début d'un changement d'éclairage sur cette frame
+    bool repeated;             // identique à la précédente : détections déjà vues
     std::string error_message;
     
-    ProcessingResult() : processing_time_ms(0), success(true) {}
+    ProcessingResult()
+        : processing_time_ms(0), success(true), skipped(false), illumination_change(false), repeated(false) {}
+};
+
+// Statistiques cumulées d'un FrameProcessor
+struct FrameProcessorStats {
+    int64_t frames_processed = 0;
+    int64_t detections = 0;
+    int64_t processing_time_ms = 0;
+    int64_t classifications = 0;          // régions passées au second étage
+    int64_t classifications_skipped = 0;  // régions au-delà du budget
+    int64_t illumination_events = 0;      // changements d'éclairage compensés
+    int64_t repeated_frames = 0;          // frames identiques à la précédente
 };
 
 // Interface pour les détecteurs
@@ -48,9 +98,42 @@ public:
     virtual std::string GetName() const = 0;
     virtual bool Initialize() = 0;
     virtual void Cleanup() = 0;
+    
+    // État appris (modèle de fond, bruit, suivi) conservé entre deux
+    // démarrages ; vide pour un détecteur sans état
+    virtual std::vector<uint8_t> SaveState() const { return {}; }
+    virtual bool RestoreState(const std::vector<uint8_t>& /*state*/) { return false; }
+    
+    // Second étage de la cascade : détections de chaque imagette, en
+    // coordonnées de l'imagette. Par défaut, Detect sur chacune ; un
+    // détecteur qui gagne à traiter un lot (réseau) la redéfinit.
+    virtual std::vector<std::vector<Detection>> DetectBatch(const std::vector<Frame>& crops);
+    
+    // Taille des imagettes attendue en second étage ; 0 : taille de la région
+    virtual int GetInputWidth() const { return 0; }
+    virtual int GetInputHeight() const { return 0; }
 };
 
-// Détecteur de mouvement basique (pour Phase 2.1 - simulation)
+// Détecteur de mouvement par soustraction de fond : la luminance moyenne
+// de chaque bloc est comparée à un fond appris (moyenne glissante) et à
+// son bruit (écart absolu moyen glissant). Les blocs qui s'en écartent
+// sont regroupés en détections ; un objet immobile finit absorbé par le
+// fond. Pas de détection pendant l'apprentissage initial.
+//
+// Avant la comparaison, un gain et un décalage globaux entre le fond et la
+// frame sont estimés sur la grille des blocs (moindres carrés itérés sur
+// les blocs dont le résidu est proche du médian, les objets en mouvement
+// étant écartés) : un éclairage qui s'allume ou un nuage ne déclenche pas
+// de mouvement. Un changement qui touche encore la majorité des blocs une
+// fois compensé est traité comme un événement d'éclairage : pas de
+// détection et le fond repart de la frame courante.
+//
+// Chaque détection reçoit dans ses métadonnées la direction et la vitesse
+// de l'objet (flot optique limité à sa boîte, voir SparseOpticalFlow).
+//
+// Une frame identique à la précédente (source figée ou qui double ses
+// frames) est analysée comme les autres mais comptée à part, et n'entre
+// pas dans la carte d'activité : elle ne montre aucune activité nouvelle.
 class BasicMotionDetector : public Detector {
 public:
     BasicMotionDetector();
@@ -61,17 +144,75 @@ public:
     bool Initialize() override;
     void Cleanup() override;
     
+    std::vector<uint8_t> SaveState() const override;
+    bool RestoreState(const std::vector<uint8_t>& state) override;
+    
+    bool IsLearning() const;
+    
+    // Écart minimal d'un bloc au fond, en part de la pleine échelle (0-1),
+    // et surface minimale d'une détection, en pixels
+    void SetMotionThreshold(double threshold);
+    void SetMinArea(int area);
+    
+    // Carte d'activité alimentée par le masque des blocs (non possédée)
+    void SetHeatmap(MotionHeatmap* heatmap);
+    
+    // Statistiques d'image calculées pendant l'extraction des
+    // caractéristiques de la frame, transmises au moniteur (non possédé)
+    void SetHealthMonitor(CameraHealthMonitor* monitor);
+    
+    // Caractéristiques de la dernière frame analysée
+    const FrameFeatures& GetFrameFeatures() const { return features_.GetFeatures(); }
+    
+    // Compensation de la dernière frame (luminance ≈ gain × fond + décalage)
+    // et changements d'éclairage détectés depuis l'initialisation
+    float GetIlluminationGain() const { return illumination_gain_; }
+    float GetIlluminationOffset() const { return illumination_offset_; }
+    uint64_t GetIlluminationEvents() const { return illumination_events_; }
+    
+    // Frames identiques à la précédente après l'apprentissage, depuis
+    // l'initialisation
+    uint64_t GetRepeatedFrames() const { return repeated_frames_; }
+    
 private:
     bool initialized_;
-    Frame previous_frame_;
     std::atomic<int> detection_counter_;
+    MotionHeatmap* heatmap_;
+    CameraHealthMonitor* health_monitor_;
+    FrameFeatureExtractor features_;  // un seul parcours de la frame
+    SparseOpticalFlow optical_flow_;
     
     // Paramètres de détection
     double motion_threshold_;
     int min_area_;
     
+    // Modèle de fond, un élément par bloc (ligne par ligne)
+    int grid_width_;
+    int grid_height_;
+    uint64_t frames_seen_;
+    uint64_t repeated_frames_;
+    std::vector<float> background_;
+    std::vector<float> noise_;
+    std::vector<uint16_t> foreground_age_;  // frames consécutives au premier plan
+    
+    // Compensation de l'éclairage
+    float illumination_gain_;
+    float illumination_offset_;
+    uint64_t illumination_events_;
+    bool illumination_change_;  // événement en cours, compté une fois
+    
+    // Tampons réutilisés d'une frame à l'autre
+    std::vector<float> luma_;
+    std::vector<float> difference_;  // écart compensé au fond, par bloc
+    std::vector<uint8_t> mask_;
+    std::vector<int> component_stack_;
+    
     // Méthodes privées
-    bool HasSignificantChange(const Frame& current, const Frame& previous) const;
+    bool ExtractFeatures(const Frame& frame);
+    void ResetModel(int grid_width, int grid_height);
+    void EstimateIllumination();
+    void UpdateModel(bool learning);  // apprentissage : tout est fond
+    std::vector<Detection> ExtractDetections(const Frame& frame);
     Detection CreateMotionDetection(int x, int y, int width, int height, float confidence) const;
     std::string GenerateDetectionId() const;
 };
@@ -96,34 +237,86 @@ public:
     void RemoveDetector(const std::string& detector_name);
     std::vector<std::string> GetDetectorNames() const;
     
-    // Configuration
+    // Configuration, transmise au détecteur de mouvement
     void SetMotionThreshold(double threshold);
     void SetMinDetectionArea(int area);
     void SetMaxDetectionsPerFrame(int max_detections);
     
-    // Statistiques
+    // Cascade : le classifieur ne voit que les régions des détections des
+    // autres détecteurs (mouvement), élargies et redimensionnées à sa taille
+    // d'entrée, en un lot par frame. Au plus budget régions par frame, les
+    // plus grandes d'abord ; une région reconnue prend la classe, la
+    // confiance et la boîte du classifieur, les autres restent "motion".
+    void SetClassifier(std::unique_ptr<Detector> classifier);
+    void SetClassificationBudget(int max_per_frame);
+    
+    // Checkpoints de l'état des détecteurs : restaure l'état du fichier s'il
+    // a été écrit avec la même configuration (retourne true), puis le
+    // réécrit depuis ProcessFrame toutes les interval et au Cleanup
+    bool EnableCheckpoint(const std::string& path, uint64_t config_hash,
+                          std::chrono::milliseconds interval);
+    bool SaveCheckpoint();
+    bool IsCheckpointEnabled() const;
+    
+    // Carte d'activité du détecteur de mouvement, lisible depuis n'importe
+    // quel thread. Avec un fichier, elle est restaurée puis réécrite toutes
+    // les interval et au Cleanup ; elle survit aux changements de réglages.
+    MotionHeatmap* GetHeatmap() const;
+    
+    // État de l'image de la caméra ; tant qu'il est dégradé, ProcessFrame
+    // n'analyse qu'une frame sur THROTTLE_INTERVAL et renvoie un résultat
+    // vide marqué skipped pour les autres
+    CameraHealthMonitor* GetHealthMonitor() const;
+    bool EnableHeatmapCheckpoint(const std::string& path, std::chrono::milliseconds interval);
+    bool SaveHeatmapCheckpoint();
+    static bool LoadHeatmapCheckpoint(const std::string& path, MotionHeatmap* heatmap);
+    
+    // Statistiques (instantané cohérent, lisible depuis n'importe quel thread)
+    FrameProcessorStats GetStats() const;
     int64_t GetTotalFramesProcessed() const;
     int64_t GetTotalDetections() const;
     double GetAverageProcessingTime() const;
     
 private:
+    // Déclarée avant les détecteurs qui l'alimentent
+    std::unique_ptr<MotionHeatmap> heatmap_;
+    std::unique_ptr<CameraHealthMonitor> health_monitor_;
     std::vector<std::unique_ptr<Detector>> detectors_;
+    std::unique_ptr<Detector> classifier_;
+    BasicMotionDetector* motion_detector_;  // détecteur par défaut, possédé par detectors_
+    uint64_t illumination_events_;          // compteurs du détecteur déjà pris en compte
+    uint64_t repeated_frames_;
     bool initialized_;
     
-    // Statistiques
-    std::atomic<int64_t> total_frames_processed_{0};
-    std::atomic<int64_t> total_detections_{0};
-    std::atomic<int64_t> total_processing_time_{0};
+    // Statistiques : écrites par le thread qui appelle ProcessFrame
+    StatsBlock<FrameProcessorStats> stats_;
     
     // Configuration
     double motion_threshold_;
     int min_detection_area_;
     int max_detections_per_frame_;
+    uint64_t throttled_frames_;
+    int classification_budget_;
+    
+    // Tampons de la cascade, réutilisés d'une frame à l'autre
+    std::vector<size_t> classification_order_;
+    std::vector<FrameRegion> classification_regions_;
+    std::vector<Frame> classification_crops_;
+    
+    // Checkpoints (thread qui appelle ProcessFrame)
+    std::unique_ptr<DetectorCheckpoint> checkpoint_;
+    uint64_t checkpoint_config_hash_;
+    std::chrono::milliseconds checkpoint_interval_;
+    std::chrono::steady_clock::time_point last_checkpoint_;
+    std::unique_ptr<DetectorCheckpoint> heatmap_checkpoint_;
+    std::chrono::milliseconds heatmap_interval_;
+    std::chrono::steady_clock::time_point last_heatmap_checkpoint_;
     
     // Méthodes privées
     bool ValidateFrame(const Frame& frame) const;
     ProcessingResult CreateErrorResult(const std::string& error) const;
-    void UpdateStatistics(int64_t processing_time, int detections_count);
+    void UpdateStatistics(const ProcessingResult& result, int classifications, int classifications_skipped);
+    int ClassifyRegions(const Frame& frame, std::vector<Detection>* detections);
     
 #ifdef HAVE_OPENCV
     cv::Mat ConvertToMat(const Frame& frame) const;
@@ -145,6 +338,20 @@ namespace FrameUtils {
     
     // Calcul de la taille d'une frame
     size_t CalculateFrameSize(int width, int height, const std::string& format);
+    int BytesPerPixel(const std::string& format);  // 0 pour les formats compressés
+    
+    // Recadrage : ne copie que les lignes de la région, cumule les offsets
+    Frame CropFrame(const Frame& frame, const FrameRegion& region);
+    
+    // Région redimensionnée (bilinéaire) à width × height, même format ;
+    // frame vide pour un format compressé
+    Frame ResizeRegion(const Frame& frame, const FrameRegion& region, int width, int height);
+    
+    // Rectangle englobant les zones actives plus une marge, borné à la
+    // frame ; vide si aucune zone active ou si la frame entière est couverte
+    FrameRegion ComputeActiveZonesRegion(
+        const google::protobuf::RepeatedPtrField<DetectionZone>& zones,
+        int frame_width, int frame_height, int margin);
     
     // Création de frames de test
     Frame CreateTestFrame(int width = 640, int height = 480, 
@@ -163,6 +370,30 @@ namespace FrameProcessorConstants {
     constexpr int MAX_FRAME_HEIGHT = 4096;
     constexpr int MIN_FRAME_WIDTH = 32;
     constexpr int MIN_FRAME_HEIGHT = 32;
+    constexpr int ZONE_REGION_MARGIN = 16;  // pixels autour des zones actives
+    
+    // Cascade
+    constexpr int DEFAULT_CLASSIFICATION_BUDGET = 4;  // régions classées par frame
+    constexpr float CLASSIFICATION_MARGIN = 0.15f;    // élargissement de chaque côté
+    
+    // Modèle de fond
+    constexpr int MOTION_BLOCK_SIZE = 16;         // pixels par côté de bloc
+    constexpr float BACKGROUND_LEARNING_RATE = 0.05f;
+    constexpr float INITIAL_NOISE = 4.0f;         // niveaux de luminance
+    constexpr float NOISE_FACTOR = 4.0f;          // écart significatif, en bruits
+    constexpr uint64_t LEARNING_FRAMES = 25;      // apprentissage initial
+    constexpr uint16_t ABSORB_FRAMES = 500;       // objet immobile intégré au fond
+    
+    // Compensation de l'éclairage
+    constexpr size_t MIN_ILLUMINATION_BLOCKS = 16;     // en dessous : pas d'estimation
+    constexpr int ILLUMINATION_FIT_PASSES = 3;
+    constexpr float ILLUMINATION_RESIDUAL_FACTOR = 2.5f;  // inliers : résidu < facteur × médian
+    constexpr float ILLUMINATION_MIN_RESIDUAL = 2.0f;     // niveaux de luminance
+    constexpr float MIN_ILLUMINATION_VARIANCE = 4.0f;     // fond plus uniforme : décalage seul
+    constexpr float MIN_ILLUMINATION_GAIN = 0.25f;
+    constexpr float MAX_ILLUMINATION_GAIN = 4.0f;
+    constexpr float ILLUMINATION_EVENT_FRACTION = 0.25f;  // blocs expliqués par la compensation
+    constexpr float GLOBAL_CHANGE_FRACTION = 0.5f;        // blocs encore en mouvement après
     
     // Formats supportés
     const std::vector<std::string> SUPPORTED_FORMATS = {
@@ -0,0 +1,304 @@
+// src/frame_session.cpp
+#include "frame_session.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace FrameSessionConstants;
+
+FrameSession::FrameSession(WorkerPool* worker_pool, ResponseSink sink,
+                           const FlowControlConfig& flow_control)
+    : worker_pool_(worker_pool), sink_(std::move(sink)), flow_control_(flow_control),
+      in_flight_(0), active_lanes_(0) {
+    flow_control_.credits_per_camera = std::max(1, flow_control_.credits_per_camera);
+    flow_control_.max_cameras = std::max(1, flow_control_.max_cameras);
+}
+
+FrameSession::~FrameSession() {
+    Drain();
+}
+
+SubmitResult FrameSession::Submit(FrameRequest&& request) {
+    CameraLane* lane = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        lane = GetOrCreateLane(request.camera_id());
+        if (!lane) {
+            return SubmitResult::REJECTED;
+        }
+        if (request.has_capabilities()) {
+            NegotiateIngest(lane, request);
+        }
+    }
+
+    // Décodage hors verrou : la référence n'est utilisée que par ce thread
+    std::string decode_error;
+    DecodeIngest(lane, &request, &decode_error);
+
+    bool needs_schedule = false;
+    SubmitResult result = SubmitResult::ACCEPTED;
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+
+        // Numéro de séquence attribué par le serveur si le client n'en fournit pas
+        if (request.sequence() <= 0) {
+            request.set_sequence(lane->next_sequence);
+        }
+        lane->next_sequence = request.sequence() + 1;
+        frames_submitted_++;
+
+        if (lane->outstanding >= flow_control_.credits_per_camera) {
+            lane->frames_shed++;
+            frames_shed_++;
+            result = SubmitResult::SHED;
+
+            if (lane->pending.empty()) {
+                // Tout le budget est en traitement ou en écriture : on garde
+                // ce qui est en cours et on abandonne la frame reçue
+                return result;
+            }
+
+            // Sous-échantillonnage temporel : la frame la plus ancienne en
+            // attente cède sa place à la plus récente
+            lane->pending.pop_front();
+            lane->outstanding--;
+            in_flight_--;
+        }
+
+        lane->pending.push_back(PendingFrame{std::move(request), std::move(decode_error)});
+        lane->outstanding++;
+        in_flight_++;
+
+        if (!lane->scheduled) {
+            lane->scheduled = true;
+            active_lanes_++;
+            needs_schedule = true;
+        }
+    }
+
+    if (needs_schedule) {
+        ScheduleLane(lane);
+    }
+    return result;
+}
+
+void FrameSession::Acknowledge(const std::string& camera_id) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    auto it = lanes_.find(camera_id);
+    if (it != lanes_.end() && it->second->outstanding > 0) {
+        it->second->outstanding--;
+    }
+}
+
+void FrameSession::Drain() {
+    std::unique_lock<std::mutex> lock(lanes_mutex_);
+    // Attendre aussi la sortie des tâches : elles référencent la session
+    drained_condition_.wait(lock, [this]() { return in_flight_ == 0 && active_lanes_ == 0; });
+}
+
+int FrameSession::GetCredits(const std::string& camera_id) const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    auto it = lanes_.find(camera_id);
+    if (it == lanes_.end()) {
+        return flow_control_.credits_per_camera;
+    }
+    return std::max(0, flow_control_.credits_per_camera - it->second->outstanding);
+}
+
+bool FrameSession::GetIngestFormat(const std::string& camera_id, IngestFormat* format) const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    auto it = lanes_.find(camera_id);
+    if (it == lanes_.end() || !it->second->has_ingest_format) {
+        return false;
+    }
+    *format = it->second->ingest_format;
+    return true;
+}
+
+const FlowControlConfig& FrameSession::GetFlowControlConfig() const {
+    return flow_control_;
+}
+
+size_t FrameSession::GetCameraCount() const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    return lanes_.size();
+}
+
+int64_t FrameSession::GetFramesSubmitted() const {
+    return frames_submitted_.load();
+}
+
+int64_t FrameSession::GetFramesCompleted() const {
+    return frames_completed_.load();
+}
+
+int64_t FrameSession::GetFramesShed() const {
+    return frames_shed_.load();
+}
+
+FrameSession::CameraLane* FrameSession::GetOrCreateLane(const std::string& camera_id) {
+    auto it = lanes_.find(camera_id);
+    if (it != lanes_.end()) {
+        return it->second.get();
+    }
+
+    if (lanes_.size() >= static_cast<size_t>(flow_control_.max_cameras)) {
+        return nullptr;
+    }
+
+    auto lane = std::make_unique<CameraLane>();
+    lane->camera_id = camera_id;
+    lane->processor.Initialize();
+
+    CameraLane* raw = lane.get();
+    lanes_[camera_id] = std::move(lane);
+    return raw;
+}
+
+void FrameSession::NegotiateIngest(CameraLane* lane, const FrameRequest& request) {
+    // Résolution source : la frame annonçant les capacités peut déjà être réduite
+    const auto& metadata = request.metadata();
+    int downscale = std::max(1, metadata.downscale());
+    IngestFormat format = IngestCodec::ChooseIngestFormat(
+        request.capabilities(), metadata.width() * downscale, metadata.height() * downscale,
+        metadata.format().empty() ? DEFAULT_FRAME_FORMAT : metadata.format());
+
+    if (!lane->has_ingest_format ||
+        format.SerializeAsString() != lane->ingest_format.SerializeAsString()) {
+        lane->ingest_format = std::move(format);
+        lane->has_ingest_format = true;
+        lane->announce_ingest_format = true;
+    }
+}
+
+void FrameSession::DecodeIngest(CameraLane* lane, FrameRequest* request, std::string* error) {
+    auto* metadata = request->mutable_metadata();
+    const std::string& encoding = metadata->encoding();
+
+    if (encoding.empty() || encoding == IngestCodecConstants::ENCODING_RAW) {
+        // Frame complète : nouvelle référence si le client travaille en delta
+        if (lane->has_ingest_format &&
+            IngestCodec::IsDeltaEncoding(lane->ingest_format.encoding())) {
+            lane->reference.assign(request->frame_data().begin(), request->frame_data().end());
+        }
+        return;
+    }
+
+    if (!IngestCodec::IsDeltaEncoding(encoding)) {
+        *error = "Unsupported frame encoding: " + encoding;
+        return;
+    }
+
+    std::vector<uint8_t> decoded;
+    if (!IngestCodec::DecodeXorRle(request->frame_data(), lane->reference, &decoded, error)) {
+        // Chaîne rompue : le client doit renvoyer une frame complète
+        lane->reference.clear();
+        return;
+    }
+
+    request->set_frame_data(decoded.data(), decoded.size());
+    metadata->set_encoding(IngestCodecConstants::ENCODING_RAW);
+    lane->reference.swap(decoded);
+}
+
+void FrameSession::ScheduleLane(CameraLane* lane) {
+    if (worker_pool_ && worker_pool_->Post([this, lane]() { RunLane(lane); })) {
+        return;
+    }
+
+    // Pool indisponible (arrêt en cours) : traitement dans le thread appelant
+    RunLane(lane);
+}
+
+void FrameSession::RunLane(CameraLane* lane) {
+    for (int processed = 0; ; ++processed) {
+        PendingFrame pending;
+        {
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            if (lane->pending.empty()) {
+                lane->scheduled = false;
+                active_lanes_--;
+                drained_condition_.notify_all();
+                return;
+            }
+
+            // Céder le worker aux autres caméras ; la lane reste "scheduled"
+            // donc aucun autre worker ne la prend entre-temps
+            if (processed >= LANE_FRAMES_PER_TASK) {
+                break;
+            }
+
+            pending = std::move(lane->pending.front());
+            lane->pending.pop_front();
+        }
+
+        FrameResponse response = ProcessRequest(lane, pending);
+        FillFlowControl(lane, &response);
+        sink_(std::move(response));
+        frames_completed_++;
+
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        in_flight_--;
+    }
+
+    ScheduleLane(lane);
+}
+
+FrameResponse FrameSession::ProcessRequest(CameraLane* lane, const PendingFrame& pending) {
+    const FrameRequest& request = pending.request;
+    FrameResponse response;
+    response.set_camera_id(request.camera_id());
+    response.set_timestamp(request.timestamp());
+    response.set_sequence(request.sequence());
+
+    if (!pending.decode_error.empty()) {
+        response.set_error_message(pending.decode_error);
+        return response;
+    }
+
+    const auto& metadata = request.metadata();
+    Frame frame(metadata.width(), metadata.height(),
+                metadata.format().empty() ? DEFAULT_FRAME_FORMAT : metadata.format());
+    frame.data.assign(request.frame_data().begin(), request.frame_data().end());
+
+    ProcessingResult result = lane->processor.ProcessFrame(frame);
+
+    // Détections ramenées dans le repère de la résolution source
+    int downscale = std::max(1, metadata.downscale());
+    for (auto& detection : result.detections) {
+        if (downscale > 1) {
+            auto* bbox = detection.mutable_bbox();
+            bbox->set_x(bbox->x() * downscale);
+            bbox->set_y(bbox->y() * downscale);
+            bbox->set_width(bbox->width() * downscale);
+            bbox->set_height(bbox->height() * downscale);
+        }
+        *response.add_detections() = std::move(detection);
+    }
+    if (!result.success) {
+        response.set_error_message(result.error_message);
+    }
+
+    auto* stats = response.mutable_processing_stats();
+    stats->set_processing_time_ms(result.processing_time_ms);
+    stats->set_detections_count(static_cast<int32_t>(result.detections.size()));
+
+    return response;
+}
+
+void FrameSession::FillFlowControl(CameraLane* lane, FrameResponse* response) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+
+    // Le crédit de cette réponse est rendu dès qu'elle est écrite : il est
+    // déjà compté comme disponible du point de vue du client qui la reçoit
+    int credits = flow_control_.credits_per_camera - lane->outstanding + 1;
+
+    auto* flow = response->mutable_flow_control();
+    flow->set_credits(std::clamp(credits, 0, flow_control_.credits_per_camera));
+    flow->set_window(flow_control_.credits_per_camera);
+    flow->set_frames_shed(lane->frames_shed);
+
+    if (lane->announce_ingest_format) {
+        *response->mutable_ingest_format() = lane->ingest_format;
+        lane->announce_ingest_format = false;
+    }
+}
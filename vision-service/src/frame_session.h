@@ -0,0 +1,186 @@
+// src/frame_session.h
+#ifndef FRAME_SESSION_H
+#define FRAME_SESSION_H
+
+#include <string>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include "vision.pb.h"
+#include "frame_processor.h"
+#include "worker_pool.h"
+#include "ingest_codec.h"
+
+using surveillance::vision::FrameRequest;
+using surveillance::vision::FrameResponse;
+
+// File de réponses entre les workers et le thread d'écriture gRPC
+// (ServerReaderWriter::Write ne supporte pas les appels concurrents)
+template <typename T>
+class ResponseQueue {
+public:
+    // false si la file est fermée (client parti) : la réponse est abandonnée
+    bool Push(T&& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            items_.push_back(std::move(item));
+        }
+        condition_.notify_one();
+        return true;
+    }
+
+    // Bloque jusqu'à au moins un élément ; récupère tout ce qui est prêt.
+    // false quand la file est fermée et vide.
+    bool PopAll(std::deque<T>* out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        out->swap(items_);
+        items_.clear();
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        condition_.notify_all();
+    }
+
+private:
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool closed_ = false;
+};
+
+// Contrôle de flux par crédits d'une session
+struct FlowControlConfig {
+    int credits_per_camera = 8;    // frames acceptées et pas encore renvoyées
+    int max_cameras = 64;          // caméras distinctes par session
+
+    FlowControlConfig() = default;
+    FlowControlConfig(int credits, int cameras)
+        : credits_per_camera(credits), max_cameras(cameras) {}
+};
+
+// Issue d'une soumission de frame
+enum class SubmitResult {
+    ACCEPTED,
+    SHED,       // budget dépassé : la frame la plus ancienne (ou celle-ci) est abandonnée
+    REJECTED    // trop de caméras dans la session
+};
+
+// Session de traitement multiplexée pour un stream ProcessFrames.
+// Chaque caméra a sa propre file ("lane") traitée par au plus un worker à
+// la fois : l'ordre est préservé par caméra, les caméras différentes sont
+// traitées en parallèle et leurs réponses arrivent dans le désordre.
+//
+// Chaque frame acceptée consomme un crédit de sa caméra jusqu'à
+// Acknowledge() (réponse écrite au client). Au-delà du budget la session
+// abandonne les frames les plus anciennes : la mémoire reste bornée à
+// max_cameras * credits_per_camera frames quel que soit le client.
+//
+// Une requête portant des IngestCapabilities déclenche la négociation du
+// format d'ingestion de sa caméra ; le format retenu est renvoyé dans la
+// réponse suivante. Les frames delta sont décodées dès Submit(), avant
+// tout abandon, pour que la chaîne de références reste intacte.
+class FrameSession {
+public:
+    // Appelé depuis les workers, dans l'ordre des séquences pour une caméra
+    using ResponseSink = std::function<void(FrameResponse&& response)>;
+
+    FrameSession(WorkerPool* worker_pool, ResponseSink sink,
+                 const FlowControlConfig& flow_control = FlowControlConfig());
+    ~FrameSession();
+
+    FrameSession(const FrameSession&) = delete;
+    FrameSession& operator=(const FrameSession&) = delete;
+
+    // Prend possession du contenu de la requête (frame_data n'est pas copié).
+    // Appelé depuis un seul thread (le lecteur du stream).
+    SubmitResult Submit(FrameRequest&& request);
+
+    // La réponse d'une frame de cette caméra a été remise : rend un crédit
+    void Acknowledge(const std::string& camera_id);
+
+    // Attend que toutes les frames soumises aient été traitées
+    void Drain();
+
+    // Crédits disponibles pour une caméra (budget complet si inconnue)
+    int GetCredits(const std::string& camera_id) const;
+
+    // Format d'ingestion négocié (false si la caméra n'a rien annoncé)
+    bool GetIngestFormat(const std::string& camera_id, IngestFormat* format) const;
+    const FlowControlConfig& GetFlowControlConfig() const;
+
+    // Statistiques
+    size_t GetCameraCount() const;
+    int64_t GetFramesSubmitted() const;
+    int64_t GetFramesCompleted() const;
+    int64_t GetFramesShed() const;
+
+private:
+    struct PendingFrame {
+        FrameRequest request;
+        std::string decode_error;      // frame non décodable : réponse d'erreur
+    };
+
+    struct CameraLane {
+        std::string camera_id;
+        std::deque<PendingFrame> pending;
+        bool scheduled = false;
+        int64_t next_sequence = 1;
+        int outstanding = 0;           // acceptées, réponse pas encore remise
+        int64_t frames_shed = 0;
+        FrameProcessor processor;
+
+        // Négociation du format d'ingestion
+        bool has_ingest_format = false;
+        bool announce_ingest_format = false;
+        IngestFormat ingest_format;
+        std::vector<uint8_t> reference;  // dernière frame décodée (thread lecteur)
+    };
+
+    WorkerPool* worker_pool_;
+    ResponseSink sink_;
+    FlowControlConfig flow_control_;
+
+    std::unordered_map<std::string, std::unique_ptr<CameraLane>> lanes_;
+    mutable std::mutex lanes_mutex_;
+    std::condition_variable drained_condition_;
+    int64_t in_flight_;
+    int active_lanes_;
+
+    std::atomic<int64_t> frames_submitted_{0};
+    std::atomic<int64_t> frames_completed_{0};
+    std::atomic<int64_t> frames_shed_{0};
+
+    CameraLane* GetOrCreateLane(const std::string& camera_id);
+    void NegotiateIngest(CameraLane* lane, const FrameRequest& request);
+    void DecodeIngest(CameraLane* lane, FrameRequest* request, std::string* error);
+    void ScheduleLane(CameraLane* lane);
+    void RunLane(CameraLane* lane);
+    FrameResponse ProcessRequest(CameraLane* lane, const PendingFrame& pending);
+    void FillFlowControl(CameraLane* lane, FrameResponse* response);
+};
+
+// Constantes
+namespace FrameSessionConstants {
+    // Frames traitées par un worker avant de céder la place aux autres caméras
+    constexpr int LANE_FRAMES_PER_TASK = 8;
+    const std::string DEFAULT_FRAME_FORMAT = "bgr";
+}
+
+#endif // FRAME_SESSION_H
@@ -0,0 +1,433 @@
+// src/hog_detector.cpp
+#include "hog_detector.h"
+#include "detector_checkpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace HogConstants;
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'H', 'O', 'G'};
+// Taille fixe : en-tête, poids, biais, CRC
+constexpr size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint32_t) + 4 * sizeof(uint16_t) + sizeof(uint32_t);
+constexpr size_t FILE_SIZE = HEADER_SIZE + (DESCRIPTOR_SIZE + 1) * sizeof(float) + sizeof(uint32_t);
+constexpr float PI = 3.14159265358979f;
+constexpr int WINDOW_BLOCK_STRIDE = CELL_SIZE / GRID_STEP;  // blocs d'une fenêtre, en pas de grille
+
+int BlockCount(int size) {
+    return size >= CELL_SIZE * BLOCK_CELLS ? (size - CELL_SIZE * BLOCK_CELLS) / GRID_STEP + 1 : 0;
+}
+
+float Overlap(const HogWindow& a, const HogWindow& b) {
+    int width = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+    int height = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+    if (width <= 0 || height <= 0) {
+        return 0.0f;
+    }
+    float intersection = static_cast<float>(width) * height;
+    return intersection / (static_cast<float>(a.width) * a.height + static_cast<float>(b.width) * b.height - intersection);
+}
+
+template <typename T>
+void Append(std::vector<uint8_t>* out, const T& value) {
+    size_t offset = out->size();
+    out->resize(offset + sizeof(T));
+    std::memcpy(out->data() + offset, &value, sizeof(T));
+}
+
+}  // namespace
+
+// =============================================================================
+// HogFeatures
+// =============================================================================
+
+void HogFeatures::Compute(const uint8_t* gray, int width, int height) {
+    width_ = width;
+    height_ = height;
+    blocks_x_ = BlockCount(width);
+    blocks_y_ = BlockCount(height);
+    if (blocks_x_ == 0 || blocks_y_ == 0) {
+        blocks_x_ = blocks_y_ = 0;
+        blocks_.clear();
+        return;
+    }
+
+    // Copie à bords répliqués : gradients centrés partout, sans test
+    size_t stride = static_cast<size_t>(width) + 2;
+    padded_.resize(stride * (height + 2));
+    for (int y = -1; y <= height; ++y) {
+        const uint8_t* source = gray + static_cast<size_t>(std::clamp(y, 0, height - 1)) * width;
+        uint8_t* row = &padded_[(y + 1) * stride];
+        row[0] = source[0];
+        std::memcpy(row + 1, source, width);
+        row[width + 1] = source[width - 1];
+    }
+
+    // Histogramme intégral : seule la première ligne est à zéro, chaque
+    // ligne commence par une colonne nulle
+    squared_magnitude_.resize(width);
+    position_.resize(width);
+    integral_.resize(static_cast<size_t>(ORIENTATIONS) * (height + 1) * (width + 1));
+    std::fill_n(integral_.begin(), static_cast<size_t>(ORIENTATIONS) * (width + 1), 0u);
+    for (int y = 0; y < height; ++y) {
+        AccumulateRow(y);
+    }
+    NormalizeBlocks();
+}
+
+void HogFeatures::AccumulateRow(int y) {
+    size_t stride = static_cast<size_t>(width_) + 2;
+    const uint8_t* up = &padded_[y * stride];
+    const uint8_t* center = up + stride;
+    const uint8_t* down = center + stride;
+
+    // Orientation non signée sans atan2 : (gx, gy) ramené au demi-plan
+    // gy >= 0, puis arctangente polynomiale sur [0, 1] (erreur < 1e-5 rad).
+    // Tout est arithmétique, sans sélection ni sqrt (errno) : le compilateur
+    // vectorise la boucle. Les gradients étant entiers, min et max obtenus
+    // par somme et écart sont exacts ; la racine de la norme est prise au vote
+    for (int x = 0; x < width_; ++x) {
+        float gx = static_cast<float>(center[x + 2]) - static_cast<float>(center[x]);
+        float gy = static_cast<float>(down[x + 1]) - static_cast<float>(up[x + 1]);
+        float sx = std::copysign(1.0f, gy) * gx;
+        float sy = std::fabs(gy);
+        float ax = std::fabs(sx);
+        float spread = std::fabs(ax - sy);
+        float a = (ax + sy - spread) / (ax + sy + spread + 1e-6f);  // min / max
+        float s = a * a;
+        float angle = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+        float steep = static_cast<float>(sy > ax);
+        angle += steep * (0.5f * PI - 2.0f * angle);
+        float backward = static_cast<float>(sx < 0.0f);
+        angle += backward * (PI - 2.0f * angle);
+        squared_magnitude_[x] = gx * gx + gy * gy;
+        position_[x] = angle * (ORIENTATIONS / PI) - 0.5f;
+    }
+
+    // Vote partagé entre les deux orientations voisines, en entiers, cumulé
+    // directement dans la ligne de l'histogramme intégral. Les sommes peuvent
+    // déborder 32 bits sur une grande image, mais les différences lues pour
+    // une cellule restent exactes modulo 2^32
+    size_t row = (static_cast<size_t>(width_) + 1) * ORIENTATIONS;
+    const uint32_t* previous = &integral_[y * row];
+    uint32_t* current = &integral_[(y + 1) * row];
+    std::fill_n(current, ORIENTATIONS, 0u);
+    uint32_t running[ORIENTATIONS] = {};
+    for (int x = 0; x < width_; ++x) {
+        if (squared_magnitude_[x] > 0.0f) {
+            float magnitude = std::sqrt(squared_magnitude_[x]);
+            float position = position_[x];  // dans [-0,5, 8,5]
+            int lower = static_cast<int>(position + 1.0f) - 1;
+            float fraction = position - static_cast<float>(lower);
+            uint32_t total = static_cast<uint32_t>(magnitude * VOTE_SCALE + 0.5f);
+            uint32_t upper_vote = std::min(total, static_cast<uint32_t>(magnitude * fraction * VOTE_SCALE + 0.5f));
+            lower = lower < 0 ? ORIENTATIONS - 1 : lower;
+            int upper = lower + 1 == ORIENTATIONS ? 0 : lower + 1;
+            running[lower] += total - upper_vote;
+            running[upper] += upper_vote;
+        }
+        size_t offset = (static_cast<size_t>(x) + 1) * ORIENTATIONS;
+        for (int b = 0; b < ORIENTATIONS; ++b) {
+            current[offset + b] = previous[offset + b] + running[b];
+        }
+    }
+}
+
+void HogFeatures::NormalizeBlocks() {
+    size_t row = (static_cast<size_t>(width_) + 1) * ORIENTATIONS;
+    blocks_.resize(static_cast<size_t>(BLOCK_SIZE) * blocks_x_ * blocks_y_);
+
+    float block[BLOCK_SIZE];
+    for (int by = 0; by < blocks_y_; ++by) {
+        for (int bx = 0; bx < blocks_x_; ++bx) {
+            for (int cell = 0; cell < BLOCK_CELLS * BLOCK_CELLS; ++cell) {
+                size_t x0 = static_cast<size_t>(bx) * GRID_STEP + (cell % BLOCK_CELLS) * CELL_SIZE;
+                size_t y0 = static_cast<size_t>(by) * GRID_STEP + (cell / BLOCK_CELLS) * CELL_SIZE;
+                const uint32_t* top_left = &integral_[y0 * row + x0 * ORIENTATIONS];
+                const uint32_t* top_right = top_left + CELL_SIZE * ORIENTATIONS;
+                const uint32_t* bottom_left = top_left + CELL_SIZE * row;
+                const uint32_t* bottom_right = bottom_left + CELL_SIZE * ORIENTATIONS;
+                for (int b = 0; b < ORIENTATIONS; ++b) {
+                    uint32_t sum = bottom_right[b] - top_right[b] - bottom_left[b] + top_left[b];
+                    block[cell * ORIENTATIONS + b] = static_cast<float>(sum) / VOTE_SCALE;
+                }
+            }
+
+            // L2-Hys : normalisation, écrêtage, renormalisation
+            float squares = 0.0f;
+            for (float value : block) {
+                squares += value * value;
+            }
+            float scale = 1.0f / std::sqrt(squares + NORMALIZATION_EPSILON * NORMALIZATION_EPSILON);
+            squares = 0.0f;
+            for (float& value : block) {
+                value = std::min(value * scale, HYSTERESIS_CLIP);
+                squares += value * value;
+            }
+            scale = 1.0f / std::sqrt(squares + NORMALIZATION_EPSILON * NORMALIZATION_EPSILON);
+            for (int k = 0; k < BLOCK_SIZE; ++k) {
+                blocks_[(static_cast<size_t>(k) * blocks_y_ + by) * blocks_x_ + bx] = block[k] * scale;
+            }
+        }
+    }
+}
+
+std::vector<float> HogFeatures::WindowDescriptor(int wx, int wy) const {
+    std::vector<float> descriptor;
+    if (wx < 0 || wy < 0 || wx + (WINDOW_BLOCKS_X - 1) * WINDOW_BLOCK_STRIDE >= blocks_x_ ||
+        wy + (WINDOW_BLOCKS_Y - 1) * WINDOW_BLOCK_STRIDE >= blocks_y_) {
+        return descriptor;
+    }
+    descriptor.reserve(DESCRIPTOR_SIZE);
+    for (int j = 0; j < WINDOW_BLOCKS_Y; ++j) {
+        for (int i = 0; i < WINDOW_BLOCKS_X; ++i) {
+            for (int k = 0; k < BLOCK_SIZE; ++k) {
+                descriptor.push_back(BlockRow(k, wy + j * WINDOW_BLOCK_STRIDE)[wx + i * WINDOW_BLOCK_STRIDE]);
+            }
+        }
+    }
+    return descriptor;
+}
+
+// =============================================================================
+// HogPersonDetector
+// =============================================================================
+
+HogPersonDetector::HogPersonDetector() : bias_(0.0f), score_threshold_(DEFAULT_SCORE_THRESHOLD) {
+}
+
+bool HogPersonDetector::Load(const std::string& path, std::string* error) {
+    // Taille et signature vérifiées avant de lire le corps du fichier
+    std::error_code size_error;
+    uintmax_t size = std::filesystem::file_size(path, size_error);
+    std::ifstream file(path, std::ios::binary);
+    if (size_error || !file) {
+        if (error) *error = "Cannot open model file: " + path;
+        return false;
+    }
+    std::vector<uint8_t> bytes(FILE_SIZE);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), sizeof(MAGIC)) ||
+        std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        if (error) *error = path + ": Not a HOG model";
+        return false;
+    }
+    if (size != FILE_SIZE) {
+        if (error) *error = path + ": Unexpected HOG model size";
+        return false;
+    }
+    file.read(reinterpret_cast<char*>(bytes.data() + sizeof(MAGIC)), bytes.size() - sizeof(MAGIC));
+    bytes.resize(sizeof(MAGIC) + static_cast<size_t>(file.gcount()));
+    if (!Parse(bytes.data(), bytes.size(), error)) {
+        if (error) *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+bool HogPersonDetector::Parse(const uint8_t* data, size_t size, std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail("Not a HOG model");
+    }
+    if (size != FILE_SIZE) {
+        return fail("Unexpected HOG model size");
+    }
+    uint32_t checksum = 0;
+    std::memcpy(&checksum, data + size - sizeof(checksum), sizeof(checksum));
+    if (DetectorCheckpoint::Checksum(data, size - sizeof(checksum)) != checksum) {
+        return fail("Model checksum mismatch");
+    }
+
+    uint32_t version = 0;
+    uint16_t header[4];
+    uint32_t count = 0;
+    const uint8_t* cursor = data + sizeof(MAGIC);
+    std::memcpy(&version, cursor, sizeof(version));
+    std::memcpy(header, cursor + sizeof(version), sizeof(header));
+    std::memcpy(&count, cursor + sizeof(version) + sizeof(header), sizeof(count));
+    if (version != FORMAT_VERSION) {
+        return fail("Unsupported model version");
+    }
+    if (header[0] != WINDOW_WIDTH || header[1] != WINDOW_HEIGHT || header[2] != ORIENTATIONS ||
+        count != static_cast<uint32_t>(DESCRIPTOR_SIZE)) {
+        return fail("Unsupported HOG layout");
+    }
+
+    std::vector<float> weights(DESCRIPTOR_SIZE);
+    float bias = 0.0f;
+    std::memcpy(weights.data(), data + HEADER_SIZE, DESCRIPTOR_SIZE * sizeof(float));
+    std::memcpy(&bias, data + HEADER_SIZE + DESCRIPTOR_SIZE * sizeof(float), sizeof(bias));
+    if (!SetModel(std::move(weights), bias)) {
+        return fail("Invalid model weights");
+    }
+    return true;
+}
+
+std::vector<uint8_t> HogPersonDetector::Serialize() const {
+    std::vector<uint8_t> out(sizeof(MAGIC));
+    std::memcpy(out.data(), MAGIC, sizeof(MAGIC));
+    Append(&out, FORMAT_VERSION);
+    Append(&out, static_cast<uint16_t>(WINDOW_WIDTH));
+    Append(&out, static_cast<uint16_t>(WINDOW_HEIGHT));
+    Append(&out, static_cast<uint16_t>(ORIENTATIONS));
+    Append(&out, static_cast<uint16_t>(0));
+    Append(&out, static_cast<uint32_t>(weights_.size()));
+    for (float weight : weights_) {
+        Append(&out, weight);
+    }
+    Append(&out, bias_);
+    Append(&out, DetectorCheckpoint::Checksum(out.data(), out.size()));
+    return out;
+}
+
+bool HogPersonDetector::SetModel(std::vector<float> weights, float bias) {
+    if (weights.size() != static_cast<size_t>(DESCRIPTOR_SIZE) || !std::isfinite(bias) ||
+        !std::all_of(weights.begin(), weights.end(), [](float weight) { return std::isfinite(weight); })) {
+        return false;
+    }
+    weights_ = std::move(weights);
+    bias_ = bias;
+    return true;
+}
+
+std::vector<float> HogPersonDetector::Describe(const uint8_t* gray, int width, int height) {
+    if (width != WINDOW_WIDTH || height != WINDOW_HEIGHT) {
+        return {};
+    }
+    HogFeatures features;
+    features.Compute(gray, width, height);
+    return features.WindowDescriptor(0, 0);
+}
+
+void HogPersonDetector::Scan(const uint8_t* gray, int width, int height, std::vector<HogWindow>* windows) {
+    windows->clear();
+    if (!HasModel()) {
+        return;
+    }
+    features_.Compute(gray, width, height);
+    int columns = features_.GetBlocksX() - (WINDOW_BLOCKS_X - 1) * WINDOW_BLOCK_STRIDE;
+    int rows = features_.GetBlocksY() - (WINDOW_BLOCKS_Y - 1) * WINDOW_BLOCK_STRIDE;
+    if (columns <= 0 || rows <= 0) {
+        return;
+    }
+
+    scores_.resize(columns);
+    for (int wy = 0; wy < rows; ++wy) {
+        // Toute la ligne de fenêtres à la fois : chaque poids multiplie une
+        // suite contiguë de blocs, une fenêtre par voie
+        std::fill(scores_.begin(), scores_.end(), bias_);
+        const float* weight = weights_.data();
+        for (int j = 0; j < WINDOW_BLOCKS_Y; ++j) {
+            for (int i = 0; i < WINDOW_BLOCKS_X; ++i) {
+                for (int k = 0; k < BLOCK_SIZE; ++k, ++weight) {
+                    const float* blocks = features_.BlockRow(k, wy + j * WINDOW_BLOCK_STRIDE) + i * WINDOW_BLOCK_STRIDE;
+                    float w = *weight;
+                    for (int wx = 0; wx < columns; ++wx) {
+                        scores_[wx] += w * blocks[wx];
+                    }
+                }
+            }
+        }
+        for (int wx = 0; wx < columns; ++wx) {
+            windows->push_back({wx * GRID_STEP, wy * GRID_STEP, WINDOW_WIDTH, WINDOW_HEIGHT, scores_[wx]});
+        }
+    }
+}
+
+std::vector<Detection> HogPersonDetector::Detect(const Frame& crop) {
+    int bytes_per_pixel = FrameUtils::BytesPerPixel(crop.format);
+    if (!HasModel() || bytes_per_pixel == 0 || crop.width <= 0 || crop.height <= 0 ||
+        crop.PixelBytes() < static_cast<size_t>(crop.width) * crop.height * bytes_per_pixel) {
+        return {};
+    }
+
+    // Luminance de l'imagette
+    gray_.width = crop.width;
+    gray_.height = crop.height;
+    gray_.format = "gray";
+    gray_.data.resize(static_cast<size_t>(crop.width) * crop.height);
+    const uint8_t* pixels = crop.Pixels();
+    if (bytes_per_pixel == 1) {
+        std::copy(pixels, pixels + gray_.data.size(), gray_.data.begin());
+    } else {
+        for (size_t i = 0; i < gray_.data.size(); ++i, pixels += 3) {
+            gray_.data[i] = static_cast<uint8_t>((pixels[0] + 2 * pixels[1] + pixels[2]) >> 2);
+        }
+    }
+
+    candidates_.clear();
+    for (float scale : SCALES) {
+        int width = static_cast<int>(std::lround(crop.width / scale));
+        int height = static_cast<int>(std::lround(crop.height / scale));
+        if (width < WINDOW_WIDTH || height < WINDOW_HEIGHT) {
+            continue;
+        }
+        Frame scaled;
+        const uint8_t* image = gray_.data.data();
+        if (width != crop.width || height != crop.height) {
+            scaled = FrameUtils::ResizeRegion(gray_, FrameRegion(0, 0, crop.width, crop.height), width, height);
+            image = scaled.data.data();
+        }
+        Scan(image, width, height, &windows_);
+
+        // Fenêtres retenues, ramenées aux coordonnées de l'imagette
+        float scale_x = static_cast<float>(crop.width) / width;
+        float scale_y = static_cast<float>(crop.height) / height;
+        for (const auto& window : windows_) {
+            if (window.score > score_threshold_) {
+                candidates_.push_back({static_cast<int>(std::lround(window.x * scale_x)),
+                                       static_cast<int>(std::lround(window.y * scale_y)),
+                                       static_cast<int>(std::lround(window.width * scale_x)),
+                                       static_cast<int>(std::lround(window.height * scale_y)),
+                                       window.score});
+            }
+        }
+    }
+
+    // Suppression des non-maxima, meilleurs scores d'abord
+    std::stable_sort(candidates_.begin(), candidates_.end(),
+                     [](const HogWindow& a, const HogWindow& b) { return a.score > b.score; });
+    windows_.clear();
+    for (const auto& candidate : candidates_) {
+        bool overlapping = std::any_of(windows_.begin(), windows_.end(), [&candidate](const HogWindow& kept) {
+            return Overlap(candidate, kept) > NMS_OVERLAP;
+        });
+        if (!overlapping) {
+            windows_.push_back(candidate);
+            if (windows_.size() >= static_cast<size_t>(MAX_DETECTIONS)) {
+                break;
+            }
+        }
+    }
+
+    std::vector<Detection> detections;
+    for (const auto& window : windows_) {
+        Detection detection;
+        detection.set_type("person");
+        detection.set_confidence(1.0f / (1.0f + std::exp(-window.score)));
+        auto* bbox = detection.mutable_bbox();
+        bbox->set_x(window.x);
+        bbox->set_y(window.y);
+        bbox->set_width(window.width);
+        bbox->set_height(window.height);
+        (*detection.mutable_metadata())["hog_score"] = std::to_string(window.score);
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+int HogPersonDetector::GetInputWidth() const {
+    return INPUT_WIDTH;
+}
+
+int HogPersonDetector::GetInputHeight() const {
+    return INPUT_HEIGHT;
+}
@@ -0,0 +1,139 @@
+// src/hog_detector.h
+#ifndef HOG_DETECTOR_H
+#define HOG_DETECTOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "frame_processor.h"
+
+// Histogrammes de gradients orientés (Dalal-Triggs) d'une image en niveaux
+// de gris : 9 orientations non signées, cellules de 8 × 8 pixels, blocs de
+// 2 × 2 cellules normalisés L2-Hys. Les blocs sont calculés sur une grille
+// de 4 pixels, ce qui permet de faire glisser les fenêtres par pas de
+// 4 pixels ; les cellules, qui se chevauchent alors, sont lues dans un
+// histogramme intégral (4 accès par orientation, quelle que soit la taille).
+//
+// La boucle des gradients (orientation sans atan2) est sans branchement :
+// le compilateur la vectorise.
+class HogFeatures {
+public:
+    void Compute(const uint8_t* gray, int width, int height);
+
+    // Blocs d'origine (4 × bx, 4 × by)
+    int GetBlocksX() const { return blocks_x_; }
+    int GetBlocksY() const { return blocks_y_; }
+    // Composante k des blocs de la ligne by, contiguë en bx : le score d'une
+    // ligne de fenêtres se calcule d'un bloc de lecture
+    const float* BlockRow(int k, int by) const {
+        return &blocks_[(static_cast<size_t>(k) * blocks_y_ + by) * blocks_x_];
+    }
+
+    // Descripteur de la fenêtre d'origine (4 × wx, 4 × wy), ordre [ligne de
+    // blocs][colonne de blocs][composante]
+    std::vector<float> WindowDescriptor(int wx, int wy) const;
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int blocks_x_ = 0;
+    int blocks_y_ = 0;
+
+    std::vector<uint8_t> padded_;           // bords répliqués : pas de cas particulier
+    std::vector<float> squared_magnitude_;  // ligne courante
+    std::vector<float> position_;           // position dans les orientations, ligne courante
+    std::vector<uint32_t> integral_;        // [y + 1][x + 1][orientation]
+    std::vector<float> blocks_;             // [composante][by][bx]
+
+    void AccumulateRow(int y);
+    void NormalizeBlocks();
+};
+
+// Fenêtre analysée, en pixels de l'image passée à Scan
+struct HogWindow {
+    int x;
+    int y;
+    int width;
+    int height;
+    float score;  // marge du SVM linéaire
+};
+
+// Détecteur de personnes HOG + SVM linéaire, sans dépendance, prévu pour le
+// second étage de la cascade : chaque région en mouvement arrive mise au
+// format d'entrée (GetInputWidth × GetInputHeight) et y est balayée à
+// quelques échelles par une fenêtre de 64 × 128. Le coût par région est
+// donc fixe, quelle que soit la taille de l'objet dans la frame.
+//
+// Les scores de toute une ligne de fenêtres sont accumulés ensemble :
+// pour chaque poids du modèle, une lecture contiguë des blocs et une
+// multiplication-addition par fenêtre.
+//
+// Fichier de modèle (petit-boutiste) :
+//   "VHOG" | version u32 | largeur u16 | hauteur u16 | orientations u16 |
+//   réservé u16 | nombre de poids u32 | poids f32 | biais f32 |
+//   CRC32 u32 de tout ce qui précède
+class HogPersonDetector : public Detector {
+public:
+    HogPersonDetector();
+
+    bool Load(const std::string& path, std::string* error = nullptr);
+    bool Parse(const uint8_t* data, size_t size, std::string* error = nullptr);
+    std::vector<uint8_t> Serialize() const;
+    // DESCRIPTOR_SIZE poids, dans l'ordre de WindowDescriptor
+    bool SetModel(std::vector<float> weights, float bias);
+    bool HasModel() const { return !weights_.empty(); }
+    void SetScoreThreshold(float threshold) { score_threshold_ = threshold; }
+
+    // Descripteur d'une image de la taille d'une fenêtre (outils
+    // d'entraînement) ; vide pour une autre taille
+    static std::vector<float> Describe(const uint8_t* gray, int width, int height);
+    // Score de toutes les fenêtres de l'image, à l'échelle 1
+    void Scan(const uint8_t* gray, int width, int height, std::vector<HogWindow>* windows);
+
+    std::vector<Detection> Detect(const Frame& crop) override;
+    std::string GetName() const override { return "HogPersonDetector"; }
+    bool Initialize() override { return HasModel(); }
+    void Cleanup() override {}
+    int GetInputWidth() const override;
+    int GetInputHeight() const override;
+
+private:
+    std::vector<float> weights_;
+    float bias_;
+    float score_threshold_;
+
+    HogFeatures features_;
+    std::vector<float> scores_;      // une ligne de fenêtres
+    std::vector<HogWindow> windows_;
+    std::vector<HogWindow> candidates_;
+    Frame gray_;
+};
+
+namespace HogConstants {
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr int ORIENTATIONS = 9;
+    constexpr int CELL_SIZE = 8;
+    constexpr int GRID_STEP = 4;                 // pas des blocs et des fenêtres, pixels
+    constexpr int BLOCK_CELLS = 2;               // blocs de 2 × 2 cellules
+    constexpr int BLOCK_SIZE = BLOCK_CELLS * BLOCK_CELLS * ORIENTATIONS;
+    constexpr int WINDOW_WIDTH = 64;
+    constexpr int WINDOW_HEIGHT = 128;
+    constexpr int WINDOW_BLOCKS_X = (WINDOW_WIDTH - CELL_SIZE * BLOCK_CELLS) / CELL_SIZE + 1;   // 7
+    constexpr int WINDOW_BLOCKS_Y = (WINDOW_HEIGHT - CELL_SIZE * BLOCK_CELLS) / CELL_SIZE + 1;  // 15
+    constexpr int DESCRIPTOR_SIZE = WINDOW_BLOCKS_X * WINDOW_BLOCKS_Y * BLOCK_SIZE;             // 3780
+    constexpr float VOTE_SCALE = 16.0f;          // votes entiers : histogramme intégral exact
+    constexpr float NORMALIZATION_EPSILON = 1.0f;
+    constexpr float HYSTERESIS_CLIP = 0.2f;      // L2-Hys
+
+    // Imagette de second étage : une fois et demie la fenêtre, balayée à
+    // trois échelles (personne de 100 %, 80 % et 67 % de sa hauteur)
+    constexpr int INPUT_WIDTH = 96;
+    constexpr int INPUT_HEIGHT = 192;
+    constexpr float SCALES[] = {1.0f, 1.25f, 1.5f};
+    constexpr float DEFAULT_SCORE_THRESHOLD = 0.0f;
+    constexpr float NMS_OVERLAP = 0.5f;          // intersection sur union
+    constexpr int MAX_DETECTIONS = 4;            // par imagette
+}
+
+#endif // HOG_DETECTOR_H
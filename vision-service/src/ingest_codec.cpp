@@ -0,0 +1,144 @@
+// src/ingest_codec.cpp
+#include "ingest_codec.h"
+#include <algorithm>
+
+#include "frame_processor.h"
+
+using namespace IngestCodecConstants;
+
+namespace {
+
+void AppendVarint(std::string* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(const std::string& in, size_t* pos, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && *pos < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[(*pos)++]);
+        *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+namespace IngestCodec {
+
+std::string EncodeXorRle(const uint8_t* current, size_t size,
+                         const std::vector<uint8_t>& reference) {
+    std::string out;
+    if (size != reference.size()) {
+        return out;
+    }
+
+    size_t pos = 0;
+    while (pos < size) {
+        // Séquence de zéros (octets inchangés)
+        size_t zero_start = pos;
+        while (pos < size && current[pos] == reference[pos]) {
+            ++pos;
+        }
+        if (pos == size) {
+            break;  // fin implicite
+        }
+        size_t zero_run = pos - zero_start;
+
+        // Séquence littérale jusqu'à MIN_ZERO_RUN zéros consécutifs
+        size_t literal_start = pos;
+        size_t zeros = 0;
+        while (pos < size && zeros < MIN_ZERO_RUN) {
+            zeros = (current[pos] == reference[pos]) ? zeros + 1 : 0;
+            ++pos;
+        }
+        pos -= zeros;
+        size_t literal_count = pos - literal_start;
+
+        AppendVarint(&out, zero_run);
+        AppendVarint(&out, literal_count);
+        for (size_t i = literal_start; i < pos; ++i) {
+            out.push_back(static_cast<char>(current[i] ^ reference[i]));
+        }
+    }
+
+    return out;
+}
+
+bool DecodeXorRle(const std::string& payload,
+                  const std::vector<uint8_t>& reference,
+                  std::vector<uint8_t>* decoded,
+                  std::string* error) {
+    if (reference.empty()) {
+        *error = "Missing reference frame for delta encoding, send a raw frame";
+        return false;
+    }
+
+    *decoded = reference;
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+
+    while (in_pos < payload.size()) {
+        uint64_t zero_run = 0;
+        uint64_t literal_count = 0;
+        if (!ReadVarint(payload, &in_pos, &zero_run) ||
+            !ReadVarint(payload, &in_pos, &literal_count)) {
+            *error = "Truncated delta payload";
+            return false;
+        }
+
+        if (zero_run > decoded->size() - out_pos ||
+            literal_count > decoded->size() - out_pos - zero_run ||
+            literal_count > payload.size() - in_pos) {
+            *error = "Delta payload does not match reference frame size";
+            return false;
+        }
+
+        out_pos += zero_run;
+        uint8_t* out = decoded->data() + out_pos;
+        const uint8_t* literals = reinterpret_cast<const uint8_t*>(payload.data()) + in_pos;
+        for (uint64_t i = 0; i < literal_count; ++i) {
+            out[i] ^= literals[i];
+        }
+        out_pos += literal_count;
+        in_pos += literal_count;
+    }
+
+    return true;
+}
+
+IngestFormat ChooseIngestFormat(const IngestCapabilities& capabilities,
+                                int source_width, int source_height,
+                                const std::string& source_format) {
+    IngestFormat format;
+
+    // Luminance seule si le client sait la produire
+    format.set_format(capabilities.gray() ? "gray" : source_format);
+
+    // Plus grand facteur qui garde la largeur d'analyse et les dimensions minimales
+    int max_downscale = std::clamp(capabilities.max_downscale(), 1, MAX_DOWNSCALE);
+    int downscale = 1;
+    for (int factor = max_downscale; factor > 1; --factor) {
+        if (source_width / factor >= MIN_ANALYSIS_WIDTH &&
+            source_height / factor >= FrameProcessorConstants::MIN_FRAME_HEIGHT) {
+            downscale = factor;
+            break;
+        }
+    }
+    format.set_downscale(downscale);
+
+    format.set_encoding(capabilities.delta_xor_rle() ? ENCODING_XOR_RLE : ENCODING_RAW);
+    return format;
+}
+
+bool IsDeltaEncoding(const std::string& encoding) {
+    return encoding == ENCODING_XOR_RLE;
+}
+
+} // namespace IngestCodec
@@ -0,0 +1,54 @@
+// src/ingest_codec.h
+#ifndef INGEST_CODEC_H
+#define INGEST_CODEC_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "vision.pb.h"
+
+using surveillance::vision::IngestCapabilities;
+using surveillance::vision::IngestFormat;
+
+// Formats d'ingestion à bande passante réduite pour ProcessFrames.
+//
+// Encodage "xor_rle" : la frame est XORée avec la frame précédente décodée
+// de la même caméra, puis le résidu est codé en séquences
+//     varint(zéros) varint(n) n octets littéraux
+// jusqu'à la fin du payload ; les octets non couverts sont inchangés.
+namespace IngestCodec {
+    // Encodage delta (côté client, utilisé aussi par les tests)
+    std::string EncodeXorRle(const uint8_t* current, size_t size,
+                             const std::vector<uint8_t>& reference);
+
+    // Décodage delta ; false (et error) si le payload est corrompu ou ne
+    // correspond pas à la référence
+    bool DecodeXorRle(const std::string& payload,
+                      const std::vector<uint8_t>& reference,
+                      std::vector<uint8_t>* decoded,
+                      std::string* error);
+
+    // Format le moins coûteux acceptable pour l'analyse, compte tenu de ce
+    // que le client sait produire et de la résolution source de la caméra
+    IngestFormat ChooseIngestFormat(const IngestCapabilities& capabilities,
+                                    int source_width, int source_height,
+                                    const std::string& source_format);
+
+    bool IsDeltaEncoding(const std::string& encoding);
+}
+
+// Constantes
+namespace IngestCodecConstants {
+    const std::string ENCODING_RAW = "raw";
+    const std::string ENCODING_XOR_RLE = "xor_rle";
+
+    // La détection de mouvement travaille sur la luminance à basse résolution
+    constexpr int MIN_ANALYSIS_WIDTH = 320;
+    constexpr int MAX_DOWNSCALE = 8;
+
+    // Au-delà de ce nombre de zéros consécutifs, une séquence littérale est coupée
+    constexpr size_t MIN_ZERO_RUN = 3;
+}
+
+#endif // INGEST_CODEC_H
@@ -4,7 +4,12 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
 #include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
@@ -17,18 +22,44 @@ using grpc::ServerBuilder;
 using grpc::ServerContext;
 using grpc::Status;
 
-// Variable globale pour l'arrêt gracieux
-volatile bool running = true;
+// Signaux d'arrêt et de rechargement : bloqués dans tous les threads et lus
+// via signalfd par le thread principal, réveillé immédiatement (pas de polling)
+int createSignalFd() {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+    
+    // Avant la création de tout thread : ils héritent du masque
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        return -1;
+    }
+    return signalfd(-1, &mask, SFD_CLOEXEC);
+}
 
-// Handler pour les signaux (SIGINT, SIGTERM)
-void signalHandler(int signal) {
-    std::cout << "\n🛑 Signal reçu (" << signal << "), arrêt en cours..." << std::endl;
-    running = false;
+// Attend un signal au plus timeout_ms ; retourne le signal ou 0
+int waitForSignal(int signal_fd, int timeout_ms) {
+    pollfd fd = {signal_fd, POLLIN, 0};
+    if (poll(&fd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+    
+    signalfd_siginfo info;
+    if (read(signal_fd, &info, sizeof(info)) != sizeof(info)) {
+        return 0;
+    }
+    return static_cast<int>(info.ssi_signo);
 }
 
 int main(int argc, char** argv) {
     // Configuration par défaut
     std::string server_address = "0.0.0.0:50051";
+    int shutdown_budget_ms = VisionServiceConstants::DEFAULT_SHUTDOWN_BUDGET_MS;
+    std::string config_path;
+    std::string state_dir;
+    std::string detection_log_dir;
+    std::string models_dir;
     
     // Parse arguments simples
     for (int i = 1; i < argc; ++i) {
@@ -39,6 +70,16 @@ int main(int argc, char** argv) {
             std::cout << "Options:\n";
             std::cout << "  --port <port>    Port d'écoute (défaut: 50051)\n";
             std::cout << "  --host <host>    Adresse d'écoute (défaut: 0.0.0.0)\n";
+            std::cout << "  --shutdown-timeout-ms <ms>\n";
+            std::cout << "                   Budget d'arrêt gracieux (défaut: "
+                      << VisionServiceConstants::DEFAULT_SHUTDOWN_BUDGET_MS << ")\n";
+            std::cout << "  --config <file>  Streams à démarrer (JSON StreamsConfig), rechargé sur SIGHUP\n";
+            std::cout << "  --state-dir <dir>\n";
+            std::cout << "                   État des détecteurs conservé entre redémarrages\n";
+            std::cout << "  --detection-log-dir <dir>\n";
+            std::cout << "                   Journal des détections par caméra (QueryDetections)\n";
+            std::cout << "  --models-dir <dir>\n";
+            std::cout << "                   Modèles de second étage (detector.classifier_model y est relatif)\n";
             std::cout << "  --help, -h       Afficher cette aide\n";
             std::cout << "  --version, -v    Afficher la version\n\n";
             std::cout << "Exemples:\n";
@@ -59,17 +100,52 @@ int main(int argc, char** argv) {
             std::string port = (colon_pos != std::string::npos) ? 
                                server_address.substr(colon_pos) : ":50051";
             server_address = host + port;
+        } else if (arg == "--shutdown-timeout-ms" && i + 1 < argc) {
+            shutdown_budget_ms = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (arg == "--state-dir" && i + 1 < argc) {
+            state_dir = argv[++i];
+        } else if (arg == "--detection-log-dir" && i + 1 < argc) {
+            detection_log_dir = argv[++i];
+        } else if (arg == "--models-dir" && i + 1 < argc) {
+            models_dir = argv[++i];
+        }
+    }
+    
+    // Une configuration invalide au démarrage est une erreur fatale
+    StreamsConfig streams_config;
+    if (!config_path.empty()) {
+        std::string config_error;
+        if (!StreamConfigFile::Load(config_path, &streams_config, &config_error)) {
+            std::cerr << "❌ Erreur: " << config_error << std::endl;
+            return 1;
         }
     }
     
-    // Installation des handlers de signaux
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+    // Installation de la réception des signaux
+    int signal_fd = createSignalFd();
+    if (signal_fd < 0) {
+        std::cerr << "❌ Erreur: Impossible d'installer la réception des signaux" << std::endl;
+        return 1;
+    }
     
     std::cout << "🎥 Vision Service - Démarrage...\n" << std::endl;
     
     // Créer le service
     VisionServiceImpl service;
+    if (!service.SetStateDirectory(state_dir)) {
+        std::cerr << "❌ Erreur: Répertoire d'état inutilisable: " << state_dir << std::endl;
+        return 1;
+    }
+    if (!service.SetDetectionLogDirectory(detection_log_dir)) {
+        std::cerr << "❌ Erreur: Répertoire du journal des détections inutilisable: " << detection_log_dir << std::endl;
+        return 1;
+    }
+    if (!service.SetModelDirectory(models_dir)) {
+        std::cerr << "❌ Erreur: Répertoire des modèles inutilisable: " << models_dir << std::endl;
+        return 1;
+    }
     
     // Activer la réflexion gRPC (pour le debugging)
     grpc::reflection::InitProtoReflectionServerBuilderPlugin();
@@ -108,31 +184,66 @@ int main(int argc, char** argv) {
     std::cout << "  - GetStreamStatus: Statut d'un stream" << std::endl;
     std::cout << "  - GetHealth: Health check du service" << std::endl;
     std::cout << "  - ProcessFrames: Traitement de frames (streaming)" << std::endl;
+    std::cout << "  - ProcessFrameBatches: Frames groupées multi-caméras" << std::endl;
+    std::cout << "  - ListStreams: Statut groupé des streams" << std::endl;
+    std::cout << "  - BatchStartStream: Démarrage parallèle de caméras" << std::endl;
     std::cout << std::endl;
     
-    // Boucle principale avec monitoring
+    // Démarrage à chaud : les streams du fichier démarrent en parallèle
+    // pendant que le serveur répond déjà
+    if (!config_path.empty()) {
+        std::cout << "📄 " << streams_config.streams_size() << " stream(s) configuré(s) dans "
+                  << config_path << std::endl;
+        service.ApplyStreamsConfigAsync(streams_config);
+    }
+    
+    // Boucle principale : stats toutes les 30 secondes, réveil immédiat sur signal
     auto start_time = std::chrono::steady_clock::now();
     
-    while (running) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    int received_signal = 0;
+    while ((received_signal = waitForSignal(signal_fd, 30000)) == 0 || received_signal == SIGHUP) {
+        if (received_signal == SIGHUP) {
+            // Rechargement : seuls les streams modifiés sont touchés ; un
+            // fichier invalide laisse les streams en l'état
+            std::string config_error;
+            if (config_path.empty()) {
+                std::cout << "🔁 SIGHUP ignoré : aucun fichier de configuration" << std::endl;
+            } else if (!StreamConfigFile::Load(config_path, &streams_config, &config_error)) {
+                std::cerr << "❌ Rechargement ignoré: " << config_error << std::endl;
+            } else {
+                std::cout << "🔁 Rechargement de " << config_path << std::endl;
+                service.ApplyStreamsConfigAsync(streams_config);
+            }
+            continue;
+        }
         
-        // Afficher des stats périodiquement (toutes les 30 secondes)
         auto now = std::chrono::steady_clock::now();
         auto uptime = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
-        
-        if (uptime.count() % 30 == 0 && uptime.count() > 0) {
-            std::cout << "📊 Uptime: " << uptime.count() << "s, "
-                      << "Streams actifs: " << service.GetActiveStreamsCount() 
-                      << std::endl;
-        }
+        std::cout << "📊 Uptime: " << uptime.count() << "s, "
+                  << "Streams actifs: " << service.GetActiveStreamsCount() 
+                  << std::endl;
     }
     
-    std::cout << "\n🔄 Arrêt du serveur..." << std::endl;
-    
-    // Arrêt gracieux
-    server->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(5));
-    
-    std::cout << "✅ Vision Service arrêté proprement" << std::endl;
+    std::cout << "\n🛑 Signal reçu (" << received_signal << "), arrêt en cours..." << std::endl;
+    auto shutdown_start = std::chrono::steady_clock::now();
+    auto shutdown_deadline = shutdown_start + std::chrono::milliseconds(shutdown_budget_ms);
+    
+    // Moitié du budget pour les RPC en cours : les streams ProcessFrames
+    // vident leurs frames en file avant de se terminer, les autres sont
+    // annulés à l'échéance
+    std::cout << "🔄 Arrêt du serveur..." << std::endl;
+    server->Shutdown(std::chrono::system_clock::now() +
+                     std::chrono::milliseconds(shutdown_budget_ms / 2));
+    
+    // Le reste pour les caméras, arrêtées en parallèle
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        shutdown_deadline - std::chrono::steady_clock::now());
+    service.Shutdown(std::max(remaining, std::chrono::milliseconds(0)));
+    close(signal_fd);
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - shutdown_start);
+    std::cout << "✅ Vision Service arrêté proprement en " << elapsed.count() << " ms" << std::endl;
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,309 @@
+// src/motion_heatmap.cpp
+#include "motion_heatmap.h"
+#include "detector_checkpoint.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace MotionHeatmapConstants;
+
+namespace {
+
+// [largeur, hauteur (u32)] [frames (u64)] [début, sauvegarde (i64, ms)]
+// [frames pondérées (f64)] [origine x, y (i32)] puis les deux cartes
+constexpr size_t STATE_HEADER_SIZE = 48;
+constexpr size_t MAX_STATE_BLOCKS = 1 << 20;
+
+int64_t WallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+void PutBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutChunk(std::vector<uint8_t>& png, const char type[4], const std::vector<uint8_t>& data) {
+    PutBigEndian(png, static_cast<uint32_t>(data.size()));
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    // Le CRC32 des checkpoints est celui de PNG (type et données)
+    PutBigEndian(png, DetectorCheckpoint::Checksum(png.data() + start, png.size() - start));
+}
+
+// Noir, bleu, rouge, jaune, blanc
+std::array<uint8_t, 3> HeatColor(int index) {
+    double t = index / 255.0;
+    auto ramp = [](double from) { return static_cast<uint8_t>(std::lround((from / 0.25) * 255.0)); };
+    if (t < 0.25) return {0, 0, ramp(t)};
+    if (t < 0.5) return {ramp(t - 0.25), 0, static_cast<uint8_t>(255 - ramp(t - 0.25))};
+    if (t < 0.75) return {255, ramp(t - 0.5), 0};
+    return {255, 255, ramp(std::min(t - 0.75, 0.25))};
+}
+
+}  // namespace
+
+MotionHeatmap::MotionHeatmap()
+    : grid_width_(0), grid_height_(0), origin_x_(0), origin_y_(0), half_life_ms_(DEFAULT_HALF_LIFE_MS),
+      decaying_frames_(0.0), gain_(1.0), frames_(0), since_ms_(0) {
+}
+
+void MotionHeatmap::Accumulate(const uint8_t* mask, int grid_width, int grid_height,
+                               int origin_x, int origin_y, std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (grid_width != grid_width_ || grid_height != grid_height_ ||
+        origin_x != origin_x_ || origin_y != origin_y_) {
+        ResetLocked(grid_width, grid_height, origin_x, origin_y);
+    }
+    AdvanceLocked(now);
+
+    float gain = static_cast<float>(gain_);
+    decaying_frames_ += gain_;
+    frames_++;
+    size_t blocks = decaying_.size();
+    for (size_t i = 0; i < blocks; ++i) {
+        if (mask[i]) {
+            decaying_[i] += gain;
+            if (cumulative_[i] != std::numeric_limits<uint32_t>::max()) {
+                cumulative_[i]++;
+            }
+        }
+    }
+}
+
+void MotionHeatmap::SetHalfLife(std::chrono::milliseconds half_life) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    half_life_ms_ = static_cast<double>(std::max<int64_t>(1, half_life.count()));
+}
+
+MotionHeatmapGrid MotionHeatmap::GetGrid(MotionHeatmapKind kind) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MotionHeatmapGrid grid;
+    if (frames_ == 0) {
+        return grid;
+    }
+    grid.grid_width = grid_width_;
+    grid.grid_height = grid_height_;
+    grid.origin_x = origin_x_;
+    grid.origin_y = origin_y_;
+    grid.frames = frames_;
+    grid.since_ms = since_ms_;
+    grid.values.resize(decaying_.size());
+
+    // Le gain se simplifie : cellule et total des frames sont à la même échelle
+    // (le total décroissant peut s'annuler après un très long arrêt)
+    double total = kind == MotionHeatmapKind::DECAYING ? decaying_frames_ : static_cast<double>(frames_);
+    double scale = total > 0.0 ? 65535.0 / total : 0.0;
+    for (size_t i = 0; i < grid.values.size(); ++i) {
+        double value = kind == MotionHeatmapKind::DECAYING ? decaying_[i] : cumulative_[i];
+        grid.values[i] = static_cast<uint16_t>(std::min(65535.0, std::round(value * scale)));
+    }
+    return grid;
+}
+
+void MotionHeatmap::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResetLocked(0, 0, 0, 0);
+}
+
+std::vector<uint8_t> MotionHeatmap::SaveState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frames_ == 0) {
+        return {};
+    }
+
+    size_t blocks = decaying_.size();
+    std::vector<uint8_t> state(STATE_HEADER_SIZE + blocks * (sizeof(float) + sizeof(uint32_t)));
+    uint8_t* out = state.data();
+    uint32_t dims[2] = {static_cast<uint32_t>(grid_width_), static_cast<uint32_t>(grid_height_)};
+    int64_t times[2] = {since_ms_, WallClockMs()};
+    double decaying_frames = decaying_frames_ / gain_;
+    int32_t origin[2] = {origin_x_, origin_y_};
+    std::memcpy(out, dims, sizeof(dims));
+    std::memcpy(out + 8, &frames_, sizeof(frames_));
+    std::memcpy(out + 16, times, sizeof(times));
+    std::memcpy(out + 32, &decaying_frames, sizeof(decaying_frames));
+    std::memcpy(out + 40, origin, sizeof(origin));
+    out += STATE_HEADER_SIZE;
+    for (size_t i = 0; i < blocks; ++i) {
+        float value = static_cast<float>(decaying_[i] / gain_);
+        std::memcpy(out + i * sizeof(float), &value, sizeof(value));
+    }
+    out += blocks * sizeof(float);
+    std::memcpy(out, cumulative_.data(), blocks * sizeof(uint32_t));
+    return state;
+}
+
+bool MotionHeatmap::RestoreState(const std::vector<uint8_t>& state) {
+    if (state.size() < STATE_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t dims[2];
+    uint64_t frames;
+    int64_t times[2];
+    double decaying_frames;
+    int32_t origin[2];
+    std::memcpy(dims, state.data(), sizeof(dims));
+    std::memcpy(&frames, state.data() + 8, sizeof(frames));
+    std::memcpy(times, state.data() + 16, sizeof(times));
+    std::memcpy(&decaying_frames, state.data() + 32, sizeof(decaying_frames));
+    std::memcpy(origin, state.data() + 40, sizeof(origin));
+
+    size_t blocks = static_cast<size_t>(dims[0]) * dims[1];
+    if (dims[0] == 0 || dims[1] == 0 || blocks > MAX_STATE_BLOCKS || frames == 0 ||
+        !(decaying_frames > 0.0) ||
+        state.size() != STATE_HEADER_SIZE + blocks * (sizeof(float) + sizeof(uint32_t))) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResetLocked(static_cast<int>(dims[0]), static_cast<int>(dims[1]), origin[0], origin[1]);
+    const uint8_t* in = state.data() + STATE_HEADER_SIZE;
+    std::memcpy(decaying_.data(), in, blocks * sizeof(float));
+    in += blocks * sizeof(float);
+    std::memcpy(cumulative_.data(), in, blocks * sizeof(uint32_t));
+    frames_ = frames;
+    since_ms_ = times[0];
+    decaying_frames_ = decaying_frames;
+
+    // Pendant l'arrêt, le passé a continué de perdre du poids
+    int64_t downtime_ms = WallClockMs() - times[1];
+    if (downtime_ms > 0) {
+        double factor = std::exp2(-static_cast<double>(downtime_ms) / half_life_ms_);
+        for (float& value : decaying_) {
+            value = static_cast<float>(value * factor);
+        }
+        decaying_frames_ *= factor;
+    }
+    last_update_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+std::vector<uint8_t> MotionHeatmap::RenderPng(const MotionHeatmapGrid& grid, int scale) {
+    if (grid.IsEmpty()) {
+        return {};
+    }
+    scale = std::clamp(scale, 1, MAX_PNG_SCALE);
+    uint32_t width = static_cast<uint32_t>(grid.grid_width * scale);
+    uint32_t height = static_cast<uint32_t>(grid.grid_height * scale);
+    uint16_t peak = *std::max_element(grid.values.begin(), grid.values.end());
+
+    // Lignes filtrées (filtre 0) d'indices de palette
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(height) * (width + 1));
+    for (int by = 0; by < grid.grid_height; ++by) {
+        size_t row_start = raw.size();
+        raw.push_back(0);
+        for (int bx = 0; bx < grid.grid_width; ++bx) {
+            uint16_t value = grid.values[static_cast<size_t>(by) * grid.grid_width + bx];
+            uint8_t index = peak == 0 ? 0 : static_cast<uint8_t>((value * 255u + peak / 2) / peak);
+            raw.insert(raw.end(), scale, index);
+        }
+        for (int repeat = 1; repeat < scale; ++repeat) {
+            raw.resize(raw.size() + width + 1);
+            std::memcpy(raw.data() + raw.size() - (width + 1), raw.data() + row_start, width + 1);
+        }
+    }
+
+    // Flux zlib en blocs deflate non compressés : quelques Kio pour une
+    // grille de blocs, pas de dépendance à zlib
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    size_t offset = 0;
+    do {
+        size_t length = std::min(MAX_STORED_BLOCK, raw.size() - offset);
+        bool last = offset + length == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(static_cast<uint8_t>(length));
+        idat.push_back(static_cast<uint8_t>(length >> 8));
+        idat.push_back(static_cast<uint8_t>(~length));
+        idat.push_back(static_cast<uint8_t>(~length >> 8));
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBigEndian(idat, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    PutBigEndian(header, width);
+    PutBigEndian(header, height);
+    header.insert(header.end(), {8, 3, 0, 0, 0});  // 8 bits, couleurs indexées
+
+    std::vector<uint8_t> palette;
+    for (int i = 0; i < 256; ++i) {
+        auto color = HeatColor(i);
+        palette.insert(palette.end(), color.begin(), color.end());
+    }
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    PutChunk(png, "IHDR", header);
+    PutChunk(png, "PLTE", palette);
+    PutChunk(png, "IDAT", idat);
+    PutChunk(png, "IEND", {});
+    return png;
+}
+
+bool MotionHeatmap::ParseKind(const std::string& name, MotionHeatmapKind* kind) {
+    if (name.empty() || name == "decaying") {
+        *kind = MotionHeatmapKind::DECAYING;
+    } else if (name == "cumulative") {
+        *kind = MotionHeatmapKind::CUMULATIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void MotionHeatmap::ResetLocked(int grid_width, int grid_height, int origin_x, int origin_y) {
+    size_t blocks = static_cast<size_t>(grid_width) * grid_height;
+    grid_width_ = grid_width;
+    grid_height_ = grid_height;
+    origin_x_ = origin_x;
+    origin_y_ = origin_y;
+    decaying_.assign(blocks, 0.0f);
+    cumulative_.assign(blocks, 0);
+    decaying_frames_ = 0.0;
+    gain_ = 1.0;
+    frames_ = 0;
+    since_ms_ = WallClockMs();
+}
+
+void MotionHeatmap::AdvanceLocked(std::chrono::steady_clock::time_point now) {
+    if (frames_ > 0 && now > last_update_) {
+        double elapsed_ms = std::chrono::duration<double, std::milli>(now - last_update_).count();
+        gain_ *= std::exp2(elapsed_ms / half_life_ms_);
+        if (gain_ > MAX_GAIN) {
+            RenormalizeLocked();
+        }
+    }
+    if (frames_ == 0 || now > last_update_) {
+        last_update_ = now;
+    }
+}
+
+void MotionHeatmap::RenormalizeLocked() {
+    // Très longue coupure : le passé ne pèse plus rien face à la frame courante
+    if (!std::isfinite(gain_)) {
+        std::fill(decaying_.begin(), decaying_.end(), 0.0f);
+        decaying_frames_ = 0.0;
+        gain_ = 1.0;
+        return;
+    }
+    float inverse = static_cast<float>(1.0 / gain_);
+    for (float& value : decaying_) {
+        value *= inverse;
+    }
+    decaying_frames_ /= gain_;
+    gain_ = 1.0;
+}
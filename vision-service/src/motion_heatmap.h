@@ -0,0 +1,96 @@
+// src/motion_heatmap.h
+#ifndef MOTION_HEATMAP_H
+#define MOTION_HEATMAP_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// Carte d'activité à retourner : part du temps où chaque bloc était en
+// mouvement, sur 16 bits (65535 = toujours en mouvement)
+struct MotionHeatmapGrid {
+    int grid_width = 0;
+    int grid_height = 0;
+    int origin_x = 0;              // coin du bloc (0, 0) dans la frame source
+    int origin_y = 0;              // (analyse limitée aux zones actives)
+    std::vector<uint16_t> values;  // ligne par ligne
+    uint64_t frames = 0;           // frames analysées depuis since_ms
+    int64_t since_ms = 0;          // début de l'accumulation, ms depuis epoch
+
+    bool IsEmpty() const { return values.empty(); }
+};
+
+enum class MotionHeatmapKind {
+    DECAYING,    // activité récente, pondérée par une demi-vie
+    CUMULATIVE   // depuis le début de l'accumulation
+};
+
+// Cartes d'activité d'une caméra à la résolution des blocs du détecteur de
+// mouvement. Mise à jour à chaque frame depuis le masque des blocs au
+// premier plan : seuls les blocs en mouvement sont touchés. La décroissance
+// est paresseuse : au lieu d'atténuer toute la carte, le poids des
+// nouvelles frames grandit (gain) et la carte n'est renormalisée que quand
+// ce gain devient trop grand.
+//
+// Écrite par le thread de traitement, lue par les RPC : protégée par un
+// mutex, jamais contesté plus d'une fois par requête.
+class MotionHeatmap {
+public:
+    MotionHeatmap();
+
+    MotionHeatmap(const MotionHeatmap&) = delete;
+    MotionHeatmap& operator=(const MotionHeatmap&) = delete;
+
+    // mask : un octet par bloc, non nul = en mouvement. Un changement de
+    // grille (résolution, zones) repart de zéro.
+    void Accumulate(const uint8_t* mask, int grid_width, int grid_height,
+                    int origin_x, int origin_y, std::chrono::steady_clock::time_point now);
+
+    void SetHalfLife(std::chrono::milliseconds half_life);
+    MotionHeatmapGrid GetGrid(MotionHeatmapKind kind) const;
+    void Reset();
+
+    // État persisté (vide si rien accumulé). La décroissance continue
+    // pendant l'arrêt d'après l'heure de sauvegarde.
+    std::vector<uint8_t> SaveState() const;
+    bool RestoreState(const std::vector<uint8_t>& state);
+
+    // PNG en couleurs indexées, scale pixels par bloc, étalé sur le
+    // maximum de la carte pour rester lisible quand l'activité est rare
+    static std::vector<uint8_t> RenderPng(const MotionHeatmapGrid& grid, int scale);
+    static bool ParseKind(const std::string& name, MotionHeatmapKind* kind);
+
+private:
+    mutable std::mutex mutex_;
+    int grid_width_;
+    int grid_height_;
+    int origin_x_;
+    int origin_y_;
+    double half_life_ms_;
+
+    // Activité décroissante : valeur réelle = cellule / gain_
+    std::vector<float> decaying_;
+    double decaying_frames_;  // même échelle que decaying_
+    double gain_;
+    std::chrono::steady_clock::time_point last_update_;
+
+    std::vector<uint32_t> cumulative_;
+    uint64_t frames_;
+    int64_t since_ms_;
+
+    void ResetLocked(int grid_width, int grid_height, int origin_x, int origin_y);
+    void AdvanceLocked(std::chrono::steady_clock::time_point now);
+    void RenormalizeLocked();
+};
+
+namespace MotionHeatmapConstants {
+    constexpr int DEFAULT_HALF_LIFE_MS = 10 * 60 * 1000;
+    constexpr double MAX_GAIN = 1e6;         // renormalisation au-delà
+    constexpr uint32_t STATE_VERSION = 1;    // empreinte du checkpoint
+    constexpr int MAX_PNG_SCALE = 16;
+    constexpr size_t MAX_STORED_BLOCK = 65535;  // bloc deflate non compressé
+}
+
+#endif // MOTION_HEATMAP_H
@@ -0,0 +1,325 @@
+// src/optical_flow.cpp
+#include "optical_flow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace OpticalFlowConstants;
+
+namespace {
+
+constexpr int WINDOW_SIZE = 2 * WINDOW_RADIUS + 1;
+constexpr int WINDOW_PIXELS = WINDOW_SIZE * WINDOW_SIZE;
+constexpr int FEATURE_RADIUS = 2;  // fenêtre du tenseur de structure
+
+float Median(std::vector<float>& values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+}  // namespace
+
+float MotionVector::GetSpeed() const {
+    return std::hypot(velocity_x, velocity_y);
+}
+
+float MotionVector::GetDirection() const {
+    float degrees = std::atan2(dy, dx) * 180.0f / static_cast<float>(M_PI);
+    return degrees < 0.0f ? degrees + 360.0f : degrees;
+}
+
+void SparseOpticalFlow::BeginFrame(int width, int height, int offset_x, int offset_y,
+                                   std::chrono::steady_clock::time_point timestamp) {
+    std::swap(previous_, current_);
+    previous_width_ = width_;
+    previous_height_ = height_;
+    previous_offset_x_ = offset_x_;
+    previous_offset_y_ = offset_y_;
+    previous_timestamp_ = timestamp_;
+
+    width_ = width;
+    height_ = height;
+    offset_x_ = offset_x;
+    offset_y_ = offset_y;
+    timestamp_ = timestamp;
+    current_.resize(static_cast<size_t>(width) * height);
+}
+
+void SparseOpticalFlow::StoreRow(const uint8_t* frame, int y, int bytes_per_pixel) {
+    const uint8_t* pixel = frame + static_cast<size_t>(y) * width_ * bytes_per_pixel;
+    uint8_t* out = &current_[static_cast<size_t>(y) * width_];
+    if (bytes_per_pixel == 1) {
+        StoreLumaRow(pixel, y);
+        return;
+    }
+    for (int x = 0; x < width_; ++x, pixel += bytes_per_pixel) {
+        out[x] = static_cast<uint8_t>((pixel[0] + 2 * pixel[1] + pixel[2]) >> 2);
+    }
+}
+
+void SparseOpticalFlow::StoreLumaRow(const uint8_t* luma, int y) {
+    std::copy(luma, luma + width_, &current_[static_cast<size_t>(y) * width_]);
+}
+
+bool SparseOpticalFlow::HasPrevious() const {
+    return width_ > 0 && previous_width_ == width_ && previous_height_ == height_ &&
+           previous_offset_x_ == offset_x_ && previous_offset_y_ == offset_y_ &&
+           previous_.size() == current_.size();
+}
+
+MotionVector SparseOpticalFlow::Track(int x, int y, int width, int height) {
+    MotionVector motion;
+    if (!HasPrevious() || width <= 0 || height <= 0) {
+        return motion;
+    }
+
+    // Région suivie : la boîte plus le déplacement maximal, dans la frame
+    int region_x = std::max(0, x - SEARCH_MARGIN);
+    int region_y = std::max(0, y - SEARCH_MARGIN);
+    int region_width = std::min(width_, x + width + SEARCH_MARGIN) - region_x;
+    int region_height = std::min(height_, y + height + SEARCH_MARGIN) - region_y;
+    if (region_width < WINDOW_SIZE + 2 || region_height < WINDOW_SIZE + 2) {
+        return motion;
+    }
+    BuildPyramid(current_, region_x, region_y, region_width, region_height, &current_pyramid_);
+    BuildPyramid(previous_, region_x, region_y, region_width, region_height, &previous_pyramid_);
+
+    // Coins choisis dans la frame courante, là où est l'objet, puis suivis
+    // en arrière : le déplacement de l'objet est l'opposé
+    SelectFeatures(current_pyramid_[0], x - region_x, y - region_y, width, height);
+    flow_x_.clear();
+    flow_y_.clear();
+    for (size_t i = 0; i < candidates_.size(); i += 3) {
+        float dx = 0.0f, dy = 0.0f;
+        if (TrackPoint(candidates_[i + 1], candidates_[i + 2], &dx, &dy)) {
+            flow_x_.push_back(-dx);
+            flow_y_.push_back(-dy);
+        }
+    }
+    if (flow_x_.size() < static_cast<size_t>(MIN_FEATURES)) {
+        return motion;
+    }
+
+    motion.points = static_cast<int>(flow_x_.size());
+    motion.dx = Median(flow_x_);
+    motion.dy = Median(flow_y_);
+    float seconds = std::chrono::duration<float>(timestamp_ - previous_timestamp_).count();
+    if (seconds > 0.0f) {
+        motion.velocity_x = motion.dx / seconds;
+        motion.velocity_y = motion.dy / seconds;
+    }
+    return motion;
+}
+
+void SparseOpticalFlow::Annotate(std::vector<Detection>* detections) {
+    if (!HasPrevious()) {
+        return;
+    }
+    for (auto& detection : *detections) {
+        const auto& bbox = detection.bbox();
+        MotionVector motion = Track(bbox.x(), bbox.y(), bbox.width(), bbox.height());
+        if (!motion.IsValid()) {
+            continue;
+        }
+        auto& metadata = *detection.mutable_metadata();
+        metadata["motion_dx"] = std::to_string(motion.dx);
+        metadata["motion_dy"] = std::to_string(motion.dy);
+        metadata["speed"] = std::to_string(motion.GetSpeed());
+        metadata["direction"] = std::to_string(motion.GetDirection());
+        metadata["flow_points"] = std::to_string(motion.points);
+    }
+}
+
+void SparseOpticalFlow::BuildPyramid(const std::vector<uint8_t>& plane, int x, int y, int width, int height,
+                                     std::vector<Level>* pyramid) const {
+    pyramid->resize(PYRAMID_LEVELS);
+    Level& base = (*pyramid)[0];
+    base.width = width;
+    base.height = height;
+    base.pixels.resize(static_cast<size_t>(width) * height);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* source = &plane[static_cast<size_t>(y + row) * width_ + x];
+        std::copy(source, source + width, &base.pixels[static_cast<size_t>(row) * width]);
+    }
+
+    // Moyenne 2 × 2 ; les niveaux trop petits pour une fenêtre sont abandonnés
+    size_t levels = 1;
+    for (; levels < static_cast<size_t>(PYRAMID_LEVELS); ++levels) {
+        const Level& finer = (*pyramid)[levels - 1];
+        Level& level = (*pyramid)[levels];
+        level.width = finer.width / 2;
+        level.height = finer.height / 2;
+        if (level.width < WINDOW_SIZE + 2 || level.height < WINDOW_SIZE + 2) {
+            break;
+        }
+        level.pixels.resize(static_cast<size_t>(level.width) * level.height);
+        for (int row = 0; row < level.height; ++row) {
+            const float* top = finer.Row(2 * row);
+            const float* bottom = finer.Row(2 * row + 1);
+            float* out = &level.pixels[static_cast<size_t>(row) * level.width];
+            for (int column = 0; column < level.width; ++column) {
+                out[column] = 0.25f * (top[2 * column] + top[2 * column + 1] +
+                                       bottom[2 * column] + bottom[2 * column + 1]);
+            }
+        }
+    }
+    pyramid->resize(levels);
+}
+
+void SparseOpticalFlow::SelectFeatures(const Level& level, int x, int y, int width, int height) {
+    candidates_.clear();
+    int margin = WINDOW_RADIUS + 1;
+    int x0 = std::max(x, margin);
+    int y0 = std::max(y, margin);
+    int x1 = std::min(x + width, level.width - margin);
+    int y1 = std::min(y + height, level.height - margin);
+
+    // Plus petite valeur propre du tenseur de structure, sur une grille
+    for (int cy = y0; cy < y1; cy += FEATURE_STEP) {
+        for (int cx = x0; cx < x1; cx += FEATURE_STEP) {
+            float xx = 0.0f, xy = 0.0f, yy = 0.0f;
+            for (int wy = cy - FEATURE_RADIUS; wy <= cy + FEATURE_RADIUS; ++wy) {
+                const float* row = level.Row(wy);
+                const float* above = level.Row(wy - 1);
+                const float* below = level.Row(wy + 1);
+                for (int wx = cx - FEATURE_RADIUS; wx <= cx + FEATURE_RADIUS; ++wx) {
+                    float ix = 0.5f * (row[wx + 1] - row[wx - 1]);
+                    float iy = 0.5f * (below[wx] - above[wx]);
+                    xx += ix * ix;
+                    xy += ix * iy;
+                    yy += iy * iy;
+                }
+            }
+            float half_trace = 0.5f * (xx + yy);
+            float score = half_trace - std::sqrt(0.25f * (xx - yy) * (xx - yy) + xy * xy);
+            if (score >= MIN_EIGENVALUE) {
+                candidates_.insert(candidates_.end(), {score, static_cast<float>(cx), static_cast<float>(cy)});
+            }
+        }
+    }
+
+    // Garder les MAX_FEATURES meilleurs (triplets triés par score décroissant)
+    size_t count = candidates_.size() / 3;
+    if (count > static_cast<size_t>(MAX_FEATURES)) {
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::partial_sort(order.begin(), order.begin() + MAX_FEATURES, order.end(),
+                          [this](size_t a, size_t b) { return candidates_[3 * a] > candidates_[3 * b]; });
+        std::vector<float> best;
+        best.reserve(3 * MAX_FEATURES);
+        for (int i = 0; i < MAX_FEATURES; ++i) {
+            best.insert(best.end(), candidates_.begin() + 3 * order[i], candidates_.begin() + 3 * order[i] + 3);
+        }
+        candidates_.swap(best);
+    }
+}
+
+bool SparseOpticalFlow::TrackPoint(float x, float y, float* dx, float* dy) {
+    template_.resize(WINDOW_PIXELS);
+    gradient_x_.resize(WINDOW_PIXELS);
+    gradient_y_.resize(WINDOW_PIXELS);
+    warped_.resize(WINDOW_PIXELS);
+
+    // Estimation du niveau grossier propagée au niveau fin (× 2)
+    float guess_x = 0.0f, guess_y = 0.0f;
+    float residual = 0.0f;
+    for (int l = static_cast<int>(current_pyramid_.size()) - 1; l >= 0; --l) {
+        const Level& current = current_pyramid_[l];
+        const Level& previous = previous_pyramid_[l];
+        float scale = 1.0f / static_cast<float>(1 << l);
+        int cx = static_cast<int>(std::lround(x * scale));
+        int cy = static_cast<int>(std::lround(y * scale));
+        bool last = l == 0;
+        if (cx - WINDOW_RADIUS < 1 || cy - WINDOW_RADIUS < 1 ||
+            cx + WINDOW_RADIUS >= current.width - 1 || cy + WINDOW_RADIUS >= current.height - 1) {
+            if (last) return false;
+            guess_x *= 2.0f;
+            guess_y *= 2.0f;
+            continue;
+        }
+
+        // Fenêtre et gradients de la frame courante, copiés en contigu
+        for (int wy = 0; wy < WINDOW_SIZE; ++wy) {
+            const float* row = current.Row(cy - WINDOW_RADIUS + wy) + cx - WINDOW_RADIUS;
+            const float* above = current.Row(cy - WINDOW_RADIUS + wy - 1) + cx - WINDOW_RADIUS;
+            const float* below = current.Row(cy - WINDOW_RADIUS + wy + 1) + cx - WINDOW_RADIUS;
+            float* out = &template_[wy * WINDOW_SIZE];
+            float* out_x = &gradient_x_[wy * WINDOW_SIZE];
+            float* out_y = &gradient_y_[wy * WINDOW_SIZE];
+            for (int wx = 0; wx < WINDOW_SIZE; ++wx) {
+                out[wx] = row[wx];
+                out_x[wx] = 0.5f * (row[wx + 1] - row[wx - 1]);
+                out_y[wx] = 0.5f * (below[wx] - above[wx]);
+            }
+        }
+        float xx = 0.0f, xy = 0.0f, yy = 0.0f;
+        for (int i = 0; i < WINDOW_PIXELS; ++i) {
+            xx += gradient_x_[i] * gradient_x_[i];
+            xy += gradient_x_[i] * gradient_y_[i];
+            yy += gradient_y_[i] * gradient_y_[i];
+        }
+        float determinant = xx * yy - xy * xy;
+        if (determinant < 1e-3f) {
+            return false;
+        }
+
+        float step_x = 0.0f, step_y = 0.0f;
+        for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+            float tx = static_cast<float>(cx) + guess_x + step_x;
+            float ty = static_cast<float>(cy) + guess_y + step_y;
+            int ix = static_cast<int>(std::floor(tx)) - WINDOW_RADIUS;
+            int iy = static_cast<int>(std::floor(ty)) - WINDOW_RADIUS;
+            if (ix < 0 || iy < 0 || ix + WINDOW_SIZE >= previous.width || iy + WINDOW_SIZE >= previous.height) {
+                return false;
+            }
+
+            // Interpolation bilinéaire : mêmes poids pour toute la fenêtre
+            float fx = tx - std::floor(tx);
+            float fy = ty - std::floor(ty);
+            float w00 = (1.0f - fx) * (1.0f - fy), w01 = fx * (1.0f - fy);
+            float w10 = (1.0f - fx) * fy, w11 = fx * fy;
+            for (int wy = 0; wy < WINDOW_SIZE; ++wy) {
+                const float* top = previous.Row(iy + wy) + ix;
+                const float* bottom = previous.Row(iy + wy + 1) + ix;
+                float* out = &warped_[wy * WINDOW_SIZE];
+                for (int wx = 0; wx < WINDOW_SIZE; ++wx) {
+                    out[wx] = w00 * top[wx] + w01 * top[wx + 1] + w10 * bottom[wx] + w11 * bottom[wx + 1];
+                }
+            }
+
+            float bx = 0.0f, by = 0.0f;
+            residual = 0.0f;
+            for (int i = 0; i < WINDOW_PIXELS; ++i) {
+                float error = template_[i] - warped_[i];
+                bx += error * gradient_x_[i];
+                by += error * gradient_y_[i];
+                residual += std::fabs(error);
+            }
+            float delta_x = (yy * bx - xy * by) / determinant;
+            float delta_y = (xx * by - xy * bx) / determinant;
+            step_x += delta_x;
+            step_y += delta_y;
+            if (delta_x * delta_x + delta_y * delta_y < CONVERGENCE * CONVERGENCE) {
+                break;
+            }
+        }
+
+        guess_x += step_x;
+        guess_y += step_y;
+        if (!last) {
+            guess_x *= 2.0f;
+            guess_y *= 2.0f;
+        }
+    }
+
+    if (residual / WINDOW_PIXELS > MAX_RESIDUAL) {
+        return false;
+    }
+    *dx = guess_x;
+    *dy = guess_y;
+    return true;
+}
@@ -0,0 +1,117 @@
+// src/optical_flow.h
+#ifndef OPTICAL_FLOW_H
+#define OPTICAL_FLOW_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "vision.pb.h"
+
+using surveillance::vision::Detection;
+
+// Déplacement d'un objet entre la frame précédente et la frame courante
+struct MotionVector {
+    float dx = 0.0f;          // pixels par frame
+    float dy = 0.0f;
+    float velocity_x = 0.0f;  // pixels par seconde
+    float velocity_y = 0.0f;
+    int points = 0;           // points suivis retenus, 0 si pas de mesure
+
+    bool IsValid() const { return points > 0; }
+    float GetSpeed() const;      // pixels par seconde
+    float GetDirection() const;  // degrés, 0 = vers la droite, 90 = vers le bas
+};
+
+// Flot optique de Lucas-Kanade pyramidal, limité aux objets détectés. La
+// luminance de chaque frame est conservée ligne par ligne pendant le calcul
+// des blocs du détecteur de mouvement ; pour chaque détection, une pyramide
+// locale est construite sur la boîte plus une marge, des coins (plus petite
+// valeur propre du tenseur de structure) y sont choisis dans la frame
+// courante puis suivis jusqu'à la frame précédente. Le vecteur retenu est
+// la médiane des points suivis. Le coût dépend de la surface en mouvement,
+// pas de la taille de la frame.
+//
+// Les fenêtres sont copiées dans des tampons contigus en flottants : les
+// boucles internes (produits et interpolation bilinéaire à poids constants)
+// sont vectorisées par le compilateur.
+//
+// Utilisé par le seul thread de traitement.
+class SparseOpticalFlow {
+public:
+    SparseOpticalFlow() = default;
+
+    SparseOpticalFlow(const SparseOpticalFlow&) = delete;
+    SparseOpticalFlow& operator=(const SparseOpticalFlow&) = delete;
+
+    // Nouvelle frame : la précédente devient la référence. Un changement de
+    // dimensions ou de recadrage invalide la référence.
+    void BeginFrame(int width, int height, int offset_x, int offset_y,
+                    std::chrono::steady_clock::time_point timestamp);
+    // Ligne y de la frame (1 ou 3 octets par pixel), pendant qu'elle est en cache
+    void StoreRow(const uint8_t* frame, int y, int bytes_per_pixel);
+    // Ligne y déjà convertie en luminance (width octets)
+    void StoreLumaRow(const uint8_t* luma, int y);
+    bool HasPrevious() const;
+
+    // Déplacement de l'objet dans la boîte (coordonnées de la frame)
+    MotionVector Track(int x, int y, int width, int height);
+
+    // Ajoute direction et vitesse aux métadonnées des détections mesurables
+    void Annotate(std::vector<Detection>* detections);
+
+private:
+    // Image d'un niveau de pyramide, restreinte à la région suivie
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> pixels;
+
+        const float* Row(int y) const { return &pixels[static_cast<size_t>(y) * width]; }
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    int offset_x_ = 0;
+    int offset_y_ = 0;
+    std::chrono::steady_clock::time_point timestamp_;
+    std::vector<uint8_t> current_;
+
+    int previous_width_ = 0;
+    int previous_height_ = 0;
+    int previous_offset_x_ = 0;
+    int previous_offset_y_ = 0;
+    std::chrono::steady_clock::time_point previous_timestamp_;
+    std::vector<uint8_t> previous_;
+
+    // Tampons réutilisés d'une détection à l'autre
+    std::vector<Level> current_pyramid_;
+    std::vector<Level> previous_pyramid_;
+    std::vector<float> template_;
+    std::vector<float> gradient_x_;
+    std::vector<float> gradient_y_;
+    std::vector<float> warped_;
+    std::vector<float> candidates_;  // (score, x, y) par triplet
+    std::vector<float> flow_x_;
+    std::vector<float> flow_y_;
+
+    void BuildPyramid(const std::vector<uint8_t>& plane, int x, int y, int width, int height,
+                      std::vector<Level>* pyramid) const;
+    void SelectFeatures(const Level& level, int x, int y, int width, int height);
+    bool TrackPoint(float x, float y, float* dx, float* dy);
+};
+
+namespace OpticalFlowConstants {
+    constexpr int PYRAMID_LEVELS = 3;
+    constexpr int WINDOW_RADIUS = 4;            // fenêtre 9 × 9 à chaque niveau
+    constexpr int SEARCH_MARGIN = 32;           // déplacement maximal suivi, en pixels
+    constexpr int FEATURE_STEP = 4;             // grille des points candidats
+    constexpr int MAX_FEATURES = 24;            // par détection
+    constexpr int MIN_FEATURES = 3;             // en dessous : pas de mesure
+    constexpr float MIN_EIGENVALUE = 200.0f;    // coin exploitable (somme sur la fenêtre)
+    constexpr int MAX_ITERATIONS = 10;
+    constexpr float CONVERGENCE = 0.03f;        // pixels
+    constexpr float MAX_RESIDUAL = 12.0f;       // erreur absolue moyenne, niveaux de luminance
+}
+
+#endif // OPTICAL_FLOW_H
@@ -0,0 +1,46 @@
+// src/pixel_pipeline.cpp
+#include "pixel_pipeline.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PIXEL_PIPELINE_X86 1
+#endif
+
+namespace {
+
+using LumaRowFn = void (*)(const uint8_t* pixels, int width, uint8_t* out);
+
+inline void Rgb24ToLumaRow(const uint8_t* __restrict pixels, int width, uint8_t* __restrict out) {
+    for (int x = 0; x < width; ++x) {
+        const uint8_t* pixel = pixels + 3 * x;
+        out[x] = static_cast<uint8_t>((pixel[0] + 2 * pixel[1] + pixel[2]) >> 2);
+    }
+}
+
+void Rgb24ToLumaScalar(const uint8_t* pixels, int width, uint8_t* out) {
+    Rgb24ToLumaRow(pixels, width, out);
+}
+
+#ifdef PIXEL_PIPELINE_X86
+// Même boucle, vectorisée par le compilateur avec les permutations d'AVX2
+__attribute__((target("avx2")))
+void Rgb24ToLumaAvx2(const uint8_t* pixels, int width, uint8_t* out) {
+    Rgb24ToLumaRow(pixels, width, out);
+}
+#endif
+
+LumaRowFn SelectRgb24ToLuma() {
+#ifdef PIXEL_PIPELINE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Rgb24ToLumaAvx2;
+    }
+#endif
+    return Rgb24ToLumaScalar;
+}
+
+}  // namespace
+
+void Rgb24ToLuma(const uint8_t* pixels, int width, uint8_t* out) {
+    static const LumaRowFn convert = SelectRgb24ToLuma();
+    convert(pixels, width, out);
+}
@@ -0,0 +1,238 @@
+// src/pixel_pipeline.h
+#ifndef PIXEL_PIPELINE_H
+#define PIXEL_PIPELINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+// Formats de pixels bruts. Luma() donne la luminance d'une ligne, dans out
+// ou directement dans la ligne quand elle l'est déjà.
+struct Gray8Format {
+    static constexpr int BYTES = 1;
+
+    static const uint8_t* Luma(const uint8_t* pixels, int /*width*/, uint8_t* /*out*/) {
+        return pixels;
+    }
+};
+
+// Luminance d'une ligne de pixels de 3 octets, (B + 2G + R) / 4 :
+// symétrique donc valable en RGB et BGR. Version AVX2 choisie à
+// l'exécution quand le processeur la supporte (désentrelacement des
+// composantes, hors de portée de SSE2).
+void Rgb24ToLuma(const uint8_t* pixels, int width, uint8_t* out);
+
+struct Rgb24Format {
+    static constexpr int BYTES = 3;
+
+    static const uint8_t* Luma(const uint8_t* pixels, int width, uint8_t* out) {
+        Rgb24ToLuma(pixels, width, out);
+        return out;
+    }
+};
+
+// Formats pour lesquels chaque pipeline est compilé
+using PixelFormats = std::tuple<Gray8Format, Rgb24Format>;
+
+struct PipelineFrame {
+    int width;
+    int height;
+    int bytes_per_pixel;
+};
+
+// Ligne courante, partagée par les étages dans leur ordre de déclaration
+struct PipelineRow {
+    const uint8_t* pixels;  // format d'origine
+    const uint8_t* luma;
+    const uint8_t* above[2];  // luminance des lignes y - 1 et y - 2, nullptr hors de la frame
+    int y;
+    int width;
+};
+
+// Étapes vides par défaut : un étage ne redéfinit que ce qu'il utilise.
+// Row est un modèle sur le format, un étage peut le spécialiser.
+struct PixelStage {
+    void Begin(const PipelineFrame& /*frame*/) {}
+    template <typename Format>
+    void Row(const PipelineRow& /*row*/) {}
+    void End() {}
+};
+
+// Luminance moyenne par bloc de block_size × block_size pixels (blocs
+// tronqués au bord droit et en bas). Chaque ligne est ajoutée à des sommes
+// par colonne sur 16 bits (une addition vectorielle par pixel), réduites
+// en sommes de blocs une fois par ligne de blocs.
+class BlockLumaStage : public PixelStage {
+public:
+    // Au plus MAX_BLOCK_SIZE : sommes de colonnes sans débordement
+    static constexpr int MAX_BLOCK_SIZE = 256;
+
+    void SetBlockSize(int block_size) { block_size_ = std::clamp(block_size, 1, MAX_BLOCK_SIZE); }
+
+    void Begin(const PipelineFrame& frame) {
+        width_ = frame.width;
+        height_ = frame.height;
+        grid_width_ = (frame.width + block_size_ - 1) / block_size_;
+        grid_height_ = (frame.height + block_size_ - 1) / block_size_;
+        columns_.assign(static_cast<size_t>(frame.width), 0);
+        means_.resize(static_cast<size_t>(grid_width_) * grid_height_);
+    }
+
+    template <typename Format>
+    void Row(const PipelineRow& row) {
+        uint16_t* columns = columns_.data();
+        for (int x = 0; x < row.width; ++x) {
+            columns[x] = static_cast<uint16_t>(columns[x] + row.luma[x]);
+        }
+        if ((row.y + 1) % block_size_ == 0 || row.y + 1 == height_) {
+            FlushBlockRow(row.y / block_size_);
+        }
+    }
+
+    int GetGridWidth() const { return grid_width_; }
+    int GetGridHeight() const { return grid_height_; }
+    const std::vector<float>& GetMeans() const { return means_; }
+
+private:
+    int block_size_ = 16;
+    int width_ = 0;
+    int height_ = 0;
+    int grid_width_ = 0;
+    int grid_height_ = 0;
+    std::vector<uint16_t> columns_;  // ligne de blocs en cours, par colonne
+    std::vector<float> means_;
+
+    void FlushBlockRow(int by) {
+        int block_height = std::min(block_size_, height_ - by * block_size_);
+        float* means = &means_[static_cast<size_t>(by) * grid_width_];
+        for (int bx = 0; bx < grid_width_; ++bx) {
+            int x0 = bx * block_size_;
+            int x1 = std::min(x0 + block_size_, width_);
+            uint32_t sum = 0;
+            for (int x = x0; x < x1; ++x) {
+                sum += columns_[x];
+            }
+            means[bx] = static_cast<float>(sum) / static_cast<float>((x1 - x0) * block_height);
+        }
+        std::fill(columns_.begin(), columns_.end(), uint16_t{0});
+    }
+};
+
+// Moyenne et variance de la luminance sur tous les pixels
+class LumaStatisticsStage : public PixelStage {
+public:
+    void Begin(const PipelineFrame& /*frame*/) {
+        sum_ = 0;
+        sum_squares_ = 0;
+        pixels_ = 0;
+    }
+
+    // Sommes sur 32 bits (multiplication-addition 16 bits vectorielle) par
+    // tranches de CHUNK pixels, sans débordement
+    template <typename Format>
+    void Row(const PipelineRow& row) {
+        for (int start = 0; start < row.width; start += CHUNK) {
+            int end = std::min(row.width, start + CHUNK);
+            uint32_t sum = 0;
+            uint32_t sum_squares = 0;
+            for (int x = start; x < end; ++x) {
+                uint32_t value = row.luma[x];
+                sum += value;
+                sum_squares += value * value;
+            }
+            sum_ += sum;
+            sum_squares_ += sum_squares;
+        }
+        pixels_ += static_cast<uint64_t>(row.width);
+    }
+
+    float GetMean() const {
+        return pixels_ > 0 ? static_cast<float>(static_cast<double>(sum_) / pixels_) : 0.0f;
+    }
+    float GetVariance() const {
+        if (pixels_ == 0) {
+            return 0.0f;
+        }
+        double mean = static_cast<double>(sum_) / pixels_;
+        return static_cast<float>(std::max(0.0, static_cast<double>(sum_squares_) / pixels_ - mean * mean));
+    }
+
+private:
+    static constexpr int CHUNK = 16384;  // 16384 × 255² < 2³²
+
+    uint64_t sum_ = 0;
+    uint64_t sum_squares_ = 0;
+    uint64_t pixels_ = 0;
+};
+
+// Pipeline composé à la compilation : chaque ligne de la frame est
+// convertie une fois en luminance dans un tampon de LUMA_ROWS lignes qui
+// reste en cache L1 (les étages de voisinage y lisent les lignes du
+// dessus), puis passée à tous les étages (expressions de repli sur le
+// tuple), sans appel virtuel : les boucles des étages sont inlinées
+// ensemble. Un seul parcours de la frame quel que soit le nombre d'étages.
+//
+// Le pipeline est instancié pour chaque format de PixelFormats ; Run()
+// choisit l'instance d'après les octets par pixel, une fois par frame.
+// Le crochet de ligne reçoit chaque ligne après les étages, pendant
+// qu'elle est encore en cache.
+template <typename... Stages>
+class PixelPipeline {
+public:
+    template <typename Stage>
+    Stage& Get() { return std::get<Stage>(stages_); }
+    template <typename Stage>
+    const Stage& Get() const { return std::get<Stage>(stages_); }
+
+    // pixels : width × height pixels de bytes_per_pixel octets, lignes
+    // contiguës. false pour un format sans instance.
+    bool Run(const uint8_t* pixels, int width, int height, int bytes_per_pixel) {
+        return Run(pixels, width, height, bytes_per_pixel, [](const PipelineRow&) {});
+    }
+
+    template <typename RowHook>
+    bool Run(const uint8_t* pixels, int width, int height, int bytes_per_pixel, RowHook&& hook) {
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+        return Dispatch(static_cast<PixelFormats*>(nullptr), pixels, width, height, bytes_per_pixel, hook);
+    }
+
+private:
+    static constexpr int LUMA_ROWS = 3;  // ligne courante et les deux du dessus
+
+    std::tuple<Stages...> stages_;
+    std::vector<uint8_t> luma_;
+
+    template <typename RowHook, typename... Formats>
+    bool Dispatch(std::tuple<Formats...>*, const uint8_t* pixels, int width, int height,
+                  int bytes_per_pixel, RowHook& hook) {
+        return ((bytes_per_pixel == Formats::BYTES &&
+                 (RunFormat<Formats>(pixels, width, height, hook), true)) || ...);
+    }
+
+    template <typename Format, typename RowHook>
+    void RunFormat(const uint8_t* pixels, int width, int height, RowHook& hook) {
+        PipelineFrame frame{width, height, Format::BYTES};
+        std::apply([&frame](auto&... stage) { (stage.Begin(frame), ...); }, stages_);
+
+        luma_.resize(static_cast<size_t>(width) * LUMA_ROWS);
+        size_t stride = static_cast<size_t>(width) * Format::BYTES;
+        PipelineRow row{nullptr, nullptr, {nullptr, nullptr}, 0, width};
+        for (int y = 0; y < height; ++y) {
+            row.y = y;
+            row.pixels = pixels + static_cast<size_t>(y) * stride;
+            row.above[1] = row.above[0];
+            row.above[0] = row.luma;
+            row.luma = Format::Luma(row.pixels, width, &luma_[static_cast<size_t>(y % LUMA_ROWS) * width]);
+            std::apply([&row](auto&... stage) { (stage.template Row<Format>(row), ...); }, stages_);
+            hook(static_cast<const PipelineRow&>(row));
+        }
+
+        std::apply([](auto&... stage) { (stage.End(), ...); }, stages_);
+    }
+};
+
+#endif // PIXEL_PIPELINE_H
@@ -0,0 +1,834 @@
+// src/quantized_cnn.cpp
+#include "quantized_cnn.h"
+#include "detector_checkpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QUANTIZED_CNN_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace QuantizedCnnConstants;
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'Q', 'N', 'N'};
+
+// acc[p × outputs + o] += Σ in[p × in_stride + i] × w[o × w_stride + i], i < n
+using DotAccumulateFn = void (*)(const uint8_t* in, size_t in_stride, int pixels,
+                                 const int8_t* w, size_t w_stride, int n, int outputs, int32_t* acc);
+// acc[c] += in[c] × w[c], c < channels
+using MultiplyAccumulateFn = void (*)(const uint8_t* in, const int8_t* w, int channels, int32_t* acc);
+
+struct KernelTable {
+    DotAccumulateFn dot;
+    MultiplyAccumulateFn multiply;
+};
+
+void DotAccumulateScalar(const uint8_t* in, size_t in_stride, int pixels,
+                         const int8_t* w, size_t w_stride, int n, int outputs, int32_t* acc) {
+    for (int p = 0; p < pixels; ++p) {
+        const uint8_t* row = in + p * in_stride;
+        int32_t* out = acc + static_cast<size_t>(p) * outputs;
+        for (int o = 0; o < outputs; ++o) {
+            const int8_t* weights = w + o * w_stride;
+            int32_t sum = 0;
+            for (int i = 0; i < n; ++i) {
+                sum += row[i] * weights[i];
+            }
+            out[o] += sum;
+        }
+    }
+}
+
+void MultiplyAccumulateScalar(const uint8_t* in, const int8_t* w, int channels, int32_t* acc) {
+    for (int c = 0; c < channels; ++c) {
+        acc[c] += in[c] * w[c];
+    }
+}
+
+#ifdef QUANTIZED_CNN_X86
+// Noyaux compilés pour leur jeu d'instructions seulement (attribut target) :
+// le reste du binaire reste exécutable sur tout x86-64, le choix se fait à
+// l'exécution (DetectKernels).
+
+// Sommes horizontales de quatre accumulateurs : [Σa, Σb, Σc, Σd]
+__attribute__((target("avx2")))
+inline __m128i ReduceFour(__m256i a, __m256i b, __m256i c, __m256i d) {
+    __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(a, b), _mm256_hadd_epi32(c, d));
+    return _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+}
+
+__attribute__((target("avx2")))
+inline __m256i MultiplyAddAvx2(__m256i sum, const uint8_t* in, const int8_t* w) {
+    // u8 et s8 élargis à 16 bits : vpmaddwd ne sature pas (|somme de 2 produits| < 2^16)
+    __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+    __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w)));
+    return _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+}
+
+__attribute__((target("avx2")))
+void DotAccumulateAvx2(const uint8_t* in, size_t in_stride, int pixels,
+                       const int8_t* w, size_t w_stride, int n, int outputs, int32_t* acc) {
+    if (n < 16) {
+        // Segments courts (première convolution) : rien à vectoriser par sortie
+        DotAccumulateScalar(in, in_stride, pixels, w, w_stride, n, outputs, acc);
+        return;
+    }
+    int vector_end = n & ~15;
+    for (int p = 0; p < pixels; ++p) {
+        const uint8_t* row = in + p * in_stride;
+        int32_t* out = acc + static_cast<size_t>(p) * outputs;
+        int o = 0;
+        // Quatre sorties à la fois : une seule réduction horizontale pour quatre
+        for (; o + 4 <= outputs; o += 4) {
+            const int8_t* w0 = w + o * w_stride;
+            __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+            for (int i = 0; i < vector_end; i += 16) {
+                s0 = MultiplyAddAvx2(s0, row + i, w0 + i);
+                s1 = MultiplyAddAvx2(s1, row + i, w0 + w_stride + i);
+                s2 = MultiplyAddAvx2(s2, row + i, w0 + 2 * w_stride + i);
+                s3 = MultiplyAddAvx2(s3, row + i, w0 + 3 * w_stride + i);
+            }
+            auto* target = reinterpret_cast<__m128i*>(out + o);
+            _mm_storeu_si128(target, _mm_add_epi32(_mm_loadu_si128(target), ReduceFour(s0, s1, s2, s3)));
+            for (int k = 0; k < 4; ++k) {
+                const int8_t* weights = w0 + k * w_stride;
+                for (int i = vector_end; i < n; ++i) {
+                    out[o + k] += row[i] * weights[i];
+                }
+            }
+        }
+        for (; o < outputs; ++o) {
+            const int8_t* weights = w + o * w_stride;
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < vector_end; i += 16) {
+                sum = MultiplyAddAvx2(sum, row + i, weights + i);
+            }
+            __m256i zero = _mm256_setzero_si256();
+            int32_t total = _mm_cvtsi128_si32(ReduceFour(sum, zero, zero, zero));
+            for (int i = vector_end; i < n; ++i) {
+                total += row[i] * weights[i];
+            }
+            out[o] += total;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void MultiplyAccumulateAvx2(const uint8_t* in, const int8_t* w, int channels, int32_t* acc) {
+    int c = 0;
+    for (; c + 16 <= channels; c += 16) {
+        __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + c)));
+        __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + c)));
+        __m256i product = _mm256_mullo_epi16(a, b);  // |u8 × s8| < 2^15 : exact
+        __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(product));
+        __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(product, 1));
+        auto* out = reinterpret_cast<__m256i*>(acc + c);
+        _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), low));
+        _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1), high));
+    }
+    for (; c < channels; ++c) {
+        acc[c] += in[c] * w[c];
+    }
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+inline __m256i FoldVnni(__m512i sum) {
+    // Variantes masquées : les autres s'appuient sur _mm256_undefined_si256(),
+    // que GCC 12 signale à tort comme non initialisé
+    return _mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xF, sum, 0),
+                            _mm512_maskz_extracti64x4_epi64(0xF, sum, 1));
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+void DotAccumulateVnni(const uint8_t* in, size_t in_stride, int pixels,
+                       const int8_t* w, size_t w_stride, int n, int outputs, int32_t* acc) {
+    for (int p = 0; p < pixels; ++p) {
+        const uint8_t* row = in + p * in_stride;
+        int32_t* out = acc + static_cast<size_t>(p) * outputs;
+        int o = 0;
+        // Chargements masqués : pas de lecture au-delà de n, pas de reste scalaire
+        for (; o + 4 <= outputs; o += 4) {
+            const int8_t* w0 = w + o * w_stride;
+            __m512i s0 = _mm512_setzero_si512(), s1 = s0, s2 = s0, s3 = s0;
+            for (int i = 0; i < n; i += 64) {
+                __mmask64 mask = n - i >= 64 ? ~__mmask64(0) : (__mmask64(1) << (n - i)) - 1;
+                __m512i a = _mm512_maskz_loadu_epi8(mask, row + i);
+                s0 = _mm512_dpbusd_epi32(s0, a, _mm512_maskz_loadu_epi8(mask, w0 + i));
+                s1 = _mm512_dpbusd_epi32(s1, a, _mm512_maskz_loadu_epi8(mask, w0 + w_stride + i));
+                s2 = _mm512_dpbusd_epi32(s2, a, _mm512_maskz_loadu_epi8(mask, w0 + 2 * w_stride + i));
+                s3 = _mm512_dpbusd_epi32(s3, a, _mm512_maskz_loadu_epi8(mask, w0 + 3 * w_stride + i));
+            }
+            auto* target = reinterpret_cast<__m128i*>(out + o);
+            __m128i sums = ReduceFour(FoldVnni(s0), FoldVnni(s1), FoldVnni(s2), FoldVnni(s3));
+            _mm_storeu_si128(target, _mm_add_epi32(_mm_loadu_si128(target), sums));
+        }
+        for (; o < outputs; ++o) {
+            const int8_t* weights = w + o * w_stride;
+            __m512i sum = _mm512_setzero_si512();
+            for (int i = 0; i < n; i += 64) {
+                __mmask64 mask = n - i >= 64 ? ~__mmask64(0) : (__mmask64(1) << (n - i)) - 1;
+                sum = _mm512_dpbusd_epi32(sum, _mm512_maskz_loadu_epi8(mask, row + i),
+                                          _mm512_maskz_loadu_epi8(mask, weights + i));
+            }
+            __m256i zero = _mm256_setzero_si256();
+            out[o] += _mm_cvtsi128_si32(ReduceFour(FoldVnni(sum), zero, zero, zero));
+        }
+    }
+}
+#endif
+
+KernelTable GetKernelTable(QuantizedKernels kernels) {
+    switch (kernels) {
+#ifdef QUANTIZED_CNN_X86
+        case QuantizedKernels::AVX512_VNNI:
+            return {DotAccumulateVnni, MultiplyAccumulateAvx2};
+        case QuantizedKernels::AVX2:
+            return {DotAccumulateAvx2, MultiplyAccumulateAvx2};
+#endif
+        default:
+            return {DotAccumulateScalar, MultiplyAccumulateScalar};
+    }
+}
+
+int OutputSize(int size, int stride) {
+    return (size + stride - 1) / stride;
+}
+
+// Lecture bornée du fichier de modèle
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size), offset_(0) {}
+
+    template <typename T>
+    bool Read(T* value) {
+        return ReadBytes(value, sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadArray(std::vector<T>* values, size_t count) {
+        if (count > (size_ - offset_) / sizeof(T)) {
+            return false;
+        }
+        values->resize(count);
+        return ReadBytes(values->data(), count * sizeof(T));
+    }
+
+    bool ReadBytes(void* out, size_t count) {
+        if (count > size_ - offset_) {
+            return false;
+        }
+        std::memcpy(out, data_ + offset_, count);
+        offset_ += count;
+        return true;
+    }
+
+    bool AtEnd() const { return offset_ == size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+};
+
+void AppendBytes(std::vector<uint8_t>* out, const void* bytes, size_t count) {
+    size_t offset = out->size();
+    out->resize(offset + count);
+    if (count > 0) {
+        std::memcpy(out->data() + offset, bytes, count);
+    }
+}
+
+template <typename T>
+void Append(std::vector<uint8_t>* out, const T& value) {
+    AppendBytes(out, &value, sizeof(T));
+}
+
+template <typename T>
+void AppendArray(std::vector<uint8_t>* out, const std::vector<T>& values) {
+    AppendBytes(out, values.data(), values.size() * sizeof(T));
+}
+
+}  // namespace
+
+// =============================================================================
+// QuantizedNetwork
+// =============================================================================
+
+QuantizedNetwork::QuantizedNetwork()
+    : input_width_(0), input_height_(0), input_channels_(0), logit_scale_(1.0f),
+      ready_(false), macs_(0), kernels_(DetectKernels()) {
+}
+
+bool QuantizedNetwork::Load(const std::string& path, std::string* error) {
+    // Taille et signature vérifiées avant de lire le corps du fichier
+    std::error_code size_error;
+    uintmax_t size = std::filesystem::file_size(path, size_error);
+    std::ifstream file(path, std::ios::binary);
+    if (size_error || !file) {
+        if (error) *error = "Cannot open model file: " + path;
+        return false;
+    }
+    if (size > MAX_MODEL_BYTES) {
+        if (error) *error = path + ": Model file too large";
+        return false;
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(size));
+    if (size < sizeof(MAGIC) || !file.read(reinterpret_cast<char*>(bytes.data()), sizeof(MAGIC)) ||
+        std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        if (error) *error = path + ": Not a quantized model";
+        return false;
+    }
+    file.read(reinterpret_cast<char*>(bytes.data() + sizeof(MAGIC)), bytes.size() - sizeof(MAGIC));
+    bytes.resize(sizeof(MAGIC) + static_cast<size_t>(file.gcount()));
+    if (!Parse(bytes.data(), bytes.size(), error)) {
+        if (error) *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+bool QuantizedNetwork::Parse(const uint8_t* data, size_t size, std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (size < sizeof(MAGIC) + sizeof(uint32_t) * 2 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail("Not a quantized model");
+    }
+    uint32_t checksum = 0;
+    std::memcpy(&checksum, data + size - sizeof(checksum), sizeof(checksum));
+    if (DetectorCheckpoint::Checksum(data, size - sizeof(checksum)) != checksum) {
+        return fail("Model checksum mismatch");
+    }
+
+    Reader reader(data + sizeof(MAGIC), size - sizeof(MAGIC) - sizeof(checksum));
+    uint32_t version = 0;
+    uint16_t width = 0, height = 0, channels = 0, layer_count = 0, class_count = 0;
+    float logit_scale = 0.0f;
+    if (!reader.Read(&version) || version != FORMAT_VERSION) {
+        return fail("Unsupported model version");
+    }
+    if (!reader.Read(&width) || !reader.Read(&height) || !reader.Read(&channels) ||
+        !reader.Read(&layer_count) || !reader.Read(&class_count) || !reader.Read(&logit_scale)) {
+        return fail("Truncated model header");
+    }
+
+    QuantizedNetwork parsed;
+    parsed.SetInput(width, height, channels);
+    std::vector<std::string> names(class_count);
+    for (auto& name : names) {
+        uint8_t length = 0;
+        if (!reader.Read(&length)) {
+            return fail("Truncated class names");
+        }
+        name.resize(length);
+        if (!reader.ReadBytes(name.data(), length)) {
+            return fail("Truncated class names");
+        }
+    }
+    parsed.SetClasses(std::move(names), logit_scale);
+
+    for (uint16_t i = 0; i < layer_count; ++i) {
+        QuantizedLayer layer;
+        uint8_t type = 0, kernel = 0, stride = 0, reserved = 0;
+        uint16_t in_channels = 0, out_channels = 0;
+        if (!reader.Read(&type) || !reader.Read(&kernel) || !reader.Read(&stride) || !reader.Read(&reserved) ||
+            !reader.Read(&in_channels) || !reader.Read(&out_channels)) {
+            return fail("Truncated layer " + std::to_string(i));
+        }
+        layer.type = static_cast<QuantizedLayer::Type>(type);
+        layer.kernel = kernel;
+        layer.stride = stride;
+        layer.in_channels = in_channels;
+        layer.out_channels = out_channels;
+
+        size_t weight_count = 0;
+        size_t parameter_count = out_channels;
+        switch (layer.type) {
+            case QuantizedLayer::Type::CONV:
+                weight_count = static_cast<size_t>(out_channels) * kernel * kernel * in_channels;
+                break;
+            case QuantizedLayer::Type::DEPTHWISE:
+                weight_count = static_cast<size_t>(kernel) * kernel * in_channels;
+                break;
+            case QuantizedLayer::Type::POINTWISE:
+            case QuantizedLayer::Type::FULLY_CONNECTED:
+                weight_count = static_cast<size_t>(out_channels) * in_channels;
+                break;
+            case QuantizedLayer::Type::GLOBAL_POOL:
+                parameter_count = 0;
+                break;
+            default:
+                return fail("Unknown layer type " + std::to_string(type));
+        }
+        if (!reader.ReadArray(&layer.weights, weight_count) || !reader.ReadArray(&layer.bias, parameter_count) ||
+            !reader.ReadArray(&layer.multipliers, parameter_count) ||
+            !reader.ReadArray(&layer.shifts, parameter_count)) {
+            return fail("Truncated layer " + std::to_string(i));
+        }
+        parsed.AddLayer(std::move(layer));
+    }
+    if (!reader.AtEnd()) {
+        return fail("Trailing bytes after layers");
+    }
+    if (!parsed.Finalize(error)) {
+        return false;
+    }
+
+    parsed.kernels_ = kernels_;
+    *this = std::move(parsed);
+    return true;
+}
+
+std::vector<uint8_t> QuantizedNetwork::Serialize() const {
+    std::vector<uint8_t> out;
+    AppendBytes(&out, MAGIC, sizeof(MAGIC));
+    Append(&out, FORMAT_VERSION);
+    Append(&out, static_cast<uint16_t>(input_width_));
+    Append(&out, static_cast<uint16_t>(input_height_));
+    Append(&out, static_cast<uint16_t>(input_channels_));
+    Append(&out, static_cast<uint16_t>(layers_.size()));
+    Append(&out, static_cast<uint16_t>(class_names_.size()));
+    Append(&out, logit_scale_);
+    for (const auto& name : class_names_) {
+        size_t length = std::min<size_t>(name.size(), 255);
+        Append(&out, static_cast<uint8_t>(length));
+        AppendBytes(&out, name.data(), length);
+    }
+    for (const auto& layer : layers_) {
+        Append(&out, static_cast<uint8_t>(layer.type));
+        Append(&out, static_cast<uint8_t>(layer.kernel));
+        Append(&out, static_cast<uint8_t>(layer.stride));
+        Append(&out, static_cast<uint8_t>(0));
+        Append(&out, static_cast<uint16_t>(layer.in_channels));
+        Append(&out, static_cast<uint16_t>(layer.out_channels));
+        AppendArray(&out, layer.weights);
+        AppendArray(&out, layer.bias);
+        AppendArray(&out, layer.multipliers);
+        AppendArray(&out, layer.shifts);
+    }
+    Append(&out, DetectorCheckpoint::Checksum(out.data(), out.size()));
+    return out;
+}
+
+void QuantizedNetwork::SetInput(int width, int height, int channels) {
+    input_width_ = width;
+    input_height_ = height;
+    input_channels_ = channels;
+    ready_ = false;
+}
+
+void QuantizedNetwork::AddLayer(QuantizedLayer layer) {
+    layers_.push_back(std::move(layer));
+    ready_ = false;
+}
+
+void QuantizedNetwork::SetClasses(std::vector<std::string> names, float logit_scale) {
+    class_names_ = std::move(names);
+    logit_scale_ = logit_scale;
+    ready_ = false;
+}
+
+bool QuantizedNetwork::Finalize(std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+    ready_ = false;
+    shapes_.clear();
+    macs_ = 0;
+    if (input_width_ < 1 || input_width_ > MAX_INPUT_SIZE || input_height_ < 1 || input_height_ > MAX_INPUT_SIZE ||
+        (input_channels_ != 1 && input_channels_ != 3)) {
+        return fail("Unsupported input shape");
+    }
+    if (layers_.empty() || layers_.size() > static_cast<size_t>(MAX_LAYERS)) {
+        return fail("Unsupported layer count");
+    }
+    if (class_names_.size() < 2 || class_names_.size() > static_cast<size_t>(MAX_CLASSES) ||
+        !std::isfinite(logit_scale_) || logit_scale_ <= 0.0f) {
+        return fail("Unsupported classes");
+    }
+
+    Shape shape{input_height_, input_width_, input_channels_};
+    size_t max_activation = 0;
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        const QuantizedLayer& layer = layers_[i];
+        std::string name = "Layer " + std::to_string(i) + ": ";
+        bool last = i + 1 == layers_.size();
+        shapes_.push_back(shape);
+
+        int pixels = shape.height * shape.width;
+        int flat = pixels * shape.channels;
+        bool spatial = layer.type == QuantizedLayer::Type::CONV || layer.type == QuantizedLayer::Type::DEPTHWISE;
+        if (spatial && (layer.kernel < 1 || layer.kernel > MAX_KERNEL || layer.kernel % 2 == 0 ||
+                        layer.stride < 1 || layer.stride > MAX_STRIDE)) {
+            return fail(name + "unsupported kernel or stride");
+        }
+        if (layer.in_channels != (layer.type == QuantizedLayer::Type::FULLY_CONNECTED ? flat : shape.channels)) {
+            return fail(name + "input size mismatch");
+        }
+        if (layer.out_channels < 1 || layer.out_channels > MAX_CHANNELS) {
+            return fail(name + "unsupported output channels");
+        }
+
+        size_t weight_count = 0;
+        Shape next = shape;
+        switch (layer.type) {
+            case QuantizedLayer::Type::CONV:
+                weight_count = static_cast<size_t>(layer.out_channels) * layer.kernel * layer.kernel * layer.in_channels;
+                next = {OutputSize(shape.height, layer.stride), OutputSize(shape.width, layer.stride), layer.out_channels};
+                macs_ += static_cast<int64_t>(next.height) * next.width * weight_count;
+                break;
+            case QuantizedLayer::Type::DEPTHWISE:
+                if (layer.out_channels != layer.in_channels) {
+                    return fail(name + "depthwise layers keep their channels");
+                }
+                weight_count = static_cast<size_t>(layer.kernel) * layer.kernel * layer.in_channels;
+                next = {OutputSize(shape.height, layer.stride), OutputSize(shape.width, layer.stride), layer.out_channels};
+                macs_ += static_cast<int64_t>(next.height) * next.width * weight_count;
+                break;
+            case QuantizedLayer::Type::POINTWISE:
+                weight_count = static_cast<size_t>(layer.out_channels) * layer.in_channels;
+                next.channels = layer.out_channels;
+                macs_ += static_cast<int64_t>(pixels) * weight_count;
+                break;
+            case QuantizedLayer::Type::GLOBAL_POOL:
+                if (layer.out_channels != layer.in_channels) {
+                    return fail(name + "pooling keeps its channels");
+                }
+                next = {1, 1, shape.channels};
+                break;
+            case QuantizedLayer::Type::FULLY_CONNECTED:
+                weight_count = static_cast<size_t>(layer.out_channels) * layer.in_channels;
+                next = {1, 1, layer.out_channels};
+                macs_ += static_cast<int64_t>(weight_count);
+                break;
+            default:
+                return fail(name + "unknown type");
+        }
+
+        size_t parameter_count = layer.type == QuantizedLayer::Type::GLOBAL_POOL ? 0 : layer.out_channels;
+        if (layer.weights.size() != weight_count || layer.bias.size() != parameter_count ||
+            layer.multipliers.size() != parameter_count || layer.shifts.size() != parameter_count) {
+            return fail(name + "parameter count mismatch");
+        }
+        for (size_t o = 0; o < parameter_count; ++o) {
+            if (layer.multipliers[o] <= 0 || layer.shifts[o] < -31 || layer.shifts[o] > 30) {
+                return fail(name + "invalid requantization");
+            }
+        }
+        // Pire cas de l'accumulateur 32 bits : chaque produit vaut au plus
+        // 255 × 128 (u8 × s8), sur la longueur de la réduction d'une sortie
+        if (parameter_count > 0) {
+            int64_t reduction = static_cast<int64_t>(weight_count / parameter_count);
+            int64_t max_bias = 0;
+            for (int32_t bias : layer.bias) {
+                max_bias = std::max(max_bias, std::abs(static_cast<int64_t>(bias)));
+            }
+            if (reduction * MAX_ACTIVATION * MAX_WEIGHT_MAGNITUDE + max_bias > INT32_MAX) {
+                return fail(name + "accumulator may overflow");
+            }
+        }
+        if (last && layer.type != QuantizedLayer::Type::FULLY_CONNECTED) {
+            return fail(name + "the last layer must be fully connected");
+        }
+        if (last && layer.out_channels != static_cast<int>(class_names_.size())) {
+            return fail(name + "one output per class expected");
+        }
+
+        shape = next;
+        max_activation = std::max(max_activation, static_cast<size_t>(shape.height) * shape.width * shape.channels);
+    }
+
+    activations_[0].resize(max_activation);
+    activations_[1].resize(max_activation);
+    logits_.assign(class_names_.size(), 0);
+    ready_ = true;
+    return true;
+}
+
+const std::vector<int32_t>& QuantizedNetwork::Run(const uint8_t* input) {
+    if (!ready_) {
+        logits_.clear();
+        return logits_;
+    }
+
+    const uint8_t* current = input;
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        const QuantizedLayer& layer = layers_[i];
+        const Shape& shape = shapes_[i];
+        uint8_t* output = activations_[i % 2].data();
+        switch (layer.type) {
+            case QuantizedLayer::Type::CONV:
+                RunConv(layer, shape, current, output);
+                break;
+            case QuantizedLayer::Type::DEPTHWISE:
+                RunDepthwise(layer, shape, current, output);
+                break;
+            case QuantizedLayer::Type::POINTWISE:
+                RunPointwise(layer, shape, current, output);
+                break;
+            case QuantizedLayer::Type::GLOBAL_POOL:
+                RunGlobalPool(shape, current, output);
+                break;
+            case QuantizedLayer::Type::FULLY_CONNECTED:
+                RunFullyConnected(layer, current, output, i + 1 == layers_.size());
+                break;
+        }
+        current = output;
+    }
+    return logits_;
+}
+
+std::vector<float> QuantizedNetwork::Classify(const uint8_t* input) {
+    const std::vector<int32_t>& logits = Run(input);
+    std::vector<float> probabilities(logits.size());
+    if (logits.empty()) {
+        return probabilities;
+    }
+    int32_t max_logit = *std::max_element(logits.begin(), logits.end());
+    float total = 0.0f;
+    for (size_t i = 0; i < logits.size(); ++i) {
+        probabilities[i] = std::exp(static_cast<float>(logits[i] - max_logit) * logit_scale_);
+        total += probabilities[i];
+    }
+    for (float& probability : probabilities) {
+        probability /= total;
+    }
+    return probabilities;
+}
+
+void QuantizedNetwork::SetKernels(QuantizedKernels kernels) {
+    kernels_ = std::min(kernels, DetectKernels());
+}
+
+QuantizedKernels QuantizedNetwork::DetectKernels() {
+#ifdef QUANTIZED_CNN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        return QuantizedKernels::AVX512_VNNI;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return QuantizedKernels::AVX2;
+    }
+#endif
+    return QuantizedKernels::SCALAR;
+}
+
+const char* QuantizedNetwork::KernelsToString(QuantizedKernels kernels) {
+    switch (kernels) {
+        case QuantizedKernels::SCALAR: return "scalar";
+        case QuantizedKernels::AVX2: return "avx2";
+        case QuantizedKernels::AVX512_VNNI: return "avx512_vnni";
+    }
+    return "unknown";
+}
+
+int32_t QuantizedNetwork::Requantize(int32_t accumulator, int32_t multiplier, int shift) {
+    // Produit exact sur 64 bits, puis division par 2^(31 - shift) arrondie
+    // au plus proche (moitiés loin de zéro)
+    int64_t product = static_cast<int64_t>(accumulator) * multiplier;
+    int total_shift = 31 - shift;
+    int64_t rounding = int64_t(1) << (total_shift - 1);
+    int64_t result = product >= 0 ? (product + rounding) >> total_shift
+                                  : -((-product + rounding) >> total_shift);
+    return static_cast<int32_t>(std::clamp<int64_t>(result, INT32_MIN, INT32_MAX));
+}
+
+void QuantizedNetwork::RunConv(const QuantizedLayer& layer, const Shape& in,
+                               const uint8_t* input, uint8_t* output) {
+    KernelTable table = GetKernelTable(kernels_);
+    int kernel = layer.kernel;
+    int pad = kernel / 2;
+    int out_height = OutputSize(in.height, layer.stride);
+    int out_width = OutputSize(in.width, layer.stride);
+    int out_channels = layer.out_channels;
+    size_t filter_size = static_cast<size_t>(kernel) * kernel * in.channels;
+    accumulators_.resize(static_cast<size_t>(out_width) * out_channels);
+
+    for (int oy = 0; oy < out_height; ++oy) {
+        for (int ox = 0; ox < out_width; ++ox) {
+            int32_t* acc = &accumulators_[static_cast<size_t>(ox) * out_channels];
+            std::copy(layer.bias.begin(), layer.bias.end(), acc);
+
+            // Pour chaque ligne du noyau, les colonnes valides sont contiguës
+            // en HWC : un seul produit scalaire de (kx_end - kx_begin) × entrée
+            int x0 = ox * layer.stride - pad;
+            int kx_begin = std::max(0, -x0);
+            int kx_end = std::min(kernel, in.width - x0);
+            int length = (kx_end - kx_begin) * in.channels;
+            for (int ky = 0; ky < kernel; ++ky) {
+                int y = oy * layer.stride - pad + ky;
+                if (y < 0 || y >= in.height || length <= 0) {
+                    continue;
+                }
+                const uint8_t* segment = input + (static_cast<size_t>(y) * in.width + x0 + kx_begin) * in.channels;
+                const int8_t* weights = layer.weights.data() + (static_cast<size_t>(ky) * kernel + kx_begin) * in.channels;
+                table.dot(segment, 0, 1, weights, filter_size, length, out_channels, acc);
+            }
+        }
+        Store(layer, accumulators_.data(), out_width, output + static_cast<size_t>(oy) * out_width * out_channels);
+    }
+}
+
+void QuantizedNetwork::RunDepthwise(const QuantizedLayer& layer, const Shape& in,
+                                    const uint8_t* input, uint8_t* output) {
+    KernelTable table = GetKernelTable(kernels_);
+    int kernel = layer.kernel;
+    int pad = kernel / 2;
+    int out_height = OutputSize(in.height, layer.stride);
+    int out_width = OutputSize(in.width, layer.stride);
+    int channels = in.channels;
+    accumulators_.resize(static_cast<size_t>(out_width) * channels);
+
+    for (int oy = 0; oy < out_height; ++oy) {
+        for (int ox = 0; ox < out_width; ++ox) {
+            int32_t* acc = &accumulators_[static_cast<size_t>(ox) * channels];
+            std::copy(layer.bias.begin(), layer.bias.end(), acc);
+            for (int ky = 0; ky < kernel; ++ky) {
+                int y = oy * layer.stride - pad + ky;
+                if (y < 0 || y >= in.height) {
+                    continue;
+                }
+                for (int kx = 0; kx < kernel; ++kx) {
+                    int x = ox * layer.stride - pad + kx;
+                    if (x < 0 || x >= in.width) {
+                        continue;
+                    }
+                    table.multiply(input + (static_cast<size_t>(y) * in.width + x) * channels,
+                                   layer.weights.data() + (static_cast<size_t>(ky) * kernel + kx) * channels,
+                                   channels, acc);
+                }
+            }
+        }
+        Store(layer, accumulators_.data(), out_width, output + static_cast<size_t>(oy) * out_width * channels);
+    }
+}
+
+void QuantizedNetwork::RunPointwise(const QuantizedLayer& layer, const Shape& in,
+                                    const uint8_t* input, uint8_t* output) {
+    KernelTable table = GetKernelTable(kernels_);
+    int out_channels = layer.out_channels;
+    accumulators_.resize(static_cast<size_t>(in.width) * out_channels);
+
+    for (int y = 0; y < in.height; ++y) {
+        for (int x = 0; x < in.width; ++x) {
+            std::copy(layer.bias.begin(), layer.bias.end(), &accumulators_[static_cast<size_t>(x) * out_channels]);
+        }
+        const uint8_t* row = input + static_cast<size_t>(y) * in.width * in.channels;
+        table.dot(row, in.channels, in.width, layer.weights.data(), in.channels, in.channels,
+                  out_channels, accumulators_.data());
+        Store(layer, accumulators_.data(), in.width, output + static_cast<size_t>(y) * in.width * out_channels);
+    }
+}
+
+void QuantizedNetwork::RunGlobalPool(const Shape& in, const uint8_t* input, uint8_t* output) const {
+    int pixels = in.height * in.width;
+    for (int c = 0; c < in.channels; ++c) {
+        int64_t sum = 0;
+        for (int p = 0; p < pixels; ++p) {
+            sum += input[static_cast<size_t>(p) * in.channels + c];
+        }
+        output[c] = static_cast<uint8_t>((sum + pixels / 2) / pixels);
+    }
+}
+
+void QuantizedNetwork::RunFullyConnected(const QuantizedLayer& layer, const uint8_t* input,
+                                         uint8_t* output, bool last) {
+    KernelTable table = GetKernelTable(kernels_);
+    accumulators_.assign(layer.bias.begin(), layer.bias.end());
+    table.dot(input, 0, 1, layer.weights.data(), layer.in_channels, layer.in_channels,
+              layer.out_channels, accumulators_.data());
+    if (last) {
+        logits_.assign(accumulators_.begin(), accumulators_.end());
+    } else {
+        Store(layer, accumulators_.data(), 1, output);
+    }
+}
+
+void QuantizedNetwork::Store(const QuantizedLayer& layer, const int32_t* accumulators, int pixels,
+                             uint8_t* output) const {
+    int channels = layer.out_channels;
+    for (int p = 0; p < pixels; ++p) {
+        for (int o = 0; o < channels; ++o) {
+            int32_t value = Requantize(accumulators[static_cast<size_t>(p) * channels + o],
+                                       layer.multipliers[o], layer.shifts[o]);
+            output[static_cast<size_t>(p) * channels + o] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+    }
+}
+
+// =============================================================================
+// CnnClassifier
+// =============================================================================
+
+CnnClassifier::CnnClassifier() : min_confidence_(DEFAULT_MIN_CONFIDENCE) {
+}
+
+bool CnnClassifier::Load(const std::string& path, std::string* error) {
+    return network_.Load(path, error);
+}
+
+void CnnClassifier::SetMinConfidence(float confidence) {
+    min_confidence_ = std::clamp(confidence, 0.0f, 1.0f);
+}
+
+std::vector<Detection> CnnClassifier::Detect(const Frame& crop) {
+    int bytes_per_pixel = FrameUtils::BytesPerPixel(crop.format);
+    if (!network_.IsReady() || bytes_per_pixel == 0 ||
+        crop.PixelBytes() < static_cast<size_t>(crop.width) * crop.height * bytes_per_pixel) {
+        return {};
+    }
+
+    // Imagette aux dimensions et au nombre de canaux du réseau
+    int width = network_.GetInputWidth();
+    int height = network_.GetInputHeight();
+    int channels = network_.GetInputChannels();
+    Frame resized;
+    const Frame* source = &crop;
+    if (crop.width != width || crop.height != height) {
+        resized = FrameUtils::ResizeRegion(crop, FrameRegion(0, 0, crop.width, crop.height), width, height);
+        if (resized.data.empty()) {
+            return {};
+        }
+        source = &resized;
+    }
+    const uint8_t* pixels = source->Pixels();
+    size_t count = static_cast<size_t>(width) * height;
+    input_.resize(count * channels);
+    if (channels == bytes_per_pixel) {
+        std::copy(pixels, pixels + input_.size(), input_.begin());
+    } else if (channels == 1) {
+        for (size_t i = 0; i < count; ++i, pixels += 3) {
+            input_[i] = static_cast<uint8_t>((pixels[0] + 2 * pixels[1] + pixels[2]) >> 2);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            std::fill_n(&input_[i * 3], 3, pixels[i]);
+        }
+    }
+
+    std::vector<float> probabilities = network_.Classify(input_.data());
+    auto best = std::max_element(probabilities.begin(), probabilities.end());
+    const std::string& name = network_.GetClassNames()[best - probabilities.begin()];
+    if (name == BACKGROUND_CLASS || *best < min_confidence_) {
+        return {};
+    }
+
+    Detection detection;
+    detection.set_type(name);
+    detection.set_confidence(*best);
+    auto* bbox = detection.mutable_bbox();
+    bbox->set_width(crop.width);
+    bbox->set_height(crop.height);
+    (*detection.mutable_metadata())["kernels"] = QuantizedNetwork::KernelsToString(network_.GetKernels());
+    return {detection};
+}
@@ -0,0 +1,167 @@
+// src/quantized_cnn.h
+#ifndef QUANTIZED_CNN_H
+#define QUANTIZED_CNN_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "frame_processor.h"
+
+// Jeux de noyaux de calcul. Tout est entier : les résultats sont
+// identiques au bit près quel que soit le jeu.
+enum class QuantizedKernels {
+    SCALAR,
+    AVX2,         // produits 16 bits élargis à 32 bits
+    AVX512_VNNI   // vpdpbusd : 4 produits u8 × s8 accumulés par voie
+};
+
+// Couche d'un réseau quantifié. Les activations sont des u8 entrelacés
+// (HWC) de point zéro 0 : chaque couche, sauf la dernière, ramène ses
+// accumulateurs 32 bits à l'échelle de sortie (multiplicateur Q31 et
+// décalage par canal) puis les borne à [0, 255], ce qui fait office de
+// ReLU. La dernière couche, entièrement connectée, donne des logits
+// entiers.
+struct QuantizedLayer {
+    enum class Type : uint8_t {
+        CONV = 1,             // K × K, poids [sortie][ky][kx][entrée]
+        DEPTHWISE = 2,        // K × K par canal, poids [ky][kx][canal]
+        POINTWISE = 3,        // 1 × 1, poids [sortie][entrée]
+        GLOBAL_POOL = 4,      // moyenne par canal, sans paramètres
+        FULLY_CONNECTED = 5   // entrée aplatie, poids [sortie][entrée]
+    };
+
+    Type type = Type::CONV;
+    int kernel = 1;           // CONV, DEPTHWISE : impair
+    int stride = 1;           // CONV, DEPTHWISE ; remplissage "same"
+    int in_channels = 0;      // FULLY_CONNECTED : taille de l'entrée aplatie
+    int out_channels = 0;
+    std::vector<int8_t> weights;
+    std::vector<int32_t> bias;         // par canal de sortie
+    std::vector<int32_t> multipliers;  // Q31, dans [2^30, 2^31)
+    std::vector<int8_t> shifts;        // > 0 : vers la gauche, < 0 : vers la droite
+};
+
+// Petit moteur d'inférence CNN int8 pour classer des imagettes sur CPU,
+// sans dépendance. Convolutions directes (ni im2col ni copie de patch) :
+// pour chaque ligne du noyau, les K × entrée octets du voisinage sont
+// contigus en HWC et multipliés d'un bloc par les poids.
+//
+// Format de fichier (petit-boutiste) :
+//   "VQNN" | version u32 | largeur u16 | hauteur u16 | canaux u16 |
+//   couches u16 | classes u16 | échelle des logits f32 |
+//   classes : longueur u8 + nom |
+//   couches : type u8 | noyau u8 | pas u8 | réservé u8 | entrée u16 |
+//             sortie u16 | poids s8 | biais s32 | multiplicateurs s32 |
+//             décalages s8 |
+//   CRC32 u32 de tout ce qui précède
+//
+// Run() n'est pas réentrant (tampons internes) : un réseau par thread.
+class QuantizedNetwork {
+public:
+    QuantizedNetwork();
+
+    bool Load(const std::string& path, std::string* error = nullptr);
+    bool Parse(const uint8_t* data, size_t size, std::string* error = nullptr);
+    std::vector<uint8_t> Serialize() const;
+
+    // Construction directe (outils de conversion, tests), puis Finalize()
+    void SetInput(int width, int height, int channels);
+    void AddLayer(QuantizedLayer layer);
+    void SetClasses(std::vector<std::string> names, float logit_scale);
+    bool Finalize(std::string* error = nullptr);  // vérifie les formes
+    bool IsReady() const { return ready_; }
+
+    int GetInputWidth() const { return input_width_; }
+    int GetInputHeight() const { return input_height_; }
+    int GetInputChannels() const { return input_channels_; }
+    const std::vector<std::string>& GetClassNames() const { return class_names_; }
+    int64_t GetMacsPerInference() const { return macs_; }
+
+    // Logits d'une entrée u8 HWC aux dimensions d'entrée
+    const std::vector<int32_t>& Run(const uint8_t* input);
+    // Probabilités : softmax des logits × échelle des logits
+    std::vector<float> Classify(const uint8_t* input);
+
+    // Jeu de noyaux, ramené au meilleur que le processeur supporte
+    void SetKernels(QuantizedKernels kernels);
+    QuantizedKernels GetKernels() const { return kernels_; }
+    static QuantizedKernels DetectKernels();
+    static const char* KernelsToString(QuantizedKernels kernels);
+
+    // round(acc × multiplier × 2^shift / 2^31), arrondi au plus proche
+    static int32_t Requantize(int32_t accumulator, int32_t multiplier, int shift);
+
+private:
+    int input_width_;
+    int input_height_;
+    int input_channels_;
+    std::vector<QuantizedLayer> layers_;
+    std::vector<std::string> class_names_;
+    float logit_scale_;
+    bool ready_;
+    int64_t macs_;
+    QuantizedKernels kernels_;
+
+    // Formes d'entrée de chaque couche (hauteur, largeur, canaux)
+    struct Shape {
+        int height;
+        int width;
+        int channels;
+    };
+    std::vector<Shape> shapes_;
+
+    // Tampons réutilisés d'une inférence à l'autre
+    std::vector<uint8_t> activations_[2];
+    std::vector<int32_t> accumulators_;
+    std::vector<int32_t> logits_;
+
+    void RunConv(const QuantizedLayer& layer, const Shape& in, const uint8_t* input, uint8_t* output);
+    void RunDepthwise(const QuantizedLayer& layer, const Shape& in, const uint8_t* input, uint8_t* output);
+    void RunPointwise(const QuantizedLayer& layer, const Shape& in, const uint8_t* input, uint8_t* output);
+    void RunGlobalPool(const Shape& in, const uint8_t* input, uint8_t* output) const;
+    void RunFullyConnected(const QuantizedLayer& layer, const uint8_t* input, uint8_t* output, bool last);
+    void Store(const QuantizedLayer& layer, const int32_t* accumulators, int pixels, uint8_t* output) const;
+};
+
+// Second étage de la cascade : classe chaque imagette avec un réseau
+// quantifié. Une imagette dont la classe la plus probable n'est pas
+// BACKGROUND_CLASS et dépasse la confiance minimale donne une détection
+// couvrant toute l'imagette.
+class CnnClassifier : public Detector {
+public:
+    CnnClassifier();
+
+    bool Load(const std::string& path, std::string* error = nullptr);
+    QuantizedNetwork& GetNetwork() { return network_; }
+    void SetMinConfidence(float confidence);
+
+    std::vector<Detection> Detect(const Frame& crop) override;
+    std::string GetName() const override { return "CnnClassifier"; }
+    bool Initialize() override { return network_.IsReady(); }
+    void Cleanup() override {}
+    int GetInputWidth() const override { return network_.GetInputWidth(); }
+    int GetInputHeight() const override { return network_.GetInputHeight(); }
+
+private:
+    QuantizedNetwork network_;
+    float min_confidence_;
+    std::vector<uint8_t> input_;  // imagette au format du réseau
+};
+
+namespace QuantizedCnnConstants {
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr int MAX_INPUT_SIZE = 1024;
+    constexpr int MAX_LAYERS = 64;
+    constexpr int MAX_CHANNELS = 1024;
+    constexpr int MAX_CLASSES = 64;
+    constexpr int MAX_KERNEL = 7;
+    constexpr int MAX_STRIDE = 4;
+    constexpr int64_t MAX_ACTIVATION = 255;         // u8
+    constexpr int64_t MAX_WEIGHT_MAGNITUDE = 128;   // |-128|, s8
+    constexpr uintmax_t MAX_MODEL_BYTES = 64 * 1024 * 1024;  // refusé avant lecture
+    constexpr float DEFAULT_MIN_CONFIDENCE = 0.6f;
+    constexpr const char* BACKGROUND_CLASS = "other";
+}
+
+#endif // QUANTIZED_CNN_H
@@ -0,0 +1,108 @@
+// src/stats_block.h
+#ifndef STATS_BLOCK_H
+#define STATS_BLOCK_H
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Taille de ligne de cache utilisée pour séparer les données écrites par
+// des threads différents
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Seqlock à écrivain unique : l'écrivain publie une copie complète de T,
+// les lecteurs copient sans verrou et recommencent si une publication a eu
+// lieu pendant leur lecture. La donnée est stockée en mots atomiques
+// relâchés pour que la lecture concurrente ne soit pas une course.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+        Store(T{});
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Un seul thread à la fois
+    void Store(const T& value) {
+        std::array<uint64_t, WORDS> words{};
+        std::memcpy(words.data(), static_cast<const void*>(&value), sizeof(T));
+
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T Load() const {
+        std::array<uint64_t, WORDS> words;
+        uint64_t before;
+        uint64_t after;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // Nombre de publications (pair hors écriture)
+    uint64_t GetVersion() const {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, WORDS> words_;
+};
+
+// Bloc de statistiques : l'écrivain met à jour sa copie privée (sur sa
+// propre ligne de cache, sans atomiques) puis la publie ; les lecteurs ne
+// voient que des instantanés cohérents.
+template <typename T>
+class StatsBlock {
+public:
+    StatsBlock() = default;
+    StatsBlock(const StatsBlock&) = delete;
+    StatsBlock& operator=(const StatsBlock&) = delete;
+
+    // Écrivain uniquement
+    template <typename F>
+    void Update(F&& update) {
+        update(local_);
+        published_.Store(local_);
+    }
+
+    // Écrivain uniquement : lecture de sa propre copie
+    const T& Local() const { return local_; }
+
+    // N'importe quel thread
+    T Snapshot() const { return published_.Load(); }
+
+private:
+    alignas(CACHE_LINE_SIZE) T local_{};
+    SeqLock<T> published_;
+};
+
+#endif // STATS_BLOCK_H
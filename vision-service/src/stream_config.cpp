@@ -0,0 +1,51 @@
+// src/stream_config.cpp
+#include "stream_config.h"
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <google/protobuf/util/json_util.h>
+
+namespace StreamConfigFile {
+
+bool Load(const std::string& path, StreamsConfig* config, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        *error = "Cannot open config file: " + path;
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    if (!Parse(content.str(), config, error)) {
+        *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+bool Parse(const std::string& json, StreamsConfig* config, std::string* error) {
+    StreamsConfig parsed;
+    google::protobuf::util::JsonParseOptions options;
+    options.ignore_unknown_fields = false;  // une faute de frappe ne doit pas passer inaperçue
+    auto status = google::protobuf::util::JsonStringToMessage(json, &parsed, options);
+    if (!status.ok()) {
+        *error = "Invalid config: " + std::string(status.message());
+        return false;
+    }
+
+    std::unordered_set<std::string> camera_ids;
+    for (const auto& stream : parsed.streams()) {
+        if (stream.camera_id().empty() || stream.camera_url().empty()) {
+            *error = "Every stream needs a camera_id and a camera_url";
+            return false;
+        }
+        if (!camera_ids.insert(stream.camera_id()).second) {
+            *error = "Duplicate camera_id: " + stream.camera_id();
+            return false;
+        }
+    }
+
+    *config = std::move(parsed);
+    return true;
+}
+
+}  // namespace StreamConfigFile
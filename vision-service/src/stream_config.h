@@ -0,0 +1,19 @@
+// src/stream_config.h
+#ifndef STREAM_CONFIG_H
+#define STREAM_CONFIG_H
+
+#include <string>
+#include "vision.pb.h"
+
+using surveillance::vision::StreamsConfig;
+
+// Fichier de configuration des streams : un StreamsConfig en JSON, même
+// schéma que les requêtes StartStream (voir vision.proto)
+namespace StreamConfigFile {
+    // false avec un message d'erreur si le fichier est illisible, mal formé,
+    // ou si un camera_id est vide ou dupliqué
+    bool Load(const std::string& path, StreamsConfig* config, std::string* error);
+    bool Parse(const std::string& json, StreamsConfig* config, std::string* error);
+}
+
+#endif // STREAM_CONFIG_H
@@ -0,0 +1,140 @@
+// src/stream_placement.cpp
+#include "stream_placement.h"
+#include <algorithm>
+#include <map>
+
+StreamPlacer::StreamPlacer(const CpuTopology& topology) : topology_(topology) {
+    // Regroupement L3 -> L2 -> CPU, dans l'ordre des CPU
+    std::map<int, size_t> l3_index_of;
+    std::map<int, size_t> l2_index_of;
+    for (const auto& info : topology_.GetCpus()) {
+        auto l3 = l3_index_of.find(info.l3_domain);
+        if (l3 == l3_index_of.end()) {
+            l3 = l3_index_of.emplace(info.l3_domain, l3_domains_.size()).first;
+            l3_domains_.push_back(L3Domain());
+            l3_domains_.back().id = info.l3_domain;
+        }
+        auto l2 = l2_index_of.find(info.l2_domain);
+        if (l2 == l2_index_of.end()) {
+            l2 = l2_index_of.emplace(info.l2_domain, l2_domains_.size()).first;
+            L2Domain domain;
+            domain.numa_node = info.numa_node;
+            domain.l3_index = static_cast<int>(l3->second);
+            l2_domains_.push_back(domain);
+            l3_domains_[l3->second].l2_indices.push_back(l2->second);
+        }
+        l2_domains_[l2->second].cpus.push_back(info.cpu);
+        l3_domains_[l3->second].cpu_count++;
+    }
+}
+
+StreamPlacement StreamPlacer::Place(const std::string& stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = l2_of_stream_.find(stream_id);
+    if (it != l2_of_stream_.end()) {
+        return MakePlacement(it->second);
+    }
+    if (l2_domains_.empty()) {
+        return StreamPlacement();
+    }
+
+    size_t l2_index = ChooseL2Domain();
+    Assign(stream_id, l2_index);
+    stats_.placements++;
+    return MakePlacement(l2_index);
+}
+
+std::vector<PlacementMove> StreamPlacer::Release(const std::string& stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = l2_of_stream_.find(stream_id);
+    if (it == l2_of_stream_.end()) {
+        return {};
+    }
+    Unassign(it->second);
+    l2_of_stream_.erase(it);
+    stats_.releases++;
+    return Rebalance();
+}
+
+StreamPlacement StreamPlacer::GetPlacement(const std::string& stream_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = l2_of_stream_.find(stream_id);
+    return it != l2_of_stream_.end() ? MakePlacement(it->second) : StreamPlacement();
+}
+
+PlacementStats StreamPlacer::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+const CpuTopology& StreamPlacer::GetTopology() const {
+    return topology_;
+}
+
+size_t StreamPlacer::ChooseL2Domain() const {
+    // Domaine L3 le moins chargé par CPU : comparaison croisée sans division
+    const L3Domain* best_l3 = &l3_domains_.front();
+    for (const auto& l3 : l3_domains_) {
+        if (static_cast<int64_t>(l3.streams) * best_l3->cpu_count <
+            static_cast<int64_t>(best_l3->streams) * l3.cpu_count) {
+            best_l3 = &l3;
+        }
+    }
+
+    size_t best_l2 = best_l3->l2_indices.front();
+    for (size_t l2_index : best_l3->l2_indices) {
+        if (l2_domains_[l2_index].streams < l2_domains_[best_l2].streams) {
+            best_l2 = l2_index;
+        }
+    }
+    return best_l2;
+}
+
+void StreamPlacer::Assign(const std::string& stream_id, size_t l2_index) {
+    l2_of_stream_[stream_id] = l2_index;
+    l2_domains_[l2_index].streams++;
+    l3_domains_[l2_domains_[l2_index].l3_index].streams++;
+}
+
+void StreamPlacer::Unassign(size_t l2_index) {
+    l2_domains_[l2_index].streams--;
+    l3_domains_[l2_domains_[l2_index].l3_index].streams--;
+}
+
+StreamPlacement StreamPlacer::MakePlacement(size_t l2_index) const {
+    const L2Domain& domain = l2_domains_[l2_index];
+    StreamPlacement placement;
+    placement.cpus = domain.cpus;
+    placement.numa_node = domain.numa_node;
+    placement.l3_domain = l3_domains_[domain.l3_index].id;
+    return placement;
+}
+
+std::vector<PlacementMove> StreamPlacer::Rebalance() {
+    std::vector<PlacementMove> moves;
+    while (true) {
+        auto bounds = std::minmax_element(
+            l2_domains_.begin(), l2_domains_.end(),
+            [](const L2Domain& a, const L2Domain& b) { return a.streams < b.streams; });
+        size_t from = static_cast<size_t>(bounds.second - l2_domains_.begin());
+        if (bounds.second->streams - bounds.first->streams <= 1) {
+            break;
+        }
+
+        // Destination : même choix qu'un nouveau placement, le stream quitte
+        // son domaine le temps de la décision
+        auto moved = std::find_if(l2_of_stream_.begin(), l2_of_stream_.end(),
+                                  [from](const auto& entry) { return entry.second == from; });
+        Unassign(from);
+        size_t to = ChooseL2Domain();
+        if (l2_domains_[to].streams >= l2_domains_[from].streams) {
+            // Aucun domaine n'est réellement moins chargé côté L3 : on garde
+            Assign(moved->first, from);
+            break;
+        }
+        Assign(moved->first, to);
+        stats_.moves++;
+        moves.push_back(PlacementMove{moved->first, MakePlacement(to)});
+    }
+    return moves;
+}
@@ -0,0 +1,80 @@
+// src/stream_placement.h
+#ifndef STREAM_PLACEMENT_H
+#define STREAM_PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#include "cpu_topology.h"
+
+// Cœurs attribués à un stream : capture et analyse (même thread) y sont
+// épinglées, les buffers de frame sont alloués et touchés en premier par
+// ce thread, donc sur son nœud NUMA
+struct StreamPlacement {
+    std::vector<int> cpus;
+    int numa_node = -1;
+    int l3_domain = -1;
+
+    bool IsEmpty() const { return cpus.empty(); }
+};
+
+// Stream déplacé par un rééquilibrage
+struct PlacementMove {
+    std::string stream_id;
+    StreamPlacement placement;
+};
+
+struct PlacementStats {
+    int64_t placements = 0;
+    int64_t releases = 0;
+    int64_t moves = 0;
+};
+
+// Politique de placement : chaque stream reçoit les CPU d'un domaine L2
+// (un cœur physique et ses hyperthreads) dans le domaine L3 le moins chargé
+// par CPU. À l'arrêt d'un stream, des streams sont déplacés tant que deux
+// domaines L2 diffèrent de plus d'un stream.
+class StreamPlacer {
+public:
+    explicit StreamPlacer(const CpuTopology& topology);
+
+    // Idempotent : un stream déjà placé garde sa place
+    StreamPlacement Place(const std::string& stream_id);
+    std::vector<PlacementMove> Release(const std::string& stream_id);
+
+    StreamPlacement GetPlacement(const std::string& stream_id) const;
+    PlacementStats GetStats() const;
+    const CpuTopology& GetTopology() const;
+
+private:
+    struct L2Domain {
+        std::vector<int> cpus;
+        int numa_node = 0;
+        int l3_index = 0;
+        int streams = 0;
+    };
+    struct L3Domain {
+        int id = 0;
+        std::vector<size_t> l2_indices;
+        int cpu_count = 0;
+        int streams = 0;
+    };
+
+    CpuTopology topology_;
+    std::vector<L2Domain> l2_domains_;
+    std::vector<L3Domain> l3_domains_;
+    std::unordered_map<std::string, size_t> l2_of_stream_;
+    PlacementStats stats_;
+    mutable std::mutex mutex_;
+
+    size_t ChooseL2Domain() const;
+    void Assign(const std::string& stream_id, size_t l2_index);
+    void Unassign(size_t l2_index);
+    StreamPlacement MakePlacement(size_t l2_index) const;
+    std::vector<PlacementMove> Rebalance();
+};
+
+#endif // STREAM_PLACEMENT_H
@@ -0,0 +1,135 @@
+// src/timer_wheel.cpp
+#include "timer_wheel.h"
+#include <iostream>
+#include <algorithm>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, size_t slot_count)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))),
+      slots_(std::max<size_t>(slot_count, 1)),
+      current_slot_(0), next_id_(1), running_id_(0), stopped_(false) {
+    thread_ = std::thread(&TimerWheel::Run, this);
+}
+
+TimerWheel::~TimerWheel() {
+    Stop();
+}
+
+TimerWheel::TimerId TimerWheel::Schedule(std::chrono::milliseconds delay, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+        return 0;
+    }
+
+    // Au moins un tick : un timer n'expire jamais dans le tick courant
+    uint64_t ticks = std::max<uint64_t>(1, (delay.count() + tick_.count() - 1) / tick_.count());
+    size_t slot = (current_slot_ + ticks) % slots_.size();
+
+    TimerId id = next_id_++;
+    slots_[slot].push_back(Entry{id, (ticks - 1) / slots_.size(), std::move(callback)});
+    slot_of_[id] = slot;
+    return id;
+}
+
+bool TimerWheel::Cancel(TimerId id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto it = slot_of_.find(id);
+    if (it != slot_of_.end()) {
+        auto& slot = slots_[it->second];
+        slot.erase(std::remove_if(slot.begin(), slot.end(),
+                                  [id](const Entry& entry) { return entry.id == id; }),
+                   slot.end());
+        slot_of_.erase(it);
+        return true;
+    }
+    if (firing_.erase(id) > 0) {
+        // Échu mais derrière un autre callback du même tick : Run le sautera
+        return true;
+    }
+
+    // Callback en cours : l'appelant peut libérer ce qu'il référence au retour
+    if (std::this_thread::get_id() != thread_.get_id()) {
+        condition_.wait(lock, [this, id]() { return running_id_ != id; });
+    }
+    return false;
+}
+
+void TimerWheel::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        for (auto& slot : slots_) {
+            slot.clear();
+        }
+        slot_of_.clear();
+        firing_.clear();
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t TimerWheel::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slot_of_.size() + firing_.size();
+}
+
+std::chrono::milliseconds TimerWheel::GetTick() const {
+    return tick_;
+}
+
+void TimerWheel::Run() {
+    auto next_tick = std::chrono::steady_clock::now() + tick_;
+    std::vector<Entry> expired;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_) {
+        if (condition_.wait_until(lock, next_tick, [this]() { return stopped_; })) {
+            break;
+        }
+        next_tick += tick_;
+
+        Advance(&expired);
+        for (auto& entry : expired) {
+            if (stopped_) {
+                break;
+            }
+            if (firing_.erase(entry.id) == 0) {
+                continue;  // annulé pendant un callback précédent
+            }
+            running_id_ = entry.id;
+            lock.unlock();
+            try {
+                entry.callback();
+            } catch (const std::exception& e) {
+                std::cerr << "[TimerWheel] Exception in timer callback: " << e.what() << std::endl;
+            }
+            lock.lock();
+            running_id_ = 0;
+            condition_.notify_all();
+        }
+        expired.clear();
+    }
+}
+
+void TimerWheel::Advance(std::vector<Entry>* expired) {
+    current_slot_ = (current_slot_ + 1) % slots_.size();
+    auto& slot = slots_[current_slot_];
+
+    auto remaining = slot.begin();
+    for (auto& entry : slot) {
+        if (entry.rounds == 0) {
+            slot_of_.erase(entry.id);
+            firing_.insert(entry.id);
+            expired->push_back(std::move(entry));
+        } else {
+            entry.rounds--;
+            *remaining++ = std::move(entry);
+        }
+    }
+    slot.erase(remaining, slot.end());
+}
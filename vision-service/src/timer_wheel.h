@@ -0,0 +1,69 @@
+// src/timer_wheel.h
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// Roue de temporisation hachée : un seul thread pour tous les timers du
+// service, coût constant par timer quelle que soit l'échéance. Précision
+// d'un tick ; adaptée aux délais longs (reconnexions, disjoncteurs).
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(100),
+                        size_t slot_count = 512);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Le callback s'exécute dans le thread de la roue ; 0 si la roue est arrêtée
+    TimerId Schedule(std::chrono::milliseconds delay, Callback callback);
+
+    // true si le timer était en attente, y compris échu mais pas encore
+    // lancé dans le tick en cours : son callback ne s'exécutera pas. S'il
+    // est en cours d'exécution, attend la fin du callback (sauf depuis le
+    // thread de la roue).
+    bool Cancel(TimerId id);
+
+    // Abandonne les timers en attente et joint le thread
+    void Stop();
+
+    size_t GetPendingCount() const;
+    std::chrono::milliseconds GetTick() const;
+
+private:
+    struct Entry {
+        TimerId id;
+        uint64_t rounds;   // tours complets restants avant échéance
+        Callback callback;
+    };
+
+    std::chrono::milliseconds tick_;
+    std::vector<std::vector<Entry>> slots_;
+    std::unordered_map<TimerId, size_t> slot_of_;  // id -> slot
+    std::unordered_set<TimerId> firing_;           // échus dans ce tick, pas encore lancés
+    size_t current_slot_;
+    TimerId next_id_;
+    TimerId running_id_;
+    bool stopped_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+
+    void Run();
+    void Advance(std::vector<Entry>* expired);
+};
+
+#endif // TIMER_WHEEL_H
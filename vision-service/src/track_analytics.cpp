@@ -0,0 +1,350 @@
+// src/track_analytics.cpp
+#include "track_analytics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace TrackAnalyticsConstants;
+
+namespace {
+
+// Coordonnées des zones bornées : 1 Mi cellules (8 Mio) au plus
+constexpr int MAX_COORDINATE = 8191;
+
+int ClampCoordinate(int value) {
+    return std::clamp(value, 0, MAX_COORDINATE);
+}
+
+bool ParseTrackId(const Detection& detection, uint32_t* track_id) {
+    auto it = detection.metadata().find("track_id");
+    if (it == detection.metadata().end()) {
+        return false;
+    }
+    try {
+        unsigned long value = std::stoul(it->second);
+        if (value == 0 || value > UINT32_MAX) {
+            return false;
+        }
+        *track_id = static_cast<uint32_t>(value);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}  // namespace
+
+const char* AnalyticsEvent::GetTypeName(Type type) {
+    switch (type) {
+        case Type::ZONE_ENTER: return "zone_enter";
+        case Type::ZONE_EXIT: return "zone_exit";
+        case Type::LINE_CROSS: return "line_cross";
+    }
+    return "unknown";
+}
+
+TrackAnalytics::TrackAnalytics(const google::protobuf::RepeatedPtrField<DetectionZone>& zones,
+                               const google::protobuf::RepeatedPtrField<CountingLine>& lines) {
+    std::vector<const DetectionZone*> active_zones;
+    for (const auto& zone : zones) {
+        if (zone.active() && zone.points_size() >= 3 &&
+            active_zones.size() < static_cast<size_t>(MAX_ZONES)) {
+            active_zones.push_back(&zone);
+            Zone entry;
+            entry.id = zone.id();
+            entry.counters.zone_id = zone.id();
+            zones_.push_back(entry);
+        }
+    }
+    RasterizeZones(active_zones);
+
+    for (const auto& line : lines) {
+        if (!line.active() || (line.start().x() == line.end().x() && line.start().y() == line.end().y())) {
+            continue;
+        }
+        Line entry;
+        entry.id = line.id();
+        entry.start_x = line.start().x();
+        entry.start_y = line.start().y();
+        entry.end_x = line.end().x();
+        entry.end_y = line.end().y();
+        entry.counters.line_id = line.id();
+        lines_.push_back(entry);
+    }
+}
+
+bool TrackAnalytics::IsEmpty() const {
+    return zones_.empty() && lines_.empty();
+}
+
+void TrackAnalytics::Update(std::vector<Detection>* detections, int64_t timestamp_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Track& track : tracks_) {
+        track.seen = false;
+    }
+
+    // Les pistes créées par AssignTracks sont ajoutées à la fin
+    size_t existing = tracks_.size();
+    AssignTracks(detections);
+    for (size_t i = 0; i < detections->size(); ++i) {
+        size_t index = static_cast<size_t>(assignment_[i]);
+        MoveTrack(tracks_[index], (*detections)[i], timestamp_ms, index >= existing);
+    }
+
+    // Pistes perdues : sortie des zones à leur dernière apparition
+    for (Track& track : tracks_) {
+        if (!track.seen && ++track.missed > MAX_MISSED_FRAMES) {
+            UpdateZones(track, 0, track.last_seen_ms);
+        }
+    }
+    tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                                 [](const Track& track) { return track.missed > MAX_MISSED_FRAMES; }),
+                  tracks_.end());
+}
+
+AnalyticsSnapshot TrackAnalytics::Snapshot(int64_t since_sequence, size_t max_events) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AnalyticsSnapshot snapshot;
+    for (const Zone& zone : zones_) {
+        snapshot.zones.push_back(zone.counters);
+    }
+    for (const Line& line : lines_) {
+        snapshot.lines.push_back(line.counters);
+    }
+    snapshot.active_tracks = static_cast<int>(tracks_.size());
+
+    since_sequence = std::max<int64_t>(0, since_sequence);
+    int64_t oldest = events_.empty() ? next_sequence_ : events_.front().sequence;
+    snapshot.events_dropped = std::max<int64_t>(0, oldest - since_sequence - 1);
+    snapshot.next_sequence = std::max(since_sequence, next_sequence_ - 1);
+
+    // Séquences contiguës : position directe dans le tampon
+    size_t first = static_cast<size_t>(std::max<int64_t>(0, since_sequence + 1 - oldest));
+    for (size_t i = first; i < events_.size() && snapshot.events.size() < max_events; ++i) {
+        snapshot.events.push_back(events_[i]);
+    }
+    if (!snapshot.events.empty() && first + snapshot.events.size() < events_.size()) {
+        snapshot.next_sequence = snapshot.events.back().sequence;
+    }
+    return snapshot;
+}
+
+uint64_t TrackAnalytics::GetZoneMask(int x, int y) const {
+    if (cells_.empty() || x < grid_x_ || y < grid_y_) {
+        return 0;
+    }
+    int cx = (x - grid_x_) / CELL_SIZE;
+    int cy = (y - grid_y_) / CELL_SIZE;
+    if (cx >= grid_width_ || cy >= grid_height_) {
+        return 0;
+    }
+    return cells_[static_cast<size_t>(cy) * grid_width_ + cx];
+}
+
+void TrackAnalytics::RasterizeZones(const std::vector<const DetectionZone*>& zones) {
+    if (zones.empty()) {
+        return;
+    }
+    int min_x = MAX_COORDINATE, min_y = MAX_COORDINATE, max_x = 0, max_y = 0;
+    for (const DetectionZone* zone : zones) {
+        for (const auto& point : zone->points()) {
+            min_x = std::min(min_x, ClampCoordinate(point.x()));
+            min_y = std::min(min_y, ClampCoordinate(point.y()));
+            max_x = std::max(max_x, ClampCoordinate(point.x()));
+            max_y = std::max(max_y, ClampCoordinate(point.y()));
+        }
+    }
+    grid_x_ = min_x;
+    grid_y_ = min_y;
+    grid_width_ = (max_x - min_x) / CELL_SIZE + 1;
+    grid_height_ = (max_y - min_y) / CELL_SIZE + 1;
+    cells_.assign(static_cast<size_t>(grid_width_) * grid_height_, 0);
+
+    // Balayage par ligne de cellules : le centre de chaque cellule est
+    // testé d'après les intersections des arêtes (règle pair-impair)
+    std::vector<double> crossings;
+    for (size_t z = 0; z < zones.size(); ++z) {
+        const auto& points = zones[z]->points();
+        uint64_t bit = uint64_t{1} << z;
+        for (int cy = 0; cy < grid_height_; ++cy) {
+            double y = grid_y_ + cy * CELL_SIZE + CELL_SIZE / 2.0;
+            crossings.clear();
+            for (int i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+                double yi = ClampCoordinate(points[i].y()), yj = ClampCoordinate(points[j].y());
+                if ((yi > y) == (yj > y)) {
+                    continue;
+                }
+                double xi = ClampCoordinate(points[i].x()), xj = ClampCoordinate(points[j].x());
+                crossings.push_back(xi + (y - yi) * (xj - xi) / (yj - yi));
+            }
+            std::sort(crossings.begin(), crossings.end());
+            uint64_t* row = &cells_[static_cast<size_t>(cy) * grid_width_];
+            for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+                // Cellules dont le centre est dans [crossings[k], crossings[k + 1])
+                int first = static_cast<int>(std::ceil((crossings[k] - grid_x_ - CELL_SIZE / 2.0) / CELL_SIZE));
+                int last = static_cast<int>(std::ceil((crossings[k + 1] - grid_x_ - CELL_SIZE / 2.0) / CELL_SIZE)) - 1;
+                for (int cx = std::max(0, first); cx <= std::min(grid_width_ - 1, last); ++cx) {
+                    row[cx] |= bit;
+                }
+            }
+        }
+    }
+}
+
+void TrackAnalytics::AssignTracks(std::vector<Detection>* detections) {
+    assignment_.assign(detections->size(), -1);
+
+    // Pistes fournies par un suivi amont pour toutes les détections
+    std::vector<uint32_t> upstream_ids(detections->size());
+    bool upstream = !detections->empty();
+    for (size_t i = 0; i < detections->size() && upstream; ++i) {
+        upstream = ParseTrackId((*detections)[i], &upstream_ids[i]);
+    }
+    if (upstream) {
+        for (size_t i = 0; i < detections->size(); ++i) {
+            auto it = std::find_if(tracks_.begin(), tracks_.end(),
+                                   [&](const Track& track) { return track.id == upstream_ids[i]; });
+            if (it == tracks_.end()) {
+                Track track;
+                track.id = upstream_ids[i];
+                track.entered_ms.assign(zones_.size(), 0);
+                tracks_.push_back(std::move(track));
+                it = tracks_.end() - 1;
+            }
+            assignment_[i] = static_cast<int>(it - tracks_.begin());
+        }
+        return;
+    }
+
+    // Association gloutone par distance des centres, rapportée à la taille
+    // de la piste : quelques détections et pistes par frame
+    std::vector<std::tuple<double, size_t, size_t>> candidates;
+    for (size_t i = 0; i < detections->size(); ++i) {
+        const auto& bbox = (*detections)[i].bbox();
+        double center_x = bbox.x() + bbox.width() / 2.0;
+        double center_y = bbox.y() + bbox.height() / 2.0;
+        for (size_t t = 0; t < tracks_.size(); ++t) {
+            double distance = std::hypot(center_x - tracks_[t].center_x, center_y - tracks_[t].center_y) /
+                              std::max(1.0, tracks_[t].size);
+            if (distance <= MAX_MATCH_DISTANCE) {
+                candidates.emplace_back(distance, i, t);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<bool> track_taken(tracks_.size(), false);
+    for (const auto& [distance, i, t] : candidates) {
+        if (assignment_[i] < 0 && !track_taken[t]) {
+            assignment_[i] = static_cast<int>(t);
+            track_taken[t] = true;
+        }
+    }
+
+    for (size_t i = 0; i < detections->size(); ++i) {
+        if (assignment_[i] < 0) {
+            Track track;
+            track.id = next_track_id_++;
+            if (next_track_id_ == 0) {
+                next_track_id_ = 1;
+            }
+            track.entered_ms.assign(zones_.size(), 0);
+            tracks_.push_back(std::move(track));
+            assignment_[i] = static_cast<int>(tracks_.size() - 1);
+        }
+        (*(*detections)[i].mutable_metadata())["track_id"] = std::to_string(tracks_[assignment_[i]].id);
+    }
+}
+
+void TrackAnalytics::MoveTrack(Track& track, const Detection& detection, int64_t timestamp_ms, bool is_new) {
+    const auto& bbox = detection.bbox();
+    double anchor_x = bbox.x() + bbox.width() / 2.0;
+    double anchor_y = bbox.y() + bbox.height();
+
+    // Segment parcouru depuis la frame précédente contre chaque ligne.
+    // Côté gauche de start → end (repère image, y vers le bas) : produit
+    // vectoriel négatif ; un point sur la ligne compte à droite.
+    if (!is_new) {
+        double move_x = anchor_x - track.anchor_x;
+        double move_y = anchor_y - track.anchor_y;
+        for (Line& line : lines_) {
+            double line_x = line.end_x - line.start_x;
+            double line_y = line.end_y - line.start_y;
+            double before = line_x * (track.anchor_y - line.start_y) - line_y * (track.anchor_x - line.start_x);
+            double after = line_x * (anchor_y - line.start_y) - line_y * (anchor_x - line.start_x);
+            if ((before < 0) == (after < 0)) {
+                continue;
+            }
+            double start_side = move_x * (line.start_y - track.anchor_y) - move_y * (line.start_x - track.anchor_x);
+            double end_side = move_x * (line.end_y - track.anchor_y) - move_y * (line.end_x - track.anchor_x);
+            if (start_side * end_side > 0) {
+                continue;  // passage à côté du segment
+            }
+            bool forward = before < 0;
+            if (forward) {
+                line.counters.forward++;
+            } else {
+                line.counters.backward++;
+            }
+            AnalyticsEvent event;
+            event.type = AnalyticsEvent::Type::LINE_CROSS;
+            event.target_id = line.id;
+            event.track_id = track.id;
+            event.object_type = detection.type();
+            event.forward = forward;
+            event.timestamp_ms = timestamp_ms;
+            Emit(std::move(event));
+        }
+    }
+
+    track.anchor_x = anchor_x;
+    track.anchor_y = anchor_y;
+    track.center_x = bbox.x() + bbox.width() / 2.0;
+    track.center_y = bbox.y() + bbox.height() / 2.0;
+    track.size = std::hypot(static_cast<double>(bbox.width()), static_cast<double>(bbox.height()));
+    track.object_type = detection.type();
+    track.missed = 0;
+    track.seen = true;
+    track.last_seen_ms = timestamp_ms;
+    UpdateZones(track, GetZoneMask(static_cast<int>(anchor_x), static_cast<int>(anchor_y)), timestamp_ms);
+}
+
+void TrackAnalytics::UpdateZones(Track& track, uint64_t zones, int64_t timestamp_ms) {
+    uint64_t changed = zones ^ track.zones;
+    while (changed) {
+        int index = __builtin_ctzll(changed);
+        changed &= changed - 1;
+        uint64_t bit = uint64_t{1} << index;
+        ZoneCounters& counters = zones_[index].counters;
+
+        AnalyticsEvent event;
+        event.target_id = zones_[index].id;
+        event.track_id = track.id;
+        event.object_type = track.object_type;
+        event.timestamp_ms = timestamp_ms;
+        if (zones & bit) {
+            counters.entries++;
+            counters.occupancy++;
+            track.entered_ms[index] = timestamp_ms;
+            event.type = AnalyticsEvent::Type::ZONE_ENTER;
+        } else {
+            int64_t dwell = std::max<int64_t>(0, timestamp_ms - track.entered_ms[index]);
+            counters.exits++;
+            counters.occupancy--;
+            counters.dwell_total_ms += dwell;
+            counters.dwell_max_ms = std::max(counters.dwell_max_ms, dwell);
+            event.type = AnalyticsEvent::Type::ZONE_EXIT;
+            event.dwell_ms = dwell;
+        }
+        Emit(std::move(event));
+    }
+    track.zones = zones;
+}
+
+void TrackAnalytics::Emit(AnalyticsEvent event) {
+    event.sequence = next_sequence_++;
+    events_.push_back(std::move(event));
+    if (events_.size() > MAX_EVENTS) {
+        events_.pop_front();
+    }
+}
@@ -0,0 +1,148 @@
+// src/track_analytics.h
+#ifndef TRACK_ANALYTICS_H
+#define TRACK_ANALYTICS_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+#include "vision.pb.h"
+
+using surveillance::vision::Detection;
+using surveillance::vision::DetectionZone;
+using surveillance::vision::CountingLine;
+
+// Événement agrégé émis à la place des boîtes brutes
+struct AnalyticsEvent {
+    enum class Type { ZONE_ENTER, ZONE_EXIT, LINE_CROSS };
+
+    int64_t sequence = 0;       // croissant par caméra, sert de curseur
+    Type type = Type::ZONE_ENTER;
+    std::string target_id;      // zone ou ligne
+    uint32_t track_id = 0;
+    std::string object_type;
+    bool forward = true;        // LINE_CROSS : gauche vers droite de start → end
+    int64_t dwell_ms = 0;       // ZONE_EXIT : temps passé dans la zone
+    int64_t timestamp_ms = 0;
+
+    static const char* GetTypeName(Type type);
+};
+
+struct ZoneCounters {
+    std::string zone_id;
+    int64_t entries = 0;
+    int64_t exits = 0;
+    int occupancy = 0;          // pistes présentes
+    int64_t dwell_total_ms = 0;  // sur les sorties
+    int64_t dwell_max_ms = 0;
+};
+
+struct LineCounters {
+    std::string line_id;
+    int64_t forward = 0;
+    int64_t backward = 0;
+};
+
+// Instantané lu par les RPC
+struct AnalyticsSnapshot {
+    std::vector<ZoneCounters> zones;
+    std::vector<LineCounters> lines;
+    std::vector<AnalyticsEvent> events;  // séquence > curseur, ordre croissant
+    int64_t next_sequence = 0;           // curseur pour l'appel suivant
+    int64_t events_dropped = 0;          // sortis du tampon avant d'être lus
+    int active_tracks = 0;
+};
+
+// Comptage par zone et par ligne à partir des pistes d'une caméra. Chaque
+// objet est réduit à son point d'appui (milieu du bas de la boîte) : les
+// zones sont rastérisées une fois pour toutes en une grille de cellules dont
+// chacune porte le masque des zones qui la couvrent, si bien que
+// l'appartenance d'une piste à toutes les zones coûte une lecture. Une ligne
+// est franchie quand le segment parcouru par le point d'appui depuis la
+// frame précédente la coupe. Coût par frame : O(pistes × lignes).
+//
+// Les pistes viennent des détections : metadata["track_id"] si un suivi
+// amont l'a fourni pour toutes, sinon un suivi glouton par distance des
+// centres qui l'ajoute aux détections.
+//
+// Update() est appelé par le thread de traitement ; Snapshot() depuis
+// n'importe quel thread.
+class TrackAnalytics {
+public:
+    // Zones et lignes inactives ignorées ; au plus MAX_ZONES zones
+    TrackAnalytics(const google::protobuf::RepeatedPtrField<DetectionZone>& zones,
+                   const google::protobuf::RepeatedPtrField<CountingLine>& lines);
+
+    TrackAnalytics(const TrackAnalytics&) = delete;
+    TrackAnalytics& operator=(const TrackAnalytics&) = delete;
+
+    bool IsEmpty() const;  // ni zone ni ligne active
+
+    void Update(std::vector<Detection>* detections, int64_t timestamp_ms);
+    AnalyticsSnapshot Snapshot(int64_t since_sequence, size_t max_events) const;
+
+    // Zones (masque de bits) contenant le point, d'après la grille
+    uint64_t GetZoneMask(int x, int y) const;
+
+private:
+    struct Zone {
+        std::string id;
+        ZoneCounters counters;
+    };
+
+    struct Line {
+        std::string id;
+        double start_x, start_y, end_x, end_y;
+        LineCounters counters;
+    };
+
+    struct Track {
+        uint32_t id = 0;
+        double anchor_x = 0, anchor_y = 0;  // point d'appui
+        double center_x = 0, center_y = 0;
+        double size = 0;                    // diagonale de la boîte
+        int missed = 0;                     // frames sans détection associée
+        int64_t last_seen_ms = 0;
+        bool seen = false;                  // associée à la frame courante
+        std::string object_type;
+        uint64_t zones = 0;
+        std::vector<int64_t> entered_ms;    // entrée dans chaque zone présente
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Zone> zones_;
+    std::vector<Line> lines_;
+
+    // Grille des zones
+    int grid_x_ = 0;
+    int grid_y_ = 0;
+    int grid_width_ = 0;
+    int grid_height_ = 0;
+    std::vector<uint64_t> cells_;
+
+    std::vector<Track> tracks_;
+    uint32_t next_track_id_ = 1;
+    std::deque<AnalyticsEvent> events_;
+    int64_t next_sequence_ = 1;
+
+    // Tampons réutilisés d'une frame à l'autre
+    std::vector<int> assignment_;
+
+    void RasterizeZones(const std::vector<const DetectionZone*>& zones);
+    void AssignTracks(std::vector<Detection>* detections);
+    void MoveTrack(Track& track, const Detection& detection, int64_t timestamp_ms, bool is_new);
+    void UpdateZones(Track& track, uint64_t zones, int64_t timestamp_ms);
+    void Emit(AnalyticsEvent event);
+};
+
+namespace TrackAnalyticsConstants {
+    constexpr int MAX_ZONES = 64;               // un bit par zone
+    constexpr int CELL_SIZE = 8;                // pixels par côté de cellule
+    constexpr int MAX_MISSED_FRAMES = 5;        // piste perdue au-delà
+    constexpr double MAX_MATCH_DISTANCE = 1.0;  // en diagonales de la piste
+    constexpr size_t MAX_EVENTS = 4096;         // tampon des événements non lus
+}
+
+#endif // TRACK_ANALYTICS_H
@@ -0,0 +1,326 @@
+// src/vision_core.cpp
+#include "vision_core.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_processor.h"
+#include "camera_manager.h"
+
+// Aucune exception ne traverse l'API C : chaque point d'entrée les
+// convertit en code de retour
+
+struct vision_processor {
+    FrameProcessor processor;
+    std::vector<std::string> detector_names;  // chaînes rendues par detector_name
+};
+
+struct vision_camera {
+    std::unique_ptr<CameraManager> camera;
+    CameraConfig config;
+    std::string last_error;  // chaîne rendue par last_error
+};
+
+namespace {
+
+void CopyString(const std::string& source, char* destination, size_t capacity) {
+    size_t length = std::min(source.size(), capacity - 1);
+    std::memcpy(destination, source.data(), length);
+    destination[length] = '\0';
+}
+
+void ToCDetection(const Detection& detection, vision_detection_t* out) {
+    CopyString(detection.id(), out->id, sizeof(out->id));
+    CopyString(detection.type(), out->type, sizeof(out->type));
+    out->confidence = detection.confidence();
+    out->x = detection.bbox().x();
+    out->y = detection.bbox().y();
+    out->width = detection.bbox().width();
+    out->height = detection.bbox().height();
+    out->timestamp_ms = detection.timestamp();
+}
+
+// Frame empruntée : seuls les pointeurs sont repris
+Frame FromCFrame(const vision_frame_t& frame) {
+    Frame borrowed(frame.width, frame.height, frame.format ? frame.format : "");
+    borrowed.external_data = frame.data;
+    borrowed.external_size = frame.size;
+    borrowed.offset_x = frame.offset_x;
+    borrowed.offset_y = frame.offset_y;
+    return borrowed;
+}
+
+vision_frame_t ToCFrame(const Frame& frame) {
+    vision_frame_t out;
+    out.data = frame.Pixels();
+    out.size = frame.PixelBytes();
+    out.width = frame.width;
+    out.height = frame.height;
+    out.format = frame.format.c_str();
+    out.offset_x = frame.offset_x;
+    out.offset_y = frame.offset_y;
+    return out;
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t vision_abi_version(void) {
+    return VISION_CORE_ABI_VERSION;
+}
+
+const char* vision_status_string(vision_status_t status) {
+    switch (status) {
+        case VISION_OK: return "ok";
+        case VISION_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case VISION_ERROR_INIT: return "initialization failed";
+        case VISION_ERROR_CAPTURE: return "capture failed";
+        case VISION_ERROR_PROCESSING: return "processing failed";
+    }
+    return "unknown";
+}
+
+vision_processor_t* vision_processor_create(void) {
+    try {
+        auto handle = std::make_unique<vision_processor>();
+        if (!handle->processor.Initialize()) {
+            return nullptr;
+        }
+        return handle.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void vision_processor_destroy(vision_processor_t* processor) {
+    delete processor;
+}
+
+vision_status_t vision_processor_set_motion_threshold(vision_processor_t* processor, double threshold) {
+    if (!processor) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    processor->processor.SetMotionThreshold(threshold);
+    return VISION_OK;
+}
+
+vision_status_t vision_processor_set_min_detection_area(vision_processor_t* processor, int32_t area) {
+    if (!processor) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    processor->processor.SetMinDetectionArea(area);
+    return VISION_OK;
+}
+
+vision_status_t vision_processor_set_max_detections(vision_processor_t* processor, int32_t max_detections) {
+    if (!processor) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    processor->processor.SetMaxDetectionsPerFrame(max_detections);
+    return VISION_OK;
+}
+
+size_t vision_processor_detector_count(vision_processor_t* processor) {
+    return processor ? processor->processor.GetDetectorNames().size() : 0;
+}
+
+const char* vision_processor_detector_name(vision_processor_t* processor, size_t index) {
+    if (!processor) {
+        return nullptr;
+    }
+    try {
+        processor->detector_names = processor->processor.GetDetectorNames();
+    } catch (...) {
+        return nullptr;
+    }
+    return index < processor->detector_names.size() ? processor->detector_names[index].c_str() : nullptr;
+}
+
+vision_status_t vision_processor_remove_detector(vision_processor_t* processor, const char* name) {
+    if (!processor || !name) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        size_t before = processor->processor.GetDetectorNames().size();
+        processor->processor.RemoveDetector(name);
+        return processor->processor.GetDetectorNames().size() < before ? VISION_OK
+                                                                        : VISION_ERROR_INVALID_ARGUMENT;
+    } catch (...) {
+        return VISION_ERROR_PROCESSING;
+    }
+}
+
+vision_status_t vision_processor_enable_checkpoint(vision_processor_t* processor, const char* path,
+                                                   uint64_t config_hash, int32_t interval_ms,
+                                                   int* restored) {
+    if (!processor || !path || interval_ms <= 0) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        bool was_restored = processor->processor.EnableCheckpoint(
+            path, config_hash, std::chrono::milliseconds(interval_ms));
+        if (restored) {
+            *restored = was_restored ? 1 : 0;
+        }
+        return processor->processor.IsCheckpointEnabled() ? VISION_OK : VISION_ERROR_INIT;
+    } catch (...) {
+        return VISION_ERROR_INIT;
+    }
+}
+
+vision_status_t vision_processor_process(vision_processor_t* processor, const vision_frame_t* frame,
+                                         vision_detection_t* detections, size_t capacity,
+                                         size_t* count) {
+    if (count) {
+        *count = 0;
+    }
+    if (!processor || !frame || !frame->data || (capacity > 0 && !detections)) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        ProcessingResult result = processor->processor.ProcessFrame(FromCFrame(*frame));
+        if (!result.success) {
+            return VISION_ERROR_PROCESSING;
+        }
+        size_t written = std::min(capacity, result.detections.size());
+        for (size_t i = 0; i < written; ++i) {
+            ToCDetection(result.detections[i], &detections[i]);
+        }
+        if (count) {
+            *count = written;
+        }
+        return VISION_OK;
+    } catch (...) {
+        return VISION_ERROR_PROCESSING;
+    }
+}
+
+int64_t vision_processor_frames_processed(vision_processor_t* processor) {
+    return processor ? processor->processor.GetTotalFramesProcessed() : 0;
+}
+
+int64_t vision_processor_total_detections(vision_processor_t* processor) {
+    return processor ? processor->processor.GetTotalDetections() : 0;
+}
+
+void vision_camera_config_init(vision_camera_config_t* config) {
+    if (!config) {
+        return;
+    }
+    CameraConfig defaults;
+    std::memset(config, 0, sizeof(*config));
+    config->width = defaults.width;
+    config->height = defaults.height;
+    config->fps = defaults.fps;
+    config->reconnect_delay_ms = defaults.reconnect_delay_ms;
+    config->max_reconnect_attempts = defaults.max_reconnect_attempts;
+}
+
+vision_camera_t* vision_camera_create(const vision_camera_config_t* config) {
+    if (!config || !config->url || !CameraManager::IsValidCameraUrl(config->url)) {
+        return nullptr;
+    }
+    try {
+        auto handle = std::make_unique<vision_camera>();
+        handle->camera = std::make_unique<CameraManager>(config->url);
+        // Champs non renseignés : valeurs par défaut de CameraConfig
+        if (config->width > 0) handle->config.width = config->width;
+        if (config->height > 0) handle->config.height = config->height;
+        if (config->fps > 0) handle->config.fps = config->fps;
+        if (config->format && FrameUtils::IsValidFormat(config->format)) handle->config.format = config->format;
+        if (config->reconnect_delay_ms > 0) handle->config.reconnect_delay_ms = config->reconnect_delay_ms;
+        if (config->max_reconnect_attempts > 0) {
+            handle->config.max_reconnect_attempts = config->max_reconnect_attempts;
+        }
+        return handle.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void vision_camera_destroy(vision_camera_t* camera) {
+    delete camera;
+}
+
+vision_status_t vision_camera_set_frame_callback(vision_camera_t* camera, vision_frame_callback_t callback,
+                                                 void* user_data) {
+    if (!camera || !callback) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    camera->camera->SetFrameCallback([callback, user_data](const Frame& frame) {
+        vision_frame_t borrowed = ToCFrame(frame);
+        callback(user_data, &borrowed);
+    });
+    return VISION_OK;
+}
+
+vision_status_t vision_camera_attach_processor(vision_camera_t* camera, vision_processor_t* processor,
+                                               vision_detection_callback_t callback, void* user_data) {
+    if (!camera || !processor || !callback) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    // Tampon propre au thread de capture, réutilisé d'une frame à l'autre
+    auto buffer = std::make_shared<std::vector<vision_detection_t>>();
+    camera->camera->SetFrameCallback([processor, callback, user_data, buffer](const Frame& frame) {
+        ProcessingResult result = processor->processor.ProcessFrame(frame);
+        if (!result.success) {
+            return;
+        }
+        buffer->resize(result.detections.size());
+        for (size_t i = 0; i < result.detections.size(); ++i) {
+            ToCDetection(result.detections[i], &(*buffer)[i]);
+        }
+        callback(user_data, buffer->data(), buffer->size(), result.processing_time_ms);
+    });
+    return VISION_OK;
+}
+
+vision_status_t vision_camera_start(vision_camera_t* camera) {
+    if (!camera) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        if (!camera->camera->Initialize(camera->config)) {
+            return VISION_ERROR_INIT;
+        }
+        return camera->camera->StartCapture() ? VISION_OK : VISION_ERROR_CAPTURE;
+    } catch (...) {
+        return VISION_ERROR_CAPTURE;
+    }
+}
+
+vision_status_t vision_camera_stop(vision_camera_t* camera) {
+    if (!camera) {
+        return VISION_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        return camera->camera->StopCapture() ? VISION_OK : VISION_ERROR_CAPTURE;
+    } catch (...) {
+        return VISION_ERROR_CAPTURE;
+    }
+}
+
+int vision_camera_is_capturing(vision_camera_t* camera) {
+    return camera && camera->camera->IsCapturing() ? 1 : 0;
+}
+
+int64_t vision_camera_frames_captured(vision_camera_t* camera) {
+    return camera ? camera->camera->GetStats().Snapshot().frames_captured : 0;
+}
+
+const char* vision_camera_last_error(vision_camera_t* camera) {
+    if (!camera) {
+        return nullptr;
+    }
+    try {
+        camera->last_error = camera->camera->GetLastError();
+    } catch (...) {
+        return nullptr;
+    }
+    return camera->last_error.c_str();
+}
+
+}  // extern "C"
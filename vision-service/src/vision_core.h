@@ -0,0 +1,153 @@
+/* src/vision_core.h */
+#ifndef VISION_CORE_H
+#define VISION_CORE_H
+
+/*
+ * API C de la bibliothèque vision-core : capture et détection dans le
+ * processus appelant (Go via cgo, autres services), sans sérialisation.
+ * Le service gRPC n'est qu'une couche au-dessus des mêmes classes.
+ *
+ * Stabilité : seules les fonctions et structures de ce fichier sont
+ * exportées par la bibliothèque partagée. Les structures ne font que
+ * grandir (nouveaux champs en fin) ; VISION_CORE_ABI_VERSION change à
+ * toute rupture. Les chaînes retournées appartiennent à la bibliothèque
+ * et restent valides jusqu'à l'appel suivant sur le même objet.
+ *
+ * Threads : un processeur n'est pas réentrant (un appelant à la fois) ;
+ * les callbacks d'une caméra sont appelés depuis son thread de capture.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define VISION_CORE_API __attribute__((visibility("default")))
+#else
+#define VISION_CORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VISION_CORE_ABI_VERSION 1
+
+typedef enum {
+    VISION_OK = 0,
+    VISION_ERROR_INVALID_ARGUMENT = 1,
+    VISION_ERROR_INIT = 2,
+    VISION_ERROR_CAPTURE = 3,
+    VISION_ERROR_PROCESSING = 4
+} vision_status_t;
+
+typedef struct vision_processor vision_processor_t;
+typedef struct vision_camera vision_camera_t;
+
+/* Frame empruntée : data n'est ni copiée ni conservée au-delà de l'appel
+ * (ou du callback qui la fournit) */
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    int32_t width;
+    int32_t height;
+    const char* format;   /* "bgr", "rgb", "gray" */
+    int32_t offset_x;     /* position dans la frame source (recadrage) */
+    int32_t offset_y;
+} vision_frame_t;
+
+typedef struct {
+    char id[64];
+    char type[32];
+    float confidence;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int64_t timestamp_ms;  /* epoch */
+} vision_detection_t;
+
+typedef struct {
+    const char* url;      /* "test://...", "rtsp://...", fichier, webcam */
+    int32_t width;
+    int32_t height;
+    int32_t fps;
+    const char* format;
+    int32_t reconnect_delay_ms;
+    int32_t max_reconnect_attempts;
+} vision_camera_config_t;
+
+/* Frame capturée, valide pendant l'appel uniquement */
+typedef void (*vision_frame_callback_t)(void* user_data, const vision_frame_t* frame);
+
+/* Résultat de l'analyse d'une frame capturée, valide pendant l'appel */
+typedef void (*vision_detection_callback_t)(void* user_data,
+                                            const vision_detection_t* detections,
+                                            size_t count,
+                                            int64_t processing_time_ms);
+
+VISION_CORE_API uint32_t vision_abi_version(void);
+VISION_CORE_API const char* vision_status_string(vision_status_t status);
+
+/* Processeur : détecteur de mouvement par défaut */
+VISION_CORE_API vision_processor_t* vision_processor_create(void);
+VISION_CORE_API void vision_processor_destroy(vision_processor_t* processor);
+
+VISION_CORE_API vision_status_t vision_processor_set_motion_threshold(vision_processor_t* processor,
+                                                                      double threshold);
+VISION_CORE_API vision_status_t vision_processor_set_min_detection_area(vision_processor_t* processor,
+                                                                        int32_t area);
+VISION_CORE_API vision_status_t vision_processor_set_max_detections(vision_processor_t* processor,
+                                                                    int32_t max_detections);
+
+VISION_CORE_API size_t vision_processor_detector_count(vision_processor_t* processor);
+VISION_CORE_API const char* vision_processor_detector_name(vision_processor_t* processor,
+                                                           size_t index);
+VISION_CORE_API vision_status_t vision_processor_remove_detector(vision_processor_t* processor,
+                                                                 const char* name);
+
+/* État des détecteurs conservé dans path ; *restored (facultatif) vaut 1
+ * si l'état sauvegardé avec config_hash a été repris */
+VISION_CORE_API vision_status_t vision_processor_enable_checkpoint(vision_processor_t* processor,
+                                                                   const char* path,
+                                                                   uint64_t config_hash,
+                                                                   int32_t interval_ms,
+                                                                   int* restored);
+
+/* Analyse sans copie de frame->data. Au plus capacity détections sont
+ * écrites dans detections ; *count reçoit leur nombre. */
+VISION_CORE_API vision_status_t vision_processor_process(vision_processor_t* processor,
+                                                         const vision_frame_t* frame,
+                                                         vision_detection_t* detections,
+                                                         size_t capacity,
+                                                         size_t* count);
+
+VISION_CORE_API int64_t vision_processor_frames_processed(vision_processor_t* processor);
+VISION_CORE_API int64_t vision_processor_total_detections(vision_processor_t* processor);
+
+/* Caméra : url obligatoire, champs à 0 ou NULL = valeurs par défaut */
+VISION_CORE_API void vision_camera_config_init(vision_camera_config_t* config);
+VISION_CORE_API vision_camera_t* vision_camera_create(const vision_camera_config_t* config);
+VISION_CORE_API void vision_camera_destroy(vision_camera_t* camera);
+
+/* À choisir avant vision_camera_start : frames brutes, ou frames analysées
+ * sur le thread de capture par processor (qui doit survivre à la caméra
+ * et n'être utilisé par personne d'autre pendant la capture) */
+VISION_CORE_API vision_status_t vision_camera_set_frame_callback(vision_camera_t* camera,
+                                                                 vision_frame_callback_t callback,
+                                                                 void* user_data);
+VISION_CORE_API vision_status_t vision_camera_attach_processor(vision_camera_t* camera,
+                                                               vision_processor_t* processor,
+                                                               vision_detection_callback_t callback,
+                                                               void* user_data);
+
+VISION_CORE_API vision_status_t vision_camera_start(vision_camera_t* camera);
+VISION_CORE_API vision_status_t vision_camera_stop(vision_camera_t* camera);
+VISION_CORE_API int vision_camera_is_capturing(vision_camera_t* camera);
+VISION_CORE_API int64_t vision_camera_frames_captured(vision_camera_t* camera);
+VISION_CORE_API const char* vision_camera_last_error(vision_camera_t* camera);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VISION_CORE_H */
@@ -3,25 +3,136 @@
 #include <iostream>
 #include <sstream>
 #include <regex>
+#include <algorithm>
+#include <queue>
+#include <condition_variable>
+#include <thread>
+#include <unordered_set>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
 
 using namespace VisionServiceConstants;
 
-VisionServiceImpl::VisionServiceImpl() 
-    : service_start_time_(std::chrono::steady_clock::now()) {
+VisionServiceImpl::VisionServiceImpl()
+    : VisionServiceImpl(CpuTopology::Load().Restrict(CpuTopology::GetProcessAllowedCpus())) {}
+
+VisionServiceImpl::VisionServiceImpl(const CpuTopology& topology)
+    : timer_wheel_(std::make_unique<TimerWheel>(std::chrono::milliseconds(TIMER_WHEEL_TICK_MS),
+                                                TIMER_WHEEL_SLOTS)),
+      frame_clock_(std::make_unique<TimerWheel>(std::chrono::milliseconds(FRAME_CLOCK_TICK_MS),
+                                                FRAME_CLOCK_SLOTS)),
+      stream_executor_(std::make_unique<WorkerPool>()),
+      service_start_time_(std::chrono::steady_clock::now()),
+      worker_pool_(std::make_unique<WorkerPool>()),
+      placer_(std::make_unique<StreamPlacer>(topology)) {
+    LogInfo("CPU topology: " + std::to_string(topology.GetCpus().size()) + " CPUs, " +
+            std::to_string(topology.GetL3DomainCount()) + " cache domains, " +
+            std::to_string(topology.GetNumaNodeCount()) + " NUMA nodes");
+    watchdog_thread_ = std::thread(&VisionServiceImpl::WatchdogLoop, this);
     LogInfo("VisionService initialized");
 }
 
 VisionServiceImpl::~VisionServiceImpl() {
-    // Nettoyer tous les streams actifs
-    auto lock = LockStreams();
-    for (auto& [camera_id, stream_state] : active_streams_) {
-        LogInfo("Cleaning up stream for camera: " + camera_id);
-        CleanupStream(camera_id);
-    }
-    active_streams_.clear();
+    Shutdown(std::chrono::milliseconds(DEFAULT_SHUTDOWN_BUDGET_MS));
     LogInfo("VisionService destroyed");
 }
 
+bool VisionServiceImpl::Shutdown(std::chrono::milliseconds budget) {
+    if (shutting_down_.exchange(true)) {
+        return true;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + budget;
+    LogInfo("Shutting down (budget " + std::to_string(budget.count()) + " ms)");
+    
+    // Plus de remplacement de source une fois l'arrêt commencé
+    StopWatchdog();
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        config_stop_ = true;
+        pending_config_.reset();
+    }
+    config_condition_.notify_all();
+    
+    // Les démarrages déjà en file se terminent et voient shutting_down_ ;
+    // une configuration en cours d'application se termine alors aussitôt.
+    // Seule l'ouverture d'une source peut bloquer : bornée par l'échéance.
+    AbandonPendingOpens(deadline);
+    worker_pool_->Shutdown();
+    StopConfigThread();
+    
+    // Retirer les streams de la table ; ceux encore en démarrage
+    // appartiennent à leur initialiseur qui les arrêtera lui-même
+    std::vector<std::unique_ptr<StreamState>> streams;
+    {
+        auto lock = LockStreams();
+        for (auto it = active_streams_.begin(); it != active_streams_.end(); ) {
+            if (it->second->status == STATUS_STARTING) {
+                ++it;
+                continue;
+            }
+            it->second->status = STATUS_STOPPING;
+            CleanupStream(it->first);
+            streams.push_back(std::move(it->second));
+            it = active_streams_.erase(it);
+        }
+    }
+    
+    // Réveiller toutes les captures avant d'en joindre une seule : la durée
+    // totale est celle de la caméra la plus lente, pas leur somme
+    for (auto& stream_state : streams) {
+        if (stream_state->camera_manager) {
+            stream_state->camera_manager->RequestStop();
+        }
+    }
+    
+    // Une capture bloquée ne sortira pas : on ne la joint qu'une fois sortie
+    for (auto& stream_state : streams) {
+        auto& camera_manager = stream_state->camera_manager;
+        while (camera_manager && !camera_manager->HasCaptureLoopExited() &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SHUTDOWN_POLL_INTERVAL_MS));
+        }
+        if (camera_manager && !camera_manager->HasCaptureLoopExited() && camera_manager->Abandon()) {
+            // Callback coupé : le processeur est libre, mais l'objet caméra
+            // reste au thread bloqué jusqu'à la fin du processus
+            LogError("Abandoning hung capture for camera: " + stream_state->camera_id);
+            camera_manager->DetachCaptureThread();
+            camera_manager.release();
+        } else if (camera_manager) {
+            camera_manager->StopCapture();
+        }
+    }
+    streams.clear();
+    ReapAbandonedCameras(true);
+    
+    // Chaque caméra arrêtée a annulé son entrée ; il ne reste que celles
+    // des streams encore en démarrage, abandonnées. Sans pool, leur
+    // coroutine finit sur le thread qui la réveille.
+    stream_executor_->Shutdown();
+    frame_clock_->Stop();
+    timer_wheel_->Stop();
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    bool within_budget = elapsed <= budget;
+    if (within_budget) {
+        LogInfo("Shutdown completed in " + std::to_string(elapsed.count()) + " ms");
+    } else {
+        LogError("Shutdown exceeded budget: " + std::to_string(elapsed.count()) + " ms");
+    }
+    return within_budget;
+}
+
+bool VisionServiceImpl::IsShuttingDown() const {
+    return shutting_down_.load();
+}
+
 Status VisionServiceImpl::StartStream(ServerContext* context,
                                      const StreamRequest* request,
                                      StreamResponse* response) {
@@ -33,76 +144,11 @@ Status VisionServiceImpl::StartStream(ServerContext* context,
         return validation_status;
     }
     
-    const std::string& camera_id = request->camera_id();
-    const std::string& camera_url = request->camera_url();
-     // After the validation passes, add this debug line:
-    auto lock = LockStreams();
-    // Vérifier si le stream existe déjà
-    if (active_streams_.find(camera_id) != active_streams_.end()) {
-        LogError("Stream already exists for camera: " + camera_id);
-        response->set_status(STATUS_ERROR);
-        response->set_message("Stream already active for camera " + camera_id);
-        return Status::OK;
-    }
-    
-    // Vérifier la limite de streams concurrents
-    if (active_streams_.size() >= MAX_CONCURRENT_STREAMS) {
-        LogError("Maximum concurrent streams reached");
-        response->set_status(STATUS_ERROR);
-        response->set_message("Maximum number of concurrent streams reached");
-        return Status::OK;
-    }
-    
-    try {
-        // Créer un nouveau stream state
-        auto stream_state = std::make_unique<StreamState>(camera_id, camera_url);
-        
-        // Créer les composants (pour l'instant, simulés)
-        stream_state->camera_manager = std::make_unique<CameraManager>(camera_url);
-        stream_state->frame_processor = std::make_unique<FrameProcessor>();
-        
-        // Initialiser le camera manager
-        if (!stream_state->camera_manager->Initialize()) {
-            LogError("Failed to initialize camera manager for: " + camera_id);
-            response->set_status(STATUS_ERROR);
-            response->set_message("Failed to initialize camera for " + camera_id);
-            return Status::OK;
-        }
-        
-        // Démarrer le traitement
-        if (!stream_state->camera_manager->StartCapture()) {
-            LogError("Failed to start capture for: " + camera_id);
-            response->set_status(STATUS_ERROR);
-            response->set_message("Failed to start capture for " + camera_id);
-            return Status::OK;
-        }
-        
-        // Marquer comme actif
-        stream_state->status = STATUS_ACTIVE;
-        
-        // Générer un ID de stream unique
-        std::string stream_id = GenerateStreamId(camera_id);
-        
-        // Ajouter aux streams actifs
-        active_streams_[camera_id] = std::move(stream_state);
-        
-        // Incrémenter les statistiques
-        total_streams_started_++;
-        ServiceMetrics::Instance().IncrementStreamsStarted();
-        
-        // Préparer la réponse
-        response->set_status(STATUS_SUCCESS);
-        response->set_message("Stream started successfully");
-        response->set_stream_id(stream_id);
-        
-        LogInfo("Stream started successfully for camera: " + camera_id);
-        
-    } catch (const std::exception& e) {
-        LogError("Exception in StartStream: " + std::string(e.what()));
-        response->set_status(STATUS_ERROR);
-        response->set_message("Internal error: " + std::string(e.what()));
+    if (shutting_down_.load()) {
+        return Status(grpc::StatusCode::UNAVAILABLE, "Service is shutting down");
     }
     
+    StartStreamInternal(*request, response);
     return Status::OK;
 }
 
@@ -129,13 +175,34 @@ Status VisionServiceImpl::StopStream(ServerContext* context,
         return Status::OK;
     }
     
+    // Un stream en cours de démarrage appartient encore à son initialiseur
+    if (it->second->status == STATUS_STARTING) {
+        LogError("Stream still starting for camera: " + camera_id);
+        response->set_status(STATUS_ERROR);
+        response->set_message("Stream is still starting for camera " + camera_id);
+        return Status::OK;
+    }
+    
+    // Idem pendant le remplacement d'une source bloquée
+    if (it->second->recovering) {
+        LogError("Stream recovering for camera: " + camera_id);
+        response->set_status(STATUS_ERROR);
+        response->set_message("Stream is recovering from a stall for camera " + camera_id);
+        return Status::OK;
+    }
+    
     try {
         // Marquer comme en cours d'arrêt
+        bool was_stalled = it->second->status == STATUS_STALLED;
         it->second->status = STATUS_STOPPING;
         
-        // Arrêter la capture
-        if (it->second->camera_manager) {
-            it->second->camera_manager->StopCapture();
+        // Arrêter la capture ; une capture bloquée n'est pas jointe mais
+        // abandonnée, sinon cette RPC attendrait indéfiniment
+        auto& camera_manager = it->second->camera_manager;
+        if (camera_manager && was_stalled && camera_manager->Abandon()) {
+            abandoned_cameras_.push_back(std::move(camera_manager));
+        } else if (camera_manager) {
+            camera_manager->StopCapture();
         }
         
         // Nettoyer les ressources
@@ -173,36 +240,7 @@ Status VisionServiceImpl::GetStreamStatus(ServerContext* context,
         return Status::OK;
     }
     
-    const auto& stream_state = it->second;
-    
-    // Calculer l'uptime
-    auto now = std::chrono::steady_clock::now();
-    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
-        now - stream_state->start_time
-    ).count();
-    
-    // Calculer le FPS approximatif
-    double fps_actual = 0.0;
-    if (uptime > 0) {
-        fps_actual = static_cast<double>(stream_state->frames_processed.load()) / uptime;
-    }
-    
-    // Remplir la réponse
-    response->set_camera_id(camera_id);
-    response->set_status(stream_state->status);
-    response->set_message("Stream active");
-    
-    // Statistiques
-    auto* stats = response->mutable_stats();
-    stats->set_frames_processed(stream_state->frames_processed.load());
-    stats->set_detections_count(stream_state->detections_count.load());
-    stats->set_fps_actual(fps_actual);
-    stats->set_uptime_seconds(uptime);
-    stats->set_last_frame_timestamp(
-        std::chrono::duration_cast<std::chrono::seconds>(
-            now.time_since_epoch()
-        ).count()
-    );
+    FillStatusResponse(*it->second, std::chrono::steady_clock::now(), response);
     
     return Status::OK;
 }
@@ -216,6 +254,8 @@ Status VisionServiceImpl::GetHealth(ServerContext* context,
     ).count();
     
     int active_streams_count = 0;
+    int stalled_streams = 0;
+    int degraded_cameras = 0;
     std::string health_status = HEALTH_HEALTHY;
     std::string health_message = "Service is healthy";
     
@@ -223,16 +263,30 @@ Status VisionServiceImpl::GetHealth(ServerContext* context,
         auto lock = LockStreams();
         active_streams_count = active_streams_.size();
         
-        // Vérifier s'il y a des streams en erreur
+        // Vérifier s'il y a des streams en erreur ou bloqués
         for (const auto& [camera_id, stream_state] : active_streams_) {
-            if (stream_state->status == "error") {
+            if (stream_state->status == STATUS_STALLED) {
+                stalled_streams++;
+            } else if (stream_state->status == "error") {
                 health_status = HEALTH_DEGRADED;
                 health_message = "One or more streams in error state";
-                break;
+            }
+            if (stream_state->frame_processor && stream_state->frame_processor->GetHealthMonitor()->IsThrottled()) {
+                degraded_cameras++;
             }
         }
     }
     
+    if (degraded_cameras > 0) {
+        health_status = HEALTH_DEGRADED;
+        health_message = std::to_string(degraded_cameras) + " camera image(s) degraded";
+    }
+    
+    if (stalled_streams > 0) {
+        health_status = HEALTH_DEGRADED;
+        health_message = std::to_string(stalled_streams) + " stream(s) stalled";
+    }
+    
     // Si trop de streams actifs, marquer comme dégradé
     if (active_streams_count >= MAX_CONCURRENT_STREAMS * 0.9) {
         health_status = HEALTH_DEGRADED;
@@ -244,6 +298,19 @@ Status VisionServiceImpl::GetHealth(ServerContext* context,
     response->set_active_streams(active_streams_count);
     response->set_uptime_seconds(uptime);
     response->set_version(GetServiceVersion());
+    response->set_stalled_streams(stalled_streams);
+    response->set_degraded_cameras(degraded_cameras);
+    response->set_stall_count(total_stalls_.load());
+    
+    PlacementStats placement_stats = placer_->GetStats();
+    const CpuTopology& topology = placer_->GetTopology();
+    auto* placement = response->mutable_placement();
+    placement->set_placements(placement_stats.placements);
+    placement->set_releases(placement_stats.releases);
+    placement->set_moves(placement_stats.moves);
+    placement->set_numa_nodes(topology.GetNumaNodeCount());
+    placement->set_cache_domains(topology.GetL3DomainCount());
+    placement->set_cpus(static_cast<int32_t>(topology.GetCpus().size()));
     
     return Status::OK;
 }
@@ -252,39 +319,584 @@ Status VisionServiceImpl::ProcessFrames(ServerContext* context,
                                        ServerReaderWriter<FrameResponse, FrameRequest>* stream) {
     LogInfo("ProcessFrames stream started");
     
+    // Les réponses sont écrites par un thread dédié dès qu'elles sont prêtes
+    ResponseQueue<FrameResponse> outgoing;
+    FrameSession session(worker_pool_.get(), [this, &outgoing](FrameResponse&& response) {
+        total_frames_processed_++;
+        ServiceMetrics::Instance().IncrementFramesProcessed();
+        outgoing.Push(std::move(response));
+    });
+    
+    std::thread writer([this, &outgoing, &session, stream]() {
+        std::deque<FrameResponse> ready;
+        while (outgoing.PopAll(&ready)) {
+            for (const auto& response : ready) {
+                if (!stream->Write(response)) {
+                    LogError("Failed to write frame response");
+                    outgoing.Close();
+                    break;
+                }
+                session.Acknowledge(response.camera_id());
+            }
+            ready.clear();
+        }
+    });
+    
+    Status status = Status::OK;
     FrameRequest request;
     while (stream->Read(&request)) {
-        const std::string& camera_id = request.camera_id();
-        
-        // Traitement simulé pour Phase 2.1
-        FrameResponse response;
-        response.set_camera_id(camera_id);
-        response.set_timestamp(request.timestamp());
-        
-        // Simuler quelques détections
-        // (sera remplacé par du vrai traitement OpenCV en Phase 2.3)
-        
-        // Statistiques de traitement simulées
-        auto* stats = response.mutable_processing_stats();
-        stats->set_processing_time_ms(10);  // 10ms simulé
-        stats->set_detections_count(0);     // Aucune détection pour l'instant
-        stats->set_cpu_usage(15.5f);        // 15.5% simulé
-        stats->set_memory_usage_mb(128);    // 128MB simulé
-        
-        if (!stream->Write(response)) {
-            LogError("Failed to write frame response");
+        if (session.Submit(std::move(request)) == SubmitResult::REJECTED) {
+            status = Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                            "Too many cameras in one ProcessFrames stream");
             break;
         }
-        
-        // Incrémenter les statistiques
+        request.Clear();
+    }
+    
+    session.Drain();
+    outgoing.Close();
+    writer.join();
+    
+    LogInfo("ProcessFrames stream ended (" + std::to_string(session.GetFramesShed()) + " frames shed)");
+    return status;
+}
+
+Status VisionServiceImpl::ProcessFrameBatches(ServerContext* context,
+                                             ServerReaderWriter<FrameResultBatch, FrameBatch>* stream) {
+    LogInfo("ProcessFrameBatches stream started");
+    
+    ResponseQueue<FrameResponse> outgoing;
+    FrameSession session(worker_pool_.get(), [this, &outgoing](FrameResponse&& response) {
         total_frames_processed_++;
         ServiceMetrics::Instance().IncrementFramesProcessed();
+        outgoing.Push(std::move(response));
+    });
+    
+    // Toutes les réponses prêtes au moment de l'écriture partent dans un seul message
+    std::thread writer([this, &outgoing, &session, stream]() {
+        std::deque<FrameResponse> ready;
+        while (outgoing.PopAll(&ready)) {
+            FrameResultBatch batch;
+            batch.mutable_results()->Reserve(static_cast<int>(ready.size()));
+            for (auto& response : ready) {
+                batch.add_results()->Swap(&response);
+            }
+            ready.clear();
+            
+            if (!stream->Write(batch)) {
+                LogError("Failed to write frame result batch");
+                outgoing.Close();
+                continue;
+            }
+            for (const auto& response : batch.results()) {
+                session.Acknowledge(response.camera_id());
+            }
+        }
+    });
+    
+    Status status = Status::OK;
+    FrameBatch batch;
+    while (status.ok() && stream->Read(&batch)) {
+        for (auto& frame_request : *batch.mutable_frames()) {
+            if (session.Submit(std::move(frame_request)) == SubmitResult::REJECTED) {
+                status = Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                "Too many cameras in one ProcessFrameBatches stream");
+                break;
+            }
+        }
+        batch.Clear();
+    }
+    
+    session.Drain();
+    outgoing.Close();
+    writer.join();
+    
+    LogInfo("ProcessFrameBatches stream ended (" + std::to_string(session.GetFramesShed()) + " frames shed)");
+    return status;
+}
+
+Status VisionServiceImpl::ListStreams(ServerContext* context,
+                                     const ListStreamsRequest* request,
+                                     ListStreamsResponse* response) {
+    auto now = std::chrono::steady_clock::now();
+    
+    // Un seul verrou : toutes les entrées viennent du même snapshot
+    auto lock = LockStreams();
+    
+    if (request->camera_ids().empty()) {
+        std::vector<const StreamState*> states;
+        states.reserve(active_streams_.size());
+        for (const auto& [camera_id, stream_state] : active_streams_) {
+            states.push_back(stream_state.get());
+        }
+        std::sort(states.begin(), states.end(),
+                  [](const StreamState* a, const StreamState* b) {
+                      return a->camera_id < b->camera_id;
+                  });
+        
+        for (const StreamState* stream_state : states) {
+            FillStatusResponse(*stream_state, now, response->add_streams());
+        }
+    } else {
+        for (const auto& camera_id : request->camera_ids()) {
+            StatusResponse* entry = response->add_streams();
+            const StreamState* stream_state = GetStreamState(camera_id);
+            if (stream_state) {
+                FillStatusResponse(*stream_state, now, entry);
+            } else {
+                entry->set_camera_id(camera_id);
+                entry->set_status(STATUS_STOPPED);
+                entry->set_message("No active stream");
+            }
+        }
+    }
+    
+    response->set_snapshot_timestamp(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count()
+    );
+    
+    return Status::OK;
+}
+
+Status VisionServiceImpl::BatchStartStream(ServerContext* context,
+                                          const BatchStartRequest* request,
+                                          ServerWriter<BatchStartResult>* writer) {
+    LogInfo("BatchStartStream called for " + std::to_string(request->streams_size()) + " cameras");
+    
+    std::vector<StreamRequest> requests(request->streams().begin(), request->streams().end());
+    
+    StartStreamsParallel(requests, [context, writer](const BatchStartResult& result) {
+        if (context && context->IsCancelled()) {
+            return false;
+        }
+        return writer->Write(result);
+    });
+    
+    return Status::OK;
+}
+
+Status VisionServiceImpl::QueryDetections(ServerContext* context,
+                                          const DetectionQuery* request,
+                                          DetectionQueryResponse* response) {
+    const std::string& camera_id = request->camera_id();
+    if (camera_id.empty()) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Camera ID cannot be empty");
+    }
+    if (detection_log_directory_.empty()) {
+        response->set_status(STATUS_ERROR);
+        response->set_message("Detection log is disabled");
+        return Status::OK;
+    }
+    
+    int64_t end = request->end_timestamp();
+    if (end <= 0) {
+        end = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+    }
+    if (request->start_timestamp() > end) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Start timestamp is after end timestamp");
+    }
+    int limit = request->limit() > 0 ? std::min(request->limit(), MAX_QUERY_DETECTIONS) : MAX_QUERY_DETECTIONS;
+    
+    // Le lot en attente d'un stream actif devient visible ; un stream
+    // arrêté a écrit le sien à l'arrêt
+    {
+        auto lock = LockStreams();
+        StreamState* stream_state = GetStreamState(camera_id);
+        if (stream_state && stream_state->detection_log) {
+            stream_state->detection_log->Flush();
+        }
+    }
+    
+    // Lecture hors verrou : le journal n'a pas besoin de son écrivain
+    DetectionQueryResult result;
+    DetectionLog::Query(GetDetectionLogPath(camera_id), request->start_timestamp(), end,
+                        static_cast<size_t>(limit), &result);
+    
+    for (const DetectionRecord& record : result.records) {
+        Detection* detection = response->add_detections();
+        detection->set_type(DetectionLog::GetTypeName(record.type_id));
+        detection->set_confidence(record.confidence);
+        detection->set_timestamp(record.timestamp_ms);
+        BoundingBox* bbox = detection->mutable_bbox();
+        bbox->set_x(record.x);
+        bbox->set_y(record.y);
+        bbox->set_width(record.width);
+        bbox->set_height(record.height);
+        if (record.track_id != 0) {
+            (*detection->mutable_metadata())["track_id"] = std::to_string(record.track_id);
+        }
+    }
+    response->set_truncated(result.truncated);
+    response->set_records_scanned(result.records_scanned);
+    response->set_status(STATUS_SUCCESS);
+    response->set_message(std::to_string(result.records.size()) + " detections from " +
+                          std::to_string(result.segments_scanned) + " segments");
+    return Status::OK;
+}
+
+Status VisionServiceImpl::GetHeatmap(ServerContext* context,
+                                     const HeatmapRequest* request,
+                                     HeatmapResponse* response) {
+    const std::string& camera_id = request->camera_id();
+    if (camera_id.empty()) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Camera ID cannot be empty");
+    }
+    MotionHeatmapKind kind;
+    if (!MotionHeatmap::ParseKind(request->kind(), &kind)) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Unknown heatmap kind: " + request->kind());
+    }
+    bool png = request->format() == "png";
+    if (!png && !request->format().empty() && request->format() != "grid") {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Unknown heatmap format: " + request->format());
+    }
+    
+    // Stream actif : carte en mémoire ; sinon la dernière sauvegardée
+    MotionHeatmapGrid grid;
+    bool found = false;
+    {
+        auto lock = LockStreams();
+        StreamState* stream_state = GetStreamState(camera_id);
+        if (stream_state && stream_state->frame_processor) {
+            grid = stream_state->frame_processor->GetHeatmap()->GetGrid(kind);
+            found = true;
+        }
+    }
+    if (!found && !state_directory_.empty()) {
+        MotionHeatmap saved;
+        if (FrameProcessor::LoadHeatmapCheckpoint(GetHeatmapPath(camera_id), &saved)) {
+            grid = saved.GetGrid(kind);
+            found = true;
+        }
+    }
+    if (!found) {
+        response->set_status(STATUS_ERROR);
+        response->set_message("No heatmap for camera " + camera_id);
+        return Status::OK;
     }
     
-    LogInfo("ProcessFrames stream ended");
+    response->set_grid_width(grid.grid_width);
+    response->set_grid_height(grid.grid_height);
+    response->set_block_size(FrameProcessorConstants::MOTION_BLOCK_SIZE);
+    response->set_origin_x(grid.origin_x);
+    response->set_origin_y(grid.origin_y);
+    response->set_frames(static_cast<int64_t>(grid.frames));
+    response->set_since_timestamp(grid.since_ms);
+    if (png) {
+        std::vector<uint8_t> image = MotionHeatmap::RenderPng(grid, request->scale());
+        response->set_png(image.data(), image.size());
+    } else {
+        std::string* bytes = response->mutable_grid();
+        bytes->resize(grid.values.size() * sizeof(uint16_t));
+        for (size_t i = 0; i < grid.values.size(); ++i) {
+            (*bytes)[2 * i] = static_cast<char>(grid.values[i] & 0xFF);
+            (*bytes)[2 * i + 1] = static_cast<char>(grid.values[i] >> 8);
+        }
+    }
+    response->set_status(STATUS_SUCCESS);
+    response->set_message(grid.IsEmpty() ? "No motion analysed yet" : "Heatmap over " +
+                          std::to_string(grid.frames) + " frames");
+    return Status::OK;
+}
+
+Status VisionServiceImpl::GetAnalytics(ServerContext* context,
+                                       const AnalyticsRequest* request,
+                                       AnalyticsResponse* response) {
+    const std::string& camera_id = request->camera_id();
+    if (camera_id.empty()) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "Camera ID cannot be empty");
+    }
+    int max_events = request->max_events() > 0 ? std::min(request->max_events(), MAX_ANALYTICS_EVENTS)
+                                               : MAX_ANALYTICS_EVENTS;
+    
+    AnalyticsSnapshot snapshot;
+    {
+        auto lock = LockStreams();
+        StreamState* stream_state = GetStreamState(camera_id);
+        if (!stream_state || stream_state->status != STATUS_ACTIVE) {
+            response->set_status(STATUS_ERROR);
+            response->set_message("Stream not found for camera " + camera_id);
+            return Status::OK;
+        }
+        if (!stream_state->analytics) {
+            response->set_status(STATUS_ERROR);
+            response->set_message("No active zone or counting line for camera " + camera_id);
+            return Status::OK;
+        }
+        snapshot = stream_state->analytics->Snapshot(request->since_sequence(), static_cast<size_t>(max_events));
+    }
+    
+    for (const ZoneCounters& zone : snapshot.zones) {
+        auto* counters = response->add_zones();
+        counters->set_zone_id(zone.zone_id);
+        counters->set_entries(zone.entries);
+        counters->set_exits(zone.exits);
+        counters->set_occupancy(zone.occupancy);
+        counters->set_dwell_total_ms(zone.dwell_total_ms);
+        counters->set_dwell_max_ms(zone.dwell_max_ms);
+    }
+    for (const LineCounters& line : snapshot.lines) {
+        auto* counters = response->add_lines();
+        counters->set_line_id(line.line_id);
+        counters->set_forward(line.forward);
+        counters->set_backward(line.backward);
+    }
+    for (const AnalyticsEvent& event : snapshot.events) {
+        auto* out = response->add_events();
+        out->set_sequence(event.sequence);
+        out->set_type(AnalyticsEvent::GetTypeName(event.type));
+        out->set_target_id(event.target_id);
+        out->set_track_id(event.track_id);
+        out->set_object_type(event.object_type);
+        if (event.type == AnalyticsEvent::Type::LINE_CROSS) {
+            out->set_direction(event.forward ? "forward" : "backward");
+        }
+        out->set_dwell_ms(event.dwell_ms);
+        out->set_timestamp(event.timestamp_ms);
+    }
+    response->set_next_sequence(snapshot.next_sequence);
+    response->set_events_dropped(snapshot.events_dropped);
+    response->set_active_tracks(snapshot.active_tracks);
+    response->set_status(STATUS_SUCCESS);
+    response->set_message(std::to_string(snapshot.events.size()) + " events");
     return Status::OK;
 }
 
+void VisionServiceImpl::StartStreamsParallel(const std::vector<StreamRequest>& requests,
+                                            const BatchResultCallback& on_result) {
+    std::mutex results_mutex;
+    std::condition_variable results_condition;
+    std::queue<BatchStartResult> results;
+    
+    auto push_result = [&](BatchStartResult result) {
+        {
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results.push(std::move(result));
+        }
+        results_condition.notify_one();
+    };
+    
+    for (const auto& request : requests) {
+        Status validation_status = ValidateStreamRequest(&request);
+        if (!validation_status.ok()) {
+            BatchStartResult result;
+            result.set_camera_id(request.camera_id());
+            result.mutable_result()->set_status(STATUS_ERROR);
+            result.mutable_result()->set_message(validation_status.error_message());
+            push_result(std::move(result));
+            continue;
+        }
+        
+        bool posted = worker_pool_->Post([this, request, &push_result]() {
+            auto begin = std::chrono::steady_clock::now();
+            
+            BatchStartResult result;
+            result.set_camera_id(request.camera_id());
+            StartStreamInternal(request, result.mutable_result());
+            result.set_elapsed_ms(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - begin
+                ).count()
+            );
+            
+            push_result(std::move(result));
+        });
+        
+        if (!posted) {
+            BatchStartResult result;
+            result.set_camera_id(request.camera_id());
+            result.mutable_result()->set_status(STATUS_ERROR);
+            result.mutable_result()->set_message("Service is shutting down");
+            push_result(std::move(result));
+        }
+    }
+    
+    // Remettre les résultats au fil de l'eau ; on attend toujours toutes les
+    // tâches car elles référencent l'état local de cette fonction
+    bool delivering = true;
+    for (size_t delivered = 0; delivered < requests.size(); ++delivered) {
+        BatchStartResult result;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            results_condition.wait(lock, [&results]() { return !results.empty(); });
+            result = std::move(results.front());
+            results.pop();
+        }
+        
+        if (delivering && !on_result(result)) {
+            LogError("Batch start results no longer delivered (client gone)");
+            delivering = false;
+        }
+    }
+}
+
+StreamsConfigReport VisionServiceImpl::ApplyStreamsConfig(const StreamsConfig& config) {
+    std::lock_guard<std::mutex> apply_lock(config_apply_mutex_);
+    auto start = std::chrono::steady_clock::now();
+    StreamsConfigReport report;
+    if (shutting_down_.load()) {
+        return report;
+    }
+    
+    // Différence entre l'ensemble désiré et les streams actifs
+    std::vector<StreamRequest> to_start;
+    std::vector<std::string> to_stop;
+    std::unordered_set<std::string> restarts;
+    {
+        auto lock = LockStreams();
+        std::unordered_set<std::string> desired;
+        for (const auto& request : config.streams()) {
+            desired.insert(request.camera_id());
+            StreamState* stream_state = GetStreamState(request.camera_id());
+            if (!stream_state) {
+                to_start.push_back(request);
+            } else if (google::protobuf::util::MessageDifferencer::Equals(stream_state->request, request)) {
+                stream_state->from_config = true;
+                report.unchanged++;
+            } else if (stream_state->status == STATUS_STARTING || stream_state->recovering) {
+                // Repris au prochain rechargement
+                LogError("Stream busy, config change deferred for camera: " + request.camera_id());
+                report.failed++;
+            } else {
+                to_stop.push_back(request.camera_id());
+                to_start.push_back(request);
+                restarts.insert(request.camera_id());
+            }
+        }
+        for (const auto& [camera_id, stream_state] : active_streams_) {
+            if (stream_state->from_config && !desired.count(camera_id)) {
+                to_stop.push_back(camera_id);
+            }
+        }
+    }
+    
+    for (const auto& camera_id : to_stop) {
+        StopRequest stop_request;
+        StopResponse stop_response;
+        stop_request.set_camera_id(camera_id);
+        StopStream(nullptr, &stop_request, &stop_response);
+        if (stop_response.status() != STATUS_SUCCESS) {
+            LogError("Config: failed to stop " + camera_id + ": " + stop_response.message());
+        } else if (!restarts.count(camera_id)) {
+            report.stopped++;
+        }
+    }
+    
+    StartStreamsParallel(to_start, [&](const BatchStartResult& result) {
+        if (result.result().status() != STATUS_SUCCESS) {
+            LogError("Config: failed to start " + result.camera_id() + ": " + result.result().message());
+            report.failed++;
+            return true;
+        }
+        {
+            auto lock = LockStreams();
+            StreamState* stream_state = GetStreamState(result.camera_id());
+            if (stream_state) {
+                stream_state->from_config = true;
+            }
+        }
+        if (restarts.count(result.camera_id())) {
+            report.restarted++;
+        } else {
+            report.started++;
+        }
+        return true;
+    });
+    
+    report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LogInfo("Streams config applied, all streams active in " + std::to_string(report.elapsed.count()) +
+            " ms (started " + std::to_string(report.started) +
+            ", restarted " + std::to_string(report.restarted) +
+            ", stopped " + std::to_string(report.stopped) +
+            ", unchanged " + std::to_string(report.unchanged) +
+            ", failed " + std::to_string(report.failed) + ")");
+    return report;
+}
+
+void VisionServiceImpl::ApplyStreamsConfigAsync(const StreamsConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        if (config_stop_) {
+            return;
+        }
+        pending_config_ = std::make_unique<StreamsConfig>(config);
+        if (!config_thread_.joinable()) {
+            config_thread_ = std::thread(&VisionServiceImpl::ConfigLoop, this);
+        }
+    }
+    config_condition_.notify_all();
+}
+
+void VisionServiceImpl::ConfigLoop() {
+    std::unique_lock<std::mutex> lock(config_mutex_);
+    while (true) {
+        config_condition_.wait(lock, [this]() { return config_stop_ || pending_config_; });
+        if (config_stop_) {
+            break;
+        }
+        std::unique_ptr<StreamsConfig> config = std::move(pending_config_);
+        lock.unlock();
+        ApplyStreamsConfig(*config);
+        lock.lock();
+    }
+}
+
+void VisionServiceImpl::StopConfigThread() {
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        config_stop_ = true;
+    }
+    config_condition_.notify_all();
+    if (config_thread_.joinable()) {
+        config_thread_.join();
+    }
+}
+
+bool VisionServiceImpl::SetStateDirectory(const std::string& directory) {
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            LogError("Cannot create state directory " + directory + ": " + error.message());
+            return false;
+        }
+    }
+    state_directory_ = directory;
+    return true;
+}
+
+bool VisionServiceImpl::SetDetectionLogDirectory(const std::string& directory) {
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            LogError("Cannot create detection log directory " + directory + ": " + error.message());
+            return false;
+        }
+    }
+    detection_log_directory_ = directory;
+    return true;
+}
+
+bool VisionServiceImpl::SetModelDirectory(const std::string& directory) {
+    if (directory.empty()) {
+        model_directory_.clear();
+        return true;
+    }
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::canonical(directory, error);
+    if (error || !std::filesystem::is_directory(canonical, error)) {
+        LogError("Cannot use model directory " + directory);
+        return false;
+    }
+    model_directory_ = canonical;
+    return true;
+}
+
 int VisionServiceImpl::GetActiveStreamsCount() const {
     auto lock = LockStreams();
     return active_streams_.size();
@@ -313,8 +925,19 @@ std::string VisionServiceImpl::GenerateStreamId(const std::string& camera_id) co
 }
 
 void VisionServiceImpl::CleanupStream(const std::string& camera_id) {
-    // Nettoyage des ressources (pour l'instant minimal)
     LogDebug("Cleaning up resources for camera: " + camera_id);
+    
+    // Les cœurs libérés peuvent rééquilibrer les autres streams ; chaque
+    // caméra déplacée se réépingle elle-même à sa frame suivante
+    for (const auto& move : placer_->Release(camera_id)) {
+        StreamState* moved = GetStreamState(move.stream_id);
+        if (moved && moved->camera_manager) {
+            moved->camera_manager->SetCpuAffinity(move.placement.cpus);
+        }
+        LogInfo("Stream " + move.stream_id + " moved to CPUs " +
+                CpuTopology::FormatCpuList(move.placement.cpus) +
+                " (NUMA node " + std::to_string(move.placement.numa_node) + ")");
+    }
     // Les unique_ptr se nettoient automatiquement
 }
 
@@ -322,11 +945,669 @@ std::string VisionServiceImpl::GetServiceVersion() const {
     return "1.0.0-phase2.1";
 }
 
+void VisionServiceImpl::StartStreamInternal(const StreamRequest& request, StreamResponse* response) {
+    const std::string& camera_id = request.camera_id();
+    const std::string& camera_url = request.camera_url();
+    StreamState* stream_state = nullptr;
+    
+    {
+        auto lock = LockStreams();
+        
+        if (shutting_down_.load()) {
+            response->set_status(STATUS_ERROR);
+            response->set_message("Service is shutting down");
+            return;
+        }
+        
+        // Vérifier si le stream existe déjà
+        if (active_streams_.find(camera_id) != active_streams_.end()) {
+            LogError("Stream already exists for camera: " + camera_id);
+            response->set_status(STATUS_ERROR);
+            response->set_message("Stream already active for camera " + camera_id);
+            return;
+        }
+        
+        // Vérifier la limite de streams concurrents
+        if (active_streams_.size() >= MAX_CONCURRENT_STREAMS) {
+            LogError("Maximum concurrent streams reached");
+            response->set_status(STATUS_ERROR);
+            response->set_message("Maximum number of concurrent streams reached");
+            return;
+        }
+        
+        // Réserver l'entrée en état "starting" pour bloquer les doublons
+        auto new_state = std::make_unique<StreamState>(camera_id, camera_url);
+        new_state->request = request;
+        stream_state = new_state.get();
+        active_streams_[camera_id] = std::move(new_state);
+    }
+    
+    // Initialisation de la caméra hors verrou : les autres RPC ne sont pas
+    // bloquées par une caméra lente à répondre
+    std::unique_ptr<DetectionLog> detection_log;
+    std::unique_ptr<TrackAnalytics> analytics;
+    std::unique_ptr<CameraManager> camera_manager;
+    std::unique_ptr<FrameProcessor> frame_processor;
+    CameraConfig camera_config = ToCameraConfig(request.config());
+    std::string error_message;
+    
+    try {
+        frame_processor = std::make_unique<FrameProcessor>();
+        frame_processor->Initialize();
+        const auto& detector = request.config().detector();
+        if (detector.motion_threshold() > 0) frame_processor->SetMotionThreshold(detector.motion_threshold());
+        if (detector.min_detection_area() > 0) frame_processor->SetMinDetectionArea(detector.min_detection_area());
+        if (detector.max_detections_per_frame() > 0) {
+            frame_processor->SetMaxDetectionsPerFrame(detector.max_detections_per_frame());
+        }
+        if (detector.max_classifications_per_frame() > 0) {
+            frame_processor->SetClassificationBudget(detector.max_classifications_per_frame());
+        }
+        std::string model_path;
+        if (ResolveModelPath(detector.classifier_model(), &model_path)) {
+            std::string model_error;
+            if (auto classifier = LoadClassifier(model_path, &model_error)) {
+                frame_processor->SetClassifier(std::move(classifier));
+            } else {
+                // Le flux démarre quand même, sans second étage
+                LogError("Classifier disabled for camera " + camera_id + ": " + model_error);
+            }
+        }
+        if (!state_directory_.empty() &&
+            frame_processor->EnableCheckpoint(GetStatePath(camera_id), HashDetectorConfig(request),
+                                              std::chrono::milliseconds(CHECKPOINT_INTERVAL_MS))) {
+            LogInfo("Detector state restored for camera: " + camera_id);
+        }
+        if (!state_directory_.empty()) {
+            frame_processor->EnableHeatmapCheckpoint(GetHeatmapPath(camera_id),
+                                                     std::chrono::milliseconds(CHECKPOINT_INTERVAL_MS));
+        }
+        // Sans capture de this : une capture abandonnée peut survivre au service
+        frame_processor->GetHealthMonitor()->SetTransitionCallback([camera_id](const CameraHealthStatus& status) {
+            std::string message = "Camera image " + std::string(CameraHealthMonitor::StateToString(status.state)) +
+                                  " for camera: " + camera_id;
+            if (status.throttled) {
+                LOG_ERROR(message);
+            } else {
+                LOG_INFO(message);
+            }
+        });
+        if (!detection_log_directory_.empty()) {
+            // Un journal inutilisable n'empêche pas l'analyse
+            detection_log = std::make_unique<DetectionLog>();
+            if (!detection_log->Open(GetDetectionLogPath(camera_id))) {
+                LogError("Cannot open detection log for camera: " + camera_id);
+                detection_log.reset();
+            }
+        }
+        analytics = std::make_unique<TrackAnalytics>(request.config().zones(), request.config().lines());
+        if (analytics->IsEmpty()) {
+            analytics.reset();
+        }
+        camera_manager = CreateCameraManager(camera_url, frame_processor.get(), analytics.get(),
+                                             detection_log.get(), stream_state);
+        
+        OpenResult opened = OpenCamera(camera_manager, camera_config);
+        if (opened == OpenResult::ABANDONED) {
+            LogError("Abandoning camera still opening at shutdown deadline: " + camera_id);
+            error_message = "Service is shutting down";
+        } else if (opened == OpenResult::FAILED) {
+            LogError("Failed to initialize camera manager for: " + camera_id);
+            error_message = "Failed to initialize camera for " + camera_id;
+        } else if (!camera_manager->StartCapture()) {
+            LogError("Failed to start capture for: " + camera_id);
+            error_message = "Failed to start capture for " + camera_id;
+        }
+    } catch (const std::exception& e) {
+        LogError("Exception in StartStream: " + std::string(e.what()));
+        error_message = "Internal error: " + std::string(e.what());
+    }
+    
+    if (error_message.empty()) {
+        auto lock = LockStreams();
+        
+        // Arrêt commencé pendant l'initialisation : Shutdown() a ignoré ce
+        // stream en démarrage, c'est à nous de l'arrêter
+        if (shutting_down_.load()) {
+            error_message = "Service is shutting down";
+        } else {
+            stream_state->camera_manager = std::move(camera_manager);
+            stream_state->frame_processor = std::move(frame_processor);
+            stream_state->detection_log = std::move(detection_log);
+            stream_state->analytics = std::move(analytics);
+            stream_state->camera_config = camera_config;
+            stream_state->start_time = std::chrono::steady_clock::now();
+            
+            // Marquer comme actif
+            stream_state->status = STATUS_ACTIVE;
+        }
+    }
+    
+    if (!error_message.empty()) {
+        // Détruire la caméra hors verrou (peut joindre un thread)
+        camera_manager.reset();
+        
+        auto lock = LockStreams();
+        CleanupStream(camera_id);
+        active_streams_.erase(camera_id);
+        response->set_status(STATUS_ERROR);
+        response->set_message(error_message);
+        return;
+    }
+    
+    // Incrémenter les statistiques
+    total_streams_started_++;
+    ServiceMetrics::Instance().IncrementStreamsStarted();
+    
+    // Préparer la réponse
+    response->set_status(STATUS_SUCCESS);
+    response->set_message("Stream started successfully");
+    response->set_stream_id(GenerateStreamId(camera_id));
+    
+    LogInfo("Stream started successfully for camera: " + camera_id);
+}
+
+FrameCallback VisionServiceImpl::MakeFrameCallback(FrameProcessor* processor, TrackAnalytics* analytics,
+                                                   DetectionLog* detection_log, StreamState* stream_state) {
+    // Les frames capturées sont analysées par l'étage de livraison du stream
+    // (coroutine sur le pool, ou thread de capture d'une source bloquante),
+    // unique écrivain des statistiques du stream, des compteurs et du journal
+    return [processor, analytics, detection_log, stream_state](const Frame& frame) {
+        ProcessingResult result = processor->ProcessFrame(frame);
+        if (result.illumination_change) {
+            LOG_INFO("Illumination change compensated for camera: " + stream_state->camera_id);
+        }
+        // Frame non analysée (caméra dégradée) : pas une absence d'objet,
+        // les pistes ne doivent pas la compter comme manquée
+        if (analytics && !result.skipped) {
+            // Avant le journal, qui conserve ainsi les pistes
+            analytics->Update(&result.detections, std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()
+            ).count());
+        }
+        // Frame répétée par la source : déjà journalisée
+        if (detection_log && !result.skipped && !result.repeated) {
+            detection_log->Append(result.detections);
+        }
+        int64_t detections = static_cast<int64_t>(result.detections.size());
+        int64_t timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+        stream_state->stats.Update([&](StreamStatsSnapshot& stats) {
+            stats.frames_processed++;
+            stats.detections_count += detections;
+            stats.last_frame_timestamp = timestamp;
+        });
+    };
+}
+
+void VisionServiceImpl::WatchdogLoop() {
+    std::unique_lock<std::mutex> lock(watchdog_mutex_);
+    while (!watchdog_condition_.wait_for(lock, std::chrono::milliseconds(WATCHDOG_INTERVAL_MS),
+                                         [this]() { return watchdog_stop_; })) {
+        lock.unlock();
+        CheckStalledStreams(std::chrono::steady_clock::now());
+        lock.lock();
+    }
+}
+
+void VisionServiceImpl::StopWatchdog() {
+    {
+        std::lock_guard<std::mutex> lock(watchdog_mutex_);
+        watchdog_stop_ = true;
+    }
+    watchdog_condition_.notify_all();
+    if (watchdog_thread_.joinable()) {
+        watchdog_thread_.join();
+    }
+}
+
+bool VisionServiceImpl::IsCaptureStalled(const CameraManager& camera,
+                                         std::chrono::steady_clock::time_point now) {
+    CameraStatsSnapshot stats = camera.GetStats().Snapshot();
+    CameraConfig config = camera.GetConfig();
+    
+    auto threshold = std::max(
+        std::chrono::milliseconds(STALL_MIN_MS),
+        std::chrono::milliseconds(STALL_FRAME_INTERVALS * 1000 / std::max(1, config.fps)));
+    
+    // Disjoncteur ouvert : source morte connue, sans thread à débloquer
+    CameraState state = camera.GetState();
+    if (state == CameraState::CIRCUIT_OPEN) {
+        return false;
+    }
+    
+    // Une reconnexion attend volontairement avant de reprendre
+    if (state == CameraState::RECONNECTING) {
+        threshold += std::chrono::milliseconds(config.reconnect_delay_ms);
+    }
+    
+    // Un essai semi-ouvert repart de sa transition, pas de la dernière frame
+    auto last_activity = std::max({stats.last_frame_time, stats.start_time,
+                                   camera.GetCircuitBreakerStatus().last_transition});
+    return now - last_activity > threshold;
+}
+
+int VisionServiceImpl::CheckStalledStreams(std::chrono::steady_clock::time_point now) {
+    ReapAbandonedCameras(false);
+    
+    int newly_stalled = 0;
+    std::vector<std::string> to_replace;
+    {
+        auto lock = LockStreams();
+        for (auto& [camera_id, stream_state] : active_streams_) {
+            if ((stream_state->status != STATUS_ACTIVE && stream_state->status != STATUS_STALLED) ||
+                stream_state->recovering) {
+                continue;
+            }
+            
+            // Remplacement précédent en échec : nouvel essai
+            if (!stream_state->camera_manager) {
+                stream_state->recovering = true;
+                to_replace.push_back(camera_id);
+                continue;
+            }
+            
+            if (!IsCaptureStalled(*stream_state->camera_manager, now)) {
+                if (stream_state->status == STATUS_STALLED) {
+                    stream_state->status = STATUS_ACTIVE;
+                    LogInfo("Stream recovered for camera: " + camera_id);
+                }
+                continue;
+            }
+            
+            if (stream_state->status == STATUS_ACTIVE) {
+                stream_state->status = STATUS_STALLED;
+                stream_state->stall_count++;
+                total_stalls_++;
+                newly_stalled++;
+                LogError("Capture stalled for camera: " + camera_id);
+            }
+            
+            // Source abandonnée sans joindre son thread ; elle reste en vie
+            // jusqu'à ce que ce thread sorte de lui-même
+            if (stream_state->camera_manager->Abandon()) {
+                abandoned_cameras_.push_back(std::move(stream_state->camera_manager));
+                stream_state->recovering = true;
+                to_replace.push_back(camera_id);
+            }
+        }
+    }
+    
+    for (const auto& camera_id : to_replace) {
+        if (!worker_pool_->Post([this, camera_id]() { ReplaceCameraSource(camera_id); })) {
+            auto lock = LockStreams();
+            StreamState* stream_state = GetStreamState(camera_id);
+            if (stream_state) {
+                stream_state->recovering = false;
+            }
+        }
+    }
+    
+    return newly_stalled;
+}
+
+void VisionServiceImpl::ReplaceCameraSource(const std::string& camera_id) {
+    StreamState* stream_state = nullptr;
+    std::string camera_url;
+    CameraConfig camera_config;
+    {
+        auto lock = LockStreams();
+        stream_state = GetStreamState(camera_id);
+        if (!stream_state || !stream_state->recovering) {
+            return;
+        }
+        camera_url = stream_state->camera_url;
+        camera_config = stream_state->camera_config;
+    }
+    
+    // Le stream ne peut pas être arrêté pendant "recovering" : stream_state
+    // et son processeur restent valides hors verrou
+    auto camera_manager = CreateCameraManager(camera_url, stream_state->frame_processor.get(),
+                                              stream_state->analytics.get(),
+                                              stream_state->detection_log.get(), stream_state);
+    bool started = false;
+    try {
+        OpenResult opened = OpenCamera(camera_manager, camera_config);
+        if (opened == OpenResult::ABANDONED) {
+            LogError("Abandoning camera still opening at shutdown deadline: " + camera_id);
+        }
+        started = opened == OpenResult::OPENED && camera_manager->StartCapture();
+    } catch (const std::exception& e) {
+        LogError("Exception while replacing camera source: " + std::string(e.what()));
+    }
+    
+    auto lock = LockStreams();
+    stream_state->recovering = false;
+    if (started) {
+        stream_state->camera_manager = std::move(camera_manager);
+        LogInfo("Camera source replaced for: " + camera_id);
+    } else {
+        // Nouvel essai au prochain passage du watchdog
+        LogError("Failed to replace camera source for: " + camera_id);
+    }
+    lock.unlock();
+    
+    // Échec : destruction hors verrou (peut joindre un thread)
+    camera_manager.reset();
+}
+
+VisionServiceImpl::OpenResult VisionServiceImpl::OpenCamera(std::unique_ptr<CameraManager>& camera_manager,
+                                                            const CameraConfig& config) {
+    auto pending = std::make_shared<PendingOpen>();
+    {
+        // Enregistrée avant que Shutdown() ne fixe les échéances, ou refusée
+        std::lock_guard<std::mutex> lock(open_mutex_);
+        if (shutting_down_.load()) {
+            return OpenResult::FAILED;
+        }
+        pending_opens_.push_back(pending);
+    }
+    
+    std::thread opener([pending, camera = camera_manager.get(), config]() {
+        bool opened = false;
+        std::exception_ptr exception;
+        try {
+            opened = camera->Initialize(config);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        std::unique_ptr<CameraManager> abandoned;  // jamais démarrée : la détruire ne touche pas au service
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->done = true;
+            pending->opened = opened;
+            pending->exception = exception;
+            abandoned = std::move(pending->abandoned);
+        }
+        pending->condition.notify_all();
+    });
+    
+    bool done = false;
+    {
+        std::unique_lock<std::mutex> lock(pending->mutex);
+        while (!pending->done) {
+            if (pending->deadline == std::chrono::steady_clock::time_point::max()) {
+                pending->condition.wait(lock);
+            } else if (pending->condition.wait_until(lock, pending->deadline) == std::cv_status::timeout) {
+                break;
+            }
+        }
+        done = pending->done;
+        if (!done) {
+            pending->abandoned = std::move(camera_manager);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(open_mutex_);
+        pending_opens_.erase(std::find(pending_opens_.begin(), pending_opens_.end(), pending));
+    }
+    
+    if (!done) {
+        opener.detach();
+        return OpenResult::ABANDONED;
+    }
+    opener.join();
+    if (pending->exception) {
+        std::rethrow_exception(pending->exception);
+    }
+    return pending->opened ? OpenResult::OPENED : OpenResult::FAILED;
+}
+
+void VisionServiceImpl::AbandonPendingOpens(std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(open_mutex_);
+    for (auto& pending : pending_opens_) {
+        {
+            std::lock_guard<std::mutex> pending_lock(pending->mutex);
+            pending->deadline = deadline;
+        }
+        pending->condition.notify_all();
+    }
+}
+
+void VisionServiceImpl::ReapAbandonedCameras(bool detach_hung) {
+    std::vector<std::unique_ptr<CameraManager>> exited;
+    {
+        auto lock = LockStreams();
+        for (auto it = abandoned_cameras_.begin(); it != abandoned_cameras_.end(); ) {
+            if ((*it)->HasCaptureLoopExited()) {
+                exited.push_back(std::move(*it));
+                it = abandoned_cameras_.erase(it);
+            } else if (detach_hung) {
+                // Fin du processus : l'objet est volontairement laissé au thread bloqué
+                (*it)->DetachCaptureThread();
+                it->release();
+                it = abandoned_cameras_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // Jointure immédiate : ces threads sont sortis de leur boucle
+}
+
+int64_t VisionServiceImpl::GetStallCount() const {
+    return total_stalls_.load();
+}
+
+void VisionServiceImpl::FillStatusResponse(const StreamState& stream_state,
+                                          std::chrono::steady_clock::time_point now,
+                                          StatusResponse* response) const {
+    // Calculer l'uptime
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        now - stream_state.start_time
+    ).count();
+    
+    // Instantané cohérent, sans verrou ni contention avec le thread de capture
+    StreamStatsSnapshot snapshot = stream_state.stats.Snapshot();
+    
+    // Calculer le FPS approximatif
+    double fps_actual = 0.0;
+    if (uptime > 0) {
+        fps_actual = static_cast<double>(snapshot.frames_processed) / uptime;
+    }
+    
+    // Remplir la réponse
+    response->set_camera_id(stream_state.camera_id);
+    response->set_status(stream_state.status);
+    response->set_message(stream_state.status == STATUS_STARTING ? "Stream starting" : "Stream active");
+    if (stream_state.camera_manager &&
+        stream_state.camera_manager->GetState() == CameraState::CIRCUIT_OPEN) {
+        response->set_message("Camera unreachable, circuit open");
+    }
+    
+    // Statistiques
+    auto* stats = response->mutable_stats();
+    stats->set_frames_processed(snapshot.frames_processed);
+    stats->set_detections_count(snapshot.detections_count);
+    stats->set_fps_actual(fps_actual);
+    stats->set_uptime_seconds(uptime);
+    stats->set_last_frame_timestamp(snapshot.last_frame_timestamp);
+    
+    StreamPlacement placement = placer_->GetPlacement(stream_state.camera_id);
+    if (!placement.IsEmpty()) {
+        auto* stream_placement = response->mutable_placement();
+        for (int cpu : placement.cpus) {
+            stream_placement->add_cpus(cpu);
+        }
+        stream_placement->set_numa_node(placement.numa_node);
+        stream_placement->set_cache_domain(placement.l3_domain);
+    }
+    
+    // Source en cours de remplacement : pas encore de disjoncteur
+    if (stream_state.camera_manager) {
+        CircuitBreakerStatus breaker = stream_state.camera_manager->GetCircuitBreakerStatus();
+        auto* circuit_breaker = response->mutable_circuit_breaker();
+        circuit_breaker->set_state(CircuitBreaker::StateToString(breaker.state));
+        circuit_breaker->set_consecutive_failures(breaker.consecutive_failures);
+        circuit_breaker->set_trips(breaker.trips);
+        if (breaker.state == CircuitState::OPEN) {
+            auto retry_in = std::chrono::duration_cast<std::chrono::milliseconds>(breaker.retry_at - now);
+            circuit_breaker->set_retry_in_ms(std::max<int64_t>(0, retry_in.count()));
+        }
+    }
+    
+    if (stream_state.frame_processor) {
+        CameraHealthStatus image = stream_state.frame_processor->GetHealthMonitor()->GetStatus();
+        auto* health = response->mutable_health();
+        health->set_state(CameraHealthMonitor::StateToString(image.state));
+        health->set_brightness(image.current.brightness);
+        health->set_contrast(image.current.contrast);
+        health->set_saturated(image.current.saturated);
+        health->set_sharpness(image.current.sharpness);
+        health->set_reference_sharpness(image.reference.sharpness);
+        health->set_edge_change(image.edge_change);
+        health->set_transitions(image.transitions);
+        health->set_since_timestamp(image.since_ms);
+        health->set_throttled(image.throttled);
+    }
+}
+
+std::unique_ptr<CameraManager> VisionServiceImpl::CreateCameraManager(const std::string& camera_url,
+                                                                      FrameProcessor* processor,
+                                                                      TrackAnalytics* analytics,
+                                                                      DetectionLog* detection_log,
+                                                                      StreamState* stream_state) const {
+    auto camera_manager = std::make_unique<CameraManager>(camera_url);
+    camera_manager->SetTimerWheel(timer_wheel_.get());
+    camera_manager->SetExecutor(stream_executor_.get(), frame_clock_.get());
+    
+    // Idempotent : une source remplacée garde les cœurs de son stream. Une
+    // capture coopérative tourne sur les threads partagés du pool : elle
+    // n'occupe aucun cœur du placement.
+    if (camera_manager->IsCooperative()) {
+        LogInfo("Stream " + stream_state->camera_id + " runs on the shared executor, not pinned");
+    } else {
+        StreamPlacement placement = placer_->Place(stream_state->camera_id);
+        camera_manager->SetCpuAffinity(placement.cpus);
+        LogInfo("Stream " + stream_state->camera_id + " placed on CPUs " +
+                 CpuTopology::FormatCpuList(placement.cpus) +
+                 " (NUMA node " + std::to_string(placement.numa_node) + ")");
+    }
+    camera_manager->SetFrameCallback(MakeFrameCallback(processor, analytics, detection_log, stream_state));
+    return camera_manager;
+}
+
+CameraConfig VisionServiceImpl::ToCameraConfig(const StreamConfig& config) {
+    // Les champs non renseignés gardent les valeurs par défaut
+    CameraConfig camera_config;
+    if (config.width() > 0) camera_config.width = config.width();
+    if (config.height() > 0) camera_config.height = config.height();
+    if (config.fps() > 0) camera_config.fps = config.fps();
+    if (FrameUtils::IsValidFormat(config.format())) camera_config.format = config.format();
+    
+    const auto& capture = config.capture();
+    if (capture.reconnect_delay_ms() > 0) camera_config.reconnect_delay_ms = capture.reconnect_delay_ms();
+    if (capture.max_reconnect_attempts() > 0) camera_config.max_reconnect_attempts = capture.max_reconnect_attempts();
+    if (capture.circuit_open_ms() > 0) camera_config.circuit_open_ms = capture.circuit_open_ms();
+    if (capture.circuit_open_max_ms() > 0) camera_config.circuit_open_max_ms = capture.circuit_open_max_ms();
+    
+    // Seules les zones actives sont analysées : la capture est recadrée dessus
+    camera_config.region_of_interest = FrameUtils::ComputeActiveZonesRegion(
+        config.zones(), camera_config.width, camera_config.height,
+        FrameProcessorConstants::ZONE_REGION_MARGIN);
+    return camera_config;
+}
+
+std::string VisionServiceImpl::GetStatePath(const std::string& camera_id) const {
+    return (std::filesystem::path(state_directory_) / (ToFileName(camera_id) + STATE_FILE_EXTENSION)).string();
+}
+
+std::string VisionServiceImpl::GetHeatmapPath(const std::string& camera_id) const {
+    return (std::filesystem::path(state_directory_) / (ToFileName(camera_id) + HEATMAP_FILE_EXTENSION)).string();
+}
+
+std::string VisionServiceImpl::GetDetectionLogPath(const std::string& camera_id) const {
+    return (std::filesystem::path(detection_log_directory_) / ToFileName(camera_id)).string();
+}
+
+std::string VisionServiceImpl::ToFileName(const std::string& camera_id) {
+    // Échappement injectif : deux caméras distinctes n'écrivent jamais dans
+    // le même fichier, et "." ou ".." ne désignent plus un répertoire
+    static const char HEX[] = "0123456789ABCDEF";
+    std::string name;
+    name.reserve(camera_id.size());
+    for (char c : camera_id) {
+        auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || c == '-' || c == '_') {
+            name += c;
+        } else {
+            name += '%';
+            name += HEX[byte >> 4];
+            name += HEX[byte & 0x0F];
+        }
+    }
+    return name;
+}
+
+bool VisionServiceImpl::IsValidCameraId(const std::string& camera_id) {
+    return !camera_id.empty() && camera_id.size() <= MAX_CAMERA_ID_LENGTH &&
+           camera_id != "." && camera_id != "..";
+}
+
+bool VisionServiceImpl::ResolveModelPath(const std::string& name, std::string* path) const {
+    std::filesystem::path relative(name);
+    if (model_directory_.empty() || name.empty() || relative.has_root_path()) {
+        return false;
+    }
+    // Liens suivis : c'est le fichier réel qui doit rester dans le répertoire
+    std::error_code error;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(model_directory_ / relative, error);
+    if (error) {
+        return false;
+    }
+    auto mismatch = std::mismatch(model_directory_.begin(), model_directory_.end(),
+                                  resolved.begin(), resolved.end());
+    if (mismatch.first != model_directory_.end() || mismatch.second == resolved.end()) {
+        return false;
+    }
+    *path = resolved.string();
+    return true;
+}
+
+std::unique_ptr<Detector> VisionServiceImpl::LoadClassifier(const std::string& path, std::string* error) {
+    char magic[4] = {};
+    std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+    if (std::string(magic, sizeof(magic)) == "VHOG") {
+        auto detector = std::make_unique<HogPersonDetector>();
+        return detector->Load(path, error) ? std::move(detector) : nullptr;
+    }
+    auto classifier = std::make_unique<CnnClassifier>();
+    return classifier->Load(path, error) ? std::move(classifier) : nullptr;
+}
+
+uint64_t VisionServiceImpl::HashDetectorConfig(const StreamRequest& request) {
+    // Les réglages de reconnexion et le second étage n'influencent
+    // pas ce que le détecteur apprend
+    StreamConfig config = request.config();
+    config.clear_capture();
+    if (config.has_detector()) {
+        config.mutable_detector()->clear_max_classifications_per_frame();
+        config.mutable_detector()->clear_classifier_model();
+    }
+    
+    std::string bytes = request.camera_url();
+    bytes.push_back('\0');
+    {
+        google::protobuf::io::StringOutputStream output(&bytes);
+        google::protobuf::io::CodedOutputStream coded(&output);
+        coded.SetSerializationDeterministic(true);
+        config.SerializeToCodedStream(&coded);
+    }
+    return DetectorCheckpoint::Hash(bytes);
+}
+
 Status VisionServiceImpl::ValidateStreamRequest(const StreamRequest* request) const {
     if (request->camera_id().empty()) {
         return Status(grpc::StatusCode::INVALID_ARGUMENT, "Camera ID cannot be empty");
     }
     
+    if (!IsValidCameraId(request->camera_id())) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                      "Camera ID must be at most " + std::to_string(MAX_CAMERA_ID_LENGTH) +
+                      " characters and not \".\" or \"..\"");
+    }
+    
     if (request->camera_url().empty()) {
         return Status(grpc::StatusCode::INVALID_ARGUMENT, "Camera URL cannot be empty");
     }
@@ -335,6 +1616,14 @@ Status VisionServiceImpl::ValidateStreamRequest(const StreamRequest* request) co
         return Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid camera URL format");
     }
     
+    // Nom relatif au répertoire des modèles du serveur, sans en sortir
+    std::string model_path;
+    const std::string& model = request->config().detector().classifier_model();
+    if (!model.empty() && !ResolveModelPath(model, &model_path)) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                      "Classifier model must name a file in the server models directory");
+    }
+    
     return Status::OK;
 }
 
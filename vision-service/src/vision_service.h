@@ -8,11 +8,27 @@
 #include <mutex>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <condition_variable>
+#include <filesystem>
+#include <exception>
 
 #include <grpcpp/grpcpp.h>
 #include "vision.grpc.pb.h"
 #include "frame_processor.h"
 #include "camera_manager.h"
+#include "worker_pool.h"
+#include "frame_session.h"
+#include "stats_block.h"
+#include "timer_wheel.h"
+#include "stream_placement.h"
+#include "stream_config.h"
+#include "detection_log.h"
+#include "track_analytics.h"
+#include "quantized_cnn.h"
+#include "hog_detector.h"
 
 using grpc::Server;
 using grpc::ServerContext;
@@ -32,6 +48,26 @@ using surveillance::vision::HealthRequest;
 using surveillance::vision::HealthResponse;
 using surveillance::vision::FrameRequest;
 using surveillance::vision::FrameResponse;
+using surveillance::vision::StreamConfig;
+using surveillance::vision::ListStreamsRequest;
+using surveillance::vision::ListStreamsResponse;
+using surveillance::vision::BatchStartRequest;
+using surveillance::vision::BatchStartResult;
+using surveillance::vision::FrameBatch;
+using surveillance::vision::FrameResultBatch;
+using surveillance::vision::DetectionQuery;
+using surveillance::vision::DetectionQueryResponse;
+using surveillance::vision::HeatmapRequest;
+using surveillance::vision::HeatmapResponse;
+using surveillance::vision::AnalyticsRequest;
+using surveillance::vision::AnalyticsResponse;
+
+// Statistiques de traitement d'un stream
+struct StreamStatsSnapshot {
+    int64_t frames_processed = 0;
+    int64_t detections_count = 0;
+    int64_t last_frame_timestamp = 0;  // secondes depuis l'epoch
+};
 
 // Structure pour suivre l'état d'un stream
 struct StreamState {
@@ -39,21 +75,46 @@ struct StreamState {
     std::string camera_url;
     std::string status;  // "starting", "active", "stopping", "error"
     std::chrono::steady_clock::time_point start_time;
-    std::atomic<int64_t> frames_processed{0};
-    std::atomic<int64_t> detections_count{0};
-    std::unique_ptr<CameraManager> camera_manager;
-    std::unique_ptr<FrameProcessor> frame_processor;
     std::mutex state_mutex;
     
+    // Écrites par le thread de capture, lues par GetStreamStatus/ListStreams
+    StatsBlock<StreamStatsSnapshot> stats;
+    
+    // Surveillance des blocages (protégé par le verrou des streams)
+    CameraConfig camera_config;
+    StreamRequest request;       // requête d'origine, comparée au rechargement
+    bool from_config = false;    // géré par le fichier de configuration
+    int64_t stall_count = 0;
+    bool recovering = false;     // source en cours de remplacement
+    
+    // La caméra est détruite (capture arrêtée) avant le processeur qu'elle
+    // alimente, puis le journal, qui écrit alors son dernier lot
+    std::unique_ptr<DetectionLog> detection_log;
+    std::unique_ptr<TrackAnalytics> analytics;  // nul sans zone ni ligne active
+    std::unique_ptr<FrameProcessor> frame_processor;
+    std::unique_ptr<CameraManager> camera_manager;
+    
     StreamState(const std::string& cam_id, const std::string& cam_url) 
         : camera_id(cam_id), camera_url(cam_url), status("starting"), 
           start_time(std::chrono::steady_clock::now()) {}
 };
 
+// Bilan de l'application d'un fichier de configuration
+struct StreamsConfigReport {
+    int started = 0;
+    int restarted = 0;
+    int stopped = 0;
+    int unchanged = 0;
+    int failed = 0;
+    std::chrono::milliseconds elapsed{0};  // jusqu'à ce que tous les streams soient actifs
+};
+
 // Implémentation du service gRPC
 class VisionServiceImpl final : public VisionService::Service {
 public:
     VisionServiceImpl();
+    // Topologie imposée (tests, machine décrite hors sysfs)
+    explicit VisionServiceImpl(const CpuTopology& topology);
     virtual ~VisionServiceImpl();
     
     // Méthodes du service gRPC
@@ -76,14 +137,132 @@ public:
     Status ProcessFrames(ServerContext* context,
                         ServerReaderWriter<FrameResponse, FrameRequest>* stream) override;
     
+    Status ListStreams(ServerContext* context,
+                      const ListStreamsRequest* request,
+                      ListStreamsResponse* response) override;
+    
+    Status BatchStartStream(ServerContext* context,
+                           const BatchStartRequest* request,
+                           ServerWriter<BatchStartResult>* writer) override;
+    
+    Status ProcessFrameBatches(ServerContext* context,
+                              ServerReaderWriter<FrameResultBatch, FrameBatch>* stream) override;
+    
+    Status QueryDetections(ServerContext* context,
+                          const DetectionQuery* request,
+                          DetectionQueryResponse* response) override;
+    
+    Status GetHeatmap(ServerContext* context,
+                     const HeatmapRequest* request,
+                     HeatmapResponse* response) override;
+    
+    Status GetAnalytics(ServerContext* context,
+                       const AnalyticsRequest* request,
+                       AnalyticsResponse* response) override;
+    
+    // Démarrage parallèle sur le pool de workers : on_result est appelé
+    // (depuis le thread appelant) dans l'ordre de complétion. Retourner
+    // false arrête la remise des résultats, pas les démarrages en cours.
+    using BatchResultCallback = std::function<bool(const BatchStartResult&)>;
+    void StartStreamsParallel(const std::vector<StreamRequest>& requests,
+                              const BatchResultCallback& on_result);
+    
+    // Arrêt du service : refuse les nouveaux streams, termine les démarrages
+    // en file puis arrête toutes les caméras en parallèle. Une ouverture de
+    // source encore en cours à l'échéance est abandonnée. Retourne false si
+    // le budget a été dépassé. Idempotent ; appelé par le destructeur.
+    bool Shutdown(std::chrono::milliseconds budget);
+    bool IsShuttingDown() const;
+    
+    // Watchdog : marque "stalled" les streams sans frame depuis trop
+    // longtemps par rapport à leur cadence, abandonne leur source bloquée
+    // (sans joindre son thread) et la remplace sur le pool. Appelé
+    // périodiquement ; retourne le nombre de nouveaux blocages.
+    int CheckStalledStreams(std::chrono::steady_clock::time_point now);
+    int64_t GetStallCount() const;
+    
+    // Configuration déclarative : compare l'ensemble désiré aux streams
+    // actifs et ne touche que les différences (nouveaux, modifiés, retirés
+    // du fichier). Les démarrages se font en parallèle sur le pool ; un
+    // stream lancé par RPC et identique au fichier est adopté tel quel.
+    // Bloquant ; les applications successives sont sérialisées.
+    StreamsConfigReport ApplyStreamsConfig(const StreamsConfig& config);
+    
+    // Idem sur un thread dédié, sans bloquer l'appelant (démarrage à chaud,
+    // SIGHUP) ; une configuration en attente est remplacée par la suivante
+    void ApplyStreamsConfigAsync(const StreamsConfig& config);
+    
+    // Répertoire des checkpoints d'état des détecteurs (créé au besoin),
+    // un fichier par caméra ; vide = pas de checkpoint. À appeler avant
+    // le démarrage des streams.
+    bool SetStateDirectory(const std::string& directory);
+    
+    // Journal des détections, un sous-répertoire par caméra (créé au
+    // besoin) ; vide = détections non conservées. Même contrainte.
+    bool SetDetectionLogDirectory(const std::string& directory);
+    
+    // Répertoire des modèles de second étage (existant) : classifier_model
+    // y est résolu et ne peut pas en sortir ; vide = aucun classifieur
+    // accepté. Même contrainte.
+    bool SetModelDirectory(const std::string& directory);
+    
     // Méthodes utilitaires publiques
     int GetActiveStreamsCount() const;
     
 private:
+    // Périodes d'ouverture des disjoncteurs de toutes les caméras ; déclarée
+    // avant les streams pour leur survivre
+    std::unique_ptr<TimerWheel> timer_wheel_;
+    
+    // Pipelines coopératifs des streams : pool partagé et horloge des
+    // frames, déclarés avant les streams pour leur survivre. Ajouter un
+    // étage à un stream n'ajoute aucun thread.
+    std::unique_ptr<TimerWheel> frame_clock_;
+    std::unique_ptr<WorkerPool> stream_executor_;
+    
     // État interne
     std::unordered_map<std::string, std::unique_ptr<StreamState>> active_streams_;
     mutable std::mutex streams_mutex_;
     std::chrono::steady_clock::time_point service_start_time_;
+    std::unique_ptr<WorkerPool> worker_pool_;
+    std::unique_ptr<StreamPlacer> placer_;
+    std::atomic<bool> shutting_down_{false};
+    std::string state_directory_;
+    std::string detection_log_directory_;
+    std::filesystem::path model_directory_;  // canonique
+    
+    // Watchdog des captures bloquées
+    std::thread watchdog_thread_;
+    std::mutex watchdog_mutex_;
+    std::condition_variable watchdog_condition_;
+    bool watchdog_stop_ = false;
+    std::atomic<int64_t> total_stalls_{0};
+    
+    // Application asynchrone de la configuration
+    std::mutex config_apply_mutex_;          // sérialise ApplyStreamsConfig
+    std::thread config_thread_;
+    std::mutex config_mutex_;
+    std::condition_variable config_condition_;
+    std::unique_ptr<StreamsConfig> pending_config_;
+    bool config_stop_ = false;
+    
+    // Caméras abandonnées dont le thread n'est pas encore sorti ; détruites
+    // seulement après sa sortie (protégé par le verrou des streams)
+    std::vector<std::unique_ptr<CameraManager>> abandoned_cameras_;
+    
+    // Ouverture de source en cours sur son propre thread, partagée avec lui :
+    // le thread ne touche qu'à elle et à sa caméra
+    struct PendingOpen {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done = false;
+        bool opened = false;
+        std::exception_ptr exception;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        std::unique_ptr<CameraManager> abandoned;  // détruite par le thread à son retour
+    };
+    std::mutex open_mutex_;
+    std::vector<std::shared_ptr<PendingOpen>> pending_opens_;
     
     // Statistiques
     std::atomic<int64_t> total_streams_started_{0};
@@ -93,9 +272,56 @@ private:
     // Méthodes privées
     bool IsValidCameraUrl(const std::string& url) const;
     std::string GenerateStreamId(const std::string& camera_id) const;
-    void CleanupStream(const std::string& camera_id);
+    void CleanupStream(const std::string& camera_id);  // verrou des streams tenu
     std::string GetServiceVersion() const;
     
+    // Démarrage d'un stream (l'initialisation caméra se fait hors verrou)
+    void StartStreamInternal(const StreamRequest& request, StreamResponse* response);
+    static FrameCallback MakeFrameCallback(FrameProcessor* processor, TrackAnalytics* analytics,
+                                           DetectionLog* detection_log, StreamState* stream_state);
+    std::unique_ptr<CameraManager> CreateCameraManager(const std::string& camera_url,
+                                                       FrameProcessor* processor,
+                                                       TrackAnalytics* analytics,
+                                                       DetectionLog* detection_log,
+                                                       StreamState* stream_state) const;
+    // Initialize() de la caméra, qui peut bloquer plusieurs secondes (RTSP).
+    // Elle tourne sur un thread à part que l'appelant attend jusqu'à son
+    // retour ou jusqu'à l'échéance fixée par Shutdown(). À l'échéance,
+    // l'ouverture est abandonnée comme une capture bloquée : la caméra
+    // passe à son thread, qui la détruit en sortant.
+    enum class OpenResult { OPENED, FAILED, ABANDONED };
+    OpenResult OpenCamera(std::unique_ptr<CameraManager>& camera_manager, const CameraConfig& config);
+    void AbandonPendingOpens(std::chrono::steady_clock::time_point deadline);
+    
+    // Watchdog
+    void WatchdogLoop();
+    void StopWatchdog();
+    void ConfigLoop();
+    void StopConfigThread();
+    static bool IsCaptureStalled(const CameraManager& camera,
+                                 std::chrono::steady_clock::time_point now);
+    void ReplaceCameraSource(const std::string& camera_id);
+    void ReapAbandonedCameras(bool detach_hung);
+    void FillStatusResponse(const StreamState& stream_state,
+                            std::chrono::steady_clock::time_point now,
+                            StatusResponse* response) const;
+    static CameraConfig ToCameraConfig(const StreamConfig& config);
+    // Classifieur de second étage selon l'en-tête du modèle (réseau
+    // quantifié ou HOG) ; nullptr et message si le fichier est refusé
+    static std::unique_ptr<Detector> LoadClassifier(const std::string& path, std::string* error);
+    // Chemin réel d'un modèle nommé relativement au répertoire des modèles ;
+    // false s'il n'y en a pas ou si le chemin en sort (absolu, "..", lien)
+    bool ResolveModelPath(const std::string& name, std::string* path) const;
+    
+    // Checkpoints : un changement de source, de résolution, de zones ou de
+    // réglages du détecteur invalide l'état sauvegardé
+    std::string GetStatePath(const std::string& camera_id) const;
+    std::string GetHeatmapPath(const std::string& camera_id) const;  // indépendant des réglages
+    static uint64_t HashDetectorConfig(const StreamRequest& request);
+    std::string GetDetectionLogPath(const std::string& camera_id) const;
+    static std::string ToFileName(const std::string& camera_id);  // injectif
+    static bool IsValidCameraId(const std::string& camera_id);
+    
     // Validation des requêtes
     Status ValidateStreamRequest(const StreamRequest* request) const;
     Status ValidateStopRequest(const StopRequest* request) const;
@@ -151,6 +377,37 @@ namespace VisionServiceConstants {
     constexpr int DEFAULT_FRAME_BUFFER_SIZE = 30;  // ~2 secondes à 15fps
     constexpr int HEALTH_CHECK_INTERVAL_SEC = 30;
     constexpr int STREAM_TIMEOUT_SEC = 300;  // 5 minutes
+    constexpr int DEFAULT_SHUTDOWN_BUDGET_MS = 800;  // déploiements progressifs
+    constexpr int SHUTDOWN_POLL_INTERVAL_MS = 5;
+    
+    // Watchdog : un stream est bloqué sans frame depuis
+    // max(STALL_MIN_MS, STALL_FRAME_INTERVALS périodes de frame)
+    constexpr int WATCHDOG_INTERVAL_MS = 1000;
+    constexpr int STALL_MIN_MS = 3000;
+    constexpr int STALL_FRAME_INTERVALS = 10;
+    
+    // Roue des disjoncteurs : précision d'un tick, 51,2 s par tour
+    constexpr int TIMER_WHEEL_TICK_MS = 100;
+    constexpr int TIMER_WHEEL_SLOTS = 512;
+    
+    // Horloge des frames : 2 ms de précision, 2 s par tour
+    constexpr int FRAME_CLOCK_TICK_MS = 2;
+    constexpr int FRAME_CLOCK_SLOTS = 1024;
+    
+    // Checkpoints de l'état des détecteurs
+    constexpr int CHECKPOINT_INTERVAL_MS = 5000;
+    const std::string STATE_FILE_EXTENSION = ".state";
+    const std::string HEATMAP_FILE_EXTENSION = ".heatmap";
+    
+    // Identifiant de caméra : une fois échappé (3 octets par caractère au
+    // plus) et suffixé, il reste un nom de fichier valide
+    constexpr size_t MAX_CAMERA_ID_LENGTH = 64;
+    
+    // Détections renvoyées au plus par QueryDetections
+    constexpr int MAX_QUERY_DETECTIONS = 100000;
+    
+    // Événements renvoyés au plus par GetAnalytics
+    constexpr int MAX_ANALYTICS_EVENTS = 1000;
     
     // Status codes
     const std::string STATUS_SUCCESS = "success";
@@ -159,6 +416,7 @@ namespace VisionServiceConstants {
     const std::string STATUS_ACTIVE = "active";
     const std::string STATUS_STOPPING = "stopping";
     const std::string STATUS_STOPPED = "stopped";
+    const std::string STATUS_STALLED = "stalled";
     
     // Health status
     const std::string HEALTH_HEALTHY = "healthy";
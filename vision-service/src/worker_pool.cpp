@@ -0,0 +1,92 @@
+// src/worker_pool.cpp
+#include "worker_pool.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace WorkerPoolConstants;
+
+WorkerPool::WorkerPool(size_t num_threads) : stopping_(false) {
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(MIN_THREADS, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, MAX_THREADS);
+
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    Shutdown();
+}
+
+bool WorkerPool::Post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_) {
+            return false;
+        }
+        tasks_.push(std::move(task));
+    }
+    queue_condition_.notify_one();
+    return true;
+}
+
+void WorkerPool::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_ && workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+    }
+    queue_condition_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+size_t WorkerPool::GetThreadCount() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return workers_.size();
+}
+
+size_t WorkerPool::GetPendingTasks() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return tasks_.size();
+}
+
+bool WorkerPool::IsRunning() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return !stopping_;
+}
+
+void WorkerPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+            // Vider la file avant de sortir
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "[WorkerPool] Exception in task: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "[WorkerPool] Unknown exception in task." << std::endl;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+// src/worker_pool.h
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// Pool de threads partagé pour les tâches courtes du service
+// (initialisation des caméras, traitement parallèle, ...)
+class WorkerPool {
+public:
+    // num_threads == 0 : dimensionné d'après std::thread::hardware_concurrency()
+    explicit WorkerPool(size_t num_threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Soumettre une tâche et récupérer son résultat via un future.
+    // Lève std::runtime_error si le pool est arrêté.
+    template <typename F>
+    auto Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+    // Soumettre une tâche sans résultat (false si le pool est arrêté)
+    bool Post(std::function<void()> task);
+
+    // Exécute les tâches déjà en file puis joint les threads
+    void Shutdown();
+
+    size_t GetThreadCount() const;
+    size_t GetPendingTasks() const;
+    bool IsRunning() const;
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_condition_;
+    bool stopping_;
+
+    void WorkerLoop();
+};
+
+template <typename F>
+auto WorkerPool::Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using ResultType = std::invoke_result_t<std::decay_t<F>>;
+
+    auto packaged = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(task));
+    std::future<ResultType> result = packaged->get_future();
+
+    if (!Post([packaged]() { (*packaged)(); })) {
+        throw std::runtime_error("WorkerPool is stopped");
+    }
+
+    return result;
+}
+
+// Constantes
+namespace WorkerPoolConstants {
+    constexpr size_t MIN_THREADS = 4;
+    constexpr size_t MAX_THREADS = 64;
+}
+
+#endif // WORKER_POOL_H
@@ -3,10 +3,41 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <numeric>
+#include <unistd.h>
 
 #include "../src/vision_service.h"
 #include "../src/frame_processor.h"
 #include "../src/camera_manager.h"
+#include "../src/worker_pool.h"
+#include "../src/frame_session.h"
+#include "../src/ingest_codec.h"
+#include "../src/stats_block.h"
+#include "../src/timer_wheel.h"
+#include "../src/coroutine.h"
+#include "../src/circuit_breaker.h"
+#include "../src/cpu_topology.h"
+#include "../src/stream_placement.h"
+#include "../src/stream_config.h"
+#include "../src/detector_checkpoint.h"
+#include "../src/detection_log.h"
+#include "../src/motion_heatmap.h"
+#include "../src/track_analytics.h"
+#include "../src/camera_health.h"
+#include "../src/optical_flow.h"
+#include "../src/quantized_cnn.h"
+#include "../src/hog_detector.h"
+#include "../src/pixel_pipeline.h"
+#include "../src/frame_features.h"
+#include "../src/vision_core.h"
 
 // Test fixture pour VisionService
 class VisionServiceTest : public ::testing::Test {
@@ -72,6 +103,90 @@ TEST_F(VisionServiceTest, StartStreamWithInvalidCameraId) {
     
     EXPECT_FALSE(status.ok());
     EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    
+    // Répertoire courant ou parent des fichiers de la caméra, nom trop long
+    for (const std::string camera_id : {std::string("."), std::string(".."), std::string(65, 'c')}) {
+        request.set_camera_id(camera_id);
+        status = service_->StartStream(&context, &request, &response);
+        EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT) << camera_id;
+    }
+}
+
+TEST_F(VisionServiceTest, DistinctCameraIdsGetDistinctFiles) {
+    std::string directory = (std::filesystem::temp_directory_path() /
+                             ("vision_ids_" + std::to_string(getpid()))).string();
+    std::filesystem::remove_all(directory);
+    ASSERT_TRUE(service_->SetDetectionLogDirectory(directory));
+    
+    // Repliés sur le même nom avant l'échappement
+    grpc::ServerContext context;
+    const std::vector<std::string> camera_ids = {"cam/1", "cam_1", "cam.1", "cam%2E1"};
+    for (const auto& camera_id : camera_ids) {
+        surveillance::vision::StreamRequest request;
+        surveillance::vision::StreamResponse response;
+        request.set_camera_id(camera_id);
+        request.set_camera_url("test://pattern");
+        ASSERT_TRUE(service_->StartStream(&context, &request, &response).ok());
+        EXPECT_EQ(response.status(), "success") << camera_id;
+    }
+    
+    std::set<std::string> names;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        names.insert(entry.path().filename().string());
+    }
+    EXPECT_EQ(names, (std::set<std::string>{"cam%2F1", "cam_1", "cam%2E1", "cam%252E1"}));
+    
+    for (const auto& camera_id : camera_ids) {
+        surveillance::vision::StopRequest stop_request;
+        surveillance::vision::StopResponse stop_response;
+        stop_request.set_camera_id(camera_id);
+        service_->StopStream(&context, &stop_request, &stop_response);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(VisionServiceTest, ClassifierModelStaysInModelsDirectory) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / ("vision_models_" + std::to_string(getpid()));
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "models");
+    HogPersonDetector detector;
+    ASSERT_TRUE(detector.SetModel(std::vector<float>(HogConstants::DESCRIPTOR_SIZE, 0.01f), 0.0f));
+    std::vector<uint8_t> bytes = detector.Serialize();
+    for (const auto& file : {root / "models" / "person.vhog", root / "outside.vhog"}) {
+        std::ofstream(file, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    std::filesystem::create_symlink(root / "outside.vhog", root / "models" / "link.vhog");
+    
+    grpc::ServerContext context;
+    surveillance::vision::StreamRequest request;
+    surveillance::vision::StreamResponse response;
+    request.set_camera_id("cam_model");
+    request.set_camera_url("test://pattern");
+    request.mutable_config()->mutable_detector()->set_classifier_model("person.vhog");
+    
+    // Sans répertoire configuré, aucun modèle n'est accepté
+    EXPECT_EQ(service_->StartStream(&context, &request, &response).error_code(),
+              grpc::StatusCode::INVALID_ARGUMENT);
+    EXPECT_FALSE(service_->SetModelDirectory((root / "missing").string()));
+    ASSERT_TRUE(service_->SetModelDirectory((root / "models").string()));
+    
+    // Chemin absolu, remontée ou lien : le fichier réel est hors du répertoire
+    for (const std::string model : {(root / "outside.vhog").string(), std::string("../outside.vhog"),
+                                    std::string("link.vhog"), std::string(".")}) {
+        request.mutable_config()->mutable_detector()->set_classifier_model(model);
+        EXPECT_EQ(service_->StartStream(&context, &request, &response).error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT) << model;
+    }
+    
+    request.mutable_config()->mutable_detector()->set_classifier_model("person.vhog");
+    ASSERT_TRUE(service_->StartStream(&context, &request, &response).ok());
+    EXPECT_EQ(response.status(), "success");
+    
+    surveillance::vision::StopRequest stop_request;
+    surveillance::vision::StopResponse stop_response;
+    stop_request.set_camera_id("cam_model");
+    service_->StopStream(&context, &stop_request, &stop_response);
+    std::filesystem::remove_all(root);
 }
 
 TEST_F(VisionServiceTest, StartStreamWithInvalidUrl) {
@@ -175,6 +290,9 @@ TEST_F(VisionServiceTest, GetStatusOfActiveStream) {
     EXPECT_EQ(status_response.camera_id(), "test_cam");
     EXPECT_EQ(status_response.status(), "active");
     EXPECT_TRUE(status_response.has_stats());
+    EXPECT_GT(status_response.stats().frames_processed(), 0);
+    EXPECT_EQ(status_response.circuit_breaker().state(), "closed");
+    EXPECT_EQ(status_response.circuit_breaker().trips(), 0);
     
     // Nettoyer
     surveillance::vision::StopRequest stop_request;
@@ -197,6 +315,498 @@ TEST_F(VisionServiceTest, GetStatusOfInactiveStream) {
     EXPECT_EQ(response.status(), "stopped");
 }
 
+// Tests des opérations groupées
+TEST_F(VisionServiceTest, ListStreamsReturnsSnapshotOfAllStreams) {
+    grpc::ServerContext context;
+    
+    for (const std::string camera_id : {"cam_b", "cam_a"}) {
+        surveillance::vision::StreamRequest request;
+        surveillance::vision::StreamResponse response;
+        request.set_camera_id(camera_id);
+        request.set_camera_url("test://pattern");
+        service_->StartStream(&context, &request, &response);
+        ASSERT_EQ(response.status(), "success");
+    }
+    
+    surveillance::vision::ListStreamsRequest list_request;
+    surveillance::vision::ListStreamsResponse list_response;
+    grpc::Status status = service_->ListStreams(&context, &list_request, &list_response);
+    
+    EXPECT_TRUE(status.ok());
+    ASSERT_EQ(list_response.streams_size(), 2);
+    EXPECT_EQ(list_response.streams(0).camera_id(), "cam_a");
+    EXPECT_EQ(list_response.streams(1).camera_id(), "cam_b");
+    EXPECT_EQ(list_response.streams(0).status(), "active");
+    EXPECT_GT(list_response.snapshot_timestamp(), 0);
+    
+    // Filtre : les caméras inconnues sont rapportées comme arrêtées
+    list_request.add_camera_ids("cam_b");
+    list_request.add_camera_ids("unknown_cam");
+    list_response.Clear();
+    service_->ListStreams(&context, &list_request, &list_response);
+    
+    ASSERT_EQ(list_response.streams_size(), 2);
+    EXPECT_EQ(list_response.streams(0).status(), "active");
+    EXPECT_EQ(list_response.streams(1).status(), "stopped");
+}
+
+TEST_F(VisionServiceTest, StartStreamsParallelReportsEachCamera) {
+    std::vector<surveillance::vision::StreamRequest> requests;
+    for (int i = 0; i < 4; ++i) {
+        surveillance::vision::StreamRequest request;
+        request.set_camera_id("batch_cam_" + std::to_string(i));
+        request.set_camera_url("test://pattern");
+        requests.push_back(request);
+    }
+    
+    // Doublon et requête invalide : erreurs individuelles, pas d'échec global
+    requests.push_back(requests[0]);
+    surveillance::vision::StreamRequest invalid;
+    invalid.set_camera_id("invalid_cam");
+    requests.push_back(invalid);
+    
+    std::map<std::string, int> successes;
+    int errors = 0;
+    service_->StartStreamsParallel(requests, [&](const surveillance::vision::BatchStartResult& result) {
+        if (result.result().status() == "success") {
+            successes[result.camera_id()]++;
+        } else {
+            errors++;
+        }
+        return true;
+    });
+    
+    EXPECT_EQ(successes.size(), 4u);
+    EXPECT_EQ(errors, 2);
+    EXPECT_EQ(service_->GetActiveStreamsCount(), 4);
+}
+
+TEST_F(VisionServiceTest, ShutdownStopsAllStreamsWithinBudget) {
+    grpc::ServerContext context;
+    
+    // 1 fps : sans attente interruptible, chaque arrêt prendrait jusqu'à 1 s
+    for (int i = 0; i < 4; ++i) {
+        surveillance::vision::StreamRequest request;
+        surveillance::vision::StreamResponse response;
+        request.set_camera_id("cam_" + std::to_string(i));
+        request.set_camera_url("test://pattern");
+        request.mutable_config()->set_fps(1);
+        service_->StartStream(&context, &request, &response);
+        ASSERT_EQ(response.status(), "success");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(service_->Shutdown(std::chrono::milliseconds(500)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    EXPECT_EQ(service_->GetActiveStreamsCount(), 0);
+    EXPECT_TRUE(service_->IsShuttingDown());
+    
+    // Plus aucun démarrage accepté
+    surveillance::vision::StreamRequest request;
+    surveillance::vision::StreamResponse response;
+    request.set_camera_id("late_cam");
+    request.set_camera_url("test://pattern");
+    grpc::Status status = service_->StartStream(&context, &request, &response);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::UNAVAILABLE);
+}
+
+TEST_F(VisionServiceTest, ShutdownAbandonsCameraStillOpeningAtDeadline) {
+    // Ouvertures bien plus longues que le budget : l'une sur le pool (via la
+    // configuration), l'autre sur un thread RPC
+    StreamsConfig config;
+    auto* pooled = config.add_streams();
+    pooled->set_camera_id("slow_pooled");
+    pooled->set_camera_url("test://slow-open");
+    service_->ApplyStreamsConfigAsync(config);
+    auto rpc = std::async(std::launch::async, [this]() {
+        grpc::ServerContext context;
+        surveillance::vision::StreamRequest request;
+        surveillance::vision::StreamResponse response;
+        request.set_camera_id("slow_rpc");
+        request.set_camera_url("test://slow-open");
+        service_->StartStream(&context, &request, &response);
+        return response;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    auto start = std::chrono::steady_clock::now();
+    service_->Shutdown(std::chrono::milliseconds(200));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(200));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(400));
+    
+    // Le démarrage RPC rend la main dès l'abandon, sans sa caméra
+    ASSERT_EQ(rpc.wait_for(std::chrono::milliseconds(100)), std::future_status::ready);
+    surveillance::vision::StreamResponse response = rpc.get();
+    EXPECT_EQ(response.status(), "error");
+    EXPECT_EQ(response.message(), "Service is shutting down");
+    EXPECT_EQ(service_->GetActiveStreamsCount(), 0);
+}
+
+TEST_F(VisionServiceTest, WatchdogMarksStalledStreamAndReplacesSource) {
+    grpc::ServerContext context;
+    surveillance::vision::StreamRequest request;
+    surveillance::vision::StreamResponse response;
+    request.set_camera_id("stuck_cam");
+    request.set_camera_url("test://pattern");
+    service_->StartStream(&context, &request, &response);
+    ASSERT_EQ(response.status(), "success");
+    
+    // Une heure sans frame du point de vue du watchdog
+    auto later = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    EXPECT_EQ(service_->CheckStalledStreams(later), 1);
+    EXPECT_EQ(service_->CheckStalledStreams(later), 0);  // déjà compté
+    EXPECT_EQ(service_->GetStallCount(), 1);
+    
+    surveillance::vision::HealthRequest health_request;
+    surveillance::vision::HealthResponse health;
+    service_->GetHealth(&context, &health_request, &health);
+    EXPECT_EQ(health.status(), "degraded");
+    EXPECT_EQ(health.stalled_streams(), 1);
+    EXPECT_EQ(health.stall_count(), 1);
+    
+    // La source remplacée produit de nouveau des frames : le stream redevient actif
+    surveillance::vision::StatusRequest status_request;
+    surveillance::vision::StatusResponse status_response;
+    status_request.set_camera_id("stuck_cam");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        service_->CheckStalledStreams(std::chrono::steady_clock::now());
+        service_->GetStreamStatus(&context, &status_request, &status_response);
+    } while (status_response.status() != "active" && std::chrono::steady_clock::now() < deadline);
+    EXPECT_EQ(status_response.status(), "active");
+    
+    surveillance::vision::StopRequest stop_request;
+    surveillance::vision::StopResponse stop_response;
+    stop_request.set_camera_id("stuck_cam");
+    service_->StopStream(&context, &stop_request, &stop_response);
+    EXPECT_EQ(stop_response.status(), "success");
+}
+
+TEST_F(VisionServiceTest, ApplyStreamsConfigOnlyTouchesChangedStreams) {
+    StreamsConfig config;
+    std::string error;
+    ASSERT_TRUE(StreamConfigFile::Parse(R"({"streams": [
+        {"camera_id": "cfg_a", "camera_url": "test://pattern"},
+        {"camera_id": "cfg_b", "camera_url": "test://pattern", "config": {"fps": 10}}
+    ]})", &config, &error)) << error;
+    
+    StreamsConfigReport report = service_->ApplyStreamsConfig(config);
+    EXPECT_EQ(report.started, 2);
+    EXPECT_EQ(report.failed, 0);
+    
+    // Stream démarré par RPC : hors du fichier, il n'est jamais arrêté
+    grpc::ServerContext context;
+    surveillance::vision::StreamRequest rpc_request;
+    surveillance::vision::StreamResponse rpc_response;
+    rpc_request.set_camera_id("rpc_cam");
+    rpc_request.set_camera_url("test://pattern");
+    service_->StartStream(&context, &rpc_request, &rpc_response);
+    ASSERT_EQ(rpc_response.status(), "success");
+    
+    report = service_->ApplyStreamsConfig(config);
+    EXPECT_EQ(report.unchanged, 2);
+    EXPECT_EQ(report.started + report.restarted + report.stopped, 0);
+    
+    // cfg_a retiré, cfg_b modifié, cfg_c ajouté
+    ASSERT_TRUE(StreamConfigFile::Parse(R"({"streams": [
+        {"camera_id": "cfg_b", "camera_url": "test://pattern", "config": {"fps": 20}},
+        {"camera_id": "cfg_c", "camera_url": "test://pattern"}
+    ]})", &config, &error)) << error;
+    report = service_->ApplyStreamsConfig(config);
+    EXPECT_EQ(report.started, 1);
+    EXPECT_EQ(report.restarted, 1);
+    EXPECT_EQ(report.stopped, 1);
+    EXPECT_EQ(report.unchanged, 0);
+    EXPECT_EQ(service_->GetActiveStreamsCount(), 3);
+    
+    // Application asynchrone : ne bloque pas l'appelant
+    config.mutable_streams()->RemoveLast();
+    service_->ApplyStreamsConfigAsync(config);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (service_->GetActiveStreamsCount() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(service_->GetActiveStreamsCount(), 2);
+}
+
+TEST(StreamConfigFileTest, RejectsInvalidConfigs) {
+    StreamsConfig config;
+    std::string error;
+    ASSERT_TRUE(StreamConfigFile::Parse(R"({"streams": [{
+        "camera_id": "cam", "camera_url": "rtsp://example.com/stream",
+        "config": {
+            "width": 1280, "height": 720,
+            "zones": [{"id": "door", "active": true, "points": [{"x": 10, "y": 20}]}],
+            "capture": {"reconnect_delay_ms": 1000, "circuit_open_ms": 2000},
+            "detector": {"motion_threshold": 0.2, "min_detection_area": 50}
+        }
+    }]})", &config, &error)) << error;
+    ASSERT_EQ(config.streams_size(), 1);
+    EXPECT_EQ(config.streams(0).config().capture().circuit_open_ms(), 2000);
+    EXPECT_DOUBLE_EQ(config.streams(0).config().detector().motion_threshold(), 0.2);
+    
+    EXPECT_FALSE(StreamConfigFile::Parse("{\"streams\": [", &config, &error));
+    EXPECT_FALSE(StreamConfigFile::Parse(R"({"streams": [{"camera_id": "x", "camera_url": "test://pattern", "fsp": 5}]})",
+                                         &config, &error));
+    EXPECT_FALSE(StreamConfigFile::Parse(R"({"streams": [
+        {"camera_id": "x", "camera_url": "test://pattern"},
+        {"camera_id": "x", "camera_url": "test://pattern"}]})", &config, &error));
+    EXPECT_NE(error.find("Duplicate"), std::string::npos);
+    EXPECT_FALSE(StreamConfigFile::Load("/nonexistent/streams.json", &config, &error));
+    EXPECT_EQ(config.streams_size(), 1);  // inchangé après un échec
+}
+
+TEST_F(VisionServiceTest, ProcessFrameBatchesReturnsTaggedResults) {
+    grpc::ServerBuilder builder;
+    builder.RegisterService(service_.get());
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    ASSERT_TRUE(server);
+    
+    auto stub = surveillance::vision::VisionService::NewStub(
+        server->InProcessChannel(grpc::ChannelArguments()));
+    grpc::ClientContext client_context;
+    auto stream = stub->ProcessFrameBatches(&client_context);
+    
+    Frame frame = FrameUtils::CreateTestFrame(64, 48, "bgr");
+    surveillance::vision::FrameBatch batch;
+    for (int i = 0; i < 6; ++i) {
+        auto* request = batch.add_frames();
+        request->set_camera_id(i % 2 == 0 ? "cam_even" : "cam_odd");
+        request->set_frame_data(frame.data.data(), frame.data.size());
+        request->mutable_metadata()->set_width(frame.width);
+        request->mutable_metadata()->set_height(frame.height);
+        request->mutable_metadata()->set_format(frame.format);
+    }
+    ASSERT_TRUE(stream->Write(batch));
+    stream->WritesDone();
+    
+    std::map<std::string, std::vector<int64_t>> sequences;
+    surveillance::vision::FrameResultBatch results;
+    while (stream->Read(&results)) {
+        for (const auto& result : results.results()) {
+            EXPECT_TRUE(result.error_message().empty());
+            sequences[result.camera_id()].push_back(result.sequence());
+        }
+    }
+    EXPECT_TRUE(stream->Finish().ok());
+    server->Shutdown();
+    
+    EXPECT_EQ(sequences["cam_even"], (std::vector<int64_t>{1, 2, 3}));
+    EXPECT_EQ(sequences["cam_odd"], (std::vector<int64_t>{1, 2, 3}));
+}
+
+TEST_F(VisionServiceTest, QueryDetectionsReadsCameraLog) {
+    ServerContext context;
+    surveillance::vision::DetectionQuery request;
+    surveillance::vision::DetectionQueryResponse response;
+    request.set_camera_id("cam/1");
+    
+    EXPECT_TRUE(service_->QueryDetections(&context, &request, &response).ok());
+    EXPECT_EQ(response.status(), "error");  // journal désactivé
+    
+    std::string directory = (std::filesystem::temp_directory_path() /
+                             ("vision_query_" + std::to_string(getpid()))).string();
+    std::filesystem::remove_all(directory);
+    ASSERT_TRUE(service_->SetDetectionLogDirectory(directory));
+    {
+        DetectionLog log;
+        ASSERT_TRUE(log.Open((std::filesystem::path(directory) / "cam%2F1").string()));
+        for (int i = 0; i < 10; ++i) {
+            DetectionRecord record{};
+            record.timestamp_ms = 1000 + i * 100;
+            record.width = 8;
+            record.type_id = DetectionLog::GetTypeId("vehicle");
+            record.track_id = i % 2;
+            ASSERT_TRUE(log.Append(record));
+        }
+    }
+    
+    request.set_start_timestamp(1200);
+    request.set_end_timestamp(1600);
+    request.set_limit(3);
+    response.Clear();
+    EXPECT_TRUE(service_->QueryDetections(&context, &request, &response).ok());
+    EXPECT_EQ(response.status(), "success");
+    ASSERT_EQ(response.detections_size(), 3);
+    EXPECT_TRUE(response.truncated());
+    EXPECT_EQ(response.detections(0).timestamp(), 1200);
+    EXPECT_EQ(response.detections(0).type(), "vehicle");
+    EXPECT_EQ(response.detections(0).bbox().width(), 8);
+    EXPECT_EQ(response.detections(0).metadata().count("track_id"), 0u);
+    EXPECT_EQ(response.detections(1).metadata().at("track_id"), "1");
+    
+    request.set_start_timestamp(2000);
+    request.set_end_timestamp(1000);
+    EXPECT_EQ(service_->QueryDetections(&context, &request, &response).error_code(),
+              grpc::StatusCode::INVALID_ARGUMENT);
+    
+    std::filesystem::remove_all(directory);
+}
+
+// Tests de la session multiplexée
+TEST(FrameSessionTest, PreservesPerCameraOrderAcrossParallelCameras) {
+    WorkerPool pool(4);
+    std::mutex results_mutex;
+    std::map<std::string, std::vector<int64_t>> sequences;
+    
+    const int frames_per_camera = 40;
+    FrameSession session(&pool, [&](surveillance::vision::FrameResponse&& response) {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        sequences[response.camera_id()].push_back(response.sequence());
+        session.Acknowledge(response.camera_id());
+    }, FlowControlConfig(frames_per_camera, 8));
+    
+    Frame frame = FrameUtils::CreateTestFrame(64, 48, "gray");
+    for (int i = 0; i < frames_per_camera; ++i) {
+        for (const std::string camera_id : {"cam_0", "cam_1", "cam_2"}) {
+            surveillance::vision::FrameRequest request;
+            request.set_camera_id(camera_id);
+            request.set_sequence(100 + i);
+            request.set_frame_data(frame.data.data(), frame.data.size());
+            request.mutable_metadata()->set_width(frame.width);
+            request.mutable_metadata()->set_height(frame.height);
+            request.mutable_metadata()->set_format(frame.format);
+            session.Submit(std::move(request));
+        }
+    }
+    session.Drain();
+    
+    EXPECT_EQ(session.GetCameraCount(), 3u);
+    EXPECT_EQ(session.GetFramesCompleted(), 3 * frames_per_camera);
+    for (const auto& [camera_id, camera_sequences] : sequences) {
+        ASSERT_EQ(camera_sequences.size(), static_cast<size_t>(frames_per_camera)) << camera_id;
+        EXPECT_TRUE(std::is_sorted(camera_sequences.begin(), camera_sequences.end())) << camera_id;
+    }
+}
+
+TEST(FrameSessionTest, ShedsOldestFramesWhenCreditsExhausted) {
+    WorkerPool pool(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pool.Post([released]() { released.wait(); });  // bloque l'unique worker
+    
+    std::vector<int64_t> processed;
+    std::vector<surveillance::vision::FlowControl> flow_controls;
+    FrameSession session(&pool, [&](surveillance::vision::FrameResponse&& response) {
+        processed.push_back(response.sequence());
+        flow_controls.push_back(response.flow_control());
+        session.Acknowledge(response.camera_id());
+    }, FlowControlConfig(2, 1));
+    
+    Frame frame = FrameUtils::CreateTestFrame(64, 48, "gray");
+    auto make_request = [&frame](const std::string& camera_id, int64_t sequence) {
+        surveillance::vision::FrameRequest request;
+        request.set_camera_id(camera_id);
+        request.set_sequence(sequence);
+        request.set_frame_data(frame.data.data(), frame.data.size());
+        request.mutable_metadata()->set_width(frame.width);
+        request.mutable_metadata()->set_height(frame.height);
+        request.mutable_metadata()->set_format(frame.format);
+        return request;
+    };
+    
+    EXPECT_EQ(session.Submit(make_request("cam", 1)), SubmitResult::ACCEPTED);
+    EXPECT_EQ(session.Submit(make_request("cam", 2)), SubmitResult::ACCEPTED);
+    EXPECT_EQ(session.GetCredits("cam"), 0);
+    EXPECT_EQ(session.Submit(make_request("cam", 3)), SubmitResult::SHED);
+    EXPECT_EQ(session.Submit(make_request("cam", 4)), SubmitResult::SHED);
+    
+    // Une seule caméra autorisée par session
+    EXPECT_EQ(session.Submit(make_request("other_cam", 1)), SubmitResult::REJECTED);
+    
+    release.set_value();
+    session.Drain();
+    
+    // Les frames les plus récentes sont conservées
+    EXPECT_EQ(processed, (std::vector<int64_t>{3, 4}));
+    EXPECT_EQ(session.GetFramesShed(), 2);
+    ASSERT_EQ(flow_controls.size(), 2u);
+    EXPECT_EQ(flow_controls[0].window(), 2);
+    EXPECT_EQ(flow_controls[0].credits(), 1);
+    EXPECT_EQ(flow_controls[1].credits(), 2);
+    EXPECT_EQ(flow_controls[1].frames_shed(), 2);
+    EXPECT_EQ(session.GetCredits("cam"), 2);
+}
+
+TEST(FrameSessionTest, NegotiatesIngestFormatAndDecodesDeltaFrames) {
+    std::vector<surveillance::vision::FrameResponse> responses;
+    FrameSession session(nullptr, [&](surveillance::vision::FrameResponse&& response) {
+        session.Acknowledge(response.camera_id());
+        responses.push_back(std::move(response));
+    });
+
+    Frame first = FrameUtils::CreateColorFrame(640, 480, 10, 10, 10, "gray");
+    Frame second = first;
+    std::fill(second.data.begin() + 1000, second.data.begin() + 1100, 200);
+
+    surveillance::vision::FrameRequest keyframe;
+    keyframe.set_camera_id("cam");
+    keyframe.set_frame_data(first.data.data(), first.data.size());
+    keyframe.mutable_metadata()->set_width(first.width);
+    keyframe.mutable_metadata()->set_height(first.height);
+    keyframe.mutable_metadata()->set_format("gray");
+    keyframe.mutable_capabilities()->set_gray(true);
+    keyframe.mutable_capabilities()->set_max_downscale(4);
+    keyframe.mutable_capabilities()->set_delta_xor_rle(true);
+
+    surveillance::vision::FrameRequest delta = keyframe;
+    delta.clear_capabilities();
+    delta.set_frame_data(IngestCodec::EncodeXorRle(second.data.data(), second.data.size(), first.data));
+    delta.mutable_metadata()->set_encoding(IngestCodecConstants::ENCODING_XOR_RLE);
+    EXPECT_LT(delta.frame_data().size(), 200u);
+
+    EXPECT_EQ(session.Submit(std::move(keyframe)), SubmitResult::ACCEPTED);
+    EXPECT_EQ(session.Submit(surveillance::vision::FrameRequest(delta)), SubmitResult::ACCEPTED);
+    session.Drain();
+
+    ASSERT_EQ(responses.size(), 2u);
+    ASSERT_TRUE(responses[0].has_ingest_format());
+    EXPECT_EQ(responses[0].ingest_format().format(), "gray");
+    EXPECT_EQ(responses[0].ingest_format().downscale(), 2);
+    EXPECT_EQ(responses[0].ingest_format().encoding(), IngestCodecConstants::ENCODING_XOR_RLE);
+    EXPECT_FALSE(responses[1].has_ingest_format());
+    EXPECT_TRUE(responses[1].error_message().empty());
+
+    // Un delta sans référence exige une frame complète
+    surveillance::vision::FrameRequest orphan = delta;
+    orphan.set_camera_id("new_cam");
+    session.Submit(std::move(orphan));
+    session.Drain();
+    ASSERT_EQ(responses.size(), 3u);
+    EXPECT_FALSE(responses[2].error_message().empty());
+}
+
+TEST(IngestCodecTest, XorRleRoundTrip) {
+    std::vector<uint8_t> reference(4096);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        reference[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> current = reference;
+    current[0] ^= 1;
+    current[2] ^= 0xFF;                                    // zéro isolé dans un littéral
+    std::fill(current.begin() + 500, current.begin() + 700, 0);
+    current.back() = 42;
+
+    std::string payload = IngestCodec::EncodeXorRle(current.data(), current.size(), reference);
+    EXPECT_LT(payload.size(), 300u);
+
+    std::vector<uint8_t> decoded;
+    std::string error;
+    ASSERT_TRUE(IngestCodec::DecodeXorRle(payload, reference, &decoded, &error)) << error;
+    EXPECT_EQ(decoded, current);
+
+    // Frame identique : payload vide
+    EXPECT_TRUE(IngestCodec::EncodeXorRle(reference.data(), reference.size(), reference).empty());
+
+    // Payload incohérent avec la référence
+    std::vector<uint8_t> small_reference(16);
+    EXPECT_FALSE(IngestCodec::DecodeXorRle(payload, small_reference, &decoded, &error));
+    EXPECT_FALSE(error.empty());
+}
+
 // Test fixture pour FrameProcessor
 class FrameProcessorTest : public ::testing::Test {
 protected:
@@ -256,103 +866,2164 @@ TEST_F(FrameProcessorTest, ProcessMultipleFrames) {
     EXPECT_GE(processor_->GetAverageProcessingTime(), 0.0);
 }
 
-// Test fixture pour CameraManager
-class CameraManagerTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        // Test avec un pattern de test
-        manager_ = std::make_unique<CameraManager>("test://pattern");
+// Scène fixe, avec ou sans objet clair de 48x48 en (64, 64)
+static Frame MakeScene(bool with_object) {
+    Frame frame = FrameUtils::CreateColorFrame(320, 240, 60, 60, 60, "bgr");
+    if (with_object) {
+        for (int y = 64; y < 112; ++y) {
+            std::fill(frame.data.begin() + (y * 320 + 64) * 3,
+                      frame.data.begin() + (y * 320 + 112) * 3, 220);
+        }
     }
-    
-    void TearDown() override {
-        if (manager_) {
-            manager_->Cleanup();
+    return frame;
+}
+
+TEST(BasicMotionDetectorTest, DetectsObjectAgainstLearnedBackground) {
+    BasicMotionDetector detector;
+    ASSERT_TRUE(detector.Initialize());
+
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        EXPECT_TRUE(detector.Detect(MakeScene(false)).empty());
+    }
+    EXPECT_FALSE(detector.IsLearning());
+
+    EXPECT_TRUE(detector.Detect(MakeScene(false)).empty());
+    auto detections = detector.Detect(MakeScene(true));
+    ASSERT_EQ(detections.size(), 1u);
+    EXPECT_EQ(detections[0].bbox().x(), 64);
+    EXPECT_EQ(detections[0].bbox().y(), 64);
+    EXPECT_EQ(detections[0].bbox().width(), 48);
+    EXPECT_EQ(detections[0].bbox().height(), 48);
+}
+
+// Dégradé horizontal et vertical, sous un éclairage gain × luminance + décalage
+static Frame MakeLitScene(float gain, float offset, bool with_object) {
+    Frame frame(320, 240, "gray");
+    frame.data.resize(320 * 240);
+    for (int y = 0; y < 240; ++y) {
+        for (int x = 0; x < 320; ++x) {
+            float value = with_object && x >= 64 && x < 112 && y >= 64 && y < 112 ? 250.0f
+                                                                                  : gain * (30 + x / 3 + y / 4) + offset;
+            frame.data[y * 320 + x] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
         }
-        manager_.reset();
     }
-    
-    std::unique_ptr<CameraManager> manager_;
-};
+    return frame;
+}
 
-// Tests du CameraManager
-TEST_F(CameraManagerTest, InitializeTestPattern) {
-    EXPECT_EQ(manager_->GetCameraType(), CameraType::TEST_PATTERN);
-    EXPECT_EQ(manager_->GetState(), CameraState::UNINITIALIZED);
+TEST(BasicMotionDetectorTest, CompensatesGlobalIlluminationChanges) {
+    BasicMotionDetector detector;
+    ASSERT_TRUE(detector.Initialize());
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        detector.Detect(MakeLitScene(1.0f, 0.0f, false));
+    }
     
-    bool success = manager_->Initialize();
-    EXPECT_TRUE(success);
-    EXPECT_EQ(manager_->GetState(), CameraState::READY);
+    // Lumière allumée : seul l'objet est détecté
+    auto detections = detector.Detect(MakeLitScene(1.3f, 10.0f, true));
+    ASSERT_EQ(detections.size(), 1u);
+    EXPECT_EQ(detections[0].bbox().x(), 64);
+    EXPECT_EQ(detections[0].bbox().width(), 48);
+    EXPECT_NEAR(detector.GetIlluminationGain(), 1.3f, 0.05f);
+    EXPECT_NEAR(detector.GetIlluminationOffset(), 10.0f, 5.0f);
+    EXPECT_EQ(detector.GetIlluminationEvents(), 1u);
+    // Même événement jusqu'à ce que le fond ait suivi le nouvel éclairage
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(detector.Detect(MakeLitScene(1.3f, 10.0f, false)).empty());
+    }
+    EXPECT_EQ(detector.GetIlluminationEvents(), 1u);
+    EXPECT_NEAR(detector.GetIlluminationGain(), 1.0f, 0.05f);
+    
+    // Changement non linéaire sur toute la frame : pas de mouvement, nouveau fond
+    Frame inverted = MakeLitScene(-1.0f, 255.0f, false);
+    EXPECT_TRUE(detector.Detect(inverted).empty());
+    EXPECT_EQ(detector.GetIlluminationEvents(), 2u);
+    EXPECT_TRUE(detector.Detect(inverted).empty());
+    EXPECT_NEAR(detector.GetIlluminationGain(), 1.0f, 0.01f);
 }
 
-TEST_F(CameraManagerTest, StartAndStopCapture) {
-    ASSERT_TRUE(manager_->Initialize());
-    
-    // Démarrer la capture
-    bool start_success = manager_->StartCapture();
-    EXPECT_TRUE(start_success);
-    EXPECT_TRUE(manager_->IsCapturing());
-    EXPECT_EQ(manager_->GetState(), CameraState::CAPTURING);
+TEST_F(FrameProcessorTest, CountsIlluminationEventsOnce) {
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        EXPECT_FALSE(processor_->ProcessFrame(MakeLitScene(1.0f, 0.0f, false)).illumination_change);
+    }
     
-    // Attendre un peu pour capturer quelques frames
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    // Signalé sur la frame où l'éclairage change, pas sur les suivantes
+    EXPECT_TRUE(processor_->ProcessFrame(MakeLitScene(1.3f, 10.0f, false)).illumination_change);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(processor_->ProcessFrame(MakeLitScene(1.3f, 10.0f, false)).illumination_change);
+    }
+    EXPECT_EQ(processor_->GetStats().illumination_events, 1);
     
-    // Vérifier les statistiques
-    // const CameraStats& stats = manager_->GetStats(); 
-    // Arrêter la capture
-    bool stop_success = manager_->StopCapture();
-    EXPECT_TRUE(stop_success);
-    EXPECT_FALSE(manager_->IsCapturing());
+    // Sans détecteur de mouvement, plus rien à compter
+    processor_->RemoveDetector("BasicMotionDetector");
+    EXPECT_FALSE(processor_->ProcessFrame(MakeLitScene(-1.0f, 255.0f, false)).illumination_change);
+    EXPECT_EQ(processor_->GetStats().illumination_events, 1);
 }
 
-TEST_F(CameraManagerTest, DetectCameraTypes) {
-    EXPECT_EQ(CameraManager::DetectCameraType("test://pattern"), CameraType::TEST_PATTERN);
-    EXPECT_EQ(CameraManager::DetectCameraType("rtsp://example.com/stream"), CameraType::RTSP_STREAM);
-    EXPECT_EQ(CameraManager::DetectCameraType("/dev/video0"), CameraType::WEBCAM);
-    EXPECT_EQ(CameraManager::DetectCameraType("video.mp4"), CameraType::FILE_VIDEO);
-    EXPECT_EQ(CameraManager::DetectCameraType(""), CameraType::UNKNOWN);
+// Objet texturé de 48 × 48 en (x, y) sur le dégradé de MakeLitScene
+static Frame MakeMovingObject(int x, int y) {
+    Frame frame = MakeLitScene(1.0f, 0.0f, false);
+    for (int row = 0; row < 48; ++row) {
+        for (int column = 0; column < 48; ++column) {
+            float value = 180 + 35 * std::sin(0.9f * column + 0.3f * row) + 35 * std::cos(0.25f * column - 0.8f * row);
+            frame.data[(y + row) * 320 + x + column] = static_cast<uint8_t>(value);
+        }
+    }
+    return frame;
 }
 
-// Tests des utilitaires
-TEST(FrameUtilsTest, CreateTestFrame) {
-    Frame frame = FrameUtils::CreateTestFrame(320, 240, "bgr");
+TEST_F(FrameProcessorTest, CountsRepeatedFramesOutsideHeatmap) {
+    // Frames identiques pendant l'apprentissage : non comptées
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        EXPECT_FALSE(processor_->ProcessFrame(MakeLitScene(1.0f, 0.0f, false)).repeated);
+    }
+    Frame object = MakeMovingObject(100, 100);
+    ProcessingResult first = processor_->ProcessFrame(object);
+    ASSERT_FALSE(first.detections.empty());
+    EXPECT_FALSE(first.repeated);
+    uint64_t heatmap_frames = processor_->GetHeatmap()->GetGrid(MotionHeatmapKind::CUMULATIVE).frames;
     
-    EXPECT_EQ(frame.width, 320);
-    EXPECT_EQ(frame.height, 240);
-    EXPECT_EQ(frame.format, "bgr");
-    EXPECT_FALSE(frame.data.empty());
-    EXPECT_EQ(frame.data.size(), 320 * 240 * 3);
+    // Source figée : mêmes détections, rien de plus dans la carte d'activité
+    for (int i = 0; i < 5; ++i) {
+        ProcessingResult repeated = processor_->ProcessFrame(object);
+        EXPECT_TRUE(repeated.repeated);
+        EXPECT_EQ(repeated.detections.size(), first.detections.size());
+    }
+    EXPECT_EQ(processor_->GetStats().repeated_frames, 5);
+    EXPECT_EQ(processor_->GetHeatmap()->GetGrid(MotionHeatmapKind::CUMULATIVE).frames, heatmap_frames);
+    
+    object.data[0] ^= 1;
+    EXPECT_FALSE(processor_->ProcessFrame(object).repeated);
+    EXPECT_EQ(processor_->GetHeatmap()->GetGrid(MotionHeatmapKind::CUMULATIVE).frames, heatmap_frames + 1);
 }
 
-TEST(FrameUtilsTest, CreateColorFrame) {
-    Frame frame = FrameUtils::CreateColorFrame(100, 100, 255, 0, 0, "rgb");
+TEST(FrameProcessorConfigTest, ThresholdAndMinimumAreaReachMotionDetector) {
+    // Réglages appliqués après Initialize, comme au démarrage d'un stream
+    auto detect = [](double threshold, int min_area) {
+        FrameProcessor processor;
+        EXPECT_TRUE(processor.Initialize());
+        if (threshold > 0) processor.SetMotionThreshold(threshold);
+        if (min_area > 0) processor.SetMinDetectionArea(min_area);
+        for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+            processor.ProcessFrame(MakeLitScene(1.0f, 0.0f, false));
+        }
+        return processor.ProcessFrame(MakeMovingObject(100, 100)).detections.size();
+    };
     
-    EXPECT_EQ(frame.width, 100);
-    EXPECT_EQ(frame.height, 100);
-    EXPECT_EQ(frame.format, "rgb");
-    EXPECT_EQ(frame.data.size(), 100 * 100 * 3);
+    EXPECT_EQ(detect(0, 0), 1u);
+    EXPECT_EQ(detect(0.9, 0), 0u);
+    EXPECT_EQ(detect(0, 100 * 100), 0u);
+}
+
+TEST(SparseOpticalFlowTest, MeasuresObjectDisplacementAndVelocity) {
+    SparseOpticalFlow flow;
+    auto start = std::chrono::steady_clock::now();
+    auto store = [&flow](const Frame& frame, std::chrono::steady_clock::time_point timestamp) {
+        flow.BeginFrame(frame.width, frame.height, 0, 0, timestamp);
+        for (int y = 0; y < frame.height; ++y) {
+            flow.StoreRow(frame.Pixels(), y, 1);
+        }
+    };
     
-    // Vérifier que la couleur est correcte (rouge en RGB)
-    EXPECT_EQ(frame.data[0], 255);  // R
-    EXPECT_EQ(frame.data[1], 0);    // G
-    EXPECT_EQ(frame.data[2], 0);    // B
+    store(MakeMovingObject(100, 80), start);
+    EXPECT_FALSE(flow.Track(100, 80, 48, 48).IsValid());  // pas de frame précédente
+    store(MakeMovingObject(106, 77), start + std::chrono::milliseconds(100));
+    MotionVector motion = flow.Track(106, 77, 48, 48);
+    ASSERT_TRUE(motion.IsValid());
+    EXPECT_GE(motion.points, OpticalFlowConstants::MIN_FEATURES);
+    EXPECT_NEAR(motion.dx, 6.0f, 0.5f);
+    EXPECT_NEAR(motion.dy, -3.0f, 0.5f);
+    EXPECT_NEAR(motion.GetSpeed(), 67.1f, 5.0f);       // √(60² + 30²) px/s
+    EXPECT_NEAR(motion.GetDirection(), 333.4f, 5.0f);  // vers la droite et le haut
+    
+    // Recadrage différent : la frame précédente n'est plus comparable
+    flow.BeginFrame(320, 240, 16, 0, start + std::chrono::milliseconds(200));
+    EXPECT_FALSE(flow.HasPrevious());
 }
 
-TEST(FrameUtilsTest, ValidateFormats) {
-    EXPECT_TRUE(FrameUtils::IsValidFormat("bgr"));
-    EXPECT_TRUE(FrameUtils::IsValidFormat("rgb"));
-    EXPECT_TRUE(FrameUtils::IsValidFormat("gray"));
-    EXPECT_FALSE(FrameUtils::IsValidFormat("invalid"));
+TEST(BasicMotionDetectorTest, AnnotatesDetectionsWithDirectionAndSpeed) {
+    BasicMotionDetector detector;
+    ASSERT_TRUE(detector.Initialize());
+    auto start = std::chrono::steady_clock::now();
+    int frame_index = 0;
+    auto detect = [&](Frame frame) {
+        frame.timestamp = start + std::chrono::milliseconds(100 * frame_index++);
+        return detector.Detect(frame);
+    };
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        detect(MakeLitScene(1.0f, 0.0f, false));
+    }
     
-    auto formats = FrameUtils::GetSupportedFormats();
-    EXPECT_FALSE(formats.empty());
-    EXPECT_GT(formats.size(), 3);
+    detect(MakeMovingObject(96, 96));
+    auto detections = detect(MakeMovingObject(104, 96));
+    ASSERT_FALSE(detections.empty());
+    const auto& metadata = detections[0].metadata();
+    ASSERT_TRUE(metadata.count("direction"));
+    EXPECT_NEAR(std::stof(metadata.at("motion_dx")), 8.0f, 1.0f);
+    EXPECT_NEAR(std::stof(metadata.at("motion_dy")), 0.0f, 1.0f);
+    EXPECT_NEAR(std::stof(metadata.at("speed")), 80.0f, 10.0f);
+    float direction = std::stof(metadata.at("direction"));
+    EXPECT_TRUE(direction < 10.0f || direction > 350.0f);
 }
 
-TEST(FrameUtilsTest, CalculateFrameSize) {
-    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "bgr"), 640 * 480 * 3);
-    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "gray"), 640 * 480);
-    EXPECT_GT(FrameUtils::CalculateFrameSize(640, 480, "jpeg"), 0);
-    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "unknown"), 0);
+TEST(PixelPipelineTest, FusedStagesMatchSeparatePasses) {
+    // Dimensions non multiples des blocs : blocs tronqués à droite et en bas
+    const int width = 45;
+    const int height = 21;
+    std::mt19937 rng(5);
+    std::vector<uint8_t> frames[2];
+    for (auto& frame : frames) {
+        frame.resize(width * height * 3);
+        for (auto& value : frame) {
+            value = static_cast<uint8_t>(rng());
+        }
+    }
+    
+    for (int bytes_per_pixel : {1, 3}) {
+        PixelPipeline<BlockLumaStage, LumaStatisticsStage> pipeline;
+        pipeline.Get<BlockLumaStage>().SetBlockSize(8);
+        for (const auto& pixels : frames) {
+            std::vector<uint8_t> luma(width * height);
+            for (int i = 0; i < width * height; ++i) {
+                const uint8_t* pixel = &pixels[i * bytes_per_pixel];
+                luma[i] = bytes_per_pixel == 3 ? (pixel[0] + 2 * pixel[1] + pixel[2]) >> 2 : pixel[0];
+            }
+            
+            int rows = 0;
+            ASSERT_TRUE(pipeline.Run(pixels.data(), width, height, bytes_per_pixel, [&](const PipelineRow& row) {
+                EXPECT_EQ(row.y, rows++);
+                EXPECT_TRUE(std::equal(row.luma, row.luma + width, &luma[row.y * width]));
+            }));
+            EXPECT_EQ(rows, height);
+            
+            const auto& blocks = pipeline.Get<BlockLumaStage>();
+            ASSERT_EQ(blocks.GetGridWidth(), 6);
+            ASSERT_EQ(blocks.GetGridHeight(), 3);
+            for (int by = 0; by < 3; ++by) {
+                for (int bx = 0; bx < 6; ++bx) {
+                    double sum = 0.0;
+                    int count = 0;
+                    for (int y = by * 8; y < std::min(height, by * 8 + 8); ++y) {
+                        for (int x = bx * 8; x < std::min(width, bx * 8 + 8); ++x, ++count) {
+                            sum += luma[y * width + x];
+                        }
+                    }
+                    EXPECT_FLOAT_EQ(blocks.GetMeans()[by * 6 + bx], static_cast<float>(sum / count));
+                }
+            }
+            
+            double sum = 0.0, sum_squares = 0.0;
+            for (int i = 0; i < width * height; ++i) {
+                sum += luma[i];
+                sum_squares += static_cast<double>(luma[i]) * luma[i];
+            }
+            double mean = sum / (width * height);
+            EXPECT_NEAR(pipeline.Get<LumaStatisticsStage>().GetMean(), mean, 1e-3);
+            EXPECT_NEAR(pipeline.Get<LumaStatisticsStage>().GetVariance(),
+                        sum_squares / (width * height) - mean * mean, 1e-2);
+        }
+        // Pas d'instance pour 4 octets par pixel
+        EXPECT_FALSE(pipeline.Run(frames[0].data(), width / 3, height, 4));
+    }
+}
+
+TEST(FrameFeaturesTest, SinglePassMatchesSeparateComputations) {
+    const int width = 70;
+    const int height = 37;
+    std::mt19937 rng(9);
+    Frame frame(width, height, "bgr");
+    frame.data.resize(width * height * 3);
+    for (auto& value : frame.data) {
+        value = static_cast<uint8_t>(rng() % 200);
+    }
+    std::vector<uint8_t> luma(width * height);
+    for (int i = 0; i < width * height; ++i) {
+        const uint8_t* pixel = &frame.data[i * 3];
+        luma[i] = static_cast<uint8_t>((pixel[0] + 2 * pixel[1] + pixel[2]) >> 2);
+    }
+    
+    FrameFeatureExtractor extractor;
+    extractor.SetQualityEnabled(true);
+    int rows = 0;
+    const FrameFeatures* features = extractor.Extract(frame.data.data(), width, height, 3,
+                                                      [&](const PipelineRow&) { rows++; });
+    ASSERT_NE(features, nullptr);
+    EXPECT_EQ(rows, height);
+    
+    ASSERT_EQ(features->grid_width, 5);
+    ASSERT_EQ(features->grid_height, 3);
+    double sum = 0.0, sum_squares = 0.0;
+    for (int value : luma) {
+        sum += value;
+        sum_squares += value * value;
+    }
+    double mean = sum / luma.size();
+    EXPECT_NEAR(features->brightness, mean, 1e-3);
+    EXPECT_NEAR(features->variance, sum_squares / luma.size() - mean * mean, 1e-2);
+    double first_block = 0.0;
+    for (int y = 0; y < 16; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            first_block += luma[y * width + x];
+        }
+    }
+    EXPECT_FLOAT_EQ(features->block_luma[0], static_cast<float>(first_block / 256.0));
+    EXPECT_FALSE(features->repeated);
+    
+    // Mêmes statistiques que l'accumulateur alimenté depuis le plan de luminance
+    FrameQualityAccumulator reference;
+    reference.Begin(width, height);
+    for (int y = 1; y < height - 1; ++y) {
+        reference.AddRow(&luma[(y - 1) * width], &luma[y * width], &luma[(y + 1) * width], y);
+    }
+    FrameQualityStats expected = reference.Finish();
+    EXPECT_GT(expected.samples, 0u);
+    EXPECT_EQ(features->quality.samples, expected.samples);
+    EXPECT_EQ(features->quality.sharpness, expected.sharpness);
+    EXPECT_EQ(features->quality.edges, expected.edges);
+    
+    std::array<uint32_t, FrameFeatureConstants::HISTOGRAM_BINS> histogram{};
+    for (int y = 0; y < height; y += CameraHealthConstants::QUALITY_SAMPLE_STEP) {
+        for (int x = 0; x < width; ++x) {
+            histogram[luma[y * width + x]]++;
+        }
+    }
+    EXPECT_EQ(features->histogram, histogram);
+    
+    // Exposition du moniteur de santé : frame entière et histogramme
+    uint32_t saturated = 0;
+    for (int level = CameraHealthConstants::SATURATION_LEVEL; level < FrameFeatureConstants::HISTOGRAM_BINS; ++level) {
+        saturated += histogram[level];
+    }
+    EXPECT_EQ(features->quality.brightness, features->brightness);
+    EXPECT_FLOAT_EQ(features->quality.contrast, std::sqrt(features->variance));
+    EXPECT_FLOAT_EQ(features->quality.saturated,
+                    static_cast<float>(saturated) / static_cast<float>(width * ((height + 3) / 4)));
+    uint64_t hash = features->content_hash;
+    
+    // Frame répétée, puis un seul pixel modifié
+    features = extractor.Extract(frame.data.data(), width, height, 3);
+    EXPECT_TRUE(features->repeated);
+    EXPECT_EQ(features->content_hash, hash);
+    frame.data[(20 * width + 40) * 3 + 1] += 40;
+    features = extractor.Extract(frame.data.data(), width, height, 3);
+    EXPECT_FALSE(features->repeated);
+    EXPECT_NE(features->content_hash, hash);
+    
+    // L'empreinte porte sur la luminance : même valeur en niveaux de gris
+    FrameFeatureExtractor gray;
+    features = gray.Extract(luma.data(), width, height, 1);
+    ASSERT_NE(features, nullptr);
+    EXPECT_EQ(features->content_hash, hash);
+    EXPECT_EQ(features->quality.samples, 0u);  // netteté non demandée
+}
+
+// Second étage factice : "person" quand le centre de l'imagette est clair
+class BrightCenterClassifier : public Detector {
+public:
+    std::vector<Detection> Detect(const Frame& crop) override {
+        const uint8_t* center = crop.Pixels() + ((crop.height / 2) * crop.width + crop.width / 2) * 3;
+        if (center[1] < 200) {
+            return {};
+        }
+        Detection detection;
+        detection.set_type("person");
+        detection.set_confidence(0.9f);
+        detection.mutable_bbox()->set_x(8);
+        detection.mutable_bbox()->set_y(16);
+        detection.mutable_bbox()->set_width(16);
+        detection.mutable_bbox()->set_height(32);
+        return {detection};
+    }
+    std::vector<std::vector<Detection>> DetectBatch(const std::vector<Frame>& crops) override {
+        batches++;
+        for (const auto& crop : crops) {
+            crop_sizes.emplace_back(crop.width, crop.height);
+        }
+        return Detector::DetectBatch(crops);
+    }
+    std::string GetName() const override { return "BrightCenterClassifier"; }
+    bool Initialize() override { return true; }
+    void Cleanup() override {}
+    int GetInputWidth() const override { return 32; }
+    int GetInputHeight() const override { return 64; }
+    
+    int batches = 0;
+    std::vector<std::pair<int, int>> crop_sizes;
+};
+
+TEST(CascadeClassificationTest, ClassifiesLargestMotionRegionsWithinBudget) {
+    auto fill = [](Frame& frame, int x, int y, int size, uint8_t value) {
+        for (int row = y; row < y + size; ++row) {
+            std::fill(frame.data.begin() + (row * 320 + x) * 3, frame.data.begin() + (row * 320 + x + size) * 3, value);
+        }
+    };
+    Frame scene = FrameUtils::CreateColorFrame(320, 240, 60, 60, 60, "bgr");
+    Frame objects = scene;
+    fill(objects, 32, 32, 64, 220);   // le plus grand
+    fill(objects, 160, 32, 48, 220);
+    fill(objects, 96, 160, 32, 220);  // hors budget
+    
+    FrameProcessor processor;
+    ASSERT_TRUE(processor.Initialize());
+    auto classifier = std::make_unique<BrightCenterClassifier>();
+    BrightCenterClassifier* second_stage = classifier.get();
+    processor.SetClassifier(std::move(classifier));
+    processor.SetClassificationBudget(2);
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        processor.ProcessFrame(scene);
+    }
+    EXPECT_EQ(second_stage->batches, 0);  // pas de région, pas d'appel
+    
+    ProcessingResult result = processor.ProcessFrame(objects);
+    ASSERT_EQ(result.detections.size(), 3u);
+    EXPECT_EQ(second_stage->batches, 1);
+    std::vector<std::pair<int, int>> expected_sizes = {{32, 64}, {32, 64}};
+    EXPECT_EQ(second_stage->crop_sizes, expected_sizes);
+    
+    std::map<std::string, int> types;
+    for (const auto& detection : result.detections) {
+        types[detection.type()]++;
+        if (detection.type() == "person") {
+            EXPECT_FLOAT_EQ(detection.confidence(), 0.9f);
+            EXPECT_EQ(detection.metadata().at("classifier"), "BrightCenterClassifier");
+            EXPECT_TRUE(detection.metadata().count("motion_confidence"));
+            // Boîte du classifieur ramenée dans la région élargie de l'objet
+            EXPECT_GT(detection.bbox().width(), 16);
+            EXPECT_LT(detection.bbox().y(), 96);
+        } else {
+            EXPECT_EQ(detection.bbox().x(), 96);
+            EXPECT_EQ(detection.bbox().width(), 32);
+        }
+    }
+    EXPECT_EQ(types["person"], 2);
+    EXPECT_EQ(types["motion"], 1);
+    EXPECT_EQ(processor.GetStats().classifications, 2);
+    EXPECT_EQ(processor.GetStats().classifications_skipped, 1);
+    
+    // Budget nul : premier étage seul
+    processor.SetClassificationBudget(0);
+    result = processor.ProcessFrame(objects);
+    EXPECT_EQ(second_stage->batches, 1);
+    for (const auto& detection : result.detections) {
+        EXPECT_EQ(detection.type(), "motion");
+    }
+}
+
+TEST(FrameUtilsTest, ResizeRegionInterpolatesWithinRegion) {
+    Frame frame(64, 32, "gray");
+    frame.data.resize(64 * 32);
+    for (int y = 0; y < 32; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            frame.data[y * 64 + x] = static_cast<uint8_t>(x * 4);
+        }
+    }
+    frame.offset_x = 100;
+    
+    Frame resized = FrameUtils::ResizeRegion(frame, FrameRegion(16, 8, 32, 16), 8, 4);
+    ASSERT_EQ(resized.width, 8);
+    ASSERT_EQ(resized.data.size(), 32u);
+    EXPECT_EQ(resized.offset_x, 116);
+    EXPECT_EQ(resized.offset_y, 8);
+    // Centres des pixels : x source = 16 + 4 × i + 1.5
+    EXPECT_EQ(resized.data[0], 70);
+    EXPECT_EQ(resized.data[7], 182);
+    EXPECT_TRUE(FrameUtils::ResizeRegion(FrameUtils::CreateTestFrame(64, 32, "jpeg"),
+                                         FrameRegion(0, 0, 8, 8), 4, 4).data.empty());
+}
+
+// Couches aléatoires couvrant bords, pas, restes de vectorisation (sorties
+// non multiples de 4, segments de plus de 64 octets) et les deux types de
+// couche entièrement connectée
+static std::vector<QuantizedLayer> MakeRandomLayers(std::mt19937& rng) {
+    using Type = QuantizedLayer::Type;
+    std::uniform_int_distribution<int> weight(-128, 127);
+    std::uniform_int_distribution<int> bias(-2000, 2000);
+    std::uniform_int_distribution<int32_t> multiplier(1 << 30, INT32_MAX);
+    std::uniform_int_distribution<int> shift(-10, -6);
+    auto layer = [&](Type type, int kernel, int stride, int in, int out, size_t weights) {
+        QuantizedLayer result;
+        result.type = type;
+        result.kernel = kernel;
+        result.stride = stride;
+        result.in_channels = in;
+        result.out_channels = out;
+        for (size_t i = 0; i < weights; ++i) result.weights.push_back(static_cast<int8_t>(weight(rng)));
+        for (int o = 0; type != Type::GLOBAL_POOL && o < out; ++o) {
+            result.bias.push_back(bias(rng));
+            result.multipliers.push_back(multiplier(rng));
+            result.shifts.push_back(static_cast<int8_t>(shift(rng)));
+        }
+        return result;
+    };
+    return {
+        layer(Type::CONV, 3, 2, 3, 8, 8 * 9 * 3),       // 17 × 13 -> 9 × 7
+        layer(Type::DEPTHWISE, 5, 1, 8, 8, 25 * 8),
+        layer(Type::POINTWISE, 1, 1, 8, 20, 20 * 8),
+        layer(Type::CONV, 5, 1, 20, 18, 18 * 25 * 20),  // 100 octets par ligne du noyau
+        layer(Type::DEPTHWISE, 3, 2, 18, 18, 9 * 18),   // -> 5 × 4
+        layer(Type::FULLY_CONNECTED, 1, 1, 5 * 4 * 18, 40, 40 * 5 * 4 * 18),
+        layer(Type::FULLY_CONNECTED, 1, 1, 40, 3, 3 * 40),
+    };
+}
+
+// Référence naïve : mêmes conventions (HWC, remplissage "same", arrondi de Requantize)
+static std::vector<int32_t> ReferenceInference(const std::vector<QuantizedLayer>& layers, int width, int height,
+                                               int channels, std::vector<uint8_t> activation) {
+    using Type = QuantizedLayer::Type;
+    std::vector<int32_t> logits;
+    for (size_t index = 0; index < layers.size(); ++index) {
+        const QuantizedLayer& layer = layers[index];
+        bool depthwise = layer.type == Type::DEPTHWISE;
+        int kernel = layer.type == Type::CONV || depthwise ? layer.kernel : 1;
+        int stride = layer.type == Type::CONV || depthwise ? layer.stride : 1;
+        int out_width = (width + stride - 1) / stride;
+        int out_height = (height + stride - 1) / stride;
+        std::vector<int32_t> acc;
+        if (layer.type == Type::GLOBAL_POOL) {
+            std::vector<uint8_t> pooled(channels);
+            for (int c = 0; c < channels; ++c) {
+                int64_t sum = 0;
+                for (int p = 0; p < width * height; ++p) sum += activation[p * channels + c];
+                pooled[c] = static_cast<uint8_t>((sum + width * height / 2) / (width * height));
+            }
+            activation = pooled;
+            width = height = 1;
+            continue;
+        }
+        if (layer.type == Type::FULLY_CONNECTED) {
+            out_width = out_height = 1;
+            for (int o = 0; o < layer.out_channels; ++o) {
+                int32_t sum = layer.bias[o];
+                for (int i = 0; i < layer.in_channels; ++i) sum += activation[i] * layer.weights[o * layer.in_channels + i];
+                acc.push_back(sum);
+            }
+        } else {
+            for (int oy = 0; oy < out_height; ++oy) {
+                for (int ox = 0; ox < out_width; ++ox) {
+                    for (int o = 0; o < layer.out_channels; ++o) {
+                        int32_t sum = layer.bias[o];
+                        for (int ky = 0; ky < kernel; ++ky) {
+                            for (int kx = 0; kx < kernel; ++kx) {
+                                int y = oy * stride - kernel / 2 + ky;
+                                int x = ox * stride - kernel / 2 + kx;
+                                if (y < 0 || y >= height || x < 0 || x >= width) continue;
+                                const uint8_t* pixel = &activation[(y * width + x) * channels];
+                                if (depthwise) {
+                                    sum += pixel[o] * layer.weights[(ky * kernel + kx) * channels + o];
+                                } else {
+                                    for (int i = 0; i < channels; ++i) {
+                                        sum += pixel[i] * layer.weights[((o * kernel + ky) * kernel + kx) * channels + i];
+                                    }
+                                }
+                            }
+                        }
+                        acc.push_back(sum);
+                    }
+                }
+            }
+        }
+        if (index + 1 == layers.size()) {
+            logits = acc;
+            break;
+        }
+        activation.resize(acc.size());
+        for (size_t i = 0; i < acc.size(); ++i) {
+            int o = static_cast<int>(i % layer.out_channels);
+            int32_t value = QuantizedNetwork::Requantize(acc[i], layer.multipliers[o], layer.shifts[o]);
+            activation[i] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+        width = out_width;
+        height = out_height;
+        channels = layer.out_channels;
+    }
+    return logits;
+}
+
+TEST(QuantizedCnnTest, KernelsMatchReferenceBitExactly) {
+    EXPECT_EQ(QuantizedNetwork::Requantize(100, 1 << 30, 0), 50);
+    EXPECT_EQ(QuantizedNetwork::Requantize(3, 1 << 30, 0), 2);    // 1,5 : loin de zéro
+    EXPECT_EQ(QuantizedNetwork::Requantize(-3, 1 << 30, 0), -2);
+    EXPECT_EQ(QuantizedNetwork::Requantize(5, 1 << 30, 2), 10);
+    
+    std::mt19937 rng(42);
+    std::vector<QuantizedLayer> layers = MakeRandomLayers(rng);
+    QuantizedNetwork network;
+    network.SetInput(17, 13, 3);
+    for (const auto& layer : layers) {
+        network.AddLayer(layer);
+    }
+    network.SetClasses({"person", "vehicle", "other"}, 0.01f);
+    std::string error;
+    ASSERT_TRUE(network.Finalize(&error)) << error;
+    
+    std::vector<std::vector<uint8_t>> inputs(4, std::vector<uint8_t>(17 * 13 * 3));
+    for (auto& input : inputs) {
+        for (auto& value : input) value = static_cast<uint8_t>(rng());
+    }
+    std::fill(inputs[0].begin(), inputs[0].end(), 255);  // saturation
+    
+    int kernel_sets = 0;
+    for (QuantizedKernels kernels : {QuantizedKernels::SCALAR, QuantizedKernels::AVX2, QuantizedKernels::AVX512_VNNI}) {
+        network.SetKernels(kernels);
+        if (network.GetKernels() != kernels) {
+            continue;  // non supporté par ce processeur
+        }
+        kernel_sets++;
+        for (const auto& input : inputs) {
+            EXPECT_EQ(network.Run(input.data()), ReferenceInference(layers, 17, 13, 3, input))
+                << QuantizedNetwork::KernelsToString(kernels);
+        }
+    }
+    EXPECT_GE(kernel_sets, 1);
+}
+
+TEST(QuantizedCnnTest, LoadsSerializedModelAndRejectsCorruptFiles) {
+    std::mt19937 rng(7);
+    QuantizedNetwork network;
+    network.SetInput(17, 13, 3);
+    for (auto& layer : MakeRandomLayers(rng)) {
+        network.AddLayer(std::move(layer));
+    }
+    network.SetClasses({"person", "vehicle", "other"}, 0.01f);
+    ASSERT_TRUE(network.Finalize());
+    std::vector<uint8_t> bytes = network.Serialize();
+    
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("vision_model_" + std::to_string(getpid()) + ".vqnn")).string();
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    QuantizedNetwork loaded;
+    std::string error;
+    ASSERT_TRUE(loaded.Load(path, &error)) << error;
+    EXPECT_EQ(loaded.GetClassNames(), network.GetClassNames());
+    EXPECT_EQ(loaded.GetMacsPerInference(), network.GetMacsPerInference());
+    std::vector<uint8_t> input(17 * 13 * 3, 90);
+    EXPECT_EQ(loaded.Run(input.data()), network.Run(input.data()));
+    
+    // Refusés sur la signature ou la taille, avant la lecture du corps
+    std::ofstream(path, std::ios::binary).write("VHOG", 4);
+    EXPECT_FALSE(loaded.Load(path, &error));
+    EXPECT_NE(error.find("Not a quantized model"), std::string::npos);
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    std::filesystem::resize_file(path, QuantizedCnnConstants::MAX_MODEL_BYTES + 1);
+    EXPECT_FALSE(loaded.Load(path, &error));
+    EXPECT_NE(error.find("too large"), std::string::npos);
+    EXPECT_FALSE(loaded.Load(std::filesystem::temp_directory_path().string(), &error));
+    std::filesystem::remove(path);
+    
+    EXPECT_FALSE(loaded.Load(path, &error));
+    EXPECT_NE(error.find("Cannot open"), std::string::npos);
+    
+    std::vector<uint8_t> corrupted = bytes;
+    corrupted[bytes.size() / 2] ^= 0x10;
+    QuantizedNetwork rejected;
+    EXPECT_FALSE(rejected.Parse(corrupted.data(), corrupted.size(), &error));
+    EXPECT_NE(error.find("checksum"), std::string::npos);
+    EXPECT_FALSE(rejected.Parse(bytes.data(), bytes.size() - 10, &error));
+    EXPECT_FALSE(rejected.IsReady());
+    
+    // Un échec de lecture laisse le réseau chargé intact
+    EXPECT_FALSE(loaded.Parse(corrupted.data(), corrupted.size()));
+    EXPECT_TRUE(loaded.IsReady());
+    
+    // Formes incohérentes refusées par Finalize
+    QuantizedNetwork mismatched;
+    mismatched.SetInput(8, 8, 1);
+    QuantizedLayer dense;
+    dense.type = QuantizedLayer::Type::FULLY_CONNECTED;
+    dense.in_channels = 32;  // 64 attendus
+    dense.out_channels = 2;
+    dense.weights.resize(64);
+    dense.bias.resize(2);
+    dense.multipliers.assign(2, 1 << 30);
+    dense.shifts.resize(2);
+    mismatched.AddLayer(dense);
+    mismatched.SetClasses({"person", "other"}, 1.0f);
+    EXPECT_FALSE(mismatched.Finalize(&error));
+    EXPECT_NE(error.find("input size"), std::string::npos);
+    
+    // Réduction de 49152 octets : 255 × 128 par produit tient encore dans
+    // l'accumulateur 32 bits, plus avec un biais de 6e8
+    QuantizedNetwork wide;
+    wide.SetInput(128, 128, 3);
+    dense.in_channels = 128 * 128 * 3;
+    dense.weights.assign(static_cast<size_t>(dense.in_channels) * 2, -128);
+    dense.bias = {0, -600000000};
+    wide.AddLayer(dense);
+    wide.SetClasses({"person", "other"}, 1.0f);
+    std::vector<uint8_t> overflowing = wide.Serialize();
+    EXPECT_FALSE(rejected.Parse(overflowing.data(), overflowing.size(), &error));
+    EXPECT_NE(error.find("overflow"), std::string::npos);
+    dense.bias = {0, 0};
+    QuantizedNetwork bounded;
+    bounded.SetInput(128, 128, 3);
+    bounded.AddLayer(dense);
+    bounded.SetClasses({"person", "other"}, 1.0f);
+    EXPECT_TRUE(bounded.Finalize(&error)) << error;
+}
+
+TEST(CascadeClassificationTest, CnnClassifierLabelsBrightMotionRegions) {
+    // Luminance moyenne de l'imagette : "person" au-delà de 120, "other" en deçà
+    auto classifier = std::make_unique<CnnClassifier>();
+    QuantizedNetwork& network = classifier->GetNetwork();
+    network.SetInput(16, 16, 1);
+    QuantizedLayer pool;
+    pool.type = QuantizedLayer::Type::GLOBAL_POOL;
+    pool.in_channels = pool.out_channels = 1;
+    network.AddLayer(pool);
+    QuantizedLayer dense;
+    dense.type = QuantizedLayer::Type::FULLY_CONNECTED;
+    dense.in_channels = 1;
+    dense.out_channels = 2;
+    dense.weights = {0, 1};
+    dense.bias = {120, 0};
+    dense.multipliers.assign(2, 1 << 30);
+    dense.shifts.assign(2, 0);
+    network.AddLayer(dense);
+    network.SetClasses({"other", "person"}, 0.5f);
+    ASSERT_TRUE(network.Finalize());
+    
+    EXPECT_TRUE(classifier->Detect(FrameUtils::CreateColorFrame(40, 40, 60, 60, 60, "bgr")).empty());
+    std::vector<Detection> bright = classifier->Detect(FrameUtils::CreateColorFrame(40, 40, 200, 200, 200, "bgr"));
+    ASSERT_EQ(bright.size(), 1u);
+    EXPECT_EQ(bright[0].type(), "person");
+    EXPECT_GT(bright[0].confidence(), 0.99f);
+    EXPECT_EQ(bright[0].bbox().width(), 40);
+    
+    Frame scene = FrameUtils::CreateColorFrame(320, 240, 60, 60, 60, "bgr");
+    Frame objects = scene;
+    for (int row = 64; row < 128; ++row) {
+        std::fill(objects.data.begin() + (row * 320 + 64) * 3, objects.data.begin() + (row * 320 + 128) * 3, 220);
+    }
+    FrameProcessor processor;
+    ASSERT_TRUE(processor.Initialize());
+    processor.SetClassifier(std::move(classifier));
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        processor.ProcessFrame(scene);
+    }
+    ProcessingResult result = processor.ProcessFrame(objects);
+    ASSERT_EQ(result.detections.size(), 1u);
+    EXPECT_EQ(result.detections[0].type(), "person");
+    EXPECT_EQ(result.detections[0].metadata().at("classifier"), "CnnClassifier");
+    EXPECT_TRUE(result.detections[0].metadata().count("kernels"));
+}
+
+// Silhouette claire sur fond sombre, dessinée pour une fenêtre 64 × 128 à
+// l'échelle donnée
+static std::vector<uint8_t> MakeSilhouette(int width, int height, int x0, int y0, float scale) {
+    std::vector<uint8_t> image(width * height, 40);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float u = (x - x0) / scale;
+            float v = (y - y0) / scale;
+            bool head = (u - 32) * (u - 32) + (v - 22) * (v - 22) < 100;
+            bool body = u >= 20 && u < 44 && v >= 32 && v < 80;
+            bool legs = ((u >= 22 && u < 30) || (u >= 34 && u < 42)) && v >= 80 && v < 116;
+            if (head || body || legs) {
+                image[y * width + x] = 200;
+            }
+        }
+    }
+    return image;
+}
+
+static Frame GrayFrame(int width, int height, const std::vector<uint8_t>& pixels) {
+    Frame frame(width, height, "gray");
+    frame.data = pixels;
+    return frame;
+}
+
+TEST(HogPersonDetectorTest, ScoresEveryWindowLikeItsDescriptor) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<float> weights(HogConstants::DESCRIPTOR_SIZE);
+    for (float& weight : weights) weight = uniform(rng);
+    HogPersonDetector detector;
+    EXPECT_FALSE(detector.Initialize());
+    EXPECT_FALSE(detector.SetModel(std::vector<float>(10, 1.0f), 0.0f));
+    ASSERT_TRUE(detector.SetModel(weights, 0.25f));
+    auto score = [&weights](const std::vector<float>& descriptor) {
+        double sum = 0.25;
+        for (size_t i = 0; i < descriptor.size(); ++i) sum += weights[i] * descriptor[i];
+        return static_cast<float>(sum);
+    };
+    
+    // Image de la taille d'une fenêtre : une seule fenêtre, celle de Describe
+    std::vector<uint8_t> window = MakeSilhouette(64, 128, 0, 0, 1.0f);
+    std::vector<float> descriptor = HogPersonDetector::Describe(window.data(), 64, 128);
+    ASSERT_EQ(descriptor.size(), static_cast<size_t>(HogConstants::DESCRIPTOR_SIZE));
+    EXPECT_GT(*std::max_element(descriptor.begin(), descriptor.end()), 0.1f);
+    EXPECT_TRUE(HogPersonDetector::Describe(window.data(), 64, 64).empty());
+    std::vector<HogWindow> windows;
+    detector.Scan(window.data(), 64, 128, &windows);
+    ASSERT_EQ(windows.size(), 1u);
+    EXPECT_NEAR(windows[0].score, score(descriptor), 1e-3f);
+    
+    // Image plus grande : fenêtres tous les 4 pixels, chacune notée comme
+    // son descripteur (histogramme intégral, cellules chevauchantes)
+    std::vector<uint8_t> image = MakeSilhouette(96, 192, 12, 30, 1.2f);
+    for (size_t i = 0; i < image.size(); ++i) image[i] = static_cast<uint8_t>(image[i] + (i * 7919) % 23);
+    detector.Scan(image.data(), 96, 192, &windows);
+    ASSERT_EQ(windows.size(), 9u * 17u);
+    HogFeatures features;
+    features.Compute(image.data(), 96, 192);
+    for (int index : {0, 5 * 9 + 3, 16 * 9 + 8}) {
+        const HogWindow& scanned = windows[index];
+        EXPECT_EQ(scanned.x, (index % 9) * 4);
+        EXPECT_EQ(scanned.y, (index / 9) * 4);
+        EXPECT_NEAR(scanned.score, score(features.WindowDescriptor(index % 9, index / 9)), 1e-3f);
+    }
+    
+    // Modèle relu depuis son format de fichier
+    std::vector<uint8_t> bytes = detector.Serialize();
+    HogPersonDetector loaded;
+    std::string error;
+    ASSERT_TRUE(loaded.Parse(bytes.data(), bytes.size(), &error)) << error;
+    std::vector<HogWindow> reloaded;
+    loaded.Scan(image.data(), 96, 192, &reloaded);
+    EXPECT_EQ(reloaded[20].score, windows[20].score);
+    bytes[100] ^= 0x01;
+    EXPECT_FALSE(loaded.Parse(bytes.data(), bytes.size(), &error));
+    EXPECT_NE(error.find("checksum"), std::string::npos);
+}
+
+TEST(HogPersonDetectorTest, FindsSilhouetteInMotionCropAtSeveralScales) {
+    // Modèle "gabarit" : descripteur centré de la silhouette, seuil à mi-score
+    std::vector<uint8_t> model = MakeSilhouette(64, 128, 0, 0, 1.0f);
+    std::vector<float> weights = HogPersonDetector::Describe(model.data(), 64, 128);
+    float mean = std::accumulate(weights.begin(), weights.end(), 0.0f) / weights.size();
+    float template_score = 0.0f;
+    for (float& weight : weights) {
+        template_score += (weight - mean) * weight;
+        weight -= mean;
+    }
+    HogPersonDetector detector;
+    ASSERT_TRUE(detector.SetModel(weights, -0.5f * template_score));
+    ASSERT_TRUE(detector.Initialize());
+    EXPECT_EQ(detector.GetInputWidth(), 96);
+    EXPECT_EQ(detector.GetInputHeight(), 192);
+    
+    // Personne à la taille de la fenêtre, décalée dans l'imagette
+    std::vector<Detection> found = detector.Detect(GrayFrame(96, 192, MakeSilhouette(96, 192, 16, 40, 1.0f)));
+    ASSERT_FALSE(found.empty());
+    EXPECT_EQ(found[0].type(), "person");
+    EXPECT_GT(found[0].confidence(), 0.5f);
+    EXPECT_NEAR(found[0].bbox().x(), 16, 4);
+    EXPECT_NEAR(found[0].bbox().y(), 40, 4);
+    EXPECT_EQ(found[0].bbox().height(), 128);
+    EXPECT_TRUE(found[0].metadata().count("hog_score"));
+    
+    // Personne remplissant l'imagette : trouvée à l'échelle 1,5
+    found = detector.Detect(GrayFrame(96, 192, MakeSilhouette(96, 192, 0, 0, 1.5f)));
+    ASSERT_FALSE(found.empty());
+    EXPECT_NEAR(found[0].bbox().x(), 0, 6);
+    EXPECT_NEAR(found[0].bbox().y(), 0, 6);
+    EXPECT_NEAR(found[0].bbox().height(), 192, 2);
+    
+    // Ni fond uniforme ni rayures
+    EXPECT_TRUE(detector.Detect(FrameUtils::CreateColorFrame(96, 192, 90, 90, 90, "bgr")).empty());
+    std::vector<uint8_t> stripes(96 * 192);
+    for (int i = 0; i < 96 * 192; ++i) stripes[i] = (i / 96) % 16 < 8 ? 40 : 200;
+    EXPECT_TRUE(detector.Detect(GrayFrame(96, 192, stripes)).empty());
+}
+
+TEST(DetectorCheckpointTest, KeepsPreviousSlotWhenLatestIsCorrupted) {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("vision_checkpoint_" + std::to_string(getpid()) + ".state")).string();
+    std::filesystem::remove(path);
+    {
+        DetectorCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(path));
+        std::vector<uint8_t> payload;
+        EXPECT_FALSE(checkpoint.Read(1, &payload));
+        ASSERT_TRUE(checkpoint.Write(1, std::vector<uint8_t>(100, 0xAA)));
+        ASSERT_TRUE(checkpoint.Write(1, std::vector<uint8_t>(100, 0xBB)));
+        ASSERT_TRUE(checkpoint.Read(1, &payload));
+        EXPECT_EQ(payload, std::vector<uint8_t>(100, 0xBB));
+        EXPECT_FALSE(checkpoint.Read(2, &payload));  // autre configuration
+    }
+
+    // Un octet du dernier slot écrit (le second) modifié sur disque
+    std::vector<uint8_t> payload;
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t position = bytes.rfind(std::string(100, '\xBB'));
+        ASSERT_NE(position, std::string::npos);
+        file.seekp(static_cast<std::streamoff>(position + 10));
+        file.put('\x00');
+    }
+    DetectorCheckpoint reopened;
+    ASSERT_TRUE(reopened.Open(path));
+    ASSERT_TRUE(reopened.Read(1, &payload));
+    EXPECT_EQ(payload, std::vector<uint8_t>(100, 0xAA));
+
+    reopened.Close();
+    std::filesystem::remove(path);
+}
+
+TEST(DetectorCheckpointTest, WarmRestartSkipsLearningOnlyForSameConfig) {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("vision_warm_" + std::to_string(getpid()) + ".state")).string();
+    std::filesystem::remove(path);
+    const auto interval = std::chrono::milliseconds(60000);
+    {
+        FrameProcessor processor;
+        ASSERT_TRUE(processor.Initialize());
+        EXPECT_FALSE(processor.EnableCheckpoint(path, 42, interval));
+        for (uint64_t i = 0; i <= FrameProcessorConstants::LEARNING_FRAMES + 5; ++i) {
+            processor.ProcessFrame(MakeScene(false));
+        }
+    }  // checkpoint écrit au Cleanup
+
+    FrameProcessor warm;
+    ASSERT_TRUE(warm.Initialize());
+    EXPECT_TRUE(warm.EnableCheckpoint(path, 42, interval));
+    EXPECT_EQ(warm.ProcessFrame(MakeScene(true)).detections.size(), 1u);
+
+    FrameProcessor changed;
+    ASSERT_TRUE(changed.Initialize());
+    EXPECT_FALSE(changed.EnableCheckpoint(path, 43, interval));
+    EXPECT_TRUE(changed.ProcessFrame(MakeScene(true)).detections.empty());
+
+    std::filesystem::remove(path);
+}
+
+TEST(MotionHeatmapTest, DecaysRecentActivityAndKeepsCumulative) {
+    MotionHeatmap heatmap;
+    heatmap.SetHalfLife(std::chrono::milliseconds(1000));
+    auto start = std::chrono::steady_clock::now();
+    const uint8_t left[8] = {1, 0, 0, 0, 0, 0, 0, 0};
+    const uint8_t right[8] = {0, 1, 0, 0, 0, 0, 0, 0};
+    
+    // Bloc 0 actif puis, dix demi-vies plus tard, bloc 1
+    for (int i = 0; i < 10; ++i) {
+        heatmap.Accumulate(left, 4, 2, 0, 0, start + std::chrono::milliseconds(i));
+    }
+    for (int i = 0; i < 10; ++i) {
+        heatmap.Accumulate(right, 4, 2, 0, 0, start + std::chrono::milliseconds(10000 + i));
+    }
+    MotionHeatmapGrid cumulative = heatmap.GetGrid(MotionHeatmapKind::CUMULATIVE);
+    ASSERT_EQ(cumulative.values.size(), 8u);
+    EXPECT_EQ(cumulative.frames, 20u);
+    EXPECT_EQ(cumulative.values[0], 32768);
+    EXPECT_EQ(cumulative.values[1], 32768);
+    EXPECT_EQ(cumulative.values[2], 0);
+    MotionHeatmapGrid decaying = heatmap.GetGrid(MotionHeatmapKind::DECAYING);
+    EXPECT_LT(decaying.values[0], 100);
+    EXPECT_GT(decaying.values[1], 65400);
+    
+    // Reprise : même carte, l'arrêt (quasi nul ici) ne change pas les proportions
+    MotionHeatmap restored;
+    ASSERT_TRUE(restored.RestoreState(heatmap.SaveState()));
+    EXPECT_EQ(restored.GetGrid(MotionHeatmapKind::CUMULATIVE).values, cumulative.values);
+    EXPECT_NEAR(restored.GetGrid(MotionHeatmapKind::DECAYING).values[1], decaying.values[1], 1);
+    EXPECT_FALSE(restored.RestoreState(std::vector<uint8_t>(10, 0)));
+    
+    // Coupure d'une heure : le gain déborde, seul le présent compte
+    heatmap.Accumulate(left, 4, 2, 0, 0, start + std::chrono::hours(1));
+    decaying = heatmap.GetGrid(MotionHeatmapKind::DECAYING);
+    EXPECT_EQ(decaying.values[0], 65535);
+    EXPECT_EQ(decaying.values[1], 0);
+    
+    // Nouvelle grille (zones modifiées) : accumulation reprise à zéro
+    heatmap.Accumulate(left, 4, 2, 16, 0, start + std::chrono::hours(1));
+    cumulative = heatmap.GetGrid(MotionHeatmapKind::CUMULATIVE);
+    EXPECT_EQ(cumulative.frames, 1u);
+    EXPECT_EQ(cumulative.origin_x, 16);
+    
+    std::vector<uint8_t> png = MotionHeatmap::RenderPng(cumulative, 8);
+    ASSERT_GT(png.size(), 33u);
+    EXPECT_EQ(std::string(png.begin() + 1, png.begin() + 4), "PNG");
+    EXPECT_EQ(std::string(png.begin() + 12, png.begin() + 16), "IHDR");
+    EXPECT_EQ(png[19], 32);  // largeur 4 blocs × 8 pixels (big-endian)
+    EXPECT_EQ(png[23], 16);
+    EXPECT_EQ(std::string(png.end() - 8, png.end() - 4), "IEND");
+    EXPECT_TRUE(MotionHeatmap::RenderPng(MotionHeatmapGrid(), 1).empty());
+}
+
+TEST(MotionHeatmapTest, FrameProcessorFeedsAndPersistsHeatmap) {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("vision_heatmap_" + std::to_string(getpid()) + ".heatmap")).string();
+    std::filesystem::remove(path);
+    MotionHeatmapGrid grid;
+    {
+        FrameProcessor processor;
+        ASSERT_TRUE(processor.Initialize());
+        EXPECT_FALSE(processor.EnableHeatmapCheckpoint(path, std::chrono::milliseconds(60000)));
+        for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+            processor.ProcessFrame(MakeScene(false));
+        }
+        EXPECT_TRUE(processor.GetHeatmap()->GetGrid(MotionHeatmapKind::CUMULATIVE).IsEmpty());
+        for (int i = 0; i < 8; ++i) {
+            processor.ProcessFrame(MakeScene(i % 2 == 0));
+        }
+        grid = processor.GetHeatmap()->GetGrid(MotionHeatmapKind::CUMULATIVE);
+    }  // carte écrite au Cleanup
+    
+    // Objet de (64, 64) à (112, 112) : blocs 4 à 6 sur 20 × 15
+    ASSERT_EQ(grid.grid_width, 20);
+    ASSERT_EQ(grid.grid_height, 15);
+    EXPECT_EQ(grid.frames, 8u);
+    EXPECT_EQ(grid.values[4 * 20 + 4], 32768);
+    EXPECT_EQ(grid.values[6 * 20 + 6], 32768);
+    EXPECT_EQ(grid.values[0], 0);
+    
+    MotionHeatmap saved;
+    ASSERT_TRUE(FrameProcessor::LoadHeatmapCheckpoint(path, &saved));
+    EXPECT_EQ(saved.GetGrid(MotionHeatmapKind::CUMULATIVE).values, grid.values);
+    EXPECT_FALSE(FrameProcessor::LoadHeatmapCheckpoint(path + ".missing", &saved));
+    EXPECT_FALSE(std::filesystem::exists(path + ".missing"));
+    
+    std::filesystem::remove(path);
+}
+
+static Detection MakeBox(int x, int y, int width, int height) {
+    Detection detection;
+    detection.set_type("person");
+    detection.mutable_bbox()->set_x(x);
+    detection.mutable_bbox()->set_y(y);
+    detection.mutable_bbox()->set_width(width);
+    detection.mutable_bbox()->set_height(height);
+    return detection;
+}
+
+TEST(TrackAnalyticsTest, CountsZoneDwellAndDirectionalLineCrossings) {
+    surveillance::vision::StreamConfig config;
+    auto* zone = config.add_zones();
+    zone->set_id("door");
+    zone->set_active(true);
+    for (auto [x, y] : {std::pair{100, 100}, {200, 100}, {200, 200}, {100, 200}}) {
+        auto* point = zone->add_points();
+        point->set_x(x);
+        point->set_y(y);
+    }
+    auto* line = config.add_lines();
+    line->set_id("gate");
+    line->set_active(true);
+    line->mutable_start()->set_x(300);
+    line->mutable_start()->set_y(0);
+    line->mutable_end()->set_x(300);
+    line->mutable_end()->set_y(400);
+    auto* inactive = config.add_lines();
+    inactive->set_id("off");
+    inactive->mutable_end()->set_x(10);
+    
+    TrackAnalytics analytics(config.zones(), config.lines());
+    ASSERT_FALSE(analytics.IsEmpty());
+    EXPECT_EQ(analytics.GetZoneMask(150, 150), 1u);
+    EXPECT_EQ(analytics.GetZoneMask(250, 150), 0u);
+    EXPECT_EQ(analytics.GetZoneMask(50, 50), 0u);
+    
+    // Un objet traverse la zone puis la ligne vers la droite, revient, et
+    // un second reste dans la zone avant de disparaître
+    int64_t now = 1000;
+    for (int x = 40; x <= 400; x += 20, now += 100) {
+        std::vector<Detection> detections = {MakeBox(x, 110, 20, 40)};
+        analytics.Update(&detections, now);
+        EXPECT_EQ(detections[0].metadata().at("track_id"), "1");
+    }
+    for (int x = 400; x >= 240; x -= 20, now += 100) {
+        std::vector<Detection> detections = {MakeBox(x, 110, 20, 40)};
+        analytics.Update(&detections, now);
+    }
+    for (int i = 0; i < 3; ++i, now += 100) {
+        std::vector<Detection> detections = {MakeBox(140, 120, 20, 40)};
+        analytics.Update(&detections, now);
+    }
+    for (int i = 0; i <= TrackAnalyticsConstants::MAX_MISSED_FRAMES; ++i, now += 100) {
+        std::vector<Detection> none;
+        analytics.Update(&none, now);
+    }
+    
+    AnalyticsSnapshot snapshot = analytics.Snapshot(0, 100);
+    ASSERT_EQ(snapshot.zones.size(), 1u);
+    ASSERT_EQ(snapshot.lines.size(), 1u);
+    EXPECT_EQ(snapshot.zones[0].entries, 2);
+    EXPECT_EQ(snapshot.zones[0].exits, 2);
+    EXPECT_EQ(snapshot.zones[0].occupancy, 0);
+    EXPECT_EQ(snapshot.zones[0].dwell_max_ms, 500);    // cinq frames dans la zone
+    EXPECT_EQ(snapshot.zones[0].dwell_total_ms, 700);  // puis trois
+    EXPECT_EQ(snapshot.lines[0].backward, 1);        // droite de start → end vers la gauche
+    EXPECT_EQ(snapshot.lines[0].forward, 1);
+    EXPECT_EQ(snapshot.active_tracks, 0);
+    
+    // Entrée, sortie, deux franchissements, entrée, sortie
+    ASSERT_EQ(snapshot.events.size(), 6u);
+    EXPECT_EQ(snapshot.events[0].type, AnalyticsEvent::Type::ZONE_ENTER);
+    EXPECT_EQ(snapshot.events[2].type, AnalyticsEvent::Type::LINE_CROSS);
+    EXPECT_FALSE(snapshot.events[2].forward);
+    EXPECT_EQ(snapshot.events[5].type, AnalyticsEvent::Type::ZONE_EXIT);
+    EXPECT_EQ(snapshot.events[5].track_id, 2u);
+    EXPECT_EQ(snapshot.events[5].dwell_ms, 200);
+    EXPECT_EQ(snapshot.next_sequence, 6);
+    
+    // Curseur : suite paginée, puis plus rien
+    snapshot = analytics.Snapshot(2, 2);
+    ASSERT_EQ(snapshot.events.size(), 2u);
+    EXPECT_EQ(snapshot.events[0].sequence, 3);
+    EXPECT_EQ(snapshot.next_sequence, 4);
+    EXPECT_TRUE(analytics.Snapshot(6, 100).events.empty());
+    EXPECT_EQ(analytics.Snapshot(6, 100).events_dropped, 0);
+}
+
+TEST(TrackAnalyticsTest, UsesUpstreamTrackIdsAndReportsDroppedEvents) {
+    surveillance::vision::StreamConfig config;
+    auto* line = config.add_lines();
+    line->set_id("gate");
+    line->set_active(true);
+    line->mutable_start()->set_x(0);
+    line->mutable_start()->set_y(100);
+    line->mutable_end()->set_x(1000);
+    line->mutable_end()->set_y(100);
+    TrackAnalytics analytics(config.zones(), config.lines());
+    
+    // Pistes amont : deux objets proches que la distance des centres confondrait
+    size_t crossings = TrackAnalyticsConstants::MAX_EVENTS / 2 + 10;
+    for (size_t i = 0; i < crossings; ++i) {
+        int y = i % 2 == 0 ? 90 : 110;  // bas de boîte au-dessus puis au-dessous
+        std::vector<Detection> detections = {MakeBox(10, y - 20, 10, 20), MakeBox(14, y - 20, 10, 20)};
+        (*detections[0].mutable_metadata())["track_id"] = "7";
+        (*detections[1].mutable_metadata())["track_id"] = "8";
+        analytics.Update(&detections, static_cast<int64_t>(i));
+    }
+    
+    AnalyticsSnapshot snapshot = analytics.Snapshot(0, 10);
+    EXPECT_EQ(snapshot.active_tracks, 2);
+    EXPECT_EQ(snapshot.lines[0].forward + snapshot.lines[0].backward,
+              static_cast<int64_t>(2 * (crossings - 1)));
+    EXPECT_EQ(snapshot.events_dropped, static_cast<int64_t>(2 * (crossings - 1) - TrackAnalyticsConstants::MAX_EVENTS));
+    ASSERT_EQ(snapshot.events.size(), 10u);
+    EXPECT_EQ(snapshot.events[0].track_id, 7u);
+    EXPECT_EQ(snapshot.events[1].track_id, 8u);
+}
+
+// Damier de carrés de 10 pixels, à bords francs ou adoucis (sinus), texturé
+// entre les colonnes x_begin et x_end seulement
+static Frame MakeTexture(bool sharp, int x_begin = 0, int x_end = 128) {
+    Frame frame(128, 96, "gray");
+    frame.data.assign(128 * 96, 128);
+    for (int y = 0; y < 96; ++y) {
+        for (int x = x_begin; x < x_end; ++x) {
+            double wave = std::sin((x + 0.5) * M_PI / 10) * std::sin((y + 0.5) * M_PI / 10);
+            if (sharp) wave = wave >= 0 ? 1.0 : -1.0;
+            frame.data[y * 128 + x] = static_cast<uint8_t>(128 + 100 * wave);
+        }
+    }
+    return frame;
+}
+
+static CameraHealthState FeedHealth(CameraHealthMonitor& monitor, const Frame& frame, int count,
+                                    std::chrono::steady_clock::time_point& now) {
+    FrameFeatureExtractor extractor;
+    extractor.SetQualityEnabled(true);
+    for (int i = 0; i < count; ++i) {
+        const FrameFeatures* features = extractor.Extract(frame.Pixels(), frame.width, frame.height, 1);
+        now += std::chrono::milliseconds(100);
+        monitor.Update(features->quality, now);
+    }
+    return monitor.GetStatus().state;
+}
+
+TEST(CameraHealthTest, DetectsGlareUnlessReferenceIsSaturated) {
+    using namespace CameraHealthConstants;
+    auto now = std::chrono::steady_clock::now();
+    Frame scene = MakeTexture(true, 0, 64);
+    Frame glare = scene;
+    for (int y = 0; y < 96; ++y) {
+        std::fill(&glare.data[y * 128 + 64], &glare.data[y * 128 + 128], uint8_t{255});
+    }
+    
+    // Projecteur dans l'objectif : la moitié de l'image saturée
+    CameraHealthMonitor monitor;
+    EXPECT_EQ(FeedHealth(monitor, scene, REFERENCE_FRAMES, now), CameraHealthState::OK);
+    EXPECT_EQ(monitor.GetStatus().current.saturated, 0.0f);
+    EXPECT_EQ(FeedHealth(monitor, glare, CONFIRM_FRAMES, now), CameraHealthState::GLARE);
+    EXPECT_NEAR(monitor.GetStatus().current.saturated, 0.5f, 0.01f);
+    EXPECT_TRUE(monitor.IsThrottled());
+    EXPECT_STREQ(CameraHealthMonitor::StateToString(CameraHealthState::GLARE), "glare");
+    
+    // Scène déjà saturée à l'apprentissage (ciel, neige) : rien d'anormal
+    CameraHealthMonitor saturated;
+    EXPECT_EQ(FeedHealth(saturated, glare, REFERENCE_FRAMES + CONFIRM_FRAMES, now), CameraHealthState::OK);
+}
+
+TEST(CameraHealthTest, DetectsBlackoutTamperAndBlurAfterConfirmation) {
+    using namespace CameraHealthConstants;
+    CameraHealthMonitor monitor;
+    std::vector<CameraHealthState> transitions;
+    monitor.SetTransitionCallback([&](const CameraHealthStatus& status) { transitions.push_back(status.state); });
+    auto now = std::chrono::steady_clock::now();
+    Frame scene = MakeTexture(true, 0, 64);
+    
+    EXPECT_EQ(FeedHealth(monitor, scene, REFERENCE_FRAMES - 1, now), CameraHealthState::LEARNING);
+    EXPECT_EQ(FeedHealth(monitor, scene, 1, now), CameraHealthState::OK);
+    EXPECT_NEAR(monitor.GetStatus().reference.brightness, 128.0f, 10.0f);
+    
+    // Image noire : confirmée après CONFIRM_FRAMES frames, analyse ralentie
+    Frame black = FrameUtils::CreateColorFrame(128, 96, 5, 5, 5, "gray");
+    EXPECT_EQ(FeedHealth(monitor, black, CONFIRM_FRAMES - 1, now), CameraHealthState::OK);
+    EXPECT_EQ(FeedHealth(monitor, black, 1, now), CameraHealthState::BLACKOUT);
+    EXPECT_TRUE(monitor.IsThrottled());
+    EXPECT_EQ(FeedHealth(monitor, scene, CONFIRM_FRAMES, now), CameraHealthState::OK);
+    EXPECT_FALSE(monitor.IsThrottled());
+    
+    // Caméra déplacée : les contours ne sont plus au même endroit
+    Frame moved = MakeTexture(true, 64, 128);
+    EXPECT_EQ(FeedHealth(monitor, moved, CONFIRM_FRAMES, now), CameraHealthState::TAMPER);
+    EXPECT_GT(monitor.GetStatus().edge_change, TAMPER_EDGE_CHANGE);
+    EXPECT_EQ(FeedHealth(monitor, scene, CONFIRM_FRAMES, now), CameraHealthState::OK);
+    
+    // Même scène, bords adoucis
+    Frame blurred = MakeTexture(false, 0, 64);
+    EXPECT_EQ(FeedHealth(monitor, blurred, CONFIRM_FRAMES, now), CameraHealthState::BLUR);
+    EXPECT_LT(monitor.GetStatus().edge_change, TAMPER_EDGE_CHANGE);
+    
+    // Dégradé trop longtemps : la nouvelle image devient la référence
+    now += std::chrono::milliseconds(RELEARN_MS);
+    EXPECT_EQ(FeedHealth(monitor, blurred, 1, now), CameraHealthState::LEARNING);
+    EXPECT_EQ(FeedHealth(monitor, blurred, REFERENCE_FRAMES, now), CameraHealthState::OK);
+    
+    std::vector<CameraHealthState> expected = {
+        CameraHealthState::OK, CameraHealthState::BLACKOUT, CameraHealthState::OK,
+        CameraHealthState::TAMPER, CameraHealthState::OK, CameraHealthState::BLUR,
+        CameraHealthState::LEARNING, CameraHealthState::OK};
+    EXPECT_EQ(transitions, expected);
+    EXPECT_EQ(monitor.GetStatus().transitions, 8);
+}
+
+TEST(CameraHealthTest, FrameProcessorThrottlesDegradedCamera) {
+    using namespace CameraHealthConstants;
+    FrameProcessor processor;
+    ASSERT_TRUE(processor.Initialize());
+    Frame scene = MakeTexture(true);
+    for (uint32_t i = 0; i < REFERENCE_FRAMES; ++i) {
+        processor.ProcessFrame(scene);
+    }
+    EXPECT_EQ(processor.GetHealthMonitor()->GetStatus().state, CameraHealthState::OK);
+    
+    Frame black = FrameUtils::CreateColorFrame(128, 96, 0, 0, 0, "gray");
+    for (int i = 0; i < CONFIRM_FRAMES; ++i) {
+        processor.ProcessFrame(black);
+    }
+    ASSERT_TRUE(processor.GetHealthMonitor()->IsThrottled());
+    
+    // Une frame sur THROTTLE_INTERVAL analysée
+    int64_t analysed = processor.GetTotalFramesProcessed();
+    for (int i = 0; i < 10 * THROTTLE_INTERVAL; ++i) {
+        EXPECT_TRUE(processor.ProcessFrame(black).success);
+    }
+    EXPECT_EQ(processor.GetTotalFramesProcessed() - analysed, 10);
+    
+    // Retour à la normale vu malgré le ralentissement
+    for (int i = 0; i < CONFIRM_FRAMES * THROTTLE_INTERVAL; ++i) {
+        processor.ProcessFrame(scene);
+    }
+    EXPECT_EQ(processor.GetHealthMonitor()->GetStatus().state, CameraHealthState::OK);
+    EXPECT_FALSE(processor.GetHealthMonitor()->IsThrottled());
+}
+
+// Une boîte fixe, détectée une frame analysée sur deux comme un objet
+// immobile que le mouvement ne révèle que par moments
+class IntermittentBoxDetector : public Detector {
+public:
+    std::vector<Detection> Detect(const Frame& /*frame*/) override {
+        if (calls++ % 2 != 0) {
+            return {};
+        }
+        return {MakeBox(40, 30, 16, 16)};
+    }
+    std::string GetName() const override { return "IntermittentBoxDetector"; }
+    bool Initialize() override { return true; }
+    void Cleanup() override {}
+    
+    int calls = 0;
+};
+
+TEST(CameraHealthTest, TracksSurviveThrottledPeriod) {
+    using namespace CameraHealthConstants;
+    FrameProcessor processor;
+    ASSERT_TRUE(processor.Initialize());
+    Frame scene = MakeTexture(true);
+    for (uint32_t i = 0; i < REFERENCE_FRAMES; ++i) {
+        processor.ProcessFrame(scene);
+    }
+    Frame black = FrameUtils::CreateColorFrame(128, 96, 0, 0, 0, "gray");
+    for (int i = 0; i < CONFIRM_FRAMES; ++i) {
+        processor.ProcessFrame(black);
+    }
+    ASSERT_TRUE(processor.GetHealthMonitor()->IsThrottled());
+    processor.AddDetector(std::make_unique<IntermittentBoxDetector>());
+    
+    surveillance::vision::StreamConfig config;
+    auto* zone = config.add_zones();
+    zone->set_id("all");
+    zone->set_active(true);
+    for (auto [x, y] : {std::pair{0, 0}, {128, 0}, {128, 96}, {0, 96}}) {
+        auto* point = zone->add_points();
+        point->set_x(x);
+        point->set_y(y);
+    }
+    TrackAnalytics analytics(config.zones(), config.lines());
+    
+    // Comme la boucle du stream : les frames sautées ne touchent pas aux pistes
+    int skipped = 0;
+    int64_t now = 1000;
+    for (int i = 0; i < 20 * THROTTLE_INTERVAL; ++i, now += 100) {
+        ProcessingResult result = processor.ProcessFrame(black);
+        EXPECT_TRUE(result.success);
+        if (result.skipped) {
+            EXPECT_TRUE(result.detections.empty());
+            skipped++;
+            continue;
+        }
+        analytics.Update(&result.detections, now);
+        for (const auto& detection : result.detections) {
+            EXPECT_EQ(detection.metadata().at("track_id"), "1");
+        }
+    }
+    EXPECT_EQ(skipped, 20 * (THROTTLE_INTERVAL - 1));
+    
+    AnalyticsSnapshot snapshot = analytics.Snapshot(0, 100);
+    EXPECT_EQ(snapshot.active_tracks, 1);
+    ASSERT_EQ(snapshot.events.size(), 1u);
+    EXPECT_EQ(snapshot.events[0].type, AnalyticsEvent::Type::ZONE_ENTER);
+}
+
+TEST(DetectionLogTest, QueriesTimeRangesAcrossSegmentsAndReopens) {
+    std::string directory = (std::filesystem::temp_directory_path() /
+                             ("vision_detections_" + std::to_string(getpid()))).string();
+    std::filesystem::remove_all(directory);
+    const int64_t day = DetectionLogConstants::SEGMENT_MAX_SPAN_MS;
+    const int64_t base = 1760000000000;
+    auto record_at = [](int64_t timestamp, int index) {
+        DetectionRecord record{};
+        record.timestamp_ms = timestamp;
+        record.x = index;
+        record.width = 10;
+        record.height = 20;
+        record.confidence = 0.5f;
+        record.type_id = DetectionLog::GetTypeId("motion");
+        record.track_id = static_cast<uint32_t>(index);
+        return record;
+    };
+    
+    // 1000 détections par jour sur trois jours, une par seconde : trois segments
+    {
+        DetectionLog log;
+        ASSERT_TRUE(log.Open(directory));
+        for (int d = 0; d < 3; ++d) {
+            for (int i = 0; i < 1000; ++i) {
+                ASSERT_TRUE(log.Append(record_at(base + d * day + i * 1000, d * 1000 + i)));
+            }
+        }
+        EXPECT_EQ(log.GetRecordCount(), 3000);
+    }  // dernier lot écrit à la fermeture
+    
+    DetectionQueryResult result;
+    ASSERT_TRUE(DetectionLog::Query(directory, base + day + 100 * 1000, base + day + 199 * 1000, 1000, &result));
+    ASSERT_EQ(result.records.size(), 100u);
+    EXPECT_EQ(result.records.front().x, 1100);
+    EXPECT_EQ(result.records.back().x, 1199);
+    EXPECT_FALSE(result.truncated);
+    EXPECT_EQ(result.segments_scanned, 1);
+    // L'index évite de relire le début du segment
+    EXPECT_LT(result.records_scanned, 100 + 2 * static_cast<int64_t>(DetectionLogConstants::INDEX_STRIDE));
+    
+    // Intervalle à cheval sur deux segments, tronqué par la limite
+    ASSERT_TRUE(DetectionLog::Query(directory, base + 990 * 1000, base + day + 9 * 1000, 15, &result));
+    ASSERT_EQ(result.records.size(), 15u);
+    EXPECT_TRUE(result.truncated);
+    EXPECT_EQ(result.records[9].x, 999);
+    EXPECT_EQ(result.records[10].x, 1000);
+    EXPECT_EQ(result.records[10].track_id, 1000u);
+    
+    // Lot interrompu : enregistrement partiel en fin du dernier segment
+    std::vector<std::filesystem::path> segments;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() == DetectionLogConstants::SEGMENT_EXTENSION) {
+            segments.push_back(entry.path());
+        }
+    }
+    ASSERT_EQ(segments.size(), 3u);
+    std::sort(segments.begin(), segments.end());
+    std::ofstream(segments.back(), std::ios::binary | std::ios::app) << "partial";
+    
+    // Reprise : l'horloge qui recule ne casse pas l'ordre du journal
+    {
+        DetectionLog log;
+        ASSERT_TRUE(log.Open(directory));
+        ASSERT_TRUE(log.Append(record_at(base, 3000)));
+        ASSERT_TRUE(log.Flush());
+    }
+    ASSERT_TRUE(DetectionLog::Query(directory, base + 2 * day + 999 * 1000, base + 3 * day, 10, &result));
+    ASSERT_EQ(result.records.size(), 2u);
+    EXPECT_EQ(result.records[0].x, 2999);
+    EXPECT_EQ(result.records[1].x, 3000);
+    EXPECT_EQ(result.records[1].timestamp_ms, base + 2 * day + 999 * 1000);
+    
+    ASSERT_TRUE(DetectionLog::Query(directory, base + 3 * day, base + 4 * day, 10, &result));
+    EXPECT_TRUE(result.records.empty());
+    ASSERT_TRUE(DetectionLog::Query(directory, base - day, base - 1, 10, &result));
+    EXPECT_TRUE(result.records.empty());
+    EXPECT_EQ(result.segments_scanned, 0);  // écarté d'après le nom des segments
+    
+    std::filesystem::remove_all(directory);
+}
+
+TEST(DetectionLogTest, ConvertsDetections) {
+    Detection detection;
+    detection.set_type("person");
+    detection.set_confidence(0.75f);
+    detection.set_timestamp(1234);
+    detection.mutable_bbox()->set_x(1);
+    detection.mutable_bbox()->set_y(2);
+    detection.mutable_bbox()->set_width(3);
+    detection.mutable_bbox()->set_height(4);
+    (*detection.mutable_metadata())["track_id"] = "42";
+    
+    DetectionRecord record = DetectionLog::ToRecord(detection);
+    EXPECT_EQ(record.timestamp_ms, 1234);
+    EXPECT_EQ(record.x, 1);
+    EXPECT_EQ(record.height, 4);
+    EXPECT_FLOAT_EQ(record.confidence, 0.75f);
+    EXPECT_EQ(DetectionLog::GetTypeName(record.type_id), "person");
+    EXPECT_EQ(record.track_id, 42u);
+    EXPECT_EQ(DetectionLog::GetTypeName(DetectionLog::GetTypeId("dragon")), "unknown");
+}
+
+TEST(VisionCoreApiTest, ProcessesBorrowedFramesAndCameraCallbacks) {
+    EXPECT_EQ(vision_abi_version(), static_cast<uint32_t>(VISION_CORE_ABI_VERSION));
+
+    vision_processor_t* processor = vision_processor_create();
+    ASSERT_NE(processor, nullptr);
+    ASSERT_EQ(vision_processor_detector_count(processor), 1u);
+    EXPECT_STREQ(vision_processor_detector_name(processor, 0), "BasicMotionDetector");
+
+    // Frames de l'appelant analysées en place
+    Frame background = MakeScene(false);
+    Frame object = MakeScene(true);
+    vision_frame_t frame = {background.data.data(), background.data.size(), 320, 240, "bgr", 0, 0};
+    vision_detection_t detections[4];
+    size_t count = 0;
+    for (uint64_t i = 0; i < FrameProcessorConstants::LEARNING_FRAMES; ++i) {
+        ASSERT_EQ(vision_processor_process(processor, &frame, detections, 4, &count), VISION_OK);
+    }
+    frame.data = object.data.data();
+    frame.offset_x = 100;
+    ASSERT_EQ(vision_processor_process(processor, &frame, detections, 4, &count), VISION_OK);
+    ASSERT_EQ(count, 1u);
+    EXPECT_EQ(detections[0].x, 164);
+    EXPECT_STREQ(detections[0].type, "motion");
+
+    EXPECT_EQ(vision_processor_process(processor, nullptr, detections, 4, &count),
+              VISION_ERROR_INVALID_ARGUMENT);
+
+    // Caméra de test analysée sur son thread de capture
+    vision_camera_config_t config;
+    vision_camera_config_init(&config);
+    config.url = "test://pattern";
+    config.fps = 30;
+    vision_camera_t* camera = vision_camera_create(&config);
+    ASSERT_NE(camera, nullptr);
+    std::atomic<int> results{0};
+    ASSERT_EQ(vision_camera_attach_processor(
+                  camera, processor,
+                  [](void* user_data, const vision_detection_t*, size_t, int64_t) {
+                      static_cast<std::atomic<int>*>(user_data)->fetch_add(1);
+                  },
+                  &results),
+              VISION_OK);
+    ASSERT_EQ(vision_camera_start(camera), VISION_OK);
+    for (int i = 0; i < 100 && results.load() < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(vision_camera_stop(camera), VISION_OK);
+    EXPECT_GE(results.load(), 3);
+    EXPECT_GE(vision_camera_frames_captured(camera), 3);
+    vision_camera_destroy(camera);
+
+    vision_camera_config_t invalid;
+    vision_camera_config_init(&invalid);
+    EXPECT_EQ(vision_camera_create(&invalid), nullptr);  // url manquante
+    vision_processor_destroy(processor);
+}
+
+// Test fixture pour CameraManager
+class CameraManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Test avec un pattern de test
+        manager_ = std::make_unique<CameraManager>("test://pattern");
+    }
+    
+    void TearDown() override {
+        if (manager_) {
+            manager_->Cleanup();
+        }
+        manager_.reset();
+    }
+    
+    std::unique_ptr<CameraManager> manager_;
+};
+
+// Tests du CameraManager
+TEST_F(CameraManagerTest, InitializeTestPattern) {
+    EXPECT_EQ(manager_->GetCameraType(), CameraType::TEST_PATTERN);
+    EXPECT_EQ(manager_->GetState(), CameraState::UNINITIALIZED);
+    
+    bool success = manager_->Initialize();
+    EXPECT_TRUE(success);
+    EXPECT_EQ(manager_->GetState(), CameraState::READY);
+}
+
+TEST_F(CameraManagerTest, StartAndStopCapture) {
+    ASSERT_TRUE(manager_->Initialize());
+    
+    // Démarrer la capture
+    bool start_success = manager_->StartCapture();
+    EXPECT_TRUE(start_success);
+    EXPECT_TRUE(manager_->IsCapturing());
+    EXPECT_EQ(manager_->GetState(), CameraState::CAPTURING);
+    
+    // Attendre un peu pour capturer quelques frames
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    
+    // Vérifier les statistiques
+    // const CameraStats& stats = manager_->GetStats(); 
+    // Arrêter la capture
+    bool stop_success = manager_->StopCapture();
+    EXPECT_TRUE(stop_success);
+    EXPECT_FALSE(manager_->IsCapturing());
+}
+
+TEST_F(CameraManagerTest, DetectCameraTypes) {
+    EXPECT_EQ(CameraManager::DetectCameraType("test://pattern"), CameraType::TEST_PATTERN);
+    EXPECT_EQ(CameraManager::DetectCameraType("rtsp://example.com/stream"), CameraType::RTSP_STREAM);
+    EXPECT_EQ(CameraManager::DetectCameraType("/dev/video0"), CameraType::WEBCAM);
+    EXPECT_EQ(CameraManager::DetectCameraType("video.mp4"), CameraType::FILE_VIDEO);
+    EXPECT_EQ(CameraManager::DetectCameraType(""), CameraType::UNKNOWN);
+}
+
+TEST_F(CameraManagerTest, CropsCaptureToRegionOfInterest) {
+    CameraConfig config(640, 480, 30);
+    config.region_of_interest = FrameRegion(0, 240, 640, 240);  // moitié basse
+    ASSERT_TRUE(manager_->Initialize(config));
+    
+    std::promise<Frame> first_frame;
+    std::atomic<bool> received{false};
+    manager_->SetFrameCallback([&](const Frame& frame) {
+        if (!received.exchange(true)) {
+            first_frame.set_value(frame);
+        }
+    });
+    
+    auto future = first_frame.get_future();
+    ASSERT_TRUE(manager_->StartCapture());
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    manager_->StopCapture();
+    
+    Frame frame = future.get();
+    EXPECT_EQ(frame.width, 640);
+    EXPECT_EQ(frame.height, 240);
+    EXPECT_EQ(frame.offset_y, 240);
+    EXPECT_EQ(frame.data.size(), FrameUtils::CalculateFrameSize(640, 240, frame.format));
+}
+
+TEST(CameraCircuitTest, DeadSourceOpensCircuitWithoutThread) {
+    TimerWheel wheel(std::chrono::milliseconds(10), 64);
+    
+    CameraConfig config(320, 240, 30);
+    config.reconnect_delay_ms = 5;
+    config.max_reconnect_attempts = 2;
+    config.circuit_open_ms = 100;
+    CameraManager manager("test://offline");
+    manager.SetTimerWheel(&wheel);
+    ASSERT_TRUE(manager.Initialize(config));
+    ASSERT_TRUE(manager.StartCapture());
+    
+    auto wait_for = [](const std::function<bool()>& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!condition() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return condition();
+    };
+    
+    // Ouvert : plus de thread de capture, une seule entrée dans la roue
+    ASSERT_TRUE(wait_for([&]() { return manager.GetState() == CameraState::CIRCUIT_OPEN; }));
+    EXPECT_TRUE(manager.HasCaptureLoopExited());
+    EXPECT_FALSE(manager.IsCapturing());
+    EXPECT_EQ(wheel.GetPendingCount(), 1u);
+    EXPECT_EQ(manager.GetCircuitBreakerStatus().trips, 1);
+    
+    // L'essai semi-ouvert échoue : réouverture avec une période doublée
+    ASSERT_TRUE(wait_for([&]() { return manager.GetCircuitBreakerStatus().trips == 2; }));
+    EXPECT_EQ(manager.GetCircuitBreakerStatus().open_period, std::chrono::milliseconds(200));
+    
+    EXPECT_TRUE(manager.StopCapture());
+    EXPECT_EQ(wheel.GetPendingCount(), 0u);
+    EXPECT_EQ(manager.GetState(), CameraState::READY);
+}
+
+TEST(CircuitBreakerTest, OpenPeriodGrowsUntilSuccess) {
+    CircuitBreakerConfig config;
+    config.failure_threshold = 2;
+    config.open_ms = 100;
+    config.max_open_ms = 350;
+    CircuitBreaker breaker(config);
+    auto now = std::chrono::steady_clock::now();
+    
+    EXPECT_FALSE(breaker.RecordFailure(now));
+    EXPECT_TRUE(breaker.RecordFailure(now));
+    EXPECT_EQ(breaker.GetState(), CircuitState::OPEN);
+    EXPECT_EQ(breaker.GetOpenPeriod(), std::chrono::milliseconds(100));
+    EXPECT_FALSE(breaker.RecordFailure(now));  // déjà ouvert
+    
+    // Chaque essai manqué double la période, jusqu'au plafond
+    std::vector<int64_t> periods;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(breaker.BeginTrial(now));
+        EXPECT_EQ(breaker.GetState(), CircuitState::HALF_OPEN);
+        EXPECT_TRUE(breaker.RecordFailure(now));
+        periods.push_back(breaker.GetOpenPeriod().count());
+    }
+    EXPECT_EQ(periods, (std::vector<int64_t>{200, 350, 350}));
+    EXPECT_EQ(breaker.GetStatus().trips, 4);
+    
+    // Un succès referme et repart de la période initiale
+    ASSERT_TRUE(breaker.BeginTrial(now));
+    breaker.RecordSuccess(now);
+    EXPECT_EQ(breaker.GetState(), CircuitState::CLOSED);
+    EXPECT_EQ(breaker.GetStatus().consecutive_failures, 0);
+    EXPECT_FALSE(breaker.RecordFailure(now));
+    EXPECT_TRUE(breaker.RecordFailure(now));
+    EXPECT_EQ(breaker.GetOpenPeriod(), std::chrono::milliseconds(100));
+}
+
+TEST(CameraCoroutineTest, StreamsShareExecutorWithoutThreads) {
+    WorkerPool executor(2);
+    TimerWheel frame_clock(std::chrono::milliseconds(2), 256);
+    TimerWheel circuit_wheel(std::chrono::milliseconds(10), 64);
+    CoroutineStats before = GetCoroutineStats();
+    
+    // Plus de streams que de threads : chacun n'occupe le pool que le
+    // temps d'une frame
+    constexpr int STREAM_COUNT = 8;
+    std::vector<std::unique_ptr<std::atomic<int>>> frames;
+    std::vector<std::unique_ptr<CameraManager>> cameras;
+    for (int i = 0; i < STREAM_COUNT; ++i) {
+        auto camera = std::make_unique<CameraManager>("test://pattern");
+        auto counter = std::make_unique<std::atomic<int>>(0);
+        camera->SetTimerWheel(&circuit_wheel);
+        camera->SetExecutor(&executor, &frame_clock);
+        EXPECT_TRUE(camera->IsCooperative());
+        EXPECT_FALSE(camera->SetCpuAffinity({0}));  // threads du pool partagés
+        EXPECT_TRUE(camera->GetCpuAffinity().empty());
+        camera->SetFrameCallback([count = counter.get()](const Frame&) { ++*count; });
+        CameraConfig config(160, 120, 30);
+        config.reconnect_delay_ms = 10;
+        ASSERT_TRUE(camera->Initialize(config));
+        ASSERT_TRUE(camera->StartCapture());
+        cameras.push_back(std::move(camera));
+        frames.push_back(std::move(counter));
+    }
+    
+    auto all_streams_running = [&]() {
+        return std::all_of(frames.begin(), frames.end(), [](const auto& count) { return count->load() >= 1; });
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!all_streams_running() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(all_streams_running());
+    CoroutineStats running = GetCoroutineStats();
+    EXPECT_EQ(running.live_frames - before.live_frames, 2 * STREAM_COUNT);  // capture et livraison
+    EXPECT_LT(running.largest_frame_bytes, 1024);
+    
+    for (int i = 0; i < STREAM_COUNT; ++i) {
+        EXPECT_TRUE(cameras[i]->StopCapture());
+        EXPECT_FALSE(cameras[i]->IsCapturing());
+        EXPECT_TRUE(cameras[i]->HasCaptureLoopExited());
+    }
+    EXPECT_EQ(frame_clock.GetPendingCount(), 0u);
+    
+    // Redémarrable après un arrêt
+    EXPECT_EQ(cameras[0]->GetState(), CameraState::READY);
+    ASSERT_TRUE(cameras[0]->StartCapture());
+    EXPECT_TRUE(cameras[0]->StopCapture());
+    
+    // Chaque frame est libérée juste après la sortie de sa coroutine
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (GetCoroutineStats().live_frames != before.live_frames &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(GetCoroutineStats().live_frames, before.live_frames);
+}
+
+TEST(CameraCoroutineTest, SlowCallbackDoesNotHoldCapture) {
+    WorkerPool executor(2);
+    TimerWheel frame_clock(std::chrono::milliseconds(2), 256);
+    TimerWheel circuit_wheel(std::chrono::milliseconds(10), 64);
+    
+    // Analyse 4 fois plus lente que la cadence : la capture la devance
+    std::atomic<int> delivered{0};
+    CameraManager camera("test://pattern");
+    camera.SetTimerWheel(&circuit_wheel);
+    camera.SetExecutor(&executor, &frame_clock);
+    camera.SetFrameCallback([&delivered](const Frame&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        ++delivered;
+    });
+    ASSERT_TRUE(camera.Initialize(CameraConfig(160, 120, 100)));
+    ASSERT_TRUE(camera.StartCapture());
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_TRUE(camera.StopCapture());
+    
+    CameraStatsSnapshot stats = camera.GetStats().Snapshot();
+    EXPECT_GT(stats.frames_captured, 2 * delivered.load());
+    EXPECT_GT(stats.frames_dropped, 0);
+    EXPECT_GE(delivered.load(), 3);
+    // Chaque frame est livrée ou perdue : l'arrêt livre encore celle en attente
+    EXPECT_EQ(delivered.load() + stats.frames_dropped, stats.frames_captured);
+}
+
+// Reçoit jusqu'à la fermeture ; received n'est lu qu'une fois done posé
+static DetachedTask ReceiveAll(CoChannel<int>* channel, std::vector<int>* received,
+                               std::atomic<int>* count, std::atomic<bool>* done) {
+    while (true) {
+        std::optional<int> value = co_await channel->Next();
+        if (!value) {
+            break;
+        }
+        received->push_back(*value);
+        ++*count;
+    }
+    done->store(true);
+}
+
+TEST(CameraCoroutineTest, ChannelKeepsLatestValueForNextStage) {
+    WorkerPool executor(2);
+    CoChannel<int> channel;
+    channel.Bind(&executor);
+    std::vector<int> received;
+    std::atomic<int> count{0};
+    std::atomic<bool> done{false};
+    
+    // Valeurs poussées avant la première attente : seule la dernière reste
+    EXPECT_FALSE(channel.Push(1));
+    EXPECT_TRUE(channel.Push(2));
+    ReceiveAll(&channel, &received, &count, &done);
+    
+    // Consommateur suspendu : repris sur le pool à chaque valeur
+    auto wait_for = [&count](int expected) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (count.load() < expected && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    wait_for(1);
+    EXPECT_FALSE(channel.Push(3));
+    wait_for(2);
+    EXPECT_FALSE(channel.Push(4));
+    channel.Close();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!done.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    ASSERT_TRUE(done.load());
+    EXPECT_EQ(received, (std::vector<int>{2, 3, 4}));  // fermé : la valeur en attente est rendue
+    EXPECT_TRUE(channel.Push(5));
+    executor.Shutdown();
+}
+
+// Dort par pas d'un tick jusqu'au réveil ; exited est la dernière écriture
+static DetachedTask SleepUntilWoken(CoSleeper* sleeper, std::atomic<bool>* exited) {
+    bool woken = false;
+    while (!woken) {
+        woken = co_await sleeper->SleepUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(2));
+    }
+    exited->store(true);
+}
+
+// Beaucoup de dormeurs échus dans les mêmes ticks, détruits un à un dès la
+// sortie de leur coroutine : aucun callback de la roue ne doit les toucher
+// ensuite (ASan)
+TEST(CameraCoroutineTest, SleepersCanBeFreedRightAfterWake) {
+    WorkerPool executor(2);
+    TimerWheel frame_clock(std::chrono::milliseconds(2), 1024);
+    CoroutineStats before = GetCoroutineStats();
+    
+    constexpr int SLEEPER_COUNT = 256;
+    std::vector<std::unique_ptr<CoSleeper>> sleepers;
+    std::vector<std::unique_ptr<std::atomic<bool>>> exited;
+    for (int i = 0; i < SLEEPER_COUNT; ++i) {
+        sleepers.push_back(std::make_unique<CoSleeper>());
+        exited.push_back(std::make_unique<std::atomic<bool>>(false));
+        sleepers.back()->Bind(&frame_clock, &executor);
+        SleepUntilWoken(sleepers.back().get(), exited.back().get());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    for (int i = 0; i < SLEEPER_COUNT; ++i) {
+        sleepers[i]->Wake();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!exited[i]->load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        ASSERT_TRUE(exited[i]->load());
+        sleepers[i].reset();
+    }
+    
+    // Les ticks suivants ne trouvent plus rien à lancer
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(frame_clock.GetPendingCount(), 0u);
+    frame_clock.Stop();
+    executor.Shutdown();
+    EXPECT_EQ(GetCoroutineStats().live_frames, before.live_frames);
+}
+
+TEST(TimerWheelTest, FiresAcrossRoundsAndHonoursCancel) {
+    TimerWheel wheel(std::chrono::milliseconds(5), 8);  // 40 ms par tour
+    
+    std::mutex mutex;
+    std::vector<int> fired;
+    auto record = [&](int value) {
+        return [&, value]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            fired.push_back(value);
+        };
+    };
+    
+    wheel.Schedule(std::chrono::milliseconds(100), record(3));  // plusieurs tours
+    wheel.Schedule(std::chrono::milliseconds(10), record(1));
+    auto cancelled = wheel.Schedule(std::chrono::milliseconds(20), record(2));
+    wheel.Schedule(std::chrono::milliseconds(50), record(4));
+    EXPECT_EQ(wheel.GetPendingCount(), 4u);
+    EXPECT_TRUE(wheel.Cancel(cancelled));
+    EXPECT_FALSE(wheel.Cancel(cancelled));
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (wheel.GetPendingCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    wheel.Stop();
+    
+    EXPECT_EQ(fired, (std::vector<int>{1, 4, 3}));
+    EXPECT_EQ(wheel.Schedule(std::chrono::milliseconds(10), record(5)), 0u);
+}
+
+// Deux timers échus dans le même tick : le premier annule le second, qui
+// ne doit plus s'exécuter (l'appelant libère ce qu'il référence)
+TEST(TimerWheelTest, CancelsTimerQueuedBehindCallbackOfSameTick) {
+    TimerWheel wheel(std::chrono::milliseconds(5), 8);
+
+    std::atomic<bool> second_ran{false};
+    std::atomic<int> cancel_result{-1};
+    std::atomic<TimerWheel::TimerId> second{0};
+    std::mutex mutex;
+    std::unique_lock<std::mutex> schedule_lock(mutex);  // les deux dans le même tick
+
+    wheel.Schedule(std::chrono::milliseconds(10), [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancel_result = wheel.Cancel(second.load()) ? 1 : 0;
+    });
+    second = wheel.Schedule(std::chrono::milliseconds(10), [&]() { second_ran = true; });
+    schedule_lock.unlock();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (wheel.GetPendingCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    wheel.Stop();
+
+    EXPECT_EQ(cancel_result.load(), 1);
+    EXPECT_FALSE(second_ran.load());
+}
+
+// sysfs fictif : 2 sockets (un nœud NUMA et un L3 chacun), 2 cœurs par
+// socket, 2 hyperthreads par cœur
+class FakeSysfs {
+public:
+    FakeSysfs() : root_(std::filesystem::temp_directory_path() /
+                        ("vision_sysfs_" + std::to_string(getpid()))) {
+        Write("cpu/online", "0-7");
+        for (int cpu = 0; cpu < 8; ++cpu) {
+            std::string dir = "cpu/cpu" + std::to_string(cpu);
+            int package = cpu / 4;
+            int first_sibling = cpu - cpu % 2;
+            std::string siblings = std::to_string(first_sibling) + "-" + std::to_string(first_sibling + 1);
+            std::string socket = package == 0 ? "0-3" : "4-7";
+            Write(dir + "/topology/physical_package_id", std::to_string(package));
+            Write(dir + "/topology/core_id", std::to_string((cpu / 2) % 2));
+            Write(dir + "/topology/thread_siblings_list", siblings);
+            Write(dir + "/cache/index0/level", "1");
+            Write(dir + "/cache/index0/shared_cpu_list", siblings);
+            Write(dir + "/cache/index2/level", "2");
+            Write(dir + "/cache/index2/shared_cpu_list", siblings);
+            Write(dir + "/cache/index3/level", "3");
+            Write(dir + "/cache/index3/shared_cpu_list", socket);
+        }
+        Write("node/node0/cpulist", "0-3");
+        Write("node/node1/cpulist", "4-7");
+    }
+    
+    ~FakeSysfs() {
+        std::error_code error;
+        std::filesystem::remove_all(root_, error);
+    }
+    
+    std::string GetRoot() const { return root_.string(); }
+    
+private:
+    std::filesystem::path root_;
+    
+    void Write(const std::string& relative, const std::string& content) {
+        std::filesystem::path path = root_ / relative;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << content << "\n";
+    }
+};
+
+TEST(CpuTopologyTest, LoadsTopologyFromSysfs) {
+    FakeSysfs sysfs;
+    CpuTopology topology = CpuTopology::Load(sysfs.GetRoot());
+    
+    ASSERT_EQ(topology.GetCpus().size(), 8u);
+    EXPECT_EQ(topology.GetNumaNodeCount(), 2);
+    EXPECT_EQ(topology.GetL3DomainCount(), 2);
+    
+    const CpuInfo& cpu5 = topology.GetCpus()[5];
+    EXPECT_EQ(cpu5.package_id, 1);
+    EXPECT_EQ(cpu5.numa_node, 1);
+    EXPECT_EQ(cpu5.l2_domain, 4);
+    EXPECT_EQ(cpu5.l3_domain, 4);
+    
+    EXPECT_EQ(topology.Restrict({0, 1, 2}).GetNumaNodeCount(), 1);
+    EXPECT_EQ(CpuTopology::ParseCpuList("0-2,5,7-8"), (std::vector<int>{0, 1, 2, 5, 7, 8}));
+    EXPECT_EQ(CpuTopology::FormatCpuList({8, 0, 1, 2, 5, 7}), "0-2,5,7-8");
+    
+    // Sans sysfs : repli sur une topologie plate
+    EXPECT_FALSE(CpuTopology::Load(sysfs.GetRoot() + "/missing").IsEmpty());
+}
+
+TEST(StreamPlacementTest, SpreadsAcrossCacheDomainsAndRebalances) {
+    FakeSysfs sysfs;
+    StreamPlacer placer(CpuTopology::Load(sysfs.GetRoot()));
+    
+    // Alternance des sockets, un cœur physique par stream
+    EXPECT_EQ(placer.Place("a").cpus, (std::vector<int>{0, 1}));
+    EXPECT_EQ(placer.Place("b").cpus, (std::vector<int>{4, 5}));
+    EXPECT_EQ(placer.Place("c").cpus, (std::vector<int>{2, 3}));
+    EXPECT_EQ(placer.Place("d").cpus, (std::vector<int>{6, 7}));
+    EXPECT_EQ(placer.Place("b").numa_node, 1);  // idempotent
+    
+    // Cinquième stream : partage le premier cœur
+    StreamPlacement e = placer.Place("e");
+    EXPECT_EQ(e.cpus, (std::vector<int>{0, 1}));
+    EXPECT_EQ(e.l3_domain, 0);
+    
+    // Le cœur de "c" se libère : un des deux streams du cœur 0 y migre
+    std::vector<PlacementMove> moves = placer.Release("c");
+    ASSERT_EQ(moves.size(), 1u);
+    EXPECT_TRUE(moves[0].stream_id == "a" || moves[0].stream_id == "e");
+    EXPECT_EQ(moves[0].placement.cpus, (std::vector<int>{2, 3}));
+    EXPECT_EQ(placer.GetPlacement(moves[0].stream_id).cpus, (std::vector<int>{2, 3}));
+    
+    EXPECT_TRUE(placer.Release("d").empty());
+    EXPECT_TRUE(placer.Release("unknown").empty());
+    
+    PlacementStats stats = placer.GetStats();
+    EXPECT_EQ(stats.placements, 5);
+    EXPECT_EQ(stats.releases, 2);
+    EXPECT_EQ(stats.moves, 1);
+}
+
+TEST(StreamPlacementTest, ServiceLeavesCooperativeStreamsUnpinned) {
+    FakeSysfs sysfs;
+    VisionServiceImpl service(CpuTopology::Load(sysfs.GetRoot()));
+    grpc::ServerContext context;
+    
+    // Les patterns de test tournent sur le pool partagé : aucun cœur réservé
+    for (const std::string camera_id : {"socket0_cam", "socket1_cam"}) {
+        surveillance::vision::StreamRequest request;
+        surveillance::vision::StreamResponse response;
+        request.set_camera_id(camera_id);
+        request.set_camera_url("test://pattern");
+        service.StartStream(&context, &request, &response);
+        ASSERT_EQ(response.status(), "success");
+    }
+    
+    surveillance::vision::StatusRequest status_request;
+    surveillance::vision::StatusResponse status_response;
+    status_request.set_camera_id("socket1_cam");
+    service.GetStreamStatus(&context, &status_request, &status_response);
+    EXPECT_FALSE(status_response.has_placement());
+    
+    surveillance::vision::StopRequest stop_request;
+    surveillance::vision::StopResponse stop_response;
+    stop_request.set_camera_id("socket0_cam");
+    service.StopStream(&context, &stop_request, &stop_response);
+    
+    surveillance::vision::HealthRequest health_request;
+    surveillance::vision::HealthResponse health;
+    service.GetHealth(&context, &health_request, &health);
+    EXPECT_EQ(health.placement().placements(), 0);
+    EXPECT_EQ(health.placement().releases(), 0);
+    EXPECT_EQ(health.placement().numa_nodes(), 2);
+    EXPECT_EQ(health.placement().cpus(), 8);
+}
+
+// Tests des utilitaires
+TEST(FrameUtilsTest, CropFrameCopiesOnlyRegion) {
+    Frame frame = FrameUtils::CreateTestFrame(64, 48, "gray");
+    Frame cropped = FrameUtils::CropFrame(frame, FrameRegion(8, 16, 32, 32));
+    
+    EXPECT_EQ(cropped.width, 32);
+    EXPECT_EQ(cropped.height, 32);
+    EXPECT_EQ(cropped.offset_x, 8);
+    EXPECT_EQ(cropped.offset_y, 16);
+    ASSERT_EQ(cropped.data.size(), 32u * 32u);
+    EXPECT_EQ(cropped.data[0], frame.data[16 * 64 + 8]);
+    EXPECT_EQ(cropped.data[33], frame.data[17 * 64 + 9]);
+    
+    // Région vide : frame inchangée
+    EXPECT_EQ(FrameUtils::CropFrame(frame, FrameRegion()).data, frame.data);
+}
+
+TEST(FrameUtilsTest, ComputeActiveZonesRegion) {
+    surveillance::vision::StreamConfig config;
+    auto* zone = config.add_zones();
+    zone->set_active(true);
+    for (auto [x, y] : {std::pair<int, int>{100, 300}, {400, 300}, {400, 450}, {100, 450}}) {
+        auto* point = zone->add_points();
+        point->set_x(x);
+        point->set_y(y);
+    }
+    auto* inactive = config.add_zones();
+    inactive->set_active(false);
+    inactive->add_points()->set_x(0);
+    
+    FrameRegion region = FrameUtils::ComputeActiveZonesRegion(config.zones(), 640, 480, 16);
+    EXPECT_EQ(region.x, 84);
+    EXPECT_EQ(region.y, 284);
+    EXPECT_EQ(region.width, 333);
+    EXPECT_EQ(region.height, 183);
+    
+    // Aucune zone active : frame entière
+    zone->set_active(false);
+    EXPECT_TRUE(FrameUtils::ComputeActiveZonesRegion(config.zones(), 640, 480, 16).IsEmpty());
+}
+
+TEST(FrameUtilsTest, CreateTestFrame) {
+    Frame frame = FrameUtils::CreateTestFrame(320, 240, "bgr");
+    
+    EXPECT_EQ(frame.width, 320);
+    EXPECT_EQ(frame.height, 240);
+    EXPECT_EQ(frame.format, "bgr");
+    EXPECT_FALSE(frame.data.empty());
+    EXPECT_EQ(frame.data.size(), 320 * 240 * 3);
+}
+
+TEST(FrameUtilsTest, CreateColorFrame) {
+    Frame frame = FrameUtils::CreateColorFrame(100, 100, 255, 0, 0, "rgb");
+    
+    EXPECT_EQ(frame.width, 100);
+    EXPECT_EQ(frame.height, 100);
+    EXPECT_EQ(frame.format, "rgb");
+    EXPECT_EQ(frame.data.size(), 100 * 100 * 3);
+    
+    // Vérifier que la couleur est correcte (rouge en RGB)
+    EXPECT_EQ(frame.data[0], 255);  // R
+    EXPECT_EQ(frame.data[1], 0);    // G
+    EXPECT_EQ(frame.data[2], 0);    // B
+}
+
+TEST(FrameUtilsTest, ValidateFormats) {
+    EXPECT_TRUE(FrameUtils::IsValidFormat("bgr"));
+    EXPECT_TRUE(FrameUtils::IsValidFormat("rgb"));
+    EXPECT_TRUE(FrameUtils::IsValidFormat("gray"));
+    EXPECT_FALSE(FrameUtils::IsValidFormat("invalid"));
+    
+    auto formats = FrameUtils::GetSupportedFormats();
+    EXPECT_FALSE(formats.empty());
+    EXPECT_GT(formats.size(), 3);
+}
+
+TEST(FrameUtilsTest, CalculateFrameSize) {
+    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "bgr"), 640 * 480 * 3);
+    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "gray"), 640 * 480);
+    EXPECT_GT(FrameUtils::CalculateFrameSize(640, 480, "jpeg"), 0);
+    EXPECT_EQ(FrameUtils::CalculateFrameSize(640, 480, "unknown"), 0);
+}
+
+// Tests des statistiques publiées par seqlock
+TEST(StatsBlockTest, ReadersSeeConsistentSnapshots) {
+    struct Counters {
+        int64_t a = 0;
+        int64_t b = 0;
+        int64_t sum = 0;
+    };
+    StatsBlock<Counters> block;
+    std::atomic<bool> done{false};
+    
+    std::thread writer([&]() {
+        for (int64_t i = 1; i <= 200000; ++i) {
+            block.Update([i](Counters& counters) {
+                counters.a = i;
+                counters.b = 3 * i;
+                counters.sum = counters.a + counters.b;
+            });
+        }
+        done = true;
+    });
+    
+    int64_t torn = 0;
+    int64_t last_seen = 0;
+    while (!done.load()) {
+        Counters snapshot = block.Snapshot();
+        if (snapshot.b != 3 * snapshot.a || snapshot.sum != snapshot.a + snapshot.b) {
+            torn++;
+        }
+        EXPECT_GE(snapshot.a, last_seen);  // jamais de retour en arrière
+        last_seen = snapshot.a;
+    }
+    writer.join();
+    
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(block.Snapshot().a, 200000);
+    EXPECT_EQ(alignof(StatsBlock<Counters>), CACHE_LINE_SIZE);
+}
+
+// Tests du WorkerPool
+TEST(WorkerPoolTest, RunsSubmittedTasks) {
+    WorkerPool pool(2);
+    EXPECT_EQ(pool.GetThreadCount(), 2u);
+    
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 10; ++i) {
+        results.push_back(pool.Submit([i]() { return i * i; }));
+    }
+    
+    int sum = 0;
+    for (auto& result : results) {
+        sum += result.get();
+    }
+    EXPECT_EQ(sum, 285);
+}
+
+TEST(WorkerPoolTest, ShutdownDrainsQueueAndRejectsNewTasks) {
+    WorkerPool pool(1);
+    std::atomic<int> executed{0};
+    
+    for (int i = 0; i < 5; ++i) {
+        pool.Post([&executed]() { executed++; });
+    }
+    pool.Shutdown();
+    
+    EXPECT_EQ(executed.load(), 5);
+    EXPECT_FALSE(pool.IsRunning());
+    EXPECT_FALSE(pool.Post([]() {}));
+    EXPECT_THROW(pool.Submit([]() { return 0; }), std::runtime_error);
 }
 
 // Tests de ServiceMetrics